@@ -181,6 +181,28 @@ endif()
 #	message(FATAL_ERROR "time_t is less than 64-bit")
 #endif()
 
+#
+# AVX2, for code that's built with AVX2_FLAG in addition to the normal
+# flags and only called if ws_cpuid_avx2() says the CPU supports it.
+# As for SSE 4.2 in wsutil, we assume MSVC doesn't need a flag for the
+# intrinsics.
+#
+if(CMAKE_SYSTEM_PROCESSOR MATCHES "x86_64|AMD64")
+	if(CMAKE_C_COMPILER_ID MATCHES "MSVC")
+		set(AVX2_FLAG "")
+		check_include_file("immintrin.h" HAVE_AVX2)
+	else()
+		check_c_compiler_flag(-mavx2 COMPILER_CAN_HANDLE_AVX2)
+		if(COMPILER_CAN_HANDLE_AVX2)
+			set(AVX2_FLAG "-mavx2")
+			cmake_push_check_state()
+			set(CMAKE_REQUIRED_FLAGS "${AVX2_FLAG}")
+			check_include_file("immintrin.h" HAVE_AVX2)
+			cmake_pop_check_state()
+		endif()
+	endif()
+endif()
+
 #
 # Check if the libc vsnprintf() conforms to C99. If this fails we may
 # need to fall-back on GLib I/O.
@@ -50,6 +50,7 @@
 #include <stdarg.h>
 #include <locale.h>
 
+#include <ws_attributes.h>
 #include <ws_exit_codes.h>
 #include <wsutil/clopts_common.h>
 #include <wsutil/ws_getopt.h>
@@ -147,16 +148,13 @@ static bool cap_file_hashes    = true;  /* Calculate file hashes */
 #define HASH_STR_SIZE (65) /* Max hash size * 2 + '\0' */
 #define HASH_BUF_SIZE (1024 * 1024)
 
-
-static char file_sha256[HASH_STR_SIZE];
-static char file_sha1[HASH_STR_SIZE];
-
-static char  *hash_buf;
-static gcry_md_hd_t hd;
-
-static unsigned int num_ipv4_addresses;
-static unsigned int num_ipv6_addresses;
-static unsigned int num_decryption_secrets;
+/*
+ * Counters for the wiretap callbacks, which have no user data; they're
+ * per-thread, as files can be processed in parallel with -j.
+ */
+static WS_THREAD_LOCAL unsigned int num_ipv4_addresses;
+static WS_THREAD_LOCAL unsigned int num_ipv6_addresses;
+static WS_THREAD_LOCAL unsigned int num_decryption_secrets;
 
 /*
  * If we have at least two packets with time stamps, and they're not in
@@ -217,6 +215,13 @@ typedef struct _capture_info {
     GArray               *interface_packet_counts;  /* array of per_packet interface_id counts; one entry per file IDB */
     uint32_t              pkt_interface_id_unknown; /* counts if packet interface_id didn't match a known one */
     GArray               *idb_info_strings;         /* array of IDB info strings */
+
+    unsigned int          num_ipv4_addresses;
+    unsigned int          num_ipv6_addresses;
+    unsigned int          num_decryption_secrets;
+
+    char                  file_sha256[HASH_STR_SIZE];
+    char                  file_sha1[HASH_STR_SIZE];
 } capture_info;
 
 static char *decimal_point;
@@ -591,8 +596,8 @@ print_stats(const char *filename, capture_info *cf_info)
         }
     }
     if (cap_file_hashes) {
-        printf     ("SHA256:              %s\n", file_sha256);
-        printf     ("SHA1:                %s\n", file_sha1);
+        printf     ("SHA256:              %s\n", cf_info->file_sha256);
+        printf     ("SHA1:                %s\n", cf_info->file_sha1);
     }
     if (cap_order)          printf     ("Strict time order:   %s\n", order_string(cf_info->order));
 
@@ -657,14 +662,14 @@ print_stats(const char *filename, capture_info *cf_info)
     }
 
     if (cap_file_nrb) {
-        if (num_ipv4_addresses != 0)
-            printf   ("Number of resolved IPv4 addresses in file: %u\n", num_ipv4_addresses);
-        if (num_ipv6_addresses != 0)
-            printf   ("Number of resolved IPv6 addresses in file: %u\n", num_ipv6_addresses);
+        if (cf_info->num_ipv4_addresses != 0)
+            printf   ("Number of resolved IPv4 addresses in file: %u\n", cf_info->num_ipv4_addresses);
+        if (cf_info->num_ipv6_addresses != 0)
+            printf   ("Number of resolved IPv6 addresses in file: %u\n", cf_info->num_ipv6_addresses);
     }
     if (cap_file_dsb) {
-        if (num_decryption_secrets != 0)
-            printf   ("Number of decryption secrets in file: %u\n", num_decryption_secrets);
+        if (cf_info->num_decryption_secrets != 0)
+            printf   ("Number of decryption secrets in file: %u\n", cf_info->num_decryption_secrets);
     }
 }
 
@@ -895,12 +900,12 @@ print_stats_table(const char *filename, capture_info *cf_info)
     if (cap_file_hashes) {
         putsep();
         putquote();
-        printf("%s", file_sha256);
+        printf("%s", cf_info->file_sha256);
         putquote();
 
         putsep();
         putquote();
-        printf("%s", file_sha1);
+        printf("%s", cf_info->file_sha1);
         putquote();
     }
 
@@ -1051,31 +1056,43 @@ hash_to_str(const unsigned char *hash, size_t length, char *str)
 }
 
 static void
-calculate_hashes(const char *filename)
+calculate_hashes(const char *filename, capture_info *cf_info)
 {
     FILE  *fh;
     size_t hash_bytes;
+    char  *hash_buf;
+    gcry_md_hd_t hd = NULL;
 
-    (void) g_strlcpy(file_sha256, "<unknown>", HASH_STR_SIZE);
-    (void) g_strlcpy(file_sha1, "<unknown>", HASH_STR_SIZE);
+    (void) g_strlcpy(cf_info->file_sha256, "<unknown>", HASH_STR_SIZE);
+    (void) g_strlcpy(cf_info->file_sha1, "<unknown>", HASH_STR_SIZE);
 
     if (cap_file_hashes) {
         fh = ws_fopen(filename, "rb");
-        if (fh && hd) {
+        if (fh && gcry_md_open(&hd, GCRY_MD_SHA256, 0) == 0) {
+            gcry_md_enable(hd, GCRY_MD_SHA1);
+            hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
             while((hash_bytes = fread(hash_buf, 1, HASH_BUF_SIZE, fh)) > 0) {
                 gcry_md_write(hd, hash_buf, hash_bytes);
             }
             gcry_md_final(hd);
-            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, file_sha256);
-            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, file_sha1);
+            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA256), HASH_SIZE_SHA256, cf_info->file_sha256);
+            hash_to_str(gcry_md_read(hd, GCRY_MD_SHA1), HASH_SIZE_SHA1, cf_info->file_sha1);
+            g_free(hash_buf);
+            gcry_md_close(hd);
         }
         if (fh) fclose(fh);
-        if (hd) gcry_md_reset(hd);
     }
 }
 
+/*
+ * Read a file and fill in cf_info. Returns 2 on failure, in which case
+ * the file has been closed; otherwise the file is left open, as printing
+ * the report needs it, and cf_info must be given to print_cap_file().
+ *
+ * If hash is false, the hashes are left to the caller.
+ */
 static int
-process_cap_file(const char *filename, bool need_separator)
+scan_cap_file(const char *filename, capture_info *cf_info, bool hash)
 {
     int                   status = 0;
     int                   err;
@@ -1088,7 +1105,6 @@ process_cap_file(const char *filename, bool need_separator)
     uint32_t              snaplen_min_inferred = 0xffffffff;
     uint32_t              snaplen_max_inferred =          0;
     wtap_rec              rec;
-    capture_info          cf_info;
     bool                  have_times = true;
     nstime_t              earliest_packet_time;
     int                   earliest_packet_time_tsprec;
@@ -1103,8 +1119,8 @@ process_cap_file(const char *filename, bool need_separator)
 
     pkt_cmt *pc = NULL, *prev = NULL;
 
-    cf_info.wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, false);
-    if (!cf_info.wth) {
+    cf_info->wth = wtap_open_offline(filename, WTAP_TYPE_AUTO, &err, &err_info, false);
+    if (!cf_info->wth) {
         cfile_open_failure_message(filename, err, err_info);
         return 2;
     }
@@ -1114,10 +1130,8 @@ process_cap_file(const char *filename, bool need_separator)
      * bother calculating them for files that are not known capture types
      * where we wouldn't print them anyway.
      */
-    calculate_hashes(filename);
-
-    if (need_separator && long_report) {
-        printf("\n");
+    if (hash) {
+        calculate_hashes(filename, cf_info);
     }
 
     nstime_set_zero(&earliest_packet_time);
@@ -1127,17 +1141,17 @@ process_cap_file(const char *filename, bool need_separator)
     nstime_set_zero(&cur_time);
     nstime_set_zero(&prev_time);
 
-    cf_info.encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
+    cf_info->encap_counts = g_new0(int,WTAP_NUM_ENCAP_TYPES);
 
-    idb_info = wtap_file_get_idb_info(cf_info.wth);
+    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
     ws_assert(idb_info->interface_data != NULL);
 
-    cf_info.pkt_cmts = NULL;
-    cf_info.num_interfaces = idb_info->interface_data->len;
-    cf_info.interface_packet_counts  = g_array_sized_new(false, true, sizeof(uint32_t), cf_info.num_interfaces);
-    g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
-    cf_info.pkt_interface_id_unknown = 0;
+    cf_info->pkt_cmts = NULL;
+    cf_info->num_interfaces = idb_info->interface_data->len;
+    cf_info->interface_packet_counts  = g_array_sized_new(false, true, sizeof(uint32_t), cf_info->num_interfaces);
+    g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
+    cf_info->pkt_interface_id_unknown = 0;
 
     g_free(idb_info);
     idb_info = NULL;
@@ -1149,13 +1163,13 @@ process_cap_file(const char *filename, bool need_separator)
 
     /* Register callbacks for new name<->address maps from the file and
        decryption secrets from the file. */
-    wtap_set_cb_new_ipv4(cf_info.wth, count_ipv4_address);
-    wtap_set_cb_new_ipv6(cf_info.wth, count_ipv6_address);
-    wtap_set_cb_new_secrets(cf_info.wth, count_decryption_secret);
+    wtap_set_cb_new_ipv4(cf_info->wth, count_ipv4_address);
+    wtap_set_cb_new_ipv6(cf_info->wth, count_ipv6_address);
+    wtap_set_cb_new_secrets(cf_info->wth, count_decryption_secret);
 
     /* Tally up data that we need to parse through the file to find */
     wtap_rec_init(&rec, 1514);
-    while (wtap_read(cf_info.wth, &rec, &err, &err_info, &data_offset))  {
+    while (wtap_read(cf_info->wth, &rec, &err, &err_info, &data_offset))  {
         if (rec.presence_flags & WTAP_HAS_TS) {
             prev_time = cur_time;
             cur_time = rec.ts;
@@ -1197,7 +1211,7 @@ process_cap_file(const char *filename, bool need_separator)
                 pc->next = NULL;
 
                 if (prev == NULL)
-                  cf_info.pkt_cmts = pc;
+                  cf_info->pkt_cmts = pc;
                 else
                   prev->next = pc;
 
@@ -1218,7 +1232,7 @@ process_cap_file(const char *filename, bool need_separator)
 
             if ((rec.rec_header.packet_header.pkt_encap > 0) &&
                     (rec.rec_header.packet_header.pkt_encap < WTAP_NUM_ENCAP_TYPES)) {
-                cf_info.encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
+                cf_info->encap_counts[rec.rec_header.packet_header.pkt_encap] += 1;
             } else {
                 fprintf(stderr, "capinfos: Unknown packet encapsulation %d in frame %u of file \"%s\"\n",
                         rec.rec_header.packet_header.pkt_encap, packet, filename);
@@ -1226,37 +1240,37 @@ process_cap_file(const char *filename, bool need_separator)
 
             /* Packet interface_id info */
             if (rec.presence_flags & WTAP_HAS_INTERFACE_ID) {
-                /* cf_info.num_interfaces is size, not index, so it's one more than max index */
-                if (rec.rec_header.packet_header.interface_id >= cf_info.num_interfaces) {
+                /* cf_info->num_interfaces is size, not index, so it's one more than max index */
+                if (rec.rec_header.packet_header.interface_id >= cf_info->num_interfaces) {
                     /*
                      * OK, re-fetch the number of interfaces, as there might have
                      * been an interface that was in the middle of packets, and
                      * grow the array to be big enough for the new number of
                      * interfaces.
                      */
-                    idb_info = wtap_file_get_idb_info(cf_info.wth);
+                    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
-                    cf_info.num_interfaces = idb_info->interface_data->len;
-                    g_array_set_size(cf_info.interface_packet_counts, cf_info.num_interfaces);
+                    cf_info->num_interfaces = idb_info->interface_data->len;
+                    g_array_set_size(cf_info->interface_packet_counts, cf_info->num_interfaces);
 
                     g_free(idb_info);
                     idb_info = NULL;
                 }
-                if (rec.rec_header.packet_header.interface_id < cf_info.num_interfaces) {
-                    g_array_index(cf_info.interface_packet_counts, uint32_t,
+                if (rec.rec_header.packet_header.interface_id < cf_info->num_interfaces) {
+                    g_array_index(cf_info->interface_packet_counts, uint32_t,
                             rec.rec_header.packet_header.interface_id) += 1;
                 }
                 else {
-                    cf_info.pkt_interface_id_unknown += 1;
+                    cf_info->pkt_interface_id_unknown += 1;
                 }
             }
             else {
                 /* it's for interface_id 0 */
-                if (cf_info.num_interfaces != 0) {
-                    g_array_index(cf_info.interface_packet_counts, uint32_t, 0) += 1;
+                if (cf_info->num_interfaces != 0) {
+                    g_array_index(cf_info->interface_packet_counts, uint32_t, 0) += 1;
                 }
                 else {
-                    cf_info.pkt_interface_id_unknown += 1;
+                    cf_info->pkt_interface_id_unknown += 1;
                 }
             }
         }
@@ -1272,14 +1286,14 @@ process_cap_file(const char *filename, bool need_separator)
      * we get, for example, a count of the number of statistics entries
      * for each interface as of the *end* of the file.
      */
-    idb_info = wtap_file_get_idb_info(cf_info.wth);
+    idb_info = wtap_file_get_idb_info(cf_info->wth);
 
-    cf_info.idb_info_strings = g_array_sized_new(false, false, sizeof(char*), cf_info.num_interfaces);
-    cf_info.num_interfaces = idb_info->interface_data->len;
-    for (i = 0; i < cf_info.num_interfaces; i++) {
+    cf_info->idb_info_strings = g_array_sized_new(false, false, sizeof(char*), cf_info->num_interfaces);
+    cf_info->num_interfaces = idb_info->interface_data->len;
+    for (i = 0; i < cf_info->num_interfaces; i++) {
         const wtap_block_t if_descr = g_array_index(idb_info->interface_data, wtap_block_t, i);
         char *s = wtap_get_debug_if_descr(if_descr, 21, "\n");
-        g_array_append_val(cf_info.idb_info_strings, s);
+        g_array_append_val(cf_info->idb_info_strings, s);
     }
 
     g_free(idb_info);
@@ -1296,94 +1310,258 @@ process_cap_file(const char *filename, bool need_separator)
             fprintf(stderr,
                     "  (will continue anyway, checksums might be incorrect)\n");
         } else {
-            cleanup_capture_info(&cf_info);
-            wtap_close(cf_info.wth);
+            cleanup_capture_info(cf_info);
+            wtap_close(cf_info->wth);
             return 2;
         }
     }
 
     /* File size */
-    size = wtap_file_size(cf_info.wth, &err);
+    size = wtap_file_size(cf_info->wth, &err);
     if (size == -1) {
         fprintf(stderr,
                 "capinfos: Can't get size of \"%s\": %s.\n",
                 filename, g_strerror(err));
-        cleanup_capture_info(&cf_info);
-        wtap_close(cf_info.wth);
+        cleanup_capture_info(cf_info);
+        wtap_close(cf_info->wth);
         return 2;
     }
 
-    cf_info.filesize = size;
+    cf_info->filesize = size;
 
     /* File Type */
-    cf_info.file_type = wtap_file_type_subtype(cf_info.wth);
-    cf_info.compression_type = wtap_get_compression_type(cf_info.wth);
+    cf_info->file_type = wtap_file_type_subtype(cf_info->wth);
+    cf_info->compression_type = wtap_get_compression_type(cf_info->wth);
 
     /* File Encapsulation */
-    cf_info.file_encap = wtap_file_encap(cf_info.wth);
+    cf_info->file_encap = wtap_file_encap(cf_info->wth);
 
-    cf_info.file_tsprec = wtap_file_tsprec(cf_info.wth);
+    cf_info->file_tsprec = wtap_file_tsprec(cf_info->wth);
 
     /* Packet size limit (snaplen) */
-    cf_info.snaplen = wtap_snapshot_length(cf_info.wth);
-    if (cf_info.snaplen > 0)
-        cf_info.snap_set = true;
+    cf_info->snaplen = wtap_snapshot_length(cf_info->wth);
+    if (cf_info->snaplen > 0)
+        cf_info->snap_set = true;
     else
-        cf_info.snap_set = false;
+        cf_info->snap_set = false;
 
-    cf_info.snaplen_min_inferred = snaplen_min_inferred;
-    cf_info.snaplen_max_inferred = snaplen_max_inferred;
+    cf_info->snaplen_min_inferred = snaplen_min_inferred;
+    cf_info->snaplen_max_inferred = snaplen_max_inferred;
 
     /* # of packets */
-    cf_info.packet_count = packet;
+    cf_info->packet_count = packet;
 
     /* File Times */
-    cf_info.times_known = have_times;
-    cf_info.earliest_packet_time = earliest_packet_time;
-    cf_info.earliest_packet_time_tsprec = earliest_packet_time_tsprec;
-    cf_info.latest_packet_time = latest_packet_time;
-    cf_info.latest_packet_time_tsprec = latest_packet_time_tsprec;
-    nstime_delta(&cf_info.duration, &latest_packet_time, &earliest_packet_time);
+    cf_info->times_known = have_times;
+    cf_info->earliest_packet_time = earliest_packet_time;
+    cf_info->earliest_packet_time_tsprec = earliest_packet_time_tsprec;
+    cf_info->latest_packet_time = latest_packet_time;
+    cf_info->latest_packet_time_tsprec = latest_packet_time_tsprec;
+    nstime_delta(&cf_info->duration, &latest_packet_time, &earliest_packet_time);
     /* Duration precision is the higher of the earliest and latest packet timestamp precisions. */
-    if (cf_info.latest_packet_time_tsprec > cf_info.earliest_packet_time_tsprec)
-        cf_info.duration_tsprec = cf_info.latest_packet_time_tsprec;
+    if (cf_info->latest_packet_time_tsprec > cf_info->earliest_packet_time_tsprec)
+        cf_info->duration_tsprec = cf_info->latest_packet_time_tsprec;
     else
-        cf_info.duration_tsprec = cf_info.earliest_packet_time_tsprec;
-    cf_info.know_order = know_order;
-    cf_info.order = order;
+        cf_info->duration_tsprec = cf_info->earliest_packet_time_tsprec;
+    cf_info->know_order = know_order;
+    cf_info->order = order;
 
     /* Number of packet bytes */
-    cf_info.packet_bytes = bytes;
+    cf_info->packet_bytes = bytes;
 
-    cf_info.data_rate   = 0.0;
-    cf_info.packet_rate = 0.0;
-    cf_info.packet_size = 0.0;
+    cf_info->data_rate   = 0.0;
+    cf_info->packet_rate = 0.0;
+    cf_info->packet_size = 0.0;
 
     if (packet > 0) {
         double delta_time = nstime_to_sec(&latest_packet_time) - nstime_to_sec(&earliest_packet_time);
         if (delta_time > 0.0) {
-            cf_info.data_rate   = (double)bytes  / delta_time; /* Data rate per second */
-            cf_info.packet_rate = (double)packet / delta_time; /* packet rate per second */
+            cf_info->data_rate   = (double)bytes  / delta_time; /* Data rate per second */
+            cf_info->packet_rate = (double)packet / delta_time; /* packet rate per second */
         }
-        cf_info.packet_size = (double)bytes / packet;                  /* Avg packet size      */
+        cf_info->packet_size = (double)bytes / packet;                  /* Avg packet size      */
+    }
+
+    cf_info->num_ipv4_addresses = num_ipv4_addresses;
+    cf_info->num_ipv6_addresses = num_ipv6_addresses;
+    cf_info->num_decryption_secrets = num_decryption_secrets;
+
+    return status;
+}
+
+/* Print the report for a file read by scan_cap_file(), and close it. */
+static void
+print_cap_file(const char *filename, capture_info *cf_info, bool need_separator)
+{
+    if (need_separator && long_report) {
+        printf("\n");
     }
 
     if (!long_report && table_report_header) {
-      print_stats_table_header(&cf_info);
+      print_stats_table_header(cf_info);
     }
 
     if (long_report) {
-        print_stats(filename, &cf_info);
+        print_stats(filename, cf_info);
     } else {
-        print_stats_table(filename, &cf_info);
+        print_stats_table(filename, cf_info);
     }
 
-    cleanup_capture_info(&cf_info);
-    wtap_close(cf_info.wth);
+    cleanup_capture_info(cf_info);
+    wtap_close(cf_info->wth);
+}
+
+static int
+process_cap_file(const char *filename, bool need_separator)
+{
+    capture_info cf_info;
+    int          status;
 
+    status = scan_cap_file(filename, &cf_info, true);
+    if (status != 2) {
+        print_cap_file(filename, &cf_info, need_separator);
+    }
     return status;
 }
 
+/*
+ * Processing files in parallel, for -j.
+ *
+ * Each file is read by a worker thread, and its hashes, which take a
+ * separate pass over the file, are calculated by another one. The main
+ * thread prints the reports in the order in which the files were given.
+ * As a file stays open until its report has been printed, only a few
+ * more files than there are threads are processed at a time.
+ */
+typedef struct _file_job file_job;
+
+typedef struct {
+    file_job     *job;
+    bool          hash;
+} file_task;
+
+struct _file_job {
+    const char   *filename;
+    capture_info  cf_info;
+    int           status;
+    unsigned      pending;      /* tasks not done yet */
+    file_task     scan_task;
+    file_task     hash_task;
+};
+
+static GMutex jobs_mutex;
+static GCond  jobs_cond;
+static bool   jobs_cancelled;   /* -C and a file failed */
+
+static void
+run_file_task(void *data, void *user_data _U_)
+{
+    file_task *task = (file_task *)data;
+    file_job  *job = task->job;
+    bool       cancelled;
+
+    g_mutex_lock(&jobs_mutex);
+    cancelled = jobs_cancelled;
+    g_mutex_unlock(&jobs_mutex);
+
+    if (task->hash) {
+        if (!cancelled)
+            calculate_hashes(job->filename, &job->cf_info);
+    } else {
+        if (cancelled)
+            job->status = 2;
+        else
+            job->status = scan_cap_file(job->filename, &job->cf_info, !cap_file_hashes);
+    }
+
+    g_mutex_lock(&jobs_mutex);
+    if (--job->pending == 0)
+        g_cond_broadcast(&jobs_cond);
+    g_mutex_unlock(&jobs_mutex);
+}
+
+static void
+start_file_job(GThreadPool *pool, file_job *job, const char *filename)
+{
+    job->filename = filename;
+    job->status = 0;
+    job->scan_task.job = job;
+    job->scan_task.hash = false;
+    job->hash_task.job = job;
+    job->hash_task.hash = true;
+
+    /* Without hashes, the scan just sets them to "<unknown>" */
+    job->pending = cap_file_hashes ? 2 : 1;
+    g_thread_pool_push(pool, &job->scan_task, NULL);
+    if (cap_file_hashes)
+        g_thread_pool_push(pool, &job->hash_task, NULL);
+}
+
+static void
+wait_file_job(file_job *job)
+{
+    g_mutex_lock(&jobs_mutex);
+    while (job->pending != 0)
+        g_cond_wait(&jobs_cond, &jobs_mutex);
+    g_mutex_unlock(&jobs_mutex);
+}
+
+static int
+process_cap_files_parallel(char **filenames, int file_count, int threads)
+{
+    GThreadPool *pool;
+    file_job    *jobs;
+    int          max_jobs = threads * 2;
+    int          started = 0;
+    int          done;
+    bool         need_separator = false;
+    int          overall_error_status = 0;
+
+    jobs = g_new0(file_job, max_jobs);
+    pool = g_thread_pool_new(run_file_task, NULL, threads, false, NULL);
+
+    for (done = 0; done < file_count; done++) {
+        file_job *job = &jobs[done % max_jobs];
+
+        while (started < file_count && started < done + max_jobs) {
+            start_file_job(pool, &jobs[started % max_jobs], filenames[started]);
+            started++;
+        }
+
+        wait_file_job(job);
+        if (job->status != 2) {
+            print_cap_file(job->filename, &job->cf_info, need_separator);
+            /* As in main(), separate it from the next report */
+            need_separator = true;
+        }
+        if (job->status) {
+            overall_error_status = job->status;
+            if (stop_after_failure) {
+                done++;
+                break;
+            }
+        }
+    }
+
+    /* If -C stopped us, drop the files that are still being processed */
+    g_mutex_lock(&jobs_mutex);
+    jobs_cancelled = true;
+    g_mutex_unlock(&jobs_mutex);
+    for (; done < started; done++) {
+        file_job *job = &jobs[done % max_jobs];
+
+        wait_file_job(job);
+        if (job->status != 2) {
+            cleanup_capture_info(&job->cf_info);
+            wtap_close(job->cf_info.wth);
+        }
+    }
+
+    g_thread_pool_free(pool, false, true);
+    g_free(jobs);
+    return overall_error_status;
+}
+
 static void
 print_usage(FILE *output)
 {
@@ -1443,6 +1621,7 @@ print_usage(FILE *output)
     fprintf(output, "  -h, --help               display this help and exit\n");
     fprintf(output, "  -v, --version            display version info and exit\n");
     fprintf(output, "  -C cancel processing if file open fails (default is to continue)\n");
+    fprintf(output, "  -j <threads> process files with the given number of threads\n");
     fprintf(output, "  -A generate all infos (default)\n");
     fprintf(output, "  -K disable displaying the capture comment\n");
     fprintf(output, "  -P disable displaying individual packet comments\n");
@@ -1461,6 +1640,7 @@ main(int argc, char *argv[])
     bool need_separator = false;
     int    opt;
     int    overall_error_status = EXIT_SUCCESS;
+    int    threads = 1;
     static const struct ws_option long_options[] = {
         {"help", ws_no_argument, NULL, 'h'},
         {"version", ws_no_argument, NULL, 'v'},
@@ -1468,7 +1648,7 @@ main(int argc, char *argv[])
         {0, 0, 0, 0 }
     };
 
-#define OPTSTRING "abcdehiklmnopqrstuvxyzABCDEFHIKLMNPQRST"
+#define OPTSTRING "abcdehij:klmnopqrstuvxyzABCDEFHIKLMNPQRST"
     static const char optstring[] = OPTSTRING;
 
     int status = 0;
@@ -1653,6 +1833,13 @@ main(int argc, char *argv[])
                 stop_after_failure = true;
                 break;
 
+            case 'j':
+                if (!get_positive_int(ws_optarg, "number of threads", &threads)) {
+                    overall_error_status = WS_EXIT_INVALID_OPTION;
+                    goto exit;
+                }
+                break;
+
             case 'A':
                 enable_all_infos();
                 break;
@@ -1728,15 +1915,16 @@ main(int argc, char *argv[])
 
     if (cap_file_hashes) {
         gcry_check_version(NULL);
-        gcry_md_open(&hd, GCRY_MD_SHA256, 0);
-        if (hd)
-            gcry_md_enable(hd, GCRY_MD_SHA1);
-
-        hash_buf = (char *)g_malloc(HASH_BUF_SIZE);
     }
 
     overall_error_status = 0;
 
+    if (threads > 1) {
+        overall_error_status = process_cap_files_parallel(&argv[ws_optind],
+                argc - ws_optind, threads);
+        goto exit;
+    }
+
     for (opt = ws_optind; opt < argc; opt++) {
 
         status = process_cap_file(argv[opt], need_separator);
@@ -1757,8 +1945,6 @@ main(int argc, char *argv[])
     }
 
 exit:
-    g_free(hash_buf);
-    gcry_md_close(hd);
     wtap_cleanup();
     free_progdirs();
     return overall_error_status;
@@ -350,6 +350,7 @@ typedef struct _loop_data {
     int       err;                 /**< if non-zero, error seen while capturing */
     int       packets_captured;    /**< Number of packets we have already captured */
     unsigned  inpkts_to_sync_pipe; /**< Packets not already send out to the sync_pipe */
+    unsigned  inpkts_flushing;     /**< Packets flushed to the capture file, but maybe not yet in it */
 #ifdef SIGINFO
     bool      report_packet_count; /**< Set by SIGINFO handler; print packet count */
 #endif
@@ -431,6 +432,10 @@ dumpcap_log_writer(const char *domain, enum ws_log_level level,
 /* capture related options */
 static capture_options global_capture_opts;
 static GPtrArray *capture_comments;
+
+/* Size of each of the two buffers used by the writer thread. */
+#define WRITER_BUFFER_SIZE  (4 * 1024 * 1024)
+
 static bool quiet;
 static bool really_quiet;
 static bool use_threads;
@@ -3553,6 +3558,30 @@ capture_loop_init_pcapng_output(capture_options *capture_opts, loop_data *ld,
     return successful;
 }
 
+/*
+ * Returns true if the output can be written from a separate thread, so
+ * that a slow disk doesn't keep us from reading packets. That's only
+ * worth it for uncompressed files that are flushed once per update
+ * interval; pipes and pcapng sources are flushed after every packet.
+ */
+static bool
+capture_loop_can_write_async(capture_options *capture_opts, loop_data *ld)
+{
+    capture_src *pcap_src;
+
+    if (capture_opts->output_to_pipe ||
+        wtap_name_to_compression_type(capture_opts->compress_type) != WTAP_UNCOMPRESSED) {
+        return false;
+    }
+    for (unsigned i = 0; i < ld->pcaps->len; i++) {
+        pcap_src = g_array_index(ld->pcaps, capture_src *, i);
+        if (pcap_src->from_pcapng) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /* set up to write to the already-opened capture output file/files */
 static bool
 capture_loop_init_output(capture_options *capture_opts, loop_data *ld, char *errmsg, int errmsg_len)
@@ -3570,7 +3599,9 @@ capture_loop_init_output(capture_options *capture_opts, loop_data *ld, char *err
 
     /* Set up to write to the capture file. */
     if (capture_opts->multi_files_on) {
-        ld->pdh = ringbuf_init_libpcap_fdopen(&err);
+        ld->pdh = ringbuf_init_libpcap_fdopen(capture_loop_can_write_async(capture_opts, ld) ? WRITER_BUFFER_SIZE : 0, &err);
+    } else if (capture_loop_can_write_async(capture_opts, ld)) {
+        ld->pdh = writecap_fdopen_async(ld->save_file_fd, WRITER_BUFFER_SIZE, &err);
     } else {
         ld->pdh = writecap_fdopen(ld->save_file_fd, wtap_name_to_compression_type(capture_opts->compress_type), &err);
     }
@@ -3745,15 +3776,17 @@ capture_loop_dispatch(loop_data *ld,
                  * "select()" says we can read from it without blocking; go for
                  * it.
                  *
-                 * We don't have pcap_breakloop(), so we only process one packet
-                 * per pcap_dispatch() call, to allow a signal to stop the
-                 * processing immediately, rather than processing all packets
-                 * in a batch before quitting.
+                 * Process everything that is in the buffer (with TPACKET_V3,
+                 * a whole block) per pcap_dispatch() call, rather than one
+                 * packet per wakeup. capture_loop_stop() calls
+                 * pcap_breakloop(), and the callbacks ignore packets once
+                 * we've been told to stop, so a signal still stops the
+                 * processing promptly.
                  */
                 if (use_threads) {
-                    inpkts = pcap_dispatch(pcap_src->pcap_h, 1, capture_loop_queue_packet_cb, (uint8_t *)pcap_src);
+                    inpkts = pcap_dispatch(pcap_src->pcap_h, -1, capture_loop_queue_packet_cb, (uint8_t *)pcap_src);
                 } else {
-                    inpkts = pcap_dispatch(pcap_src->pcap_h, 1, capture_loop_write_packet_cb, (uint8_t *)pcap_src);
+                    inpkts = pcap_dispatch(pcap_src->pcap_h, -1, capture_loop_write_packet_cb, (uint8_t *)pcap_src);
                 }
                 if (inpkts < 0) {
                     if (inpkts == -1) {
@@ -4122,6 +4155,10 @@ do_file_switch_or_stop(capture_options *capture_opts)
                 global_ld.next_interval_time = get_next_time_interval(global_ld.interval_s);
             }
             writecap_flush(global_ld.pdh, NULL);
+            writecap_flushed(global_ld.pdh, true);
+            /* The previous file is closed, so all its packets are in it. */
+            global_ld.inpkts_to_sync_pipe += global_ld.inpkts_flushing;
+            global_ld.inpkts_flushing = 0;
             if (global_ld.inpkts_to_sync_pipe) {
                 if (!quiet)
                     report_packet_count(global_ld.inpkts_to_sync_pipe);
@@ -4263,6 +4300,7 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
     global_ld.report_packet_count = false;
 #endif
     global_ld.inpkts_to_sync_pipe = 0;
+    global_ld.inpkts_flushing     = 0;
     global_ld.err                 = 0;  /* no error seen yet */
     global_ld.pdh                 = NULL;
     global_ld.save_file_fd        = -1;
@@ -4340,6 +4378,7 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
            update its windows to indicate that we have a live capture in
            progress. */
         writecap_flush(global_ld.pdh, NULL);
+        writecap_flushed(global_ld.pdh, true);
         report_new_capture_file(capture_opts->save_file);
     }
 
@@ -4460,16 +4499,21 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
             }
 #endif
             /* Let the parent process know. */
-            if (global_ld.inpkts_to_sync_pipe) {
+            if (global_ld.inpkts_to_sync_pipe && !global_ld.inpkts_flushing) {
                 /* do sync here */
                 writecap_flush(global_ld.pdh, NULL);
-
+                global_ld.inpkts_flushing = global_ld.inpkts_to_sync_pipe;
+                global_ld.inpkts_to_sync_pipe = 0;
+            }
+            /* The writer thread may still be writing them; if so, try
+               again after the next interval instead of waiting. */
+            if (global_ld.inpkts_flushing && writecap_flushed(global_ld.pdh, false)) {
                 /* Send our parent a message saying we've written out
-                   "global_ld.inpkts_to_sync_pipe" packets to the capture file. */
+                   "global_ld.inpkts_flushing" packets to the capture file. */
                 if (!quiet)
-                    report_packet_count(global_ld.inpkts_to_sync_pipe);
+                    report_packet_count(global_ld.inpkts_flushing);
 
-                global_ld.inpkts_to_sync_pipe = 0;
+                global_ld.inpkts_flushing = 0;
             }
 
             /* check capture duration condition */
@@ -4658,6 +4702,8 @@ capture_loop_start(capture_options *capture_opts, bool *stats_known, struct pcap
 
     /* there might be packets not yet notified to the parent */
     /* (do this after closing the file, so all packets are already flushed) */
+    global_ld.inpkts_to_sync_pipe += global_ld.inpkts_flushing;
+    global_ld.inpkts_flushing = 0;
     if (global_ld.inpkts_to_sync_pipe) {
         if (!quiet)
             report_packet_count(global_ld.inpkts_to_sync_pipe);
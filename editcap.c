@@ -1040,6 +1040,8 @@ print_usage(FILE *output)
     fprintf(output, "                         comments added by \"--capture-comment\" in the same\n");
     fprintf(output, "                         command line.\n");
     fprintf(output, "  --compress <type>      Compress the output file using the type compression format.\n");
+    fprintf(output, "  --compress-threads <n> Use <n> threads to compress the output file;\n");
+    fprintf(output, "                         0 is one per processor, default is 1.\n");
     fprintf(output, "\n");
     fprintf(output, "Miscellaneous:\n");
     fprintf(output, "  -h, --help             display this help and exit.\n");
@@ -1400,6 +1402,7 @@ main(int argc, char *argv[])
 #define LONGOPT_PRESERVE_PACKET_COMMENTS LONGOPT_BASE_APPLICATION+10
 #define LONGOPT_EXTRACT_SECRETS          LONGOPT_BASE_APPLICATION+11
 #define LONGOPT_COMPRESS                 LONGOPT_BASE_APPLICATION+12
+#define LONGOPT_COMPRESS_THREADS         LONGOPT_BASE_APPLICATION+13
 
     static const struct ws_option long_options[] = {
         {"novlan", ws_no_argument, NULL, LONGOPT_NO_VLAN},
@@ -1416,6 +1419,7 @@ main(int argc, char *argv[])
         {"preserve-packet-comments", ws_no_argument, NULL, LONGOPT_PRESERVE_PACKET_COMMENTS},
         {"extract-secrets", ws_no_argument, NULL, LONGOPT_EXTRACT_SECRETS},
         {"compress", ws_required_argument, NULL, LONGOPT_COMPRESS},
+        {"compress-threads", ws_required_argument, NULL, LONGOPT_COMPRESS_THREADS},
         LONGOPT_WSLOG
         {0, 0, 0, 0 }
     };
@@ -1642,6 +1646,18 @@ main(int argc, char *argv[])
             break;
         }
 
+        case LONGOPT_COMPRESS_THREADS:
+        {
+            uint32_t compress_threads;
+
+            if (!get_uint32(ws_optarg, "number of compression threads", &compress_threads)) {
+                ret = WS_EXIT_INVALID_OPTION;
+                goto clean_exit;
+            }
+            wtap_set_compression_threads(compress_threads);
+            break;
+        }
+
         case 'a':
         {
             uint64_t frame_number;
@@ -178,6 +178,21 @@ static wmem_map_t *conversation_hashtable_deinterlacer = NULL;
 
 static uint32_t new_index;
 
+/*
+ * If usage is tracked, all conversations in the order in which they
+ * were last used, least recently used first, for conversation_expire().
+ */
+static bool track_usage;
+static conversation_t *lru_head;
+static conversation_t *lru_tail;
+static unsigned lru_count;
+
+/*
+ * Routines to release protocol data of expired conversations, keyed
+ * by protocol ID.
+ */
+static wmem_map_t *expire_routines;
+
 /*
  * Placeholder for address-less conversations.
  */
@@ -395,6 +410,10 @@ conversation_create_from_template(conversation_t *conversation, const address *a
          * the handler of the new conversation as well.
          */
         new_conversation_from_template->dissector_tree = conversation->dissector_tree;
+        if (conversation->dissector_tree) {
+            conversation->dissector_tree_shared = true;
+            new_conversation_from_template->dissector_tree_shared = true;
+        }
 
         return new_conversation_from_template;
     }
@@ -760,6 +779,61 @@ conversation_epan_reset(void)
      * Start the conversation indices over at 0.
      */
     new_index = 0;
+
+    /*
+     * The conversations went away with the file scope.
+     */
+    lru_head = NULL;
+    lru_tail = NULL;
+    lru_count = 0;
+}
+
+static void
+conversation_lru_unlink(conversation_t *conv)
+{
+    if (conv->lru_prev)
+        conv->lru_prev->lru_next = conv->lru_next;
+    else
+        lru_head = conv->lru_next;
+
+    if (conv->lru_next)
+        conv->lru_next->lru_prev = conv->lru_prev;
+    else
+        lru_tail = conv->lru_prev;
+
+    conv->lru_prev = NULL;
+    conv->lru_next = NULL;
+    lru_count--;
+}
+
+/*
+ * Note that a conversation was used, making it the most recently used one.
+ * Conversations created while usage wasn't tracked are added here when
+ * they're first used.
+ */
+static inline void
+conversation_touch(conversation_t *conv, const uint32_t frame_num)
+{
+    if (!track_usage)
+        return;
+
+    if (frame_num > conv->last_used)
+        conv->last_used = frame_num;
+
+    if (conv == lru_tail)
+        return;
+
+    if (conv->lru_prev || conv == lru_head)
+        conversation_lru_unlink(conv);
+
+    conv->lru_prev = lru_tail;
+    conv->lru_next = NULL;
+    if (lru_tail)
+        lru_tail->lru_next = conv;
+    else
+        lru_head = conv;
+    lru_tail = conv;
+    lru_count++;
 }
 
 /*
@@ -773,6 +847,8 @@ conversation_insert_into_hashtable(wmem_map_t *hashtable, conversation_t *conv)
 {
     conversation_t *chain_head, *chain_tail, *cur, *prev;
 
+    conversation_touch(conv, conv->setup_frame);
+
     chain_head = (conversation_t *)wmem_map_lookup(hashtable, conv->key_ptr);
 
     if (NULL==chain_head) {
@@ -1443,6 +1519,12 @@ conversation_set_port2(conversation_t *conv, const uint32_t port)
     if ((!(conv->options & NO_PORT2)) || (conv->options & NO_PORT2_FORCE))
         return;
 
+    /*
+     * An expired conversation isn't in any of the tables any more.
+     */
+    if (conv->expired)
+        return;
+
     DINDENT();
     if (conv->options & NO_ADDR2) {
         conversation_remove_from_hashtable(conversation_hashtable_no_addr2_or_port2, conv);
@@ -1490,6 +1572,12 @@ conversation_set_addr2(conversation_t *conv, const address *addr)
     if (!(conv->options & NO_ADDR2))
         return;
 
+    /*
+     * An expired conversation isn't in any of the tables any more.
+     */
+    if (conv->expired)
+        return;
+
     DINDENT();
     if (conv->options & NO_PORT2) {
         conversation_remove_from_hashtable(conversation_hashtable_no_addr2_or_port2, conv);
@@ -1528,8 +1616,10 @@ static conversation_t *conversation_lookup_hashtable(wmem_map_t *conversation_ha
     if (chain_head && (chain_head->setup_frame <= frame_num)) {
         match = chain_head;
 
-        if (chain_head->last && (chain_head->last->setup_frame <= frame_num))
+        if (chain_head->last && (chain_head->last->setup_frame <= frame_num)) {
+            conversation_touch(chain_head->last, frame_num);
             return chain_head->last;
+        }
 
         if (chain_head->latest_found && (chain_head->latest_found->setup_frame <= frame_num))
             match = chain_head->latest_found;
@@ -1543,6 +1633,7 @@ static conversation_t *conversation_lookup_hashtable(wmem_map_t *conversation_ha
 
     if (match) {
         chain_head->latest_found = match;
+        conversation_touch(match, frame_num);
     }
 
     return match;
@@ -2695,6 +2786,90 @@ conversation_delete_proto_data(conversation_t *conv, const int proto)
         wmem_tree_remove32(conv->data_list, proto);
 }
 
+void
+conversation_register_expire_routine(const int proto, conversation_expire_func func)
+{
+    if (expire_routines == NULL)
+        expire_routines = wmem_map_new(wmem_epan_scope(), g_direct_hash, g_direct_equal);
+
+    wmem_map_insert(expire_routines, GINT_TO_POINTER(proto), (void *)func);
+}
+
+void
+conversation_track_usage(bool track)
+{
+    track_usage = track;
+}
+
+static bool
+conversation_call_expire_routine(const void *key, void *value, void *userdata)
+{
+    conversation_expire_func func;
+
+    func = (conversation_expire_func)wmem_map_lookup(expire_routines, key);
+    if (func && value)
+        func((conversation_t *)userdata, value);
+
+    return false;
+}
+
+/*
+ * Take a conversation out of its hash table and the usage list, and free
+ * its data and whatever its protocols release. Dissectors may still hold
+ * pointers to the conversation, so it and its key are left for the end of
+ * the file scope.
+ */
+static void
+conversation_release(conversation_t *conv)
+{
+    char *el_list_map_key = conversation_element_list_name(NULL, conv->key_ptr);
+    wmem_map_t *el_list_map = (wmem_map_t *) wmem_map_lookup(conversation_hashtable_element_list, el_list_map_key);
+    g_free(el_list_map_key);
+
+    if (el_list_map && wmem_map_lookup(el_list_map, conv->key_ptr))
+        conversation_remove_from_hashtable(el_list_map, conv);
+
+    if (conv->lru_prev || conv == lru_head)
+        conversation_lru_unlink(conv);
+
+    if (conv->data_list) {
+        if (expire_routines)
+            wmem_tree_foreach(conv->data_list, conversation_call_expire_routine, conv);
+        wmem_tree_destroy(conv->data_list, false, false);
+        conv->data_list = NULL;
+    }
+    /*
+     * A template and the conversations created from it share one tree,
+     * so leave a shared tree for the end of the file scope.
+     */
+    if (conv->dissector_tree && !conv->dissector_tree_shared) {
+        wmem_tree_destroy(conv->dissector_tree, false, false);
+    }
+    conv->dissector_tree = NULL;
+
+    conv->expired = true;
+}
+
+unsigned
+conversation_expire(const uint32_t before_frame, const unsigned max_count)
+{
+    unsigned expired = 0;
+
+    while (lru_head && (lru_head->last_used < before_frame ||
+                (max_count != 0 && lru_count > max_count))) {
+        conversation_release(lru_head);
+        expired++;
+    }
+
+    return expired;
+}
+
+unsigned
+conversation_tracked_count(void)
+{
+    return lru_count;
+}
+
 void
 conversation_set_dissector_from_frame_number(conversation_t *conversation,
         const uint32_t starting_frame_num, const dissector_handle_t handle)
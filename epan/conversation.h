@@ -237,6 +237,11 @@ typedef struct conversation {
     wmem_tree_t *dissector_tree;	/** tree containing protocol dissector client associated with conversation */
     unsigned	options;		/** wildcard flags */
     conversation_element_t *key_ptr;	/** Keys are conversation element arrays terminated with a CE_CONVERSATION_TYPE */
+    struct conversation *lru_prev;	/** less recently used conversation, if usage is tracked */
+    struct conversation *lru_next;	/** more recently used conversation, if usage is tracked */
+    uint32_t last_used;		/** highest frame number this conversation was found for, if usage is tracked */
+    bool	expired;		/** removed by conversation_expire() */
+    bool	dissector_tree_shared;	/** dissector_tree is shared with a template or a conversation created from one */
 } conversation_t;
 
 /*
@@ -496,6 +501,50 @@ WS_DLL_PUBLIC void *conversation_get_proto_data(const conversation_t *conv, cons
  */
 WS_DLL_PUBLIC void conversation_delete_proto_data(conversation_t *conv, const int proto);
 
+/** Called for a protocol's data when its conversation is expired by
+ * conversation_expire(). The routine should free the data and anything
+ * it refers to that isn't needed any more.
+ * @param conv The conversation being expired.
+ * @param proto_data The data that was set with conversation_add_proto_data.
+ */
+typedef void (*conversation_expire_func)(conversation_t *conv, void *proto_data);
+
+/** Register a routine to release a protocol's conversation data when
+ * the conversation is expired. Without one, the data is dropped along
+ * with the conversation, but its memory is only freed at the end of
+ * the file scope.
+ * @param proto Protocol ID.
+ * @param func The routine.
+ */
+WS_DLL_PUBLIC void conversation_register_expire_routine(const int proto, conversation_expire_func func);
+
+/** Start or stop tracking which conversations were used most recently.
+ * This has to be on for conversation_expire() to find anything, and it
+ * costs a little on every lookup, so it is off by default.
+ * @param track true to track usage.
+ */
+WS_DLL_PUBLIC void conversation_track_usage(bool track);
+
+/** Remove conversations that are no longer in use and free their data. This
+ * is meant for single-pass dissection of endless captures, where the
+ * conversations would otherwise grow without bound. A conversation that
+ * is expired and seen again is created anew. The expired one loses its
+ * protocol data and dissectors, but stays allocated until the end of the
+ * file scope, so pointers that dissectors kept to it remain valid. Data of
+ * protocols without an expire routine, and a dissector tree shared with a
+ * template, are also only freed then, so this limits memory use rather
+ * than bounding it.
+ * @param before_frame Expire the conversations that were last used in
+ * a frame before this one.
+ * @param max_count If non-zero, also expire the least recently used
+ * conversations until there are no more than this many.
+ * @return The number of conversations that were expired.
+ */
+WS_DLL_PUBLIC unsigned conversation_expire(const uint32_t before_frame, const unsigned max_count);
+
+/** @return The number of conversations whose usage is being tracked. */
+WS_DLL_PUBLIC unsigned conversation_tracked_count(void);
+
 WS_DLL_PUBLIC void conversation_set_dissector(conversation_t *conversation, const dissector_handle_t handle);
 
 WS_DLL_PUBLIC void conversation_set_dissector_from_frame_number(conversation_t *conversation,
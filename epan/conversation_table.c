@@ -19,6 +19,8 @@
 #include "addr_resolv.h"
 #include "address_types.h"
 
+#include <wsutil/strtoi.h>
+
 #include "stat_tap_ui.h"
 
 struct register_ct {
@@ -280,6 +282,244 @@ conversation_equal(const void *key1, const void *key2)
     return FALSE;
 }
 
+/*
+ * Keeping only the heaviest items.
+ *
+ * If ch->top_items is set, the table holds at most that many items, and
+ * once it is full a new item takes the place of the lightest one, as in
+ * the Space-Saving algorithm of Metwally, Agrawal and El Abbadi. The items
+ * are kept in a binary min-heap ordered by weight, i.e. by packets or by
+ * bytes, so that the lightest one can be found quickly.
+ *
+ * What a new item had before it got into the table isn't known. A
+ * Count-Min sketch of all items, which never underestimates, gives an
+ * upper bound for it, which is kept in frames_error and bytes_error. The
+ * weight of an item is its count plus its error. An item that isn't in
+ * the table has had at most the weight it had when it was replaced, so
+ * the highest weight of a replaced item is an upper bound too, and any
+ * item heavier than that is in the table.
+ */
+
+#define TOP_SKETCH_DEPTH 4
+/* 4 MiB for the two sketches; wider only helps for more than 16384 items. */
+#define TOP_SKETCH_MAX_WIDTH (1U << 16)
+
+struct _conv_top_t {
+    bool        endpoints;      /* the items are endpoint_item_t, not conv_item_t */
+    bool        by_bytes;       /* weigh the items by bytes rather than packets */
+    unsigned    size;           /* the number of items to keep */
+    unsigned   *heap;           /* indexes into conv_array, lightest first */
+    unsigned   *heap_pos;       /* the position in the heap of each item */
+    unsigned    sketch_mask;    /* the width of a sketch row - 1 */
+    uint64_t   *sketch_frames;  /* TOP_SKETCH_DEPTH rows */
+    uint64_t   *sketch_bytes;
+    uint64_t    dropped_weight; /* the highest weight of an item that was replaced */
+};
+
+static struct _conv_top_t *
+top_new(unsigned size, bool by_bytes, bool endpoints)
+{
+    struct _conv_top_t *top = g_new0(struct _conv_top_t, 1);
+    unsigned width = 64;
+
+    /*
+     * A few cells per item keeps the sketch's error small. For more items
+     * the error bounds get looser, but they stay upper bounds.
+     */
+    while (width / 4 < size && width < TOP_SKETCH_MAX_WIDTH) {
+        width <<= 1;
+    }
+
+    top->endpoints = endpoints;
+    top->by_bytes = by_bytes;
+    top->size = size;
+    top->heap = g_new(unsigned, size);
+    top->heap_pos = g_new(unsigned, size);
+    top->sketch_mask = width - 1;
+    top->sketch_frames = g_new0(uint64_t, (size_t)width * TOP_SKETCH_DEPTH);
+    top->sketch_bytes = g_new0(uint64_t, (size_t)width * TOP_SKETCH_DEPTH);
+    return top;
+}
+
+static void
+top_free(struct _conv_top_t *top)
+{
+    if (!top) {
+        return;
+    }
+    g_free(top->heap);
+    g_free(top->heap_pos);
+    g_free(top->sketch_frames);
+    g_free(top->sketch_bytes);
+    g_free(top);
+}
+
+static uint64_t
+top_weight(const conv_hash_t *ch, unsigned idx)
+{
+    if (ch->top->endpoints) {
+        const endpoint_item_t *item = &g_array_index(ch->conv_array, endpoint_item_t, idx);
+
+        return ch->top->by_bytes ?
+            item->tx_bytes_total + item->rx_bytes_total + item->bytes_error :
+            item->tx_frames_total + item->rx_frames_total + item->frames_error;
+    } else {
+        const conv_item_t *item = &g_array_index(ch->conv_array, conv_item_t, idx);
+
+        return ch->top->by_bytes ?
+            item->tx_bytes_total + item->rx_bytes_total + item->bytes_error :
+            item->tx_frames_total + item->rx_frames_total + item->frames_error;
+    }
+}
+
+static inline void
+top_heap_set(struct _conv_top_t *top, unsigned pos, unsigned idx)
+{
+    top->heap[pos] = idx;
+    top->heap_pos[idx] = pos;
+}
+
+/* Move an item towards the bottom of the heap after it got heavier. */
+static void
+top_heap_down(conv_hash_t *ch, unsigned idx)
+{
+    struct _conv_top_t *top = ch->top;
+    unsigned len = ch->conv_array->len;
+    unsigned pos = top->heap_pos[idx];
+    uint64_t weight = top_weight(ch, idx);
+
+    for (;;) {
+        unsigned child = 2 * pos + 1;
+        uint64_t child_weight;
+
+        if (child >= len) {
+            break;
+        }
+        child_weight = top_weight(ch, top->heap[child]);
+        if (child + 1 < len) {
+            uint64_t right_weight = top_weight(ch, top->heap[child + 1]);
+
+            if (right_weight < child_weight) {
+                child++;
+                child_weight = right_weight;
+            }
+        }
+        if (child_weight >= weight) {
+            break;
+        }
+        top_heap_set(top, pos, top->heap[child]);
+        pos = child;
+    }
+    top_heap_set(top, pos, idx);
+}
+
+/* Add the item that was just appended to conv_array to the heap. */
+static void
+top_heap_push(conv_hash_t *ch, unsigned idx)
+{
+    struct _conv_top_t *top = ch->top;
+    unsigned pos = idx;
+    uint64_t weight = top_weight(ch, idx);
+
+    while (pos > 0) {
+        unsigned parent = (pos - 1) / 2;
+
+        if (top_weight(ch, top->heap[parent]) <= weight) {
+            break;
+        }
+        top_heap_set(top, pos, top->heap[parent]);
+        pos = parent;
+    }
+    top_heap_set(top, pos, idx);
+}
+
+/*
+ * Count a packet in the sketch, and return upper bounds for the packets
+ * and bytes that the item had before it.
+ */
+static void
+top_sketch_add(struct _conv_top_t *top, unsigned hash, int num_frames, int num_bytes,
+               uint64_t *prev_frames, uint64_t *prev_bytes)
+{
+    uint64_t min_frames = UINT64_MAX;
+    uint64_t min_bytes = UINT64_MAX;
+
+    for (unsigned row = 0; row < TOP_SKETCH_DEPTH; row++) {
+        uint32_t h = hash ^ (0x9e3779b9U * (row + 1));
+        size_t cell;
+
+        h ^= h >> 16;
+        h *= 0x85ebca6bU;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35U;
+        h ^= h >> 16;
+        cell = (size_t)row * (top->sketch_mask + 1) + (h & top->sketch_mask);
+
+        if (top->sketch_frames[cell] < min_frames) {
+            min_frames = top->sketch_frames[cell];
+        }
+        if (top->sketch_bytes[cell] < min_bytes) {
+            min_bytes = top->sketch_bytes[cell];
+        }
+        top->sketch_frames[cell] += num_frames;
+        top->sketch_bytes[cell] += num_bytes;
+    }
+    *prev_frames = min_frames;
+    *prev_bytes = min_bytes;
+}
+
+/*
+ * The error bounds of a new item that takes the place of the item with
+ * the given index.
+ */
+static void
+top_error_bounds(conv_hash_t *ch, unsigned replaced_idx,
+                 uint64_t prev_frames, uint64_t prev_bytes,
+                 uint64_t *frames_error, uint64_t *bytes_error)
+{
+    uint64_t weight = top_weight(ch, replaced_idx);
+
+    if (weight > ch->top->dropped_weight) {
+        ch->top->dropped_weight = weight;
+    }
+    if (ch->top->by_bytes) {
+        prev_bytes = MIN(prev_bytes, ch->top->dropped_weight);
+    } else {
+        prev_frames = MIN(prev_frames, ch->top->dropped_weight);
+    }
+    *frames_error = prev_frames;
+    *bytes_error = prev_bytes;
+}
+
+const char *
+conversation_table_parse_top_option(conv_hash_t *ch, const char *args)
+{
+    const char *value;
+    const char *end;
+    uint32_t items;
+    bool by_bytes;
+
+    if (args == NULL) {
+        return NULL;
+    }
+    if (g_str_has_prefix(args, "top=")) {
+        value = args + strlen("top=");
+        by_bytes = false;
+    } else if (g_str_has_prefix(args, "topbytes=")) {
+        value = args + strlen("topbytes=");
+        by_bytes = true;
+    } else {
+        return args;
+    }
+    if (!ws_strtou32(value, &end, &items) || items == 0 || (*end != '\0' && *end != ',')) {
+        return args;
+    }
+
+    ch->top_items = items;
+    ch->top_by_bytes = by_bytes;
+    return *end == ',' ? end + 1 : NULL;
+}
+
 void
 reset_conversation_table_data(conv_hash_t *ch)
 {
@@ -302,8 +542,11 @@ reset_conversation_table_data(conv_hash_t *ch)
         g_hash_table_destroy(ch->hashtable);
     }
 
+    top_free(ch->top);
+
     ch->conv_array=NULL;
     ch->hashtable=NULL;
+    ch->top=NULL;
 }
 
 void reset_endpoint_table_data(conv_hash_t *ch)
@@ -326,8 +569,11 @@ void reset_endpoint_table_data(conv_hash_t *ch)
         g_hash_table_destroy(ch->hashtable);
     }
 
+    top_free(ch->top);
+
     ch->conv_array=NULL;
     ch->hashtable=NULL;
+    ch->top=NULL;
 }
 
 /* For backwards source and binary compatibility */
@@ -680,16 +926,21 @@ add_conversation_table_data_with_conv_id(
 {
     conv_item_t *conv_item = NULL;
     bool is_fwd_direction = false; /* direction of any conversation found */
+    unsigned int conversation_idx = 0;
+    uint64_t prev_frames = 0, prev_bytes = 0;
 
     /* if we don't have any entries at all yet */
     if (ch->conv_array == NULL) {
-        ch->conv_array = g_array_sized_new(false, false, sizeof(conv_item_t), 10000);
+        ch->conv_array = g_array_sized_new(false, false, sizeof(conv_item_t), ch->top_items ? ch->top_items : 10000);
 
         ch->hashtable = g_hash_table_new_full(conversation_hash,
                                               conversation_equal, /* key_equal_func */
                                               g_free,             /* key_destroy_func */
                                               NULL);              /* value_destroy_func */
 
+        if (ch->top_items) {
+            ch->top = top_new(ch->top_items, ch->top_by_bytes, false);
+        }
     } else { /* try to find it among the existing known conversations */
         /* first, check in the fwd conversations */
         conv_key_t existing_key;
@@ -701,7 +952,8 @@ add_conversation_table_data_with_conv_id(
         existing_key.port2 = dst_port;
         existing_key.conv_id = conv_id;
         if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-            conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
+            conversation_idx = GPOINTER_TO_UINT(conversation_idx_hash_val);
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
         }
         if (conv_item == NULL) {
             /* then, check in the rev conversations if not found in 'fwd' */
@@ -710,7 +962,8 @@ add_conversation_table_data_with_conv_id(
             existing_key.port1 = dst_port;
             existing_key.port2 = src_port;
             if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &conversation_idx_hash_val)) {
-                conv_item = &g_array_index(ch->conv_array, conv_item_t, GPOINTER_TO_UINT(conversation_idx_hash_val));
+                conversation_idx = GPOINTER_TO_UINT(conversation_idx_hash_val);
+                conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
             }
         } else {
             /* a conversation was found in this same fwd direction */
@@ -718,12 +971,20 @@ add_conversation_table_data_with_conv_id(
         }
     }
 
+    if (ch->top) {
+        /* The hash is the same in both directions, like conversation_equal() */
+        unsigned hash = add_address_to_hash(src_port, src) + add_address_to_hash(dst_port, dst);
+
+        top_sketch_add(ch->top, hash ^ conv_id, num_frames, num_bytes, &prev_frames, &prev_bytes);
+    }
+
     /* if we still don't know what conversation this is it has to be a new one
-       and we have to allocate it and append it to the end of the list */
+       and we have to allocate it and append it to the end of the list,
+       or take the place of the lightest one if only the top ones are kept */
     if (conv_item == NULL) {
         conv_key_t *new_key;
         conv_item_t new_conv_item;
-        unsigned int conversation_idx;
+        bool replace = ch->top && ch->conv_array->len >= ch->top->size;
 
         copy_address(&new_conv_item.src_address, src);
         copy_address(&new_conv_item.dst_address, dst);
@@ -750,9 +1011,31 @@ add_conversation_table_data_with_conv_id(
             nstime_set_unset(&new_conv_item.start_time);
             nstime_set_unset(&new_conv_item.stop_time);
         }
-        g_array_append_val(ch->conv_array, new_conv_item);
-        conversation_idx = ch->conv_array->len - 1;
-        conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
+        new_conv_item.frames_error = 0;
+        new_conv_item.bytes_error = 0;
+
+        if (replace) {
+            conv_key_t old_key;
+
+            conversation_idx = ch->top->heap[0];
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
+            top_error_bounds(ch, conversation_idx, prev_frames, prev_bytes,
+                             &new_conv_item.frames_error, &new_conv_item.bytes_error);
+
+            old_key.addr1 = conv_item->src_address;
+            old_key.addr2 = conv_item->dst_address;
+            old_key.port1 = conv_item->src_port;
+            old_key.port2 = conv_item->dst_port;
+            old_key.conv_id = conv_item->conv_id;
+            g_hash_table_remove(ch->hashtable, &old_key);
+            free_address(&conv_item->src_address);
+            free_address(&conv_item->dst_address);
+            *conv_item = new_conv_item;
+        } else {
+            g_array_append_val(ch->conv_array, new_conv_item);
+            conversation_idx = ch->conv_array->len - 1;
+            conv_item = &g_array_index(ch->conv_array, conv_item_t, conversation_idx);
+        }
 
         /* ct->conversations address is not a constant but src/dst_address.data are */
         new_key = g_new(conv_key_t, 1);
@@ -772,6 +1055,12 @@ add_conversation_table_data_with_conv_id(
             conv_item->tx_bytes += num_bytes;
             conv_item->filtered = false;
         }
+
+        if (replace) {
+            top_heap_down(ch, conversation_idx);
+        } else if (ch->top) {
+            top_heap_push(ch, conversation_idx);
+        }
     } else {
         /*
          * update an existing conversation
@@ -794,6 +1083,10 @@ add_conversation_table_data_with_conv_id(
             }
             conv_item->filtered = false;
         }
+
+        if (ch->top) {
+            top_heap_down(ch, conversation_idx);
+        }
     }
 
     if (ts) {
@@ -949,16 +1242,22 @@ void
 add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, bool sender, int num_frames, int num_bytes, et_dissector_info_t *et_info, endpoint_type etype)
 {
     endpoint_item_t *endpoint_item = NULL;
+    unsigned int endpoint_idx = 0;
+    bool is_new = false, replace = false;
+    uint64_t prev_frames = 0, prev_bytes = 0;
 
     /* XXX should be optimized to allocate n extra entries at a time
        instead of just one */
     /* if we don't have any entries at all yet */
     if(ch->conv_array==NULL){
-        ch->conv_array=g_array_sized_new(false, false, sizeof(endpoint_item_t), 10000);
+        ch->conv_array=g_array_sized_new(false, false, sizeof(endpoint_item_t), ch->top_items ? ch->top_items : 10000);
         ch->hashtable = g_hash_table_new_full(endpoint_hash,
                                               endpoint_match, /* key_equal_func */
                                               g_free,     /* key_destroy_func */
                                               NULL);      /* value_destroy_func */
+        if (ch->top_items) {
+            ch->top = top_new(ch->top_items, ch->top_by_bytes, true);
+        }
     }
     else {
         /* try to find it among the existing known conversations */
@@ -969,16 +1268,24 @@ add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, boo
         existing_key.port = port;
 
         if (g_hash_table_lookup_extended(ch->hashtable, &existing_key, NULL, &endpoint_idx_hash_val)) {
-            endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, GPOINTER_TO_UINT(endpoint_idx_hash_val));
+            endpoint_idx = GPOINTER_TO_UINT(endpoint_idx_hash_val);
+            endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
         }
     }
 
+    if (ch->top) {
+        top_sketch_add(ch->top, add_address_to_hash(port, addr), num_frames, num_bytes, &prev_frames, &prev_bytes);
+    }
+
     /* if we still don't know what endpoint this is it has to be a new one
-       and we have to allocate it and append it to the end of the list */
+       and we have to allocate it and append it to the end of the list,
+       or take the place of the lightest one if only the top ones are kept */
     if(endpoint_item==NULL){
         endpoint_key_t *new_key;
         endpoint_item_t new_endpoint_item;
-        unsigned int endpoint_idx;
+
+        is_new = true;
+        replace = ch->top && ch->conv_array->len >= ch->top->size;
 
         copy_address(&new_endpoint_item.myaddress, addr);
         new_endpoint_item.dissector_info = et_info;
@@ -994,10 +1301,27 @@ add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, boo
         new_endpoint_item.tx_bytes_total=0;
         new_endpoint_item.modified = true;
         new_endpoint_item.filtered = true;
-
-        g_array_append_val(ch->conv_array, new_endpoint_item);
-        endpoint_idx = ch->conv_array->len - 1;
-        endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
+        new_endpoint_item.frames_error = 0;
+        new_endpoint_item.bytes_error = 0;
+
+        if (replace) {
+            endpoint_key_t old_key;
+
+            endpoint_idx = ch->top->heap[0];
+            endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
+            top_error_bounds(ch, endpoint_idx, prev_frames, prev_bytes,
+                             &new_endpoint_item.frames_error, &new_endpoint_item.bytes_error);
+
+            old_key.myaddress = endpoint_item->myaddress;
+            old_key.port = endpoint_item->port;
+            g_hash_table_remove(ch->hashtable, &old_key);
+            free_address(&endpoint_item->myaddress);
+            *endpoint_item = new_endpoint_item;
+        } else {
+            g_array_append_val(ch->conv_array, new_endpoint_item);
+            endpoint_idx = ch->conv_array->len - 1;
+            endpoint_item = &g_array_index(ch->conv_array, endpoint_item_t, endpoint_idx);
+        }
 
         /* hl->hosts address is not a constant but address.data is */
         new_key = g_new(endpoint_key_t,1);
@@ -1028,6 +1352,14 @@ add_endpoint_table_data(conv_hash_t *ch, const address *addr, uint32_t port, boo
         endpoint_item->rx_frames_total+=num_frames;
         endpoint_item->rx_bytes_total+=num_bytes;
     }
+
+    if (ch->top) {
+        if (is_new && !replace) {
+            top_heap_push(ch, endpoint_idx);
+        } else {
+            top_heap_down(ch, endpoint_idx);
+        }
+    }
 }
 
 void
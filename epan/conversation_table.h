@@ -47,14 +47,24 @@ typedef enum {
     CONV_DIR_ANY_FROM_B
 } conv_direction_e;
 
+struct _conv_top_t;
+
 /** Conversation hash + value storage
  * Hash table keys are conv_key_t. Hash table values are indexes into conv_array.
+ *
+ * If top_items is set when the table is empty, the table keeps only that
+ * many of the heaviest conversations or endpoints, by packets or by bytes,
+ * so that its memory is bounded however many there are in the capture.
+ * The counts are then approximate; see frames_error and bytes_error.
  */
 typedef struct _conversation_hash_t {
     GHashTable  *hashtable;       /**< conversations hash table */
     GArray      *conv_array;      /**< array of conversation values */
     void        *user_data;       /**< "GUI" specifics (if necessary) */
     unsigned    flags;            /**< flags given to the tap packet */
+    unsigned    top_items;        /**< if not 0, the number of items to keep */
+    bool        top_by_bytes;     /**< weigh items by bytes rather than packets for top_items */
+    struct _conv_top_t *top;      /**< private state for top_items */
 } conv_hash_t;
 
 /** Key for hash lookups */
@@ -144,6 +154,9 @@ typedef struct _conversation_item_t {
     bool filtered;                  /**< the entry contains only filtered data */
 
     conv_extension_tcp_t ext_tcp;      /**< extension for optional TCP counters */
+
+    uint64_t            frames_error;   /**< packets that may have been missed, if only the top items are kept */
+    uint64_t            bytes_error;    /**< bytes that may have been missed, if only the top items are kept */
 } conv_item_t;
 
 /** Endpoint information */
@@ -166,6 +179,8 @@ typedef struct _endpoint_item_t {
     bool modified;      /**< new to redraw the row */
     bool filtered;      /**< the entry contains only filtered data */
 
+    uint64_t frames_error;   /**< packets that may have been missed, if only the top items are kept */
+    uint64_t bytes_error;    /**< bytes that may have been missed, if only the top items are kept */
 } endpoint_item_t;
 
 /* For backwards source compatibility */
@@ -270,6 +285,16 @@ WS_DLL_PUBLIC void reset_endpoint_table_data(conv_hash_t *ch);
 G_DEPRECATED_FOR(reset_endpoint_table_data)
 WS_DLL_PUBLIC void reset_hostlist_table_data(conv_hash_t *ch);
 
+/** Parse the "top=<n>" or "topbytes=<n>" option that may precede the
+ * filter in the arguments of "-z conv,<type>" and "-z endpoints,<type>",
+ * and set up the table accordingly.
+ *
+ * @param ch the table
+ * @param args the arguments after the type, or NULL
+ * @return the rest of the arguments, i.e. the filter, or NULL if there is none
+ */
+WS_DLL_PUBLIC const char *conversation_table_parse_top_option(conv_hash_t *ch, const char *args);
+
 /** Initialize dissector conversation for stats and (possibly) GUI.
  *
  * @param opt_arg filter string to compare with dissector
@@ -49,6 +49,7 @@ dfvm_opcode_tostr(dfvm_opcode_t code)
 		case DFVM_ANY_LE:		return "ANY_LE";
 		case DFVM_ALL_CONTAINS:		return "ALL_CONTAINS";
 		case DFVM_ANY_CONTAINS:		return "ANY_CONTAINS";
+		case DFVM_ANY_CONTAINS_MULTI:	return "ANY_CONTAINS_MULTI";
 		case DFVM_ALL_MATCHES:		return "ALL_MATCHES";
 		case DFVM_ANY_MATCHES:		return "ANY_MATCHES";
 		case DFVM_SET_ALL_IN:		return "SET_ALL_IN";
@@ -89,6 +90,11 @@ dfvm_value_free(dfvm_value_t *v)
 		case PCRE:
 			ws_regex_free(v->value.pcre);
 			break;
+		case MULTIPATTERN:
+			ws_multipattern_free(v->value.multipattern->mp);
+			g_ptr_array_unref(v->value.multipattern->needles);
+			g_free(v->value.multipattern);
+			break;
 		case EMPTY:
 		case HFINFO:
 		case RAW_HFINFO:
@@ -235,6 +241,26 @@ dfvm_value_new_pcre(ws_regex_t *re)
 	return v;
 }
 
+/* Takes ownership of the needles, which must be non-empty values
+ * accepted by fvalue_add_contains_needle(). */
+dfvm_value_t*
+dfvm_value_new_multipattern(GPtrArray *needles)
+{
+	dfvm_value_t *v = dfvm_value_new(MULTIPATTERN);
+	dfvm_multipattern_t *mp = g_new(dfvm_multipattern_t, 1);
+
+	mp->mp = ws_multipattern_new();
+	for (unsigned i = 0; i < needles->len; i++) {
+		if (!fvalue_add_contains_needle(mp->mp, needles->pdata[i])) {
+			ws_assert_not_reached();
+		}
+	}
+	ws_multipattern_compile(mp->mp);
+	mp->needles = needles;
+	v->value.multipattern = mp;
+	return v;
+}
+
 dfvm_value_t*
 dfvm_value_new_uint(unsigned num)
 {
@@ -243,6 +269,24 @@ dfvm_value_new_uint(unsigned num)
 	return v;
 }
 
+static char *
+multipattern_tostr(dfvm_multipattern_t *mp)
+{
+	GString *gs = g_string_new("{");
+	char *s;
+
+	for (unsigned i = 0; i < mp->needles->len; i++) {
+		if (i != 0) {
+			g_string_append(gs, ", ");
+		}
+		s = fvalue_to_debug_repr(NULL, mp->needles->pdata[i]);
+		g_string_append(gs, s);
+		g_free(s);
+	}
+	g_string_append_c(gs, '}');
+	return g_string_free(gs, FALSE);
+}
+
 static char *
 dfvm_value_tostr(dfvm_value_t *v)
 {
@@ -270,6 +314,9 @@ dfvm_value_tostr(dfvm_value_t *v)
 		case PCRE:
 			s = ws_strdup(ws_regex_pattern(v->value.pcre));
 			break;
+		case MULTIPATTERN:
+			s = multipattern_tostr(v->value.multipattern);
+			break;
 		case REGISTER:
 			s = ws_strdup_printf("R%"PRIu32, v->value.numeric);
 			break;
@@ -538,6 +585,7 @@ append_op_args(wmem_strbuf_t *buf, dfvm_insn_t *insn, GSList **stack_print,
 
 		case DFVM_ALL_CONTAINS:
 		case DFVM_ANY_CONTAINS:
+		case DFVM_ANY_CONTAINS_MULTI:
 			wmem_strbuf_append_printf(buf, "%s%s contains %s%s",
 						arg1_str, arg1_str_type, arg2_str, arg2_str_type);
 			break;
@@ -1176,6 +1224,23 @@ all_matches(dfilter_t *df, dfvm_value_t *arg1, dfvm_value_t *arg2)
 	return true;
 }
 
+/* contains(A, {n1, n2, ...}) <=> A contains n1 OR A contains n2 OR ... */
+static bool
+any_contains_multi(dfilter_t *df, dfvm_value_t *arg1, dfvm_value_t *arg2)
+{
+	df_cell_t *rp = &df->registers[arg1->value.numeric];
+	ws_multipattern_t *mp = arg2->value.multipattern->mp;
+
+	const fvalue_t **fv_ptr = (const fvalue_t **)df_cell_array(rp);
+
+	for (size_t idx = 0; idx < df_cell_size(rp); idx++) {
+		if (fvalue_contains_any(fv_ptr[idx], mp) == FT_TRUE) {
+			return true;
+		}
+	}
+	return false;
+}
+
 static bool
 test_in_internal(fvalue_t *fv, GPtrArray *range[2])
 {
@@ -1758,6 +1823,10 @@ dfvm_apply_full(dfilter_t *df, proto_tree *tree, GPtrArray **fvals)
 				accum = any_test(df, fvalue_contains, arg1, arg2);
 				break;
 
+			case DFVM_ANY_CONTAINS_MULTI:
+				accum = any_contains_multi(df, arg1, arg2);
+				break;
+
 			case DFVM_ALL_MATCHES:
 				accum = all_matches(df, arg1, arg2);
 				break;
@@ -11,6 +11,7 @@
 #define DFVM_H
 
 #include <wsutil/regex.h>
+#include <wsutil/ws_multipattern.h>
 #include "dfilter-int.h"
 #include "syntax-tree.h"
 #include "drange.h"
@@ -31,8 +32,15 @@ typedef enum {
 	DRANGE,
 	FUNCTION_DEF,
 	PCRE,
+	MULTIPATTERN,
 } dfvm_value_type_t;
 
+/* The needles of a chain of "contains" tests ORed together. */
+typedef struct {
+	ws_multipattern_t	*mp;
+	GPtrArray		*needles; /* fvalue_t, for dumping */
+} dfvm_multipattern_t;
+
 typedef struct {
 	dfvm_value_type_t	type;
 
@@ -43,6 +51,7 @@ typedef struct {
 		header_field_info	*hfinfo;
 		df_func_def_t		*funcdef;
 		ws_regex_t		*pcre;
+		dfvm_multipattern_t	*multipattern;
 	} value;
 
 	int ref_count;
@@ -77,6 +86,7 @@ typedef enum {
 	DFVM_ANY_LE,
 	DFVM_ALL_CONTAINS,
 	DFVM_ANY_CONTAINS,
+	DFVM_ANY_CONTAINS_MULTI,
 	DFVM_ALL_MATCHES,
 	DFVM_ANY_MATCHES,
 	DFVM_SET_ALL_IN,
@@ -149,6 +159,9 @@ dfvm_value_new_funcdef(df_func_def_t *funcdef);
 dfvm_value_t*
 dfvm_value_new_pcre(ws_regex_t *re);
 
+dfvm_value_t*
+dfvm_value_new_multipattern(GPtrArray *needles);
+
 dfvm_value_t*
 dfvm_value_new_uint(unsigned num);
 
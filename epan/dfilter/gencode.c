@@ -501,6 +501,167 @@ gen_relation_in(dfwork_t *dfw, dfvm_opcode_t op, stmatch_t how,
 	jumps = NULL;
 }
 
+/* Appends the operands of a chain of "or" tests to the array. */
+static void
+get_or_operands(stnode_t *st_node, GPtrArray *operands)
+{
+	stnode_t	*st_arg1, *st_arg2;
+
+	if (stnode_type_id(st_node) == STTYPE_TEST &&
+			sttype_oper_get_op(st_node) == STNODE_OP_OR) {
+		sttype_oper_get(st_node, NULL, &st_arg1, &st_arg2);
+		get_or_operands(st_arg1, operands);
+		get_or_operands(st_arg2, operands);
+	}
+	else {
+		g_ptr_array_add(operands, st_node);
+	}
+}
+
+/* Returns the field tested if st_node is a "field contains literal" test
+ * that can be evaluated as part of a multi-pattern search. */
+static header_field_info *
+get_multipattern_field(stnode_t *st_node)
+{
+	stnode_op_t	st_op;
+	stnode_t	*st_arg1, *st_arg2;
+	header_field_info *hfinfo;
+	ws_multipattern_t *mp;
+	bool		ok;
+
+	if (stnode_type_id(st_node) != STTYPE_TEST)
+		return NULL;
+	sttype_oper_get(st_node, &st_op, &st_arg1, &st_arg2);
+	if (st_op != STNODE_OP_CONTAINS ||
+			sttype_test_get_match(st_node) == STNODE_MATCH_ALL)
+		return NULL;
+	if (stnode_type_id(st_arg1) != STTYPE_FIELD ||
+			sttype_field_drange(st_arg1) != NULL ||
+			stnode_type_id(st_arg2) != STTYPE_FVALUE)
+		return NULL;
+
+	/* Check that the literal is a usable (non-empty) needle. */
+	mp = ws_multipattern_new();
+	ok = fvalue_add_contains_needle(mp, stnode_data(st_arg2));
+	ws_multipattern_free(mp);
+	if (!ok)
+		return NULL;
+
+	hfinfo = sttype_field_hfinfo(st_arg1);
+	/* Rewind to find the first field of this name. */
+	while (hfinfo->same_name_prev_id != -1) {
+		hfinfo = proto_registrar_get_nth(hfinfo->same_name_prev_id);
+	}
+	return hfinfo;
+}
+
+static bool
+same_field_flags(stnode_t *st_node1, stnode_t *st_node2)
+{
+	stnode_t	*st_field1, *st_field2;
+
+	sttype_oper_get(st_node1, NULL, &st_field1, NULL);
+	sttype_oper_get(st_node2, NULL, &st_field2, NULL);
+	return sttype_field_raw(st_field1) == sttype_field_raw(st_field2) &&
+		sttype_field_value_string(st_field1) == sttype_field_value_string(st_field2);
+}
+
+/* Generate a single search for all the needles of a group of
+ * "field contains literal" tests on the same field. */
+static void
+gen_relation_contains_multi(dfwork_t *dfw, GPtrArray *group)
+{
+	GSList		*jumps = NULL;
+	dfvm_value_t	*val1, *val2;
+	stnode_t	*st_arg1, *st_arg2;
+	GPtrArray	*needles;
+
+	needles = g_ptr_array_new_with_free_func((GDestroyNotify)fvalue_free);
+	for (unsigned i = 0; i < group->len; i++) {
+		sttype_oper_get(group->pdata[i], NULL, NULL, &st_arg2);
+		g_ptr_array_add(needles, stnode_steal_data(st_arg2));
+	}
+
+	sttype_oper_get(group->pdata[0], NULL, &st_arg1, NULL);
+	val1 = gen_entity(dfw, st_arg1, &jumps);
+	val2 = dfvm_value_new_multipattern(needles);
+	gen_relation_insn(dfw, DFVM_ANY_CONTAINS_MULTI, val1, val2, NULL);
+
+	g_slist_foreach(jumps, fixup_jumps, dfw);
+	g_slist_free(jumps);
+}
+
+/*
+ * Generate the code for a chain of "or" tests. Each operand is tested
+ * in turn and the first one that is true ends the chain.
+ *
+ * "contains" tests with a literal on the same field are gathered and
+ * evaluated with a single multi-pattern search, so that a filter made
+ * of many alternatives scans the field once instead of once per
+ * alternative. This is transparent because the operands of "or" have
+ * no side effects other than loading registers.
+ */
+static void
+gen_or_chain(dfwork_t *dfw, stnode_t *st_node)
+{
+	GPtrArray	*operands, *groups, *group;
+	header_field_info **fields;
+	GSList		*exits = NULL;
+	dfvm_insn_t	*insn;
+	dfvm_value_t	*jmp;
+
+	operands = g_ptr_array_new();
+	get_or_operands(st_node, operands);
+
+	fields = g_new(header_field_info *, operands->len);
+	for (unsigned i = 0; i < operands->len; i++) {
+		fields[i] = get_multipattern_field(operands->pdata[i]);
+	}
+
+	/* Group the operands, keeping the order of first appearance. */
+	groups = g_ptr_array_new_with_free_func((GDestroyNotify)g_ptr_array_unref);
+	for (unsigned i = 0; i < operands->len; i++) {
+		if (operands->pdata[i] == NULL) {
+			/* Already part of a group. */
+			continue;
+		}
+		group = g_ptr_array_new();
+		g_ptr_array_add(group, operands->pdata[i]);
+		for (unsigned j = i + 1; fields[i] != NULL && j < operands->len; j++) {
+			if (operands->pdata[j] != NULL && fields[j] == fields[i] &&
+					same_field_flags(operands->pdata[i], operands->pdata[j])) {
+				g_ptr_array_add(group, operands->pdata[j]);
+				operands->pdata[j] = NULL;
+			}
+		}
+		g_ptr_array_add(groups, group);
+	}
+
+	for (unsigned i = 0; i < groups->len; i++) {
+		group = groups->pdata[i];
+		if (group->len > 1) {
+			gen_relation_contains_multi(dfw, group);
+		}
+		else {
+			gencode(dfw, group->pdata[0]);
+		}
+
+		if (i + 1 < groups->len) {
+			insn = dfvm_insn_new(DFVM_IF_TRUE_GOTO);
+			jmp = dfvm_value_new(INSN_NUMBER);
+			insn->arg1 = dfvm_value_ref(jmp);
+			dfw_append_insn(dfw, insn);
+			exits = g_slist_prepend(exits, jmp);
+		}
+	}
+
+	g_slist_foreach(exits, fixup_jumps, dfw);
+	g_slist_free(exits);
+	g_ptr_array_free(groups, TRUE);
+	g_free(fields);
+	g_ptr_array_free(operands, TRUE);
+}
+
 static dfvm_value_t *
 gen_arithmetic(dfwork_t *dfw, stnode_t *st_arg, GSList **jumps_ptr)
 {
@@ -738,15 +899,7 @@ gen_test(dfwork_t *dfw, stnode_t *st_node)
 			break;
 
 		case STNODE_OP_OR:
-			gencode(dfw, st_arg1);
-
-			insn = dfvm_insn_new(DFVM_IF_TRUE_GOTO);
-			jmp = dfvm_value_new(INSN_NUMBER);
-			insn->arg1 = dfvm_value_ref(jmp);
-			dfw_append_insn(dfw, insn);
-
-			gencode(dfw, st_arg2);
-			jmp->value.numeric = dfw->next_insn_id;
+			gen_or_chain(dfw, st_node);
 			break;
 
 		case STNODE_OP_ALL_EQ:
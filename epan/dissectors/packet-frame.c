@@ -21,8 +21,10 @@
 #include <epan/exceptions.h>
 #include <epan/show_exception.h>
 #include <epan/prefs.h>
+#include <epan/reassemble.h>
 #include <epan/to_str.h>
 #include <epan/sequence_analysis.h>
+#include <epan/stat_tap_ui.h>
 #include <epan/tap.h>
 #include <epan/expert.h>
 #include <epan/tfs.h>
@@ -110,6 +112,7 @@ static expert_field ei_comments_text;
 static expert_field ei_arrive_time_out_of_range;
 static expert_field ei_incomplete;
 static expert_field ei_len_lt_caplen;
+static expert_field ei_reassembly_evicted;
 
 static int frame_tap;
 
@@ -520,6 +523,7 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 	const color_filter_t *color_filter;
 	dissector_handle_t dissector_handle;
 	fr_foreach_t fr_user_data;
+	unsigned     evicted;
 
 	tree=parent_tree;
 
@@ -849,7 +853,7 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 		}
 		if (do_frame_dissection) {
 			item = proto_tree_add_time(fh_tree, hf_frame_shift_offset, tvb,
-					    0, 0, &(pinfo->fd->shift_offset));
+					    0, 0, frame_data_get_shift_offset(pinfo->fd));
 			proto_item_set_generated(item);
 
 			if (proto_field_is_referenced(tree, hf_frame_time_delta)) {
@@ -1220,6 +1224,14 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 		ENDTRY;
 	}
 
+	evicted = reassembly_get_evictions(pinfo);
+	if (evicted != 0) {
+		ensure_tree_item(fh_tree, 1);
+		proto_tree_add_expert_format(fh_tree, pinfo, &ei_reassembly_evicted, tvb, 0, 0,
+		    "%u incomplete reassembl%s dropped to stay within the memory limit",
+		    evicted, plurality(evicted, "y was", "ies were"));
+	}
+
 	/* Attempt to (re-)calculate color filters (if any). */
 	if (pinfo->fd->need_colorize) {
 		color_filter = color_filters_colorize_packet(fr_data->color_edt);
@@ -1279,6 +1291,130 @@ dissect_frame(tvbuff_t *tvb, packet_info *pinfo, proto_tree *parent_tree, void*
 	return tvb_captured_length(tvb);
 }
 
+/* Dissector profile statistics ("-z dissector,profile") */
+typedef enum
+{
+	PROFILE_DISSECTOR_COLUMN = 0,
+	PROFILE_TYPE_COLUMN,
+	PROFILE_CALLS_COLUMN,
+	PROFILE_ACCEPTED_COLUMN,
+	PROFILE_EXCEPTIONS_COLUMN,
+	PROFILE_INCLUSIVE_COLUMN,
+	PROFILE_EXCLUSIVE_COLUMN,
+	PROFILE_ALLOC_COLUMN
+} dissector_profile_columns;
+
+static stat_tap_table_item dissector_profile_fields[] = {
+	{TABLE_ITEM_STRING, TAP_ALIGN_LEFT, "Dissector", "%-30s"},
+	{TABLE_ITEM_STRING, TAP_ALIGN_LEFT, "Type", "%-9s"},
+	{TABLE_ITEM_UINT, TAP_ALIGN_RIGHT, "Calls", "%10u"},
+	{TABLE_ITEM_UINT, TAP_ALIGN_RIGHT, "Accepted", "%10u"},
+	{TABLE_ITEM_UINT, TAP_ALIGN_RIGHT, "Exceptions", "%10u"},
+	{TABLE_ITEM_FLOAT, TAP_ALIGN_RIGHT, "Inclusive ms", "%12.3f"},
+	{TABLE_ITEM_FLOAT, TAP_ALIGN_RIGHT, "Exclusive ms", "%12.3f"},
+	{TABLE_ITEM_FLOAT, TAP_ALIGN_RIGHT, "Allocated KiB", "%13.1f"}
+};
+
+static void
+dissector_profile_stat_reset(stat_tap_table* table)
+{
+	stat_tap_table_item_type* item_data;
+
+	for (unsigned element = 0; element < table->num_elements; element++) {
+		for (unsigned col = PROFILE_CALLS_COLUMN; col < table->num_fields; col++) {
+			item_data = stat_tap_get_field_data(table, element, col);
+			memset(&item_data->value, 0, sizeof(item_data->value));
+		}
+	}
+	dissector_profile_reset();
+}
+
+/* The number of tap listeners that use the profile. */
+static unsigned dissector_profile_listeners;
+
+static void
+dissector_profile_stat_init(stat_tap_table_ui* new_stat)
+{
+	const char *table_name = "Dissector Profile";
+	stat_tap_table *table;
+
+	/* Profiling isn't free, so it's only on while someone is listening. */
+	if (dissector_profile_listeners++ == 0) {
+		dissector_profile_set_enabled(true);
+	}
+
+	table = stat_tap_find_table(new_stat, table_name);
+	if (table) {
+		if (new_stat->stat_tap_reset_table_cb) {
+			new_stat->stat_tap_reset_table_cb(table);
+		}
+		return;
+	}
+
+	table = stat_tap_init_table(table_name, array_length(dissector_profile_fields), 0, NULL);
+	stat_tap_add_table(new_stat, table);
+	dissector_profile_reset();
+}
+
+static void
+dissector_profile_stat_finish(stat_tap_table_ui* new_stat _U_)
+{
+	ws_assert(dissector_profile_listeners > 0);
+	if (--dissector_profile_listeners == 0) {
+		dissector_profile_set_enabled(false);
+	}
+}
+
+/*
+ * The counters are kept by epan/packet.c, so there is nothing to do per
+ * frame other than asking for the table to be redrawn.
+ */
+static tap_packet_status
+dissector_profile_stat_packet(void *tapdata _U_, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *data _U_, tap_flags_t flags _U_)
+{
+	return TAP_PACKET_REDRAW;
+}
+
+/* Copy the counters into the table, most expensive dissectors first. */
+static void
+dissector_profile_stat_draw(stat_tap_table_ui* new_stat)
+{
+	stat_tap_table* table;
+	stat_tap_table_item_type items[array_length(dissector_profile_fields)];
+	GPtrArray *entries;
+
+	if (new_stat->tables->len == 0) {
+		return;
+	}
+	table = g_array_index(new_stat->tables, stat_tap_table*, 0);
+	entries = dissector_profile_get_entries();
+
+	memset(items, 0, sizeof(items));
+	items[PROFILE_DISSECTOR_COLUMN].type = TABLE_ITEM_STRING;
+	items[PROFILE_TYPE_COLUMN].type = TABLE_ITEM_STRING;
+	items[PROFILE_CALLS_COLUMN].type = TABLE_ITEM_UINT;
+	items[PROFILE_ACCEPTED_COLUMN].type = TABLE_ITEM_UINT;
+	items[PROFILE_EXCEPTIONS_COLUMN].type = TABLE_ITEM_UINT;
+	items[PROFILE_INCLUSIVE_COLUMN].type = TABLE_ITEM_FLOAT;
+	items[PROFILE_EXCLUSIVE_COLUMN].type = TABLE_ITEM_FLOAT;
+	items[PROFILE_ALLOC_COLUMN].type = TABLE_ITEM_FLOAT;
+
+	for (unsigned i = 0; i < entries->len; i++) {
+		const dissector_profile_entry_t *entry = (const dissector_profile_entry_t *)g_ptr_array_index(entries, i);
+
+		items[PROFILE_DISSECTOR_COLUMN].value.string_value = entry->name;
+		items[PROFILE_TYPE_COLUMN].value.string_value = entry->heuristic ? "heuristic" : "handle";
+		items[PROFILE_CALLS_COLUMN].value.uint_value = (unsigned)entry->calls;
+		items[PROFILE_ACCEPTED_COLUMN].value.uint_value = (unsigned)entry->accepted;
+		items[PROFILE_EXCEPTIONS_COLUMN].value.uint_value = (unsigned)entry->exceptions;
+		items[PROFILE_INCLUSIVE_COLUMN].value.float_value = entry->inclusive_ns / 1000000.0;
+		items[PROFILE_EXCLUSIVE_COLUMN].value.float_value = entry->exclusive_ns / 1000000.0;
+		items[PROFILE_ALLOC_COLUMN].value.float_value = entry->alloc_bytes / 1024.0;
+		stat_tap_init_table_row(table, i, array_length(dissector_profile_fields), items);
+	}
+	g_ptr_array_free(entries, true);
+}
+
 void
 proto_register_frame(void)
 {
@@ -1561,7 +1697,8 @@ proto_register_frame(void)
 		{ &ei_comments_text, { "frame.comment.expert", PI_COMMENTS_GROUP, PI_COMMENT, "Formatted comment", EXPFILL }},
 		{ &ei_arrive_time_out_of_range, { "frame.time_invalid", PI_SEQUENCE, PI_NOTE, "Arrival Time: Fractional second out of range (0-1000000000)", EXPFILL }},
 		{ &ei_incomplete, { "frame.incomplete", PI_UNDECODED, PI_NOTE, "Incomplete dissector", EXPFILL }},
-		{ &ei_len_lt_caplen, { "frame.len_lt_caplen", PI_MALFORMED, PI_ERROR, "Frame length is less than captured length", EXPFILL }}
+		{ &ei_len_lt_caplen, { "frame.len_lt_caplen", PI_MALFORMED, PI_ERROR, "Frame length is less than captured length", EXPFILL }},
+		{ &ei_reassembly_evicted, { "frame.reassembly_evicted", PI_REASSEMBLE, PI_WARN, "Incomplete reassemblies were dropped to stay within the memory limit", EXPFILL }}
 	};
 
 	module_t *frame_module;
@@ -1640,7 +1777,26 @@ proto_register_frame(void)
 	    " (applied separately to each comment)",
 	    10, &max_comment_lines);
 
+	static stat_tap_table_ui dissector_profile_stat_table = {
+		REGISTER_STAT_GROUP_GENERIC,
+		"Dissector Profile",
+		"frame",
+		"dissector,profile",
+		dissector_profile_stat_init,
+		dissector_profile_stat_packet,
+		dissector_profile_stat_reset,
+		NULL,
+		NULL,
+		array_length(dissector_profile_fields), dissector_profile_fields,
+		0, NULL,
+		NULL,
+		0,
+		dissector_profile_stat_draw,
+		dissector_profile_stat_finish
+	};
+
 	frame_tap=register_tap("frame");
+	register_stat_tap_table_ui(&dissector_profile_stat_table);
 }
 
 void
@@ -62,6 +62,7 @@
 #include <epan/expert.h>
 #include <epan/prefs.h>
 #include <epan/strutil.h>
+#include <epan/uncompress_cache.h>
 #include <epan/proto_data.h>
 #include "packet-http.h"
 #include "packet-http2.h"
@@ -290,7 +291,8 @@ dissect_grpc_message(tvbuff_t *tvb, unsigned offset, unsigned length, packet_inf
     if (compressed_flag & GRPC_COMPRESSED) {
         if (can_uncompress_body(compression_method)) {
             proto_item *compressed_proto_item = NULL;
-            tvbuff_t *uncompressed_tvb = tvb_child_uncompress_zlib(tvb, tvb, offset, message_length);
+            tvbuff_t *uncompressed_tvb = tvb_child_uncompress_cached(pinfo, tvb, tvb, offset, message_length,
+                tvb_uncompress_zlib);
 
             proto_tree *compressed_entity_tree = proto_tree_add_subtree_format(
                 grpc_tree, tvb, offset, message_length, ett_grpc_encoded_entity,
@@ -37,6 +37,7 @@
 #include <epan/exceptions.h>
 #include <epan/show_exception.h>
 #include <epan/unit_strings.h>
+#include <epan/uncompress_cache.h>
 #include <glib.h>
 #include "packet-http.h"
 #include "packet-http2.h"
@@ -2164,8 +2165,8 @@ dissecting_body:
 			     g_ascii_strcasecmp(headers->content_encoding, "x-gzip") == 0 ||
 			     g_ascii_strcasecmp(headers->content_encoding, "x-deflate") == 0))
 			{
-				uncomp_tvb = tvb_child_uncompress_zlib(tvb, next_tvb, 0,
-				    tvb_captured_length(next_tvb));
+				uncomp_tvb = tvb_child_uncompress_cached(pinfo, tvb, next_tvb, 0,
+				    tvb_captured_length(next_tvb), tvb_uncompress_zlib);
 			}
 #endif
 
@@ -2173,8 +2174,8 @@ dissecting_body:
 			if (http_decompress_body &&
 			    g_ascii_strcasecmp(headers->content_encoding, "br") == 0)
 			{
-				uncomp_tvb = tvb_child_uncompress_brotli(tvb, next_tvb, 0,
-				    tvb_captured_length(next_tvb));
+				uncomp_tvb = tvb_child_uncompress_cached(pinfo, tvb, next_tvb, 0,
+				    tvb_captured_length(next_tvb), tvb_uncompress_brotli);
 			}
 #endif
 
@@ -2182,8 +2183,8 @@ dissecting_body:
 			if (http_decompress_body &&
 			    g_ascii_strcasecmp(headers->content_encoding, "snappy") == 0)
 			{
-				uncomp_tvb = tvb_child_uncompress_snappy(tvb, next_tvb, 0,
-				    tvb_captured_length(next_tvb));
+				uncomp_tvb = tvb_child_uncompress_cached(pinfo, tvb, next_tvb, 0,
+				    tvb_captured_length(next_tvb), tvb_uncompress_snappy);
 			}
 #endif
 
@@ -2191,8 +2192,8 @@ dissecting_body:
 			if (http_decompress_body &&
 			    g_ascii_strcasecmp(headers->content_encoding, "zstd") == 0)
 			{
-				uncomp_tvb = tvb_child_uncompress_zstd(tvb, next_tvb, 0,
-				    tvb_captured_length(next_tvb));
+				uncomp_tvb = tvb_child_uncompress_cached(pinfo, tvb, next_tvb, 0,
+				    tvb_captured_length(next_tvb), tvb_uncompress_zstd);
 			}
 #endif
 
@@ -49,6 +49,7 @@
 #include <epan/reassemble.h>
 #include <epan/follow.h>
 #include <epan/addr_resolv.h>
+#include <epan/uncompress_cache.h>
 
 #include "packet-e212.h"
 #include "packet-tcp.h"
@@ -3196,11 +3197,11 @@ dissect_http2_data_full_body(tvbuff_t *tvb, packet_info *pinfo, http2_session_t*
 
         tvbuff_t *uncompressed_tvb = NULL;
         if (uncompression == BODY_UNCOMPRESSION_ZLIB) {
-            uncompressed_tvb = tvb_child_uncompress_zlib(tvb, tvb, 0, datalen);
+            uncompressed_tvb = tvb_child_uncompress_cached(pinfo, tvb, tvb, 0, datalen, tvb_uncompress_zlib);
         } else if (uncompression == BODY_UNCOMPRESSION_BROTLI) {
-            uncompressed_tvb = tvb_child_uncompress_brotli(tvb, tvb, 0, datalen);
+            uncompressed_tvb = tvb_child_uncompress_cached(pinfo, tvb, tvb, 0, datalen, tvb_uncompress_brotli);
         } else if (uncompression == BODY_UNCOMPRESSION_ZSTD) {
-            uncompressed_tvb = tvb_child_uncompress_zstd(tvb, tvb, 0, datalen);
+            uncompressed_tvb = tvb_child_uncompress_cached(pinfo, tvb, tvb, 0, datalen, tvb_uncompress_zstd);
         }
 
         http2_data_stream_body_info_t *body_info = get_data_stream_body_info(pinfo, h2session);
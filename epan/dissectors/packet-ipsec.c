@@ -303,6 +303,28 @@ static extra_esp_sa_records_t extra_esp_sa_records;
 static uat_t * esp_uat;
 static unsigned num_sa_uat;
 
+/*
+ * Index of the SA records by SPI, so that a packet is only checked against
+ * the records for its SPI and those whose SPI has wildcards, rather than
+ * against all of them. It's rebuilt after the records change.
+ */
+typedef struct {
+  unsigned order;                   /* the order in which records are tried */
+  uat_esp_sa_record_t *record;
+} esp_sa_index_entry_t;
+
+static GHashTable *esp_sa_spi_index;    /* SPI -> GArray of esp_sa_index_entry_t */
+static GArray *esp_sa_wildcard_index;   /* esp_sa_index_entry_t with SPI wildcards */
+static bool esp_sa_index_valid;
+static uat_esp_sa_record_t *esp_sa_index_uat_records;
+static unsigned esp_sa_index_num_uat;
+
+static void
+esp_sa_index_invalidate(void)
+{
+  esp_sa_index_valid = false;
+}
+
 /*
    Name : static int compute_ascii_key(char **ascii_key, char *key)
    Description : Allocate memory for the key and transform the key if it is hexadecimal
@@ -558,6 +580,8 @@ void esp_sa_record_add_from_dissector(uint8_t protocol, const char *srcIP, const
        /* Free (but ignore) any error string set */
        g_free(err);
    }
+
+   esp_sa_index_invalidate();
 }
 
 /*************************************/
@@ -1133,6 +1157,81 @@ filter_spi_match(unsigned spi, char *filter)
 }
 
 
+static void
+esp_sa_index_free_bucket(void *data)
+{
+  g_array_free((GArray *)data, true);
+}
+
+static void
+esp_sa_index_add(unsigned order, uat_esp_sa_record_t *record)
+{
+  esp_sa_index_entry_t entry;
+  unsigned long spi;
+  GArray *bucket;
+
+  entry.order = order;
+  entry.record = record;
+
+  /* Anything but a plain number is left to filter_spi_match() */
+  if (record->spi == NULL || strchr(record->spi, IPSEC_SA_WILDCARDS_ANY) != NULL) {
+    g_array_append_val(esp_sa_wildcard_index, entry);
+    return;
+  }
+
+  spi = strtoul(record->spi, NULL, 0);
+  if (spi != (uint32_t)spi) {
+    /* Can't match any SPI */
+    return;
+  }
+  bucket = (GArray *)g_hash_table_lookup(esp_sa_spi_index, GUINT_TO_POINTER(spi));
+  if (bucket == NULL) {
+    bucket = g_array_new(false, false, sizeof(esp_sa_index_entry_t));
+    g_hash_table_insert(esp_sa_spi_index, GUINT_TO_POINTER(spi), bucket);
+  }
+  g_array_append_val(bucket, entry);
+}
+
+static void
+esp_sa_index_free(void)
+{
+  if (esp_sa_spi_index) {
+    g_hash_table_destroy(esp_sa_spi_index);
+    esp_sa_spi_index = NULL;
+  }
+  if (esp_sa_wildcard_index) {
+    g_array_free(esp_sa_wildcard_index, true);
+    esp_sa_wildcard_index = NULL;
+  }
+  esp_sa_index_valid = false;
+}
+
+/* (Re)build the index if the records have changed since it was built. */
+static void
+esp_sa_index_update(void)
+{
+  unsigned order = 0;
+  unsigned n;
+
+  if (esp_sa_index_valid && esp_sa_index_uat_records == uat_esp_sa_records &&
+      esp_sa_index_num_uat == num_sa_uat)
+    return;
+
+  esp_sa_index_free();
+  esp_sa_spi_index = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, esp_sa_index_free_bucket);
+  esp_sa_wildcard_index = g_array_new(false, false, sizeof(esp_sa_index_entry_t));
+
+  /* Extra ones are tried first, then UAT ones */
+  for (n = 0; n < extra_esp_sa_records.num_records; n++)
+    esp_sa_index_add(order++, &extra_esp_sa_records.records[n]);
+  for (n = 0; n < num_sa_uat; n++)
+    esp_sa_index_add(order++, &uat_esp_sa_records[n]);
+
+  esp_sa_index_uat_records = uat_esp_sa_records;
+  esp_sa_index_num_uat = num_sa_uat;
+  esp_sa_index_valid = true;
+}
+
 /*
    Name : static goolean get_esp_sa(g_esp_sa_database *sad, int protocol_typ, char *src,  char *dst,  unsigned spi,
            int *encryption_algo,
@@ -1179,23 +1278,31 @@ get_esp_sa(int protocol_typ, char *src,  char *dst,  unsigned spi,
   )
 {
   bool found = false;
-  unsigned i, j;
+  GArray *bucket;
+  unsigned i, j, bucket_len;
 
   *cipher_hd = NULL;
   *cipher_hd_created = NULL;
 
-  /* Check each known SA in turn */
-  for (i = 0, j=0; (found == false) && ((i < num_sa_uat) || (j < extra_esp_sa_records.num_records)); )
+  esp_sa_index_update();
+  bucket = (GArray *)g_hash_table_lookup(esp_sa_spi_index, GUINT_TO_POINTER(spi));
+  bucket_len = bucket ? bucket->len : 0;
+
+  /*
+   * Check the records for this SPI and the wildcard records in the
+   * order in which they were configured.
+   */
+  for (i = 0, j = 0; (found == false) && ((i < bucket_len) || (j < esp_sa_wildcard_index->len)); )
   {
     /* Get the next record to try */
     uat_esp_sa_record_t *record;
-    if (j < extra_esp_sa_records.num_records) {
-      /* Extra ones checked first */
-      record = &extra_esp_sa_records.records[j++];
+    if (j >= esp_sa_wildcard_index->len ||
+        (i < bucket_len &&
+         g_array_index(bucket, esp_sa_index_entry_t, i).order < g_array_index(esp_sa_wildcard_index, esp_sa_index_entry_t, j).order)) {
+      record = g_array_index(bucket, esp_sa_index_entry_t, i++).record;
     }
     else {
-      /* Then UAT ones */
-      record = &uat_esp_sa_records[i++];
+      record = g_array_index(esp_sa_wildcard_index, esp_sa_index_entry_t, j++).record;
     }
 
     if((protocol_typ == record->protocol || record->protocol == IPSEC_SA_ANY)
@@ -2635,6 +2742,8 @@ static void ipsec_cleanup_protocol(void)
   g_free(extra_esp_sa_records.records);
   extra_esp_sa_records.records = NULL;
   extra_esp_sa_records.num_records = 0;
+
+  esp_sa_index_free();
 }
 
 void
@@ -2833,8 +2942,8 @@ proto_register_ipsec(void)
             uat_esp_sa_record_copy_cb,      /* copy callback */
             uat_esp_sa_record_update_cb,    /* update callback */
             uat_esp_sa_record_free_cb,      /* free callback */
-            NULL,                           /* post update callback */
-            NULL,                           /* reset callback */
+            esp_sa_index_invalidate,        /* post update callback */
+            esp_sa_index_invalidate,        /* reset callback */
             esp_uat_flds);                  /* UAT field definitions */
 
   static const char *esp_uat_defaults_[] = {
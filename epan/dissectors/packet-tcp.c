@@ -2061,6 +2061,50 @@ init_tcp_conversation_data(packet_info *pinfo, int direction)
     return tcpd;
 }
 
+static void
+expire_tcp_flow(tcp_flow_t *flow)
+{
+    wmem_tree_destroy(flow->multisegment_pdus, false, true);
+
+    if (flow->ooo_segments)
+        wmem_destroy_list(flow->ooo_segments);
+
+    if (flow->tcp_analyze_seq_info) {
+        tcp_unacked_t *ual = flow->tcp_analyze_seq_info->segments;
+
+        while (ual) {
+            tcp_unacked_t *next = ual->next;
+
+            wmem_free(wmem_file_scope(), ual);
+            ual = next;
+        }
+        wmem_free(wmem_file_scope(), flow->tcp_analyze_seq_info);
+    }
+
+    if (flow->process_info) {
+        wmem_free(wmem_file_scope(), flow->process_info->username);
+        wmem_free(wmem_file_scope(), flow->process_info->command);
+        wmem_free(wmem_file_scope(), flow->process_info);
+    }
+}
+
+/* Free the conversation data when the conversation is expired */
+static void
+expire_tcp_conversation_data(conversation_t *conv _U_, void *proto_data)
+{
+    struct tcp_analysis *tcpd = (struct tcp_analysis *)proto_data;
+
+    /* The subflows of an MPTCP connection refer to each other, so leave
+     * them to the file scope. */
+    if (tcpd->mptcp_analysis)
+        return;
+
+    expire_tcp_flow(&tcpd->flow1);
+    expire_tcp_flow(&tcpd->flow2);
+    wmem_tree_destroy(tcpd->acked_table, false, true);
+    wmem_free(wmem_file_scope(), tcpd);
+}
+
 /* setup meta as well */
 static void
 mptcp_init_subflow(tcp_flow_t *flow)
@@ -10924,6 +10968,8 @@ proto_reg_handoff_tcp(void)
 
     proto_ip = proto_get_id_by_filter_name("ip");
     proto_icmp = proto_get_id_by_filter_name("icmp");
+
+    conversation_register_expire_routine(proto_tcp, expire_tcp_conversation_data);
 }
 
 /*
@@ -189,6 +189,19 @@ init_udp_conversation_data(packet_info *pinfo)
     return udpd;
 }
 
+/* Free the conversation data when the conversation is expired */
+static void
+expire_udp_conversation_data(conversation_t *conv _U_, void *proto_data)
+{
+    struct udp_analysis *udpd = (struct udp_analysis *)proto_data;
+
+    wmem_free(wmem_file_scope(), udpd->flow1.username);
+    wmem_free(wmem_file_scope(), udpd->flow1.command);
+    wmem_free(wmem_file_scope(), udpd->flow2.username);
+    wmem_free(wmem_file_scope(), udpd->flow2.command);
+    wmem_free(wmem_file_scope(), udpd);
+}
+
 struct udp_analysis *
 get_udp_conversation_data(conversation_t *conv, packet_info *pinfo)
 {
@@ -1569,6 +1582,8 @@ proto_reg_handoff_udp(void)
     capture_dissector_add_uint("ip.proto", IP_PROTO_UDPLITE, udplite_cap_handle);
 
     exported_pdu_tap = find_tap_id(EXPORT_PDU_TAP_NAME_LAYER_4);
+
+    conversation_register_expire_routine(proto_udp, expire_udp_conversation_data);
 }
 
 /*
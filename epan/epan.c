@@ -33,6 +33,7 @@
 #include "epan_dissect.h"
 
 #include <wsutil/nstime.h>
+#include <wsutil/strtoi.h>
 #include <wsutil/wslog.h>
 #include <wsutil/ws_assert.h>
 #include <wsutil/version_info.h>
@@ -58,6 +59,7 @@
 #include "conversation_filter.h"
 #include "conversation_table.h"
 #include "reassemble.h"
+#include "uncompress_cache-int.h"
 #include "srt_table.h"
 #include "stats_tree.h"
 #include "secrets.h"
@@ -283,6 +285,15 @@ epan_init(register_cb cb, void *client_data, bool load_plugins)
 	/* initialize memory allocation subsystem */
 	wmem_init_scopes();
 
+	/* If WIRESHARK_MEM_ACCOUNTING is set to a sample rate, count wmem
+	 * allocations by protocol from the start, so that the file scope
+	 * figures are complete. */
+	const char *mem_accounting_env = getenv("WIRESHARK_MEM_ACCOUNTING");
+	uint32_t mem_accounting_rate;
+	if (mem_accounting_env != NULL && ws_strtou32(mem_accounting_env, NULL, &mem_accounting_rate)) {
+		dissector_mem_accounting_set_sample_rate(mem_accounting_rate);
+	}
+
 	/* initialize the GUID to name mapping table */
 	guids_init();
 
@@ -342,6 +353,7 @@ epan_init(register_cb cb, void *client_data, bool load_plugins)
 		conversation_init();
 		capture_dissector_init();
 		reassembly_tables_init();
+		uncompress_cache_init();
 		conversation_filters_init();
 		g_slist_foreach(epan_plugins, epan_plugin_init, NULL);
 		proto_init(epan_plugin_register_all_procotols, epan_plugin_register_all_handoffs, cb, client_data);
@@ -476,9 +488,22 @@ epan_cleanup(void)
 #endif
 }
 
+/* When a frame was seen, for streaming mode. */
+typedef struct {
+	time_t secs;
+	uint32_t frame;
+} streaming_mark_t;
+
 struct epan_session {
 	struct packet_provider_data *prov;	/* packet provider data for this session */
 	struct packet_provider_funcs funcs;	/* functions using that data */
+
+	/* Streaming mode, see epan_set_streaming() */
+	unsigned streaming_idle_timeout;	/* 0 if not streaming */
+	unsigned streaming_max_conversations;
+	time_t streaming_next_sweep;
+	uint32_t streaming_idle_frame;	/* frames before this one are idle */
+	GQueue *streaming_marks;	/* streaming_mark_t, once per second */
 };
 
 epan_t *
@@ -542,6 +567,11 @@ void
 epan_free(epan_t *session)
 {
 	if (session) {
+		if (session->streaming_marks) {
+			conversation_track_usage(false);
+			g_queue_free_full(session->streaming_marks, g_free);
+		}
+
 		/* XXX, it should take session as param */
 		cleanup_dissection();
 
@@ -549,6 +579,65 @@ epan_free(epan_t *session)
 	}
 }
 
+void
+epan_set_streaming(epan_t *session, unsigned idle_timeout, unsigned max_conversations)
+{
+	ws_assert(idle_timeout > 0);
+
+	session->streaming_idle_timeout = idle_timeout;
+	session->streaming_max_conversations = max_conversations;
+	session->streaming_next_sweep = 0;
+	session->streaming_idle_frame = 0;
+	if (session->streaming_marks == NULL)
+		session->streaming_marks = g_queue_new();
+	conversation_track_usage(true);
+}
+
+/*
+ * Once a second of capture time, before a frame is dissected, expire the
+ * conversations and reassemblies that are idle or over the limit.
+ *
+ * Conversations and fragments only know the frames they were last used
+ * in, so remember which frame was current each second and go by the
+ * newest one that is at least the idle timeout old.
+ */
+static void
+epan_streaming_sweep(epan_t *session, const frame_data *fd)
+{
+	streaming_mark_t *mark;
+	time_t now;
+
+	if (!fd->has_ts) {
+		/* Only the limit on conversations applies. */
+		conversation_expire(0, session->streaming_max_conversations);
+		return;
+	}
+
+	now = fd->abs_ts.secs;
+	if (now < session->streaming_next_sweep) {
+		if (now + 1 >= session->streaming_next_sweep)
+			return;
+		/* The clock went back; start timing over. */
+		while ((mark = (streaming_mark_t *)g_queue_pop_head(session->streaming_marks)) != NULL)
+			g_free(mark);
+	}
+	session->streaming_next_sweep = now + 1;
+
+	mark = g_new(streaming_mark_t, 1);
+	mark->secs = now;
+	mark->frame = fd->num;
+	g_queue_push_tail(session->streaming_marks, mark);
+
+	while ((mark = (streaming_mark_t *)g_queue_peek_head(session->streaming_marks)) != NULL &&
+			mark->secs + (time_t)session->streaming_idle_timeout <= now) {
+		session->streaming_idle_frame = mark->frame;
+		g_free(g_queue_pop_head(session->streaming_marks));
+	}
+
+	conversation_expire(session->streaming_idle_frame, session->streaming_max_conversations);
+	reassembly_tables_expire(session->streaming_idle_frame);
+}
+
 void
 epan_conversation_init(void)
 {
@@ -584,6 +673,7 @@ epan_dissect_init(epan_dissect_t *edt, epan_t *session, const bool create_proto_
 	}
 	else {
 		edt->pi.pool = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK_FAST);
+		wmem_allocator_set_accounting_scope(edt->pi.pool, WMEM_ACCOUNTING_PACKET_SCOPE);
 	}
 
 	if (create_proto_tree) {
@@ -625,6 +715,7 @@ epan_dissect_reset(epan_dissect_t *edt)
 
 	tmp = edt->pi.pool;
 	wmem_free_all(tmp);
+	wmem_accounting_reset(WMEM_ACCOUNTING_PACKET_SCOPE);
 
 	memset(&edt->pi, 0, sizeof(edt->pi));
 	edt->pi.pool = tmp;
@@ -658,6 +749,9 @@ epan_dissect_run(epan_dissect_t *edt, int file_type_subtype,
 	 * registered to a fake tap. */
 	wslua_prime_dfilter(edt); /* done before entering wmem scope */
 #endif
+	if (edt->session && edt->session->streaming_idle_timeout)
+		epan_streaming_sweep(edt->session, fd);
+
 	wmem_enter_packet_scope();
 	dissect_record(edt, file_type_subtype, rec, fd, cinfo);
 
@@ -671,6 +765,9 @@ void
 epan_dissect_run_with_taps(epan_dissect_t *edt, int file_type_subtype,
 	wtap_rec *rec, frame_data *fd, column_info *cinfo)
 {
+	if (edt->session && edt->session->streaming_idle_timeout)
+		epan_streaming_sweep(edt->session, fd);
+
 	wmem_enter_packet_scope();
 	tap_queue_init(edt);
 	dissect_record(edt, file_type_subtype, rec, fd, cinfo);
@@ -741,6 +838,7 @@ epan_dissect_cleanup(epan_dissect_t* edt)
 	else {
 		wmem_destroy_allocator(edt->pi.pool);
 	}
+	wmem_accounting_reset(WMEM_ACCOUNTING_PACKET_SCOPE);
 }
 
 void
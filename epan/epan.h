@@ -154,6 +154,21 @@ const nstime_t *epan_get_frame_ts(const epan_t *session, uint32_t frame_num);
 
 WS_DLL_PUBLIC void epan_free(epan_t *session);
 
+/**
+ * Put a session into streaming mode, for single-pass dissection of
+ * captures that don't end. Instead of keeping all state for the whole
+ * capture, conversations and reassemblies are freed once they have been
+ * idle for a while, and the least recently used conversations are
+ * freed if there are too many. Frames must not be dissected again,
+ * or out of order, afterwards.
+ *
+ * @param session The session.
+ * @param idle_timeout Seconds of capture time after which conversations
+ * and reassemblies that weren't used are freed. Must be non-zero.
+ * @param max_conversations The most conversations to keep, or 0 for no limit.
+ */
+WS_DLL_PUBLIC void epan_set_streaming(epan_t *session, unsigned idle_timeout, unsigned max_conversations);
+
 WS_DLL_PUBLIC const char*
 epan_get_version(void);
 
@@ -50,15 +50,17 @@ typedef enum {
 
    There is one of these structures for every frame in the capture.
    That means a lot of memory if we have a lot of frames.
-   They are packed into power-of-2 chunks, so their size is effectively
-   rounded up to a power of 2.
-   Try to keep it close to, and less than or equal to, a power of 2.
-   "Smaller than a power of 2" is OK for ILP32 platforms.
+   They are packed into arrays of 1024 in frame_data_sequence, so every
+   byte here costs a byte per frame; 80 bytes on LP64 and LLP64
+   platforms.  Attributes that are only set for a few frames go in a
+   separately allocated frame_data_cold structure instead, and must be
+   accessed with the frame_data_*() functions below.
 
    XXX - shuffle the fields to try to keep the most commonly-accessed
    fields within the first 16 or 32 bytes, so they all fit in a cache
    line? */
 struct _color_filter; /* Forward */
+struct _frame_data_cold; /* Forward */
 DIAG_OFF_PEDANTIC
 typedef struct _frame_data {
   uint32_t     num;          /**< Frame number */
@@ -66,16 +68,14 @@ typedef struct _frame_data {
   uint32_t     pkt_len;      /**< Packet length */
   uint32_t     cap_len;      /**< Amount actually captured */
   int64_t      file_off;     /**< File offset */
-  /* These two are pointers, meaning 64-bit on LP64 (64-bit UN*X) and
+  /* These are pointers, meaning 64-bit on LP64 (64-bit UN*X) and
      LLP64 (64-bit Windows) platforms.  Put them here, one after the
      other, so they don't require padding between them. */
   GSList      *pfd;          /**< Per frame proto data */
-  GHashTable  *dependent_frames;     /**< A hash table of frames which this one depends on */
+  struct _frame_data_cold *cold;  /**< Rarely set attributes, NULL if none are set */
   const struct _color_filter *color_filter;  /**< Per-packet matching color_filter_t object */
   uint32_t     cum_bytes;    /**< Cumulative bytes into the capture */
-  uint8_t      tcp_snd_manual_analysis;   /**< TCP SEQ Analysis Overriding, 0 = none, 1 = OOO, 2 = RET , 3 = Fast RET, 4 = Spurious RET  */
-  /* Keep the bitfields below to 24 bits, so this plus the previous field
-     are 32 bits. (XXX - The previous field could be a bitfield too.) */
+  /* Keep the bitfields below to 32 bits. */
   unsigned int passed_dfilter   : 1; /**< 1 = display, 0 = no display */
   unsigned int dependent_of_displayed : 1; /**< 1 if a displayed frame depends on this frame */
   /* Do NOT use packet_char_enc enum here: MSVC compiler does not handle an enum in a bit field properly */
@@ -88,8 +88,8 @@ typedef struct _frame_data {
   unsigned int has_modified_block : 1; /** 1 = block for this packet has been modified */
   unsigned int need_colorize    : 1; /**< 1 = need to (re-)calculate packet color */
   unsigned int tsprec           : 4; /**< Time stamp precision -2^tsprec gives up to femtoseconds */
+  unsigned int tcp_snd_manual_analysis : 3; /**< TCP SEQ Analysis Overriding, 0 = none, 1 = OOO, 2 = RET , 3 = Fast RET, 4 = Spurious RET  */
   nstime_t     abs_ts;       /**< Absolute timestamp */
-  nstime_t     shift_offset; /**< How much the abs_tm of the frame is shifted */
   uint32_t     frame_ref_num; /**< Previous reference frame (0 if this is one) */
   uint32_t     prev_dis_num; /**< Previous displayed frame (0 if first one) */
 } frame_data;
@@ -106,6 +106,25 @@ WS_DLL_PUBLIC void frame_data_init(frame_data *fdata, uint32_t num,
                 const wtap_rec *rec, int64_t offset,
                 uint32_t cum_bytes);
 
+/**
+ * Returns the frames this one depends on, as a set of frame numbers,
+ * or NULL if there are none.
+ */
+WS_DLL_PUBLIC GHashTable *frame_data_get_dependent_frames(const frame_data *fdata);
+
+/**
+ * Records that this frame depends on frame number frame_num.
+ */
+WS_DLL_PUBLIC void frame_data_add_dependent_frame(frame_data *fdata, uint32_t frame_num);
+
+/**
+ * Returns how much the absolute timestamp of the frame has been shifted
+ * by the user; zero if it hasn't.
+ */
+WS_DLL_PUBLIC const nstime_t *frame_data_get_shift_offset(const frame_data *fdata);
+
+WS_DLL_PUBLIC void frame_data_set_shift_offset(frame_data *fdata, const nstime_t *shift_offset);
+
 extern bool frame_rel_first_frame_time(const struct epan_session *epan,
                                        const frame_data *fdata,
                                        nstime_t *delta);
@@ -328,8 +328,9 @@ find_and_mark_frame_depended_upon(void *key, void *value _U_, void *user_data)
      */
     if (!(dependent_fd->dependent_of_displayed || dependent_fd->passed_dfilter)) {
       dependent_fd->dependent_of_displayed = 1;
-      if (dependent_fd->dependent_frames) {
-        g_hash_table_foreach(dependent_fd->dependent_frames, find_and_mark_frame_depended_upon, frames);
+      GHashTable *dependent_frames = frame_data_get_dependent_frames(dependent_fd);
+      if (dependent_frames) {
+        g_hash_table_foreach(dependent_frames, find_and_mark_frame_depended_upon, frames);
       }
     }
   }
@@ -10,6 +10,7 @@
 
 #include "ftypes-int.h"
 
+#include <epan/exceptions.h>
 #include <wsutil/ws_assert.h>
 
 /* Keep track of ftype_t's via their ftenum number */
@@ -1366,6 +1367,90 @@ fvalue_contains(const fvalue_t *a, const fvalue_t *b)
 	return yes ? FT_TRUE : FT_FALSE;
 }
 
+/*
+ * Returns the bytes that the "contains" operator of a type searches,
+ * both as the haystack and as the needle. Protocol values without a
+ * tvbuff are not supported, and getting the tvbuff data may throw.
+ */
+static bool
+get_contains_data(const fvalue_t *fv, const uint8_t **data, size_t *size)
+{
+	tvbuff_t *tvb;
+
+	if (FT_IS_STRING(fv->ftype->ftype)) {
+		*data = (const uint8_t *)fv->value.strbuf->str;
+		*size = fv->value.strbuf->len;
+		return true;
+	}
+
+	switch (fv->ftype->ftype) {
+		case FT_PROTOCOL:
+			tvb = fv->value.protocol.tvb;
+			if (tvb == NULL)
+				return false;
+			*size = tvb_captured_length(tvb);
+			*data = tvb_get_ptr(tvb, 0, (int)*size);
+			return true;
+
+		case FT_BYTES:
+		case FT_UINT_BYTES:
+		case FT_VINES:
+		case FT_ETHER:
+		case FT_OID:
+		case FT_REL_OID:
+		case FT_SYSTEM_ID:
+		case FT_FCWWN:
+		case FT_EUI64:
+			*data = g_bytes_get_data(fv->value.bytes, size);
+			return true;
+
+		default:
+			break;
+	}
+	return false;
+}
+
+bool
+fvalue_add_contains_needle(ws_multipattern_t *mp, const fvalue_t *b)
+{
+	const uint8_t *data;
+	size_t size;
+	volatile bool ok = false;
+
+	TRY {
+		if (get_contains_data(b, &data, &size) && size > 0) {
+			ok = ws_multipattern_add(mp, data, size) >= 0;
+		}
+	}
+	CATCH_ALL {
+		/* nothing */
+	}
+	ENDTRY;
+
+	return ok;
+}
+
+ft_bool_t
+fvalue_contains_any(const fvalue_t *a, const ws_multipattern_t *mp)
+{
+	const uint8_t *data;
+	size_t size;
+	volatile ft_bool_t yes = FT_FALSE;
+
+	TRY {
+		if (get_contains_data(a, &data, &size) &&
+				ws_multipattern_exec(mp, data, size, NULL) != NULL) {
+			yes = FT_TRUE;
+		}
+	}
+	CATCH_ALL {
+		/* nothing */
+	}
+	ENDTRY;
+
+	return yes;
+}
+
 ft_bool_t
 fvalue_matches(const fvalue_t *a, const ws_regex_t *re)
 {
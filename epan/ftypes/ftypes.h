@@ -15,6 +15,7 @@
 #include <wireshark.h>
 
 #include <wsutil/regex.h>
+#include <wsutil/ws_multipattern.h>
 #include <epan/wmem_scopes.h>
 
 #ifdef __cplusplus
@@ -561,6 +562,20 @@ WS_DLL_PUBLIC
 ft_bool_t
 fvalue_matches(const fvalue_t *a, const ws_regex_t *re);
 
+/* Adds the value that "a contains b" would look for as a needle of a
+ * multi-pattern search. Returns false if the value can't be used that
+ * way; the needle must also be non-empty. */
+WS_DLL_PUBLIC
+bool
+fvalue_add_contains_needle(ws_multipattern_t *mp, const fvalue_t *b);
+
+/* Equivalent to fvalue_contains(a, b1) || fvalue_contains(a, b2) || ...
+ * for the needles added to the compiled pattern set, in a single pass
+ * over the value. */
+WS_DLL_PUBLIC
+ft_bool_t
+fvalue_contains_any(const fvalue_t *a, const ws_multipattern_t *mp);
+
 WS_DLL_PUBLIC
 ft_bool_t
 fvalue_is_zero(const fvalue_t *a);
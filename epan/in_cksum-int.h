@@ -0,0 +1,25 @@
+/** @file
+ * Internal definitions for the Internet checksum routines.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __IN_CKSUM_INT_H__
+#define __IN_CKSUM_INT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef HAVE_AVX2
+/*
+ * Add up the 32-bit words in len bytes, which must be a multiple of 64,
+ * with AVX2; only call this if ws_cpuid_avx2() says we can.
+ */
+uint64_t in_cksum_avx2(const uint8_t *p, size_t len);
+#endif
+
+#endif /* __IN_CKSUM_INT_H__ */
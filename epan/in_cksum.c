@@ -13,10 +13,25 @@
 
 #include "config.h"
 
+#include <string.h>
+
 #include <glib.h>
 
 #include <epan/tvbuff.h>
 #include <epan/in_cksum.h>
+#include "in_cksum-int.h"
+
+#ifdef HAVE_AVX2
+#include <wsutil/ws_cpuid.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define IN_CKSUM_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define IN_CKSUM_NEON
+#include <arm_neon.h>
+#endif
 
 /*
  * Checksum routine for Internet Protocol family headers (Portable Version).
@@ -28,6 +43,122 @@
 #define ADDCARRY(x)  {if ((x) > 65535) (x) -= 65535;}
 #define REDUCE {l_util.l = sum; sum = l_util.s[0] + l_util.s[1]; ADDCARRY(sum);}
 
+/*
+ * The one's complement sum of 16-bit words can also be computed by
+ * adding up larger words and folding the carries back in at the end
+ * (RFC 1071, section 2 (B) and (C)). So the bulk of the data is added
+ * up 32 bits at a time into 64-bit accumulators, which can't overflow,
+ * with SSE2, AVX2 or NEON where we have them, and reduced only once.
+ */
+static inline uint32_t
+in_cksum_fold(uint64_t sum)
+{
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	return (uint32_t)sum;
+}
+
+#if defined(IN_CKSUM_SSE2)
+/* len must be a multiple of 32. */
+static uint64_t
+in_cksum_sse2(const uint8_t *p, size_t len)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc0 = zero, acc1 = zero;
+	uint64_t lanes[2];
+
+	for (; len != 0; p += 32, len -= 32) {
+		__m128i v0 = _mm_loadu_si128((const __m128i *)(const void *)p);
+		__m128i v1 = _mm_loadu_si128((const __m128i *)(const void *)(p + 16));
+
+		acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v0, zero));
+		acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v0, zero));
+		acc0 = _mm_add_epi64(acc0, _mm_unpacklo_epi32(v1, zero));
+		acc1 = _mm_add_epi64(acc1, _mm_unpackhi_epi32(v1, zero));
+	}
+	_mm_storeu_si128((__m128i *)(void *)lanes, _mm_add_epi64(acc0, acc1));
+	return lanes[0] + lanes[1];
+}
+#elif defined(IN_CKSUM_NEON)
+/* len must be a multiple of 32. */
+static uint64_t
+in_cksum_neon(const uint8_t *p, size_t len)
+{
+	uint64x2_t acc0 = vdupq_n_u64(0), acc1 = vdupq_n_u64(0);
+
+	for (; len != 0; p += 32, len -= 32) {
+		acc0 = vpadalq_u32(acc0, vreinterpretq_u32_u8(vld1q_u8(p)));
+		acc1 = vpadalq_u32(acc1, vreinterpretq_u32_u8(vld1q_u8(p + 16)));
+	}
+	acc0 = vaddq_u64(acc0, acc1);
+	return vgetq_lane_u64(acc0, 0) + vgetq_lane_u64(acc0, 1);
+}
+#endif
+
+/*
+ * Return the one's complement sum, reduced to 16 bits, of the 16-bit
+ * words in the len bytes at p, which must be an even number.
+ */
+static uint32_t
+in_cksum_words(const uint8_t *p, size_t len)
+{
+	uint64_t sum = 0;
+	size_t block_len;
+#ifdef HAVE_AVX2
+	static size_t cpu_checked;
+	static bool use_avx2;
+
+	if (g_once_init_enter(&cpu_checked)) {
+		use_avx2 = ws_cpuid_avx2() != 0;
+		g_once_init_leave(&cpu_checked, 1);
+	}
+	if (use_avx2) {
+		block_len = len & ~(size_t)63;
+		sum += in_cksum_avx2(p, block_len);
+		p += block_len;
+		len -= block_len;
+	}
+#endif
+
+	block_len = len & ~(size_t)31;
+#if defined(IN_CKSUM_SSE2)
+	sum += in_cksum_sse2(p, block_len);
+#elif defined(IN_CKSUM_NEON)
+	sum += in_cksum_neon(p, block_len);
+#else
+	for (size_t i = 0; i < block_len; i += 16) {
+		uint32_t w[4];
+
+		memcpy(w, p + i, sizeof w);
+		sum += w[0];
+		sum += w[1];
+		sum += w[2];
+		sum += w[3];
+	}
+#endif
+	p += block_len;
+	len -= block_len;
+
+	while (len >= 4) {
+		uint32_t w;
+
+		memcpy(&w, p, sizeof w);
+		sum += w;
+		p += 4;
+		len -= 4;
+	}
+	if (len != 0) {
+		uint16_t w;
+
+		memcpy(&w, p, sizeof w);
+		sum += w;
+	}
+
+	return in_cksum_fold(sum);
+}
+
 /*
  * Linux and Windows, at least, when performing Local Checksum Offload
  * store the one's complement sum (not inverted to its bitwise complement)
@@ -95,28 +226,14 @@ in_cksum_ret_partial(const vec_t *vec, int veclen, uint16_t *partial)
 			byte_swapped = 1;
 		}
 		/*
-		 * Unroll the loop to make overhead from
-		 * branches &c small.
+		 * Add up all the whole words in one go; the result
+		 * has already been reduced.
 		 */
-		while ((mlen -= 32) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			sum += w[4]; sum += w[5]; sum += w[6]; sum += w[7];
-			sum += w[8]; sum += w[9]; sum += w[10]; sum += w[11];
-			sum += w[12]; sum += w[13]; sum += w[14]; sum += w[15];
-			w += 16;
-		}
-		mlen += 32;
-		while ((mlen -= 8) >= 0) {
-			sum += w[0]; sum += w[1]; sum += w[2]; sum += w[3];
-			w += 4;
-		}
-		mlen += 8;
-		if (mlen == 0 && byte_swapped == 0)
-			continue;
-		REDUCE;
-		while ((mlen -= 2) >= 0) {
-			sum += *w++;
+		if (mlen > 1) {
+			sum += in_cksum_words((const uint8_t *)w, mlen & ~1);
+			w = (const uint16_t *)(const void *)((const uint8_t *)w + (mlen & ~1));
 		}
+		mlen = (mlen & 1) ? -1 : 0;
 		if (byte_swapped) {
 			REDUCE;
 			sum <<= 8;
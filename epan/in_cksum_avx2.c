@@ -0,0 +1,56 @@
+/* in_cksum_avx2.c
+ * Internet checksum routine using AVX2
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_AVX2
+
+#include <immintrin.h>
+
+#include "in_cksum-int.h"
+
+uint64_t
+in_cksum_avx2(const uint8_t *p, size_t len)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc0 = zero, acc1 = zero;
+	uint64_t lanes[4];
+
+	/*
+	 * Widen each 32-bit word to 64 bits and add it in; the order of
+	 * the words doesn't matter, so the in-lane unpacks are fine.
+	 */
+	for (; len != 0; p += 64, len -= 64) {
+		__m256i v0 = _mm256_loadu_si256((const __m256i *)(const void *)p);
+		__m256i v1 = _mm256_loadu_si256((const __m256i *)(const void *)(p + 32));
+
+		acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v0, zero));
+		acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v0, zero));
+		acc0 = _mm256_add_epi64(acc0, _mm256_unpacklo_epi32(v1, zero));
+		acc1 = _mm256_add_epi64(acc1, _mm256_unpackhi_epi32(v1, zero));
+	}
+	_mm256_storeu_si256((__m256i *)(void *)lanes, _mm256_add_epi64(acc0, acc1));
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+#endif /* HAVE_AVX2 */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 8
+ * tab-width: 8
+ * indent-tabs-mode: t
+ * End:
+ *
+ * vi: set shiftwidth=8 tabstop=8 noexpandtab:
+ * :indentSize=8:tabSize=8:noTabs=false:
+ */
@@ -35,6 +35,7 @@ static mmdb_lookup_t mmdb_not_found;
 #include <epan/addr_resolv.h>
 #include <epan/uat.h>
 #include <epan/prefs.h>
+#include <epan/mmdb_reader.h>
 
 #include <wsutil/report_message.h>
 #include <wsutil/file_util.h>
@@ -43,6 +44,10 @@ static mmdb_lookup_t mmdb_not_found;
 #include <wsutil/strtoi.h>
 #include <wsutil/glib-compat.h>
 
+// Databases are normally read in-process by mmdb_reader. If any of them
+// can't be, all lookups go through an mmdbresolve child process instead,
+// which uses libmaxminddb.
+
 // To do:
 // - Add RBL lookups? Along with the "is this a spammer" information that most RBL databases
 //   provide, you can also fetch AS information: https://www.team-cymru.com/IP-ASN-mapping.html
@@ -107,6 +112,15 @@ UAT_DIRECTORYNAME_CB_DEF(maxmind_mod, path, maxmind_db_path_t)
 
 static GPtrArray *mmdb_file_arr; // .mmdb files
 
+// In-process readers, one per file in mmdb_file_arr, or NULL.
+static GPtrArray *mmdb_readers; // mmdb_reader_t *
+
+// Results of in-process lookups, keyed by the entry found in each
+// database (an array of mmdb_readers->len uint32_t). Addresses in the
+// same networks share a result, which is decoded only once.
+static GHashTable *mmdb_entry_results; // g_allocated uint32_t * -> wmem allocated mmdb_lookup_t *
+static uint32_t *mmdb_entry_scratch;
+
 static bool resolve_synchronously;
 
 static void mmdb_resolve_stop(void);
@@ -160,6 +174,193 @@ static bool mmdbr_pipe_valid(void) {
     return pipe_valid;
 }
 
+static bool mmdb_resolve_running(void) {
+    return mmdb_readers != NULL || mmdbr_pipe_valid();
+}
+
+static unsigned mmdb_entries_hash(const void *key) {
+    const uint32_t *entries = (const uint32_t *)key;
+    unsigned hash = 0;
+
+    for (unsigned i = 0; i < mmdb_readers->len; i++) {
+        hash = hash * 31 + entries[i];
+    }
+    return hash;
+}
+
+static gboolean mmdb_entries_equal(const void *a, const void *b) {
+    return memcmp(a, b, mmdb_readers->len * sizeof(uint32_t)) == 0;
+}
+
+static void mmdb_readers_close(void) {
+    if (!mmdb_readers) {
+        return;
+    }
+    g_hash_table_destroy(mmdb_entry_results);
+    mmdb_entry_results = NULL;
+    g_free(mmdb_entry_scratch);
+    mmdb_entry_scratch = NULL;
+    for (unsigned i = 0; i < mmdb_readers->len; i++) {
+        mmdb_reader_close((mmdb_reader_t *)g_ptr_array_index(mmdb_readers, i));
+    }
+    g_ptr_array_free(mmdb_readers, true);
+    mmdb_readers = NULL;
+}
+
+/**
+ * Open all the databases in-process.
+ *
+ * @return false if any of them can't be read, in which case mmdbresolve
+ * should be used.
+ */
+static bool mmdb_readers_open(void) {
+    GPtrArray *readers = g_ptr_array_new();
+
+    for (unsigned i = 0; i < mmdb_file_arr->len; i++) {
+        const char *path = (const char *)g_ptr_array_index(mmdb_file_arr, i);
+        char *err_msg = NULL;
+        mmdb_reader_t *reader = mmdb_reader_open(path, &err_msg);
+
+        if (!reader) {
+            ws_debug("can't read %s in-process: %s", path, err_msg);
+            g_free(err_msg);
+            for (unsigned j = 0; j < readers->len; j++) {
+                mmdb_reader_close((mmdb_reader_t *)g_ptr_array_index(readers, j));
+            }
+            g_ptr_array_free(readers, true);
+            return false;
+        }
+        ws_debug("opened %s type %s", path, mmdb_reader_database_type(reader));
+        g_ptr_array_add(readers, reader);
+    }
+
+    mmdb_readers = readers;
+    mmdb_entry_results = g_hash_table_new_full(mmdb_entries_hash, mmdb_entries_equal, g_free, NULL);
+    mmdb_entry_scratch = g_new(uint32_t, readers->len);
+    return true;
+}
+
+static const char *mmdb_get_string(const mmdb_reader_t *reader, uint32_t entry, const char * const *path) {
+    mmdb_value_t value;
+
+    if (!mmdb_reader_get_value(reader, entry, path, &value) || value.type != MMDB_VALUE_STRING) {
+        return NULL;
+    }
+    char *str = g_strndup(value.value.string.str, value.value.string.len);
+    const char *chunk_string = chunkify_string(str);
+    g_free(str);
+    return chunk_string;
+}
+
+static bool mmdb_get_number(const mmdb_reader_t *reader, uint32_t entry, const char * const *path, double *number) {
+    mmdb_value_t value;
+
+    if (!mmdb_reader_get_value(reader, entry, path, &value)) {
+        return false;
+    }
+    switch (value.type) {
+        case MMDB_VALUE_DOUBLE:
+            *number = value.value.dbl;
+            return true;
+        case MMDB_VALUE_UINT:
+            *number = (double)value.value.uint;
+            return true;
+        case MMDB_VALUE_INT:
+            *number = value.value.sint;
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Same keys as mmdbresolve.
+static const char *co_iso_key[]     = {"country", "iso_code", NULL};
+static const char *co_name_key[]    = {"country", "names", "en", NULL};
+static const char *ci_name_key[]    = {"city", "names", "en", NULL};
+static const char *asn_o_key[]      = {"autonomous_system_organization", NULL};
+static const char *asn_key[]        = {"autonomous_system_number", NULL};
+static const char *l_lat_key[]      = {"location", "latitude", NULL};
+static const char *l_lon_key[]      = {"location", "longitude", NULL};
+static const char *l_accuracy_key[] = {"location", "accuracy_radius", NULL};
+
+/* Merge an entry into a result. Later databases override earlier ones. */
+static void mmdb_read_entry(const mmdb_reader_t *reader, uint32_t entry, mmdb_lookup_t *result) {
+    const char *str;
+    double number;
+
+    if ((str = mmdb_get_string(reader, entry, co_iso_key)) != NULL) {
+        result->found = true;
+        result->country_iso = str;
+    }
+    if ((str = mmdb_get_string(reader, entry, co_name_key)) != NULL) {
+        result->found = true;
+        result->country = str;
+    }
+    if ((str = mmdb_get_string(reader, entry, ci_name_key)) != NULL) {
+        result->found = true;
+        result->city = str;
+    }
+    if ((str = mmdb_get_string(reader, entry, asn_o_key)) != NULL) {
+        result->found = true;
+        result->as_org = str;
+    }
+    if (mmdb_get_number(reader, entry, asn_key, &number) && number >= 0 && number <= UINT32_MAX) {
+        result->found = true;
+        result->as_number = (uint32_t)number;
+    }
+    if (mmdb_get_number(reader, entry, l_lat_key, &number)) {
+        result->found = true;
+        result->latitude = number;
+    }
+    if (mmdb_get_number(reader, entry, l_lon_key, &number)) {
+        result->found = true;
+        result->longitude = number;
+    }
+    if (mmdb_get_number(reader, entry, l_accuracy_key, &number) && number >= 0 && number <= UINT16_MAX) {
+        result->found = true;
+        result->accuracy = (uint16_t)number;
+    }
+}
+
+/**
+ * Look up an address in the in-process databases. Exactly one of the
+ * addresses must be non-NULL.
+ */
+static const mmdb_lookup_t *mmdb_readers_lookup(const ws_in4_addr *ipv4_addr, const ws_in6_addr *ipv6_addr) {
+    uint32_t *entries = mmdb_entry_scratch;
+    bool found = false;
+    mmdb_lookup_t *result;
+
+    for (unsigned i = 0; i < mmdb_readers->len; i++) {
+        const mmdb_reader_t *reader = (const mmdb_reader_t *)g_ptr_array_index(mmdb_readers, i);
+
+        if (ipv4_addr) {
+            entries[i] = mmdb_reader_lookup_ipv4(reader, ipv4_addr);
+        } else {
+            entries[i] = mmdb_reader_lookup_ipv6(reader, ipv6_addr);
+        }
+        if (entries[i] != MMDB_READER_NOT_FOUND) {
+            found = true;
+        }
+    }
+    if (!found) {
+        return &mmdb_not_found;
+    }
+
+    result = (mmdb_lookup_t *) g_hash_table_lookup(mmdb_entry_results, entries);
+    if (!result) {
+        result = wmem_new(wmem_epan_scope(), mmdb_lookup_t);
+        init_lookup(result);
+        for (unsigned i = 0; i < mmdb_readers->len; i++) {
+            if (entries[i] != MMDB_READER_NOT_FOUND) {
+                mmdb_read_entry((const mmdb_reader_t *)g_ptr_array_index(mmdb_readers, i), entries[i], result);
+            }
+        }
+        g_hash_table_insert(mmdb_entry_results, g_memdup2(entries, mmdb_readers->len * sizeof(uint32_t)), result);
+    }
+    return result;
+}
+
 // Writing to mmdbr_pipe.stdin_fd can block. Do so in a separate thread.
 static void *
 write_mmdbr_stdin_worker(void *data _U_) {
@@ -373,6 +574,8 @@ static void mmdb_resolve_stop(void) {
     char *request;
     mmdb_response_t *response;
 
+    mmdb_readers_close();
+
     while (mmdbr_request_q && (request = (char *) g_async_queue_try_pop(mmdbr_request_q)) != NULL) {
         g_free(request);
     }
@@ -446,7 +649,8 @@ static void mmdb_resolve_stop(void) {
 }
 
 /**
- * Start an mmdbresolve process.
+ * Open the databases, or start an mmdbresolve process if we can't read
+ * them ourselves.
  */
 static void mmdb_resolve_start(void) {
     if (!mmdbr_request_q) {
@@ -485,6 +689,10 @@ static void mmdb_resolve_start(void) {
         return;
     }
 
+    if (mmdb_readers_open()) {
+        return;
+    }
+
     GPtrArray *args = g_ptr_array_new();
     char *mmdbresolve = get_executable_path("mmdbresolve");
     g_ptr_array_add(args, mmdbresolve);
@@ -657,11 +865,11 @@ void maxmind_db_pref_cleanup(void)
 void maxmind_db_pref_apply(void)
 {
     if (gbl_resolv_flags.maxmind_geoip) {
-        if (!mmdbr_pipe_valid()) {
+        if (!mmdb_resolve_running()) {
             mmdb_resolve_start();
         }
     } else {
-        if (mmdbr_pipe_valid()) {
+        if (mmdb_resolve_running()) {
             mmdb_resolve_stop();
         }
     }
@@ -743,6 +951,11 @@ maxmind_db_lookup_ipv4(const ws_in4_addr *addr) {
 
     mmdb_lookup_t *result = (mmdb_lookup_t *) wmem_map_lookup(mmdb_ipv4_map, GUINT_TO_POINTER(*addr));
 
+    if (!result && mmdb_readers) {
+        result = (mmdb_lookup_t *) mmdb_readers_lookup(addr, NULL);
+        wmem_map_insert(mmdb_ipv4_map, GUINT_TO_POINTER(*addr), result);
+    }
+
     if (!result) {
         result = &mmdb_not_found;
         wmem_map_insert(mmdb_ipv4_map, GUINT_TO_POINTER(*addr), result);
@@ -770,6 +983,11 @@ maxmind_db_lookup_ipv6(const ws_in6_addr *addr) {
 
     mmdb_lookup_t * result = (mmdb_lookup_t *) wmem_map_lookup(mmdb_ipv6_map, addr->bytes);
 
+    if (!result && mmdb_readers) {
+        result = (mmdb_lookup_t *) mmdb_readers_lookup(NULL, addr);
+        wmem_map_insert(mmdb_ipv6_map, chunkify_v6_addr(addr), result);
+    }
+
     if (!result) {
         result = &mmdb_not_found;
         wmem_map_insert(mmdb_ipv6_map, chunkify_v6_addr(addr), result);
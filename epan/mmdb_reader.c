@@ -0,0 +1,542 @@
+/* mmdb_reader.c
+ * Reader for MaxMind DB (.mmdb) files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include "mmdb_reader.h"
+
+#include <string.h>
+
+#include <wsutil/pint.h>
+
+/*
+ * A database is a binary search tree over the address bits, followed by
+ * a 16-byte separator, the data section and the metadata section. The
+ * metadata starts after the last occurrence of METADATA_MARKER, which is
+ * somewhere in the last 128 KiB of the file. Both sections use the same
+ * self-describing encoding, in which pointers are relative to the start
+ * of their section.
+ */
+
+static const uint8_t METADATA_MARKER[] = "\xAB\xCD\xEFMaxMind.com";
+#define METADATA_MARKER_LEN (sizeof(METADATA_MARKER) - 1)
+#define METADATA_MAX_SIZE   (128 * 1024)
+
+#define DATA_SEPARATOR_LEN  16
+
+/* Maps and arrays nested more deeply than this are treated as corrupt. */
+#define MAX_DEPTH           32
+
+enum {
+    TYPE_EXTENDED = 0,
+    TYPE_POINTER = 1,
+    TYPE_UTF8_STRING = 2,
+    TYPE_DOUBLE = 3,
+    TYPE_BYTES = 4,
+    TYPE_UINT16 = 5,
+    TYPE_UINT32 = 6,
+    TYPE_MAP = 7,
+    TYPE_INT32 = 8,
+    TYPE_UINT64 = 9,
+    TYPE_UINT128 = 10,
+    TYPE_ARRAY = 11,
+    TYPE_CONTAINER = 12,
+    TYPE_END_MARKER = 13,
+    TYPE_BOOLEAN = 14,
+    TYPE_FLOAT = 15,
+};
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t size;
+} mmdb_section_t;
+
+struct _mmdb_reader {
+    GMappedFile *mapped_file;
+    const uint8_t *tree;
+    uint32_t node_count;
+    unsigned record_size;       /* in bits: 24, 28 or 32 */
+    unsigned node_size;         /* in bytes */
+    unsigned ip_version;
+    uint32_t ipv4_start;        /* node of ::/96 in an IPv6 tree */
+    mmdb_section_t data;
+    mmdb_section_t metadata;
+    char *database_type;
+};
+
+/*
+ * Decode the control byte(s) of the field at *offset and advance *offset
+ * to its payload. For a pointer, *size is set to the target offset and
+ * *offset is advanced past the pointer.
+ */
+static bool
+read_control(const mmdb_section_t *sec, uint32_t *offset, unsigned *type, uint32_t *size)
+{
+    uint32_t off = *offset;
+    const uint8_t *p;
+    uint8_t ctrl;
+
+    if (off >= sec->size)
+        return false;
+    ctrl = sec->data[off++];
+    *type = ctrl >> 5;
+
+    if (*type == TYPE_POINTER) {
+        unsigned len = ((ctrl >> 3) & 0x3) + 1;
+        uint32_t val = ctrl & 0x7;
+
+        if (sec->size - off < len)
+            return false;
+        p = sec->data + off;
+        switch (len) {
+        case 1:
+            val = (val << 8) | p[0];
+            break;
+        case 2:
+            val = ((val << 16) | pntoh16(p)) + 2048;
+            break;
+        case 3:
+            val = ((val << 24) | pntoh24(p)) + 526336;
+            break;
+        default:
+            val = pntoh32(p);
+            break;
+        }
+        *offset = off + len;
+        *size = val;
+        return true;
+    }
+
+    if (*type == TYPE_EXTENDED) {
+        if (off >= sec->size)
+            return false;
+        *type = 7 + sec->data[off++];
+        if (*type <= TYPE_MAP)
+            return false;
+    }
+
+    *size = ctrl & 0x1f;
+    if (*size >= 29) {
+        unsigned len = *size - 28;
+
+        if (sec->size - off < len)
+            return false;
+        p = sec->data + off;
+        switch (len) {
+        case 1:
+            *size = 29 + p[0];
+            break;
+        case 2:
+            *size = 285 + pntoh16(p);
+            break;
+        default:
+            *size = 65821 + pntoh24(p);
+            break;
+        }
+        off += len;
+    }
+    *offset = off;
+    return true;
+}
+
+/*
+ * Decode the control byte(s) of the field at *offset, following a
+ * pointer, and set *offset to the payload.
+ */
+static bool
+read_field(const mmdb_section_t *sec, uint32_t *offset, unsigned *type, uint32_t *size)
+{
+    if (!read_control(sec, offset, type, size))
+        return false;
+    if (*type == TYPE_POINTER) {
+        /* A pointer to a pointer is invalid. */
+        *offset = *size;
+        if (!read_control(sec, offset, type, size) || *type == TYPE_POINTER)
+            return false;
+    }
+    return true;
+}
+
+/* Advance *offset past the field there, without following pointers. */
+static bool
+skip_field(const mmdb_section_t *sec, uint32_t *offset, unsigned depth)
+{
+    unsigned type;
+    uint32_t size;
+
+    if (depth > MAX_DEPTH || !read_control(sec, offset, &type, &size))
+        return false;
+
+    switch (type) {
+    case TYPE_POINTER:
+    case TYPE_BOOLEAN:
+        return true;
+    case TYPE_MAP:
+        for (uint32_t i = 0; i < size; i++) {
+            if (!skip_field(sec, offset, depth + 1) || !skip_field(sec, offset, depth + 1))
+                return false;
+        }
+        return true;
+    case TYPE_ARRAY:
+        for (uint32_t i = 0; i < size; i++) {
+            if (!skip_field(sec, offset, depth + 1))
+                return false;
+        }
+        return true;
+    default:
+        if (sec->size - *offset < size)
+            return false;
+        *offset += size;
+        return true;
+    }
+}
+
+/* Read a map key at *offset and advance *offset past it. */
+static bool
+read_key(const mmdb_section_t *sec, uint32_t *offset, const uint8_t **key, uint32_t *key_len)
+{
+    uint32_t off = *offset;
+    unsigned type;
+    uint32_t size;
+
+    if (!read_control(sec, &off, &type, &size))
+        return false;
+    if (type == TYPE_POINTER) {
+        *offset = off;
+        off = size;
+        if (!read_control(sec, &off, &type, &size))
+            return false;
+        if (type != TYPE_UTF8_STRING || sec->size - off < size)
+            return false;
+    } else {
+        if (type != TYPE_UTF8_STRING || sec->size - off < size)
+            return false;
+        *offset = off + size;
+    }
+    *key = sec->data + off;
+    *key_len = size;
+    return true;
+}
+
+/* Doubles and floats are stored as big-endian IEEE 754 values. */
+static double
+get_double(const uint8_t *p)
+{
+    uint64_t bits = pntoh64(p);
+    double val;
+
+    memcpy(&val, &bits, sizeof(val));
+    return val;
+}
+
+static double
+get_float(const uint8_t *p)
+{
+    uint32_t bits = pntoh32(p);
+    float val;
+
+    memcpy(&val, &bits, sizeof(val));
+    return val;
+}
+
+static bool
+section_get_value(const mmdb_section_t *sec, uint32_t offset,
+                  const char * const *path, mmdb_value_t *value)
+{
+    const uint8_t *p;
+    unsigned type;
+    uint32_t size;
+
+    for (; *path; path++) {
+        size_t path_len = strlen(*path);
+        const uint8_t *key;
+        uint32_t key_len;
+        uint32_t i;
+
+        if (!read_field(sec, &offset, &type, &size) || type != TYPE_MAP)
+            return false;
+        for (i = 0; i < size; i++) {
+            if (!read_key(sec, &offset, &key, &key_len))
+                return false;
+            if (key_len == path_len && memcmp(key, *path, path_len) == 0)
+                break;
+            if (!skip_field(sec, &offset, 0))
+                return false;
+        }
+        if (i == size)
+            return false;
+    }
+
+    if (!read_field(sec, &offset, &type, &size))
+        return false;
+    if (type != TYPE_BOOLEAN && sec->size - offset < size)
+        return false;
+    p = sec->data + offset;
+
+    switch (type) {
+    case TYPE_UTF8_STRING:
+        value->type = MMDB_VALUE_STRING;
+        value->value.string.str = (const char *)p;
+        value->value.string.len = size;
+        return true;
+    case TYPE_DOUBLE:
+        if (size != 8)
+            return false;
+        value->type = MMDB_VALUE_DOUBLE;
+        value->value.dbl = get_double(p);
+        return true;
+    case TYPE_FLOAT:
+        if (size != 4)
+            return false;
+        value->type = MMDB_VALUE_DOUBLE;
+        value->value.dbl = get_float(p);
+        return true;
+    case TYPE_UINT16:
+    case TYPE_UINT32:
+    case TYPE_UINT64:
+        if (size > 8)
+            return false;
+        value->type = MMDB_VALUE_UINT;
+        value->value.uint = 0;
+        for (uint32_t i = 0; i < size; i++)
+            value->value.uint = (value->value.uint << 8) | p[i];
+        return true;
+    case TYPE_INT32:
+    {
+        uint32_t val = 0;
+
+        if (size > 4)
+            return false;
+        for (uint32_t i = 0; i < size; i++)
+            val = (val << 8) | p[i];
+        /* Shorter values are zero-padded, not sign-extended. */
+        value->type = MMDB_VALUE_INT;
+        value->value.sint = (int32_t)val;
+        return true;
+    }
+    case TYPE_BOOLEAN:
+        if (size > 1)
+            return false;
+        value->type = MMDB_VALUE_BOOLEAN;
+        value->value.boolean = size != 0;
+        return true;
+    default:
+        return false;
+    }
+}
+
+static bool
+metadata_get_uint(const mmdb_reader_t *reader, const char *key, uint64_t *val)
+{
+    const char *path[] = { key, NULL };
+    mmdb_value_t value;
+
+    if (!section_get_value(&reader->metadata, 0, path, &value) || value.type != MMDB_VALUE_UINT)
+        return false;
+    *val = value.value.uint;
+    return true;
+}
+
+mmdb_reader_t *
+mmdb_reader_open(const char *path, char **err_msg)
+{
+    mmdb_reader_t *reader;
+    GError *gerr = NULL;
+    const uint8_t *file;
+    size_t file_len;
+    const uint8_t *marker = NULL;
+    const char *type_path[] = { "database_type", NULL };
+    mmdb_value_t type_value;
+    uint64_t version, node_count, record_size, ip_version;
+    size_t tree_size;
+
+    reader = g_new0(mmdb_reader_t, 1);
+    reader->mapped_file = g_mapped_file_new(path, false, &gerr);
+    if (reader->mapped_file == NULL) {
+        *err_msg = g_strdup(gerr->message);
+        g_error_free(gerr);
+        g_free(reader);
+        return NULL;
+    }
+    file = (const uint8_t *)g_mapped_file_get_contents(reader->mapped_file);
+    file_len = g_mapped_file_get_length(reader->mapped_file);
+    if (file_len > UINT32_MAX) {
+        *err_msg = g_strdup("file is too large");
+        goto fail;
+    }
+
+    /* Find the last metadata marker. */
+    if (file_len >= METADATA_MARKER_LEN) {
+        size_t start = file_len > METADATA_MAX_SIZE ? file_len - METADATA_MAX_SIZE : 0;
+
+        for (size_t off = file_len - METADATA_MARKER_LEN + 1; off-- > start; ) {
+            if (memcmp(file + off, METADATA_MARKER, METADATA_MARKER_LEN) == 0) {
+                marker = file + off;
+                break;
+            }
+        }
+    }
+    if (marker == NULL) {
+        *err_msg = g_strdup("metadata not found");
+        goto fail;
+    }
+    reader->metadata.data = marker + METADATA_MARKER_LEN;
+    reader->metadata.size = (uint32_t)(file + file_len - reader->metadata.data);
+
+    if (!metadata_get_uint(reader, "binary_format_major_version", &version) || version != 2) {
+        *err_msg = g_strdup("unsupported format version");
+        goto fail;
+    }
+    if (!metadata_get_uint(reader, "node_count", &node_count) ||
+            !metadata_get_uint(reader, "record_size", &record_size) ||
+            !metadata_get_uint(reader, "ip_version", &ip_version) ||
+            node_count == 0 || node_count >= UINT32_MAX ||
+            (record_size != 24 && record_size != 28 && record_size != 32) ||
+            (ip_version != 4 && ip_version != 6)) {
+        *err_msg = g_strdup("invalid metadata");
+        goto fail;
+    }
+    reader->node_count = (uint32_t)node_count;
+    reader->record_size = (unsigned)record_size;
+    reader->node_size = reader->record_size / 4;
+    reader->ip_version = (unsigned)ip_version;
+
+    tree_size = (size_t)reader->node_count * reader->node_size;
+    if (tree_size + DATA_SEPARATOR_LEN > (size_t)(marker - file)) {
+        *err_msg = g_strdup("search tree is truncated");
+        goto fail;
+    }
+    reader->tree = file;
+    reader->data.data = file + tree_size + DATA_SEPARATOR_LEN;
+    reader->data.size = (uint32_t)(marker - reader->data.data);
+
+    if (section_get_value(&reader->metadata, 0, type_path, &type_value) &&
+            type_value.type == MMDB_VALUE_STRING) {
+        reader->database_type = g_strndup(type_value.value.string.str, type_value.value.string.len);
+    } else {
+        reader->database_type = g_strdup("");
+    }
+
+    /* IPv4 addresses are looked up in ::/96 of an IPv6 tree. */
+    reader->ipv4_start = 0;
+    if (reader->ip_version == 6) {
+        for (unsigned i = 0; i < 96 && reader->ipv4_start < reader->node_count; i++) {
+            const uint8_t *p = reader->tree + (size_t)reader->ipv4_start * reader->node_size;
+
+            /* The left record is always first. */
+            switch (reader->record_size) {
+            case 24:
+                reader->ipv4_start = pntoh24(p);
+                break;
+            case 28:
+                reader->ipv4_start = ((uint32_t)(p[3] & 0xf0) << 20) | pntoh24(p);
+                break;
+            default:
+                reader->ipv4_start = pntoh32(p);
+                break;
+            }
+        }
+    }
+
+    return reader;
+
+fail:
+    g_mapped_file_unref(reader->mapped_file);
+    g_free(reader);
+    return NULL;
+}
+
+void
+mmdb_reader_close(mmdb_reader_t *reader)
+{
+    if (reader == NULL)
+        return;
+    g_mapped_file_unref(reader->mapped_file);
+    g_free(reader->database_type);
+    g_free(reader);
+}
+
+const char *
+mmdb_reader_database_type(const mmdb_reader_t *reader)
+{
+    return reader->database_type;
+}
+
+static inline uint32_t
+read_record(const mmdb_reader_t *reader, uint32_t node, unsigned bit)
+{
+    const uint8_t *p = reader->tree + (size_t)node * reader->node_size;
+
+    switch (reader->record_size) {
+    case 24:
+        return pntoh24(p + bit * 3);
+    case 28:
+        if (bit == 0)
+            return ((uint32_t)(p[3] & 0xf0) << 20) | pntoh24(p);
+        return ((uint32_t)(p[3] & 0x0f) << 24) | pntoh24(p + 4);
+    default:
+        return pntoh32(p + bit * 4);
+    }
+}
+
+static uint32_t
+tree_lookup(const mmdb_reader_t *reader, uint32_t node, const uint8_t *addr, unsigned bits)
+{
+    uint32_t offset;
+
+    for (unsigned i = 0; i < bits && node < reader->node_count; i++) {
+        node = read_record(reader, node, (addr[i >> 3] >> (7 - (i & 7))) & 1);
+    }
+
+    /* node_count means "no data"; smaller values mean the tree is
+     * deeper than the address, which a valid database never is. */
+    if (node <= reader->node_count)
+        return MMDB_READER_NOT_FOUND;
+    offset = node - reader->node_count;
+    if (offset < DATA_SEPARATOR_LEN || offset - DATA_SEPARATOR_LEN >= reader->data.size)
+        return MMDB_READER_NOT_FOUND;
+    return offset - DATA_SEPARATOR_LEN;
+}
+
+uint32_t
+mmdb_reader_lookup_ipv4(const mmdb_reader_t *reader, const ws_in4_addr *addr)
+{
+    return tree_lookup(reader, reader->ipv4_start, (const uint8_t *)addr, 32);
+}
+
+uint32_t
+mmdb_reader_lookup_ipv6(const mmdb_reader_t *reader, const ws_in6_addr *addr)
+{
+    if (reader->ip_version != 6)
+        return MMDB_READER_NOT_FOUND;
+    return tree_lookup(reader, 0, addr->bytes, 128);
+}
+
+bool
+mmdb_reader_get_value(const mmdb_reader_t *reader, uint32_t entry,
+                      const char * const *path, mmdb_value_t *value)
+{
+    if (entry == MMDB_READER_NOT_FOUND)
+        return false;
+    return section_get_value(&reader->data, entry, path, value);
+}
+
+/*
+ * Editor modelines
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * ex: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,108 @@
+/** @file
+ * Reader for MaxMind DB (.mmdb) files
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __MMDB_READER_H__
+#define __MMDB_READER_H__
+
+#include <wireshark.h>
+#include <wsutil/inet_addr.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * A minimal implementation of the MaxMind DB file format
+ * (https://maxmind.github.io/MaxMind-DB/), so that lookups can be done
+ * in-process on a memory-mapped file. libmaxminddb itself can't be
+ * linked into libwireshark because of its license.
+ */
+
+typedef struct _mmdb_reader mmdb_reader_t;
+
+/** Returned by the lookup functions if there is no entry for an address. */
+#define MMDB_READER_NOT_FOUND UINT32_MAX
+
+typedef enum {
+    MMDB_VALUE_STRING,
+    MMDB_VALUE_DOUBLE,
+    MMDB_VALUE_UINT,
+    MMDB_VALUE_INT,
+    MMDB_VALUE_BOOLEAN,
+} mmdb_value_type_t;
+
+typedef struct {
+    mmdb_value_type_t type;
+    union {
+        struct {
+            const char *str;    /**< Not NUL-terminated. */
+            size_t len;
+        } string;
+        double dbl;
+        uint64_t uint;
+        int32_t sint;
+        bool boolean;
+    } value;
+} mmdb_value_t;
+
+/**
+ * Map and validate a database file.
+ *
+ * @param path The file to open.
+ * @param[out] err_msg Set to a g_allocated error message on failure.
+ * @return The reader, or NULL on failure.
+ */
+WS_DLL_LOCAL mmdb_reader_t *mmdb_reader_open(const char *path, char **err_msg);
+
+WS_DLL_LOCAL void mmdb_reader_close(mmdb_reader_t *reader);
+
+/** The "database_type" metadata, e.g. "GeoLite2-City". */
+WS_DLL_LOCAL const char *mmdb_reader_database_type(const mmdb_reader_t *reader);
+
+/**
+ * Find the entry for an address.
+ *
+ * @return An entry handle for mmdb_reader_get_value(), or
+ * MMDB_READER_NOT_FOUND. Addresses in the same network share the
+ * same entry.
+ */
+WS_DLL_LOCAL uint32_t mmdb_reader_lookup_ipv4(const mmdb_reader_t *reader, const ws_in4_addr *addr);
+
+WS_DLL_LOCAL uint32_t mmdb_reader_lookup_ipv6(const mmdb_reader_t *reader, const ws_in6_addr *addr);
+
+/**
+ * Get a scalar value from an entry.
+ *
+ * @param entry An entry returned by one of the lookup functions.
+ * @param path NULL-terminated list of map keys, e.g. { "country", "iso_code", NULL }.
+ * @param[out] value The value. Strings point into the mapped file.
+ * @return false if the path doesn't exist or doesn't lead to a scalar value.
+ */
+WS_DLL_LOCAL bool mmdb_reader_get_value(const mmdb_reader_t *reader, uint32_t entry,
+                                        const char * const *path, mmdb_value_t *value);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __MMDB_READER_H__ */
+
+/*
+ * Editor modelines
+ *
+ * Local Variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * ex: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,345 @@
+/* mmdb_reader_test.c
+ * Tests for the MaxMind DB reader
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include <glib/gstdio.h>
+
+#include "mmdb_reader.h"
+
+/*
+ * The database is test/captures/maxmind-test.mmdb, written by
+ * test/util_make_mmdb.py. Its path is the first argument.
+ */
+static const char *mmdb_path;
+
+static mmdb_reader_t *
+open_test_db(void)
+{
+    mmdb_reader_t *reader;
+    char *err_msg = NULL;
+
+    reader = mmdb_reader_open(mmdb_path, &err_msg);
+    g_assert_null(err_msg);
+    g_assert_nonnull(reader);
+    return reader;
+}
+
+static void
+read_test_db(uint8_t **contents, size_t *len)
+{
+    GError *err = NULL;
+    char *buf;
+    gsize buf_len;
+
+    g_assert_true(g_file_get_contents(mmdb_path, &buf, &buf_len, &err));
+    g_assert_no_error(err);
+    *contents = (uint8_t *)buf;
+    *len = buf_len;
+}
+
+/* Offset of the last metadata marker in a database. */
+static size_t
+find_marker(const uint8_t *contents, size_t len)
+{
+    static const char marker[] = "\xAB\xCD\xEFMaxMind.com";
+
+    for (size_t off = len - (sizeof(marker) - 1) + 1; off-- > 0; ) {
+        if (memcmp(contents + off, marker, sizeof(marker) - 1) == 0)
+            return off;
+    }
+    g_assert_not_reached();
+}
+
+/* Write a database to a temporary file and check that it can't be opened. */
+static void
+check_open_fails(const uint8_t *contents, size_t len, const char *expected_err)
+{
+    GError *err = NULL;
+    char *path;
+    int fd;
+    mmdb_reader_t *reader;
+    char *err_msg = NULL;
+
+    fd = g_file_open_tmp("mmdb_reader_test-XXXXXX.mmdb", &path, &err);
+    g_assert_no_error(err);
+    g_close(fd, NULL);
+    g_assert_true(g_file_set_contents(path, (const char *)contents, len, &err));
+    g_assert_no_error(err);
+
+    reader = mmdb_reader_open(path, &err_msg);
+    g_assert_null(reader);
+    g_assert_cmpstr(err_msg, ==, expected_err);
+
+    g_free(err_msg);
+    g_unlink(path);
+    g_free(path);
+}
+
+static uint32_t
+lookup_ipv4(const mmdb_reader_t *reader, const char *addr_str)
+{
+    ws_in4_addr addr;
+
+    g_assert_true(ws_inet_pton4(addr_str, &addr));
+    return mmdb_reader_lookup_ipv4(reader, &addr);
+}
+
+static uint32_t
+lookup_ipv6(const mmdb_reader_t *reader, const char *addr_str)
+{
+    ws_in6_addr addr;
+
+    g_assert_true(ws_inet_pton6(addr_str, &addr));
+    return mmdb_reader_lookup_ipv6(reader, &addr);
+}
+
+#define check_string(reader, entry, path, expected) \
+    do { \
+        mmdb_value_t value_; \
+        g_assert_true(mmdb_reader_get_value(reader, entry, path, &value_)); \
+        g_assert_cmpint(value_.type, ==, MMDB_VALUE_STRING); \
+        g_assert_cmpmem(value_.value.string.str, value_.value.string.len, \
+                        expected, strlen(expected)); \
+    } while (0)
+
+static void
+test_mmdb_metadata(void)
+{
+    mmdb_reader_t *reader = open_test_db();
+
+    g_assert_cmpstr(mmdb_reader_database_type(reader), ==, "Wireshark-Test-City");
+    mmdb_reader_close(reader);
+}
+
+static void
+test_mmdb_ipv4(void)
+{
+    static const char *city_name[] = { "city", "names", "en", NULL };
+    static const char *geoname_id[] = { "city", "geoname_id", NULL };
+    static const char *accuracy[] = { "location", "accuracy_radius", NULL };
+    static const char *latitude[] = { "location", "latitude", NULL };
+    static const char *longitude[] = { "location", "longitude", NULL };
+    static const char *anycast[] = { "traits", "is_anycast", NULL };
+    static const char *asn[] = { "autonomous_system_number", NULL };
+    static const char *org[] = { "autonomous_system_organization", NULL };
+    mmdb_reader_t *reader = open_test_db();
+    mmdb_value_t value;
+    uint32_t entry;
+
+    entry = lookup_ipv4(reader, "10.1.2.3");
+    g_assert_cmpuint(entry, !=, MMDB_READER_NOT_FOUND);
+    check_string(reader, entry, city_name, "Springfield");
+    g_assert_true(mmdb_reader_get_value(reader, entry, geoname_id, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_UINT);
+    g_assert_cmpuint(value.value.uint, ==, 4951305);
+    g_assert_true(mmdb_reader_get_value(reader, entry, accuracy, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_UINT);
+    g_assert_cmpuint(value.value.uint, ==, 100);
+    g_assert_true(mmdb_reader_get_value(reader, entry, latitude, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_DOUBLE);
+    g_assert_cmpfloat(value.value.dbl, ==, 42.1);
+    g_assert_true(mmdb_reader_get_value(reader, entry, longitude, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_DOUBLE);
+    g_assert_cmpfloat(value.value.dbl, ==, -72.6);
+    g_assert_true(mmdb_reader_get_value(reader, entry, anycast, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_BOOLEAN);
+    g_assert_true(value.value.boolean);
+
+    /* Every address in the network has the same entry. */
+    g_assert_cmpuint(lookup_ipv4(reader, "10.255.255.255"), ==, entry);
+
+    entry = lookup_ipv4(reader, "192.0.2.200");
+    g_assert_cmpuint(entry, !=, MMDB_READER_NOT_FOUND);
+    g_assert_true(mmdb_reader_get_value(reader, entry, asn, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_UINT);
+    g_assert_cmpuint(value.value.uint, ==, 64500);
+    check_string(reader, entry, org, "Example AS");
+
+    mmdb_reader_close(reader);
+}
+
+static void
+test_mmdb_ipv6(void)
+{
+    static const char *city_name[] = { "city", "names", "en", NULL };
+    mmdb_reader_t *reader = open_test_db();
+    uint32_t entry;
+
+    entry = lookup_ipv6(reader, "2001:db8::1");
+    g_assert_cmpuint(entry, !=, MMDB_READER_NOT_FOUND);
+    check_string(reader, entry, city_name, "Documentation");
+    g_assert_cmpuint(lookup_ipv6(reader, "2001:db8:ffff:ffff::"), ==, entry);
+
+    /* IPv4 networks are in ::/96. */
+    g_assert_cmpuint(lookup_ipv6(reader, "::10.1.2.3"), ==, lookup_ipv4(reader, "10.1.2.3"));
+
+    mmdb_reader_close(reader);
+}
+
+static void
+test_mmdb_pointer(void)
+{
+    static const char *city_name[] = { "city", "names", "en", NULL };
+    static const char *iso_code[] = { "country", "iso_code", NULL };
+    static const char *country_de[] = { "country", "names", "de", NULL };
+    mmdb_reader_t *reader = open_test_db();
+    uint32_t entry;
+
+    /* "names" and "en" were written by the country map first, so here
+     * they are keys that are pointers. */
+    entry = lookup_ipv4(reader, "10.1.2.3");
+    check_string(reader, entry, city_name, "Springfield");
+
+    /* "country" is a pointer to a map shared by both entries. */
+    check_string(reader, entry, iso_code, "US");
+    check_string(reader, entry, country_de, "Vereinigte Staaten");
+    entry = lookup_ipv6(reader, "2001:db8::1");
+    check_string(reader, entry, iso_code, "US");
+
+    mmdb_reader_close(reader);
+}
+
+static void
+test_mmdb_missing(void)
+{
+    static const char *city_name[] = { "city", "names", "en", NULL };
+    static const char *city_fr[] = { "city", "names", "fr", NULL };
+    static const char *postal[] = { "postal", "code", NULL };
+    static const char *too_deep[] = { "city", "names", "en", "x", NULL };
+    static const char *array[] = { "traits", "offsets", NULL };
+    mmdb_reader_t *reader = open_test_db();
+    mmdb_value_t value;
+    uint32_t entry;
+
+    g_assert_cmpuint(lookup_ipv4(reader, "10.1.2.3"), !=, MMDB_READER_NOT_FOUND);
+    g_assert_cmpuint(lookup_ipv4(reader, "11.0.0.1"), ==, MMDB_READER_NOT_FOUND);
+    g_assert_cmpuint(lookup_ipv4(reader, "192.0.3.1"), ==, MMDB_READER_NOT_FOUND);
+    g_assert_cmpuint(lookup_ipv6(reader, "2001:db9::1"), ==, MMDB_READER_NOT_FOUND);
+    g_assert_cmpuint(lookup_ipv6(reader, "::1"), ==, MMDB_READER_NOT_FOUND);
+    g_assert_false(mmdb_reader_get_value(reader, MMDB_READER_NOT_FOUND, city_name, &value));
+
+    entry = lookup_ipv4(reader, "10.1.2.3");
+    g_assert_false(mmdb_reader_get_value(reader, entry, city_fr, &value));
+    g_assert_false(mmdb_reader_get_value(reader, entry, postal, &value));
+    g_assert_false(mmdb_reader_get_value(reader, entry, too_deep, &value));
+    /* Arrays aren't values. */
+    g_assert_false(mmdb_reader_get_value(reader, entry, array, &value));
+
+    mmdb_reader_close(reader);
+}
+
+static void
+test_mmdb_bad_pointer(void)
+{
+    static const char *asn[] = { "autonomous_system_number", NULL };
+    static const char *org[] = { "autonomous_system_organization", NULL };
+    mmdb_reader_t *reader = open_test_db();
+    mmdb_value_t value;
+    uint32_t entry;
+
+    /* The organization is a pointer past the end of the data section. */
+    entry = lookup_ipv4(reader, "198.51.100.1");
+    g_assert_cmpuint(entry, !=, MMDB_READER_NOT_FOUND);
+    g_assert_false(mmdb_reader_get_value(reader, entry, org, &value));
+    /* The field after it can still be read. */
+    g_assert_true(mmdb_reader_get_value(reader, entry, asn, &value));
+    g_assert_cmpint(value.type, ==, MMDB_VALUE_UINT);
+    g_assert_cmpuint(value.value.uint, ==, 64501);
+
+    /* The search tree record points past the end of the data section. */
+    g_assert_cmpuint(lookup_ipv4(reader, "203.0.113.1"), ==, MMDB_READER_NOT_FOUND);
+
+    mmdb_reader_close(reader);
+}
+
+static void
+test_mmdb_truncated(void)
+{
+    uint8_t *contents;
+    size_t len, marker;
+    GByteArray *bytes;
+
+    read_test_db(&contents, &len);
+    marker = find_marker(contents, len);
+
+    check_open_fails(contents, 0, "metadata not found");
+    check_open_fails(contents, 8, "metadata not found");
+    /* Cut in the data section, before the metadata. */
+    check_open_fails(contents, marker + 5, "metadata not found");
+    /* Cut in the metadata, before node_count. */
+    check_open_fails(contents, marker + 20, "unsupported format version");
+
+    /* The metadata is intact, but the search tree is shorter than
+     * node_count nodes. */
+    bytes = g_byte_array_new();
+    g_byte_array_append(bytes, contents, 24);
+    g_byte_array_append(bytes, contents + marker, (unsigned)(len - marker));
+    check_open_fails(bytes->data, bytes->len, "search tree is truncated");
+    g_byte_array_free(bytes, true);
+
+    g_free(contents);
+}
+
+static void
+test_mmdb_bad_marker(void)
+{
+    uint8_t *contents;
+    size_t len, marker;
+
+    read_test_db(&contents, &len);
+    marker = find_marker(contents, len);
+
+    contents[marker + 3] = 'm';
+    check_open_fails(contents, len, "metadata not found");
+    contents[marker + 3] = 'M';
+    contents[marker] = 0;
+    check_open_fails(contents, len, "metadata not found");
+
+    g_free(contents);
+}
+
+int
+main(int argc, char **argv)
+{
+    g_test_init(&argc, &argv, NULL);
+
+    if (argc != 2) {
+        g_printerr("Usage: %s [test options] <path to maxmind-test.mmdb>\n", g_get_prgname());
+        return 1;
+    }
+    mmdb_path = argv[1];
+
+    g_test_add_func("/mmdb_reader/metadata", test_mmdb_metadata);
+    g_test_add_func("/mmdb_reader/ipv4", test_mmdb_ipv4);
+    g_test_add_func("/mmdb_reader/ipv6", test_mmdb_ipv6);
+    g_test_add_func("/mmdb_reader/pointer", test_mmdb_pointer);
+    g_test_add_func("/mmdb_reader/missing", test_mmdb_missing);
+    g_test_add_func("/mmdb_reader/bad_pointer", test_mmdb_bad_pointer);
+    g_test_add_func("/mmdb_reader/truncated", test_mmdb_truncated);
+    g_test_add_func("/mmdb_reader/bad_marker", test_mmdb_bad_marker);
+
+    return g_test_run();
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
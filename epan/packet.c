@@ -41,6 +41,7 @@
 #include <epan/range.h>
 
 #include <wsutil/str_util.h>
+#include <wsutil/time_util.h>
 #include <wsutil/wslog.h>
 #include <wsutil/ws_assert.h>
 
@@ -170,6 +171,14 @@ static GHashTable *heur_dissector_lists;
 /* Name hashtables for fast detection of duplicate names */
 static GHashTable* heuristic_short_names;
 
+/* Dissector profiling and memory accounting; see call_dissector_instrumented() */
+static bool instrumented;			/* either of the following */
+static bool profile_enabled;
+static bool mem_accounting_enabled;
+static GHashTable *profile_entries;		/* name -> dissector_profile_entry_t */
+static GHashTable *profile_heur_entries;	/* short name -> dissector_profile_entry_t */
+static GHashTable *mem_owners;			/* name -> wmem_owner_t */
+
 static void
 destroy_heuristic_dissector_entry(void *data)
 {
@@ -290,6 +299,17 @@ packet_cleanup(void)
 	g_hash_table_destroy(depend_dissector_lists);
 	g_hash_table_destroy(heur_dissector_lists);
 	g_hash_table_destroy(heuristic_short_names);
+	if (profile_entries) {
+		g_hash_table_destroy(profile_entries);
+		g_hash_table_destroy(profile_heur_entries);
+		profile_entries = NULL;
+		profile_heur_entries = NULL;
+	}
+	if (mem_owners) {
+		/* The owners themselves belong to wmem. */
+		g_hash_table_destroy(mem_owners);
+		mem_owners = NULL;
+	}
 	g_slist_foreach(shutdown_routines, &call_routine, NULL);
 	g_slist_free(shutdown_routines);
 	if (postdissectors) {
@@ -528,10 +548,7 @@ mark_frame_as_depended_upon(frame_data *fd, uint32_t frame_num)
 		/* ws_assert(frame_num < fd->num) - we assume in several other
 		 * places in the code that frames don't depend on future
 		 * frames. */
-		if (fd->dependent_frames == NULL) {
-			fd->dependent_frames = g_hash_table_new(g_direct_hash, g_direct_equal);
-		}
-		g_hash_table_add(fd->dependent_frames, GUINT_TO_POINTER(frame_num));
+		frame_data_add_dependent_frame(fd, frame_num);
 	}
 }
 
@@ -803,6 +820,8 @@ struct dissector_handle {
 	} dissector_func;
 	void		*dissector_data;
 	protocol_t	*protocol;
+	dissector_profile_entry_t *profile;	/* set when first profiled */
+	wmem_owner_t	*mem_owner;		/* set when first accounted */
 };
 
 static void
@@ -857,6 +876,364 @@ remove_last_layer(packet_info *pinfo, bool reduce_count)
 }
 
 
+/*
+ * Dissector profiling.
+ *
+ * Each profiled call pushes a frame on profile_stack. When it returns,
+ * the time and wmem bytes of its subdissectors are subtracted to get
+ * its exclusive figures, and its inclusive figures are added to its
+ * caller's frame. Dissection is single-threaded, so static state is
+ * fine. The nested calls of a recursive dissector are counted more
+ * than once in its inclusive time.
+ */
+#define PROFILE_MAX_DEPTH 256
+
+typedef struct {
+	uint64_t start_ns;
+	uint64_t child_ns;
+	uint64_t start_bytes;
+	uint64_t child_bytes;
+} profile_frame_t;
+
+static profile_frame_t profile_stack[PROFILE_MAX_DEPTH];
+static unsigned profile_depth;
+/* Set while an exception unwinds, so that only the dissector that threw
+ * it counts it. */
+static bool profile_unwinding;
+
+static void
+profile_free_entry(void *data)
+{
+	dissector_profile_entry_t *entry = (dissector_profile_entry_t *)data;
+
+	g_free((char *)entry->name);
+	g_free(entry);
+}
+
+static dissector_profile_entry_t *
+profile_find_entry(GHashTable *entries, const char *name, bool heuristic)
+{
+	dissector_profile_entry_t *entry;
+
+	entry = (dissector_profile_entry_t *)g_hash_table_lookup(entries, name);
+	if (entry == NULL) {
+		entry = g_new0(dissector_profile_entry_t, 1);
+		entry->name = g_strdup(name);
+		entry->heuristic = heuristic;
+		g_hash_table_insert(entries, (void *)entry->name, entry);
+	}
+	return entry;
+}
+
+static dissector_profile_entry_t *
+profile_handle_entry(dissector_handle_t handle)
+{
+	const char *name = handle->name;
+
+	if (handle->profile == NULL) {
+		/* Unnamed handles with the same description (by default the
+		 * protocol short name) share an entry. */
+		if (name == NULL)
+			name = handle->description ? handle->description : "(unnamed)";
+		handle->profile = profile_find_entry(profile_entries, name, false);
+	}
+	return handle->profile;
+}
+
+static inline uint64_t
+profile_bytes(packet_info *pinfo)
+{
+	return wmem_bytes_requested(pinfo->pool) +
+	    wmem_bytes_requested(wmem_packet_scope()) +
+	    wmem_bytes_requested(wmem_file_scope());
+}
+
+static bool
+profile_begin(packet_info *pinfo)
+{
+	profile_frame_t *frame;
+
+	if (profile_depth == PROFILE_MAX_DEPTH)
+		return false;
+
+	profile_unwinding = false;
+	frame = &profile_stack[profile_depth++];
+	frame->child_ns = 0;
+	frame->child_bytes = 0;
+	frame->start_bytes = profile_bytes(pinfo);
+	frame->start_ns = ws_clock_get_monotonic_ns();
+	return true;
+}
+
+static void
+profile_end(packet_info *pinfo, dissector_profile_entry_t *entry, bool accepted, bool exception)
+{
+	uint64_t elapsed_ns = ws_clock_get_monotonic_ns();
+	profile_frame_t *frame = &profile_stack[--profile_depth];
+	uint64_t bytes = profile_bytes(pinfo) - frame->start_bytes;
+
+	elapsed_ns -= frame->start_ns;
+	entry->calls++;
+	if (accepted)
+		entry->accepted++;
+	if (exception && !profile_unwinding) {
+		entry->exceptions++;
+		profile_unwinding = true;
+	} else if (!exception) {
+		profile_unwinding = false;
+	}
+	entry->inclusive_ns += elapsed_ns;
+	entry->exclusive_ns += elapsed_ns - MIN(frame->child_ns, elapsed_ns);
+	entry->alloc_bytes += bytes - MIN(frame->child_bytes, bytes);
+
+	if (profile_depth > 0) {
+		profile_stack[profile_depth - 1].child_ns += elapsed_ns;
+		profile_stack[profile_depth - 1].child_bytes += bytes;
+	}
+}
+
+void
+dissector_profile_set_enabled(bool enabled)
+{
+	if (enabled && profile_entries == NULL) {
+		profile_entries = g_hash_table_new_full(g_str_hash, g_str_equal,
+				NULL, profile_free_entry);
+		profile_heur_entries = g_hash_table_new_full(g_str_hash, g_str_equal,
+				NULL, profile_free_entry);
+	}
+	/* Don't switch in the middle of a dissection. */
+	ws_assert(profile_depth == 0);
+	profile_enabled = enabled;
+	instrumented = profile_enabled || mem_accounting_enabled;
+}
+
+bool
+dissector_profile_is_enabled(void)
+{
+	return profile_enabled;
+}
+
+static void
+profile_reset_entry(void *key _U_, void *value, void *user_data _U_)
+{
+	dissector_profile_entry_t *entry = (dissector_profile_entry_t *)value;
+	const char *name = entry->name;
+	bool heuristic = entry->heuristic;
+
+	memset(entry, 0, sizeof(*entry));
+	entry->name = name;
+	entry->heuristic = heuristic;
+}
+
+void
+dissector_profile_reset(void)
+{
+	if (profile_entries == NULL)
+		return;
+
+	g_hash_table_foreach(profile_entries, profile_reset_entry, NULL);
+	g_hash_table_foreach(profile_heur_entries, profile_reset_entry, NULL);
+}
+
+static void
+profile_add_entry(void *key _U_, void *value, void *user_data)
+{
+	dissector_profile_entry_t *entry = (dissector_profile_entry_t *)value;
+
+	if (entry->calls > 0)
+		g_ptr_array_add((GPtrArray *)user_data, entry);
+}
+
+static int
+profile_compare_entries(const void *a, const void *b)
+{
+	const dissector_profile_entry_t *entry_a = *(const dissector_profile_entry_t * const *)a;
+	const dissector_profile_entry_t *entry_b = *(const dissector_profile_entry_t * const *)b;
+
+	if (entry_a->exclusive_ns != entry_b->exclusive_ns)
+		return entry_a->exclusive_ns < entry_b->exclusive_ns ? 1 : -1;
+	return strcmp(entry_a->name, entry_b->name);
+}
+
+GPtrArray *
+dissector_profile_get_entries(void)
+{
+	GPtrArray *entries = g_ptr_array_new();
+
+	if (profile_entries != NULL) {
+		g_hash_table_foreach(profile_entries, profile_add_entry, entries);
+		g_hash_table_foreach(profile_heur_entries, profile_add_entry, entries);
+		g_ptr_array_sort(entries, profile_compare_entries);
+	}
+	return entries;
+}
+
+static inline int
+call_dissector_func(dissector_handle_t handle, tvbuff_t *tvb,
+		    packet_info *pinfo, proto_tree *tree, void *data)
+{
+	int len;
+
+	switch (handle->dissector_type) {
+
+	case DISSECTOR_TYPE_SIMPLE:
+		len = (handle->dissector_func.dissector_type_simple)(tvb, pinfo, tree, data);
+		break;
+
+	case DISSECTOR_TYPE_CALLBACK:
+		len = (handle->dissector_func.dissector_type_callback)(tvb, pinfo, tree, data, handle->dissector_data);
+		break;
+
+	default:
+		ws_assert_not_reached();
+	}
+
+	return len;
+}
+
+/*
+ * Memory accounting. Allocations are counted for the protocol of the
+ * innermost dissector; see wsutil/wmem/wmem_accounting.h.
+ */
+static wmem_owner_t *
+mem_owner_find(const char *name)
+{
+	wmem_owner_t *owner;
+
+	owner = (wmem_owner_t *)g_hash_table_lookup(mem_owners, name);
+	if (owner == NULL) {
+		owner = wmem_owner_new(name);
+		g_hash_table_insert(mem_owners, (void *)owner->name, owner);
+	}
+	return owner;
+}
+
+static wmem_owner_t *
+mem_owner_handle(dissector_handle_t handle)
+{
+	const char *name;
+
+	if (handle->mem_owner == NULL) {
+		/* All handles of a protocol share its owner. */
+		if (handle->protocol != NULL)
+			name = proto_get_protocol_short_name(handle->protocol);
+		else
+			name = handle->name ? handle->name : "(unnamed)";
+		handle->mem_owner = mem_owner_find(name);
+	}
+	return handle->mem_owner;
+}
+
+static wmem_owner_t *
+mem_owner_heur(heur_dtbl_entry_t *hdtbl_entry)
+{
+	if (hdtbl_entry->protocol != NULL)
+		return mem_owner_find(proto_get_protocol_short_name(hdtbl_entry->protocol));
+	return mem_owner_find(hdtbl_entry->short_name);
+}
+
+void
+dissector_mem_accounting_set_sample_rate(unsigned sample_rate)
+{
+	if (sample_rate != 0 && mem_owners == NULL)
+		mem_owners = g_hash_table_new(g_str_hash, g_str_equal);
+	/* Don't switch in the middle of a dissection. */
+	ws_assert(profile_depth == 0);
+	mem_accounting_enabled = sample_rate != 0;
+	instrumented = profile_enabled || mem_accounting_enabled;
+	wmem_accounting_set_sample_rate(sample_rate);
+}
+
+unsigned
+dissector_mem_accounting_get_sample_rate(void)
+{
+	return mem_accounting_enabled ? wmem_accounting_get_sample_rate() : 0;
+}
+
+/*
+ * Call a dissector while it is profiled or its allocations are
+ * accounted for. Exceptions are caught only to undo our state on the
+ * way out; they are passed on.
+ */
+static int
+call_dissector_instrumented(dissector_handle_t handle, tvbuff_t *tvb,
+			    packet_info *pinfo, proto_tree *tree, void *data)
+{
+	dissector_profile_entry_t *entry = NULL;
+	wmem_owner_t *saved_owner = NULL;
+	bool profiled = false;
+	volatile int len = 0;
+
+	if (mem_accounting_enabled)
+		saved_owner = wmem_owner_set_current(mem_owner_handle(handle));
+	if (profile_enabled) {
+		entry = profile_handle_entry(handle);
+		profiled = profile_begin(pinfo);
+	}
+
+	TRY {
+		len = call_dissector_func(handle, tvb, pinfo, tree, data);
+	}
+	CATCH_ALL {
+		if (profiled)
+			profile_end(pinfo, entry, false, true);
+		if (mem_accounting_enabled)
+			wmem_owner_set_current(saved_owner);
+		RETHROW;
+	}
+	ENDTRY;
+
+	if (profiled)
+		profile_end(pinfo, entry, len != 0, false);
+	if (mem_accounting_enabled)
+		wmem_owner_set_current(saved_owner);
+	return len;
+}
+
+static bool
+call_heur_dissector_instrumented(heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb,
+				 packet_info *pinfo, proto_tree *tree, void *data)
+{
+	dissector_profile_entry_t *entry = NULL;
+	wmem_owner_t *saved_owner = NULL;
+	bool profiled = false;
+	volatile bool accepted = false;
+
+	if (mem_accounting_enabled)
+		saved_owner = wmem_owner_set_current(mem_owner_heur(hdtbl_entry));
+	if (profile_enabled) {
+		entry = profile_find_entry(profile_heur_entries, hdtbl_entry->short_name, true);
+		profiled = profile_begin(pinfo);
+	}
+
+	TRY {
+		accepted = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+	}
+	CATCH_ALL {
+		if (profiled)
+			profile_end(pinfo, entry, false, true);
+		if (mem_accounting_enabled)
+			wmem_owner_set_current(saved_owner);
+		RETHROW;
+	}
+	ENDTRY;
+
+	if (profiled)
+		profile_end(pinfo, entry, accepted, false);
+	if (mem_accounting_enabled)
+		wmem_owner_set_current(saved_owner);
+	return accepted;
+}
+
+static inline bool
+call_heur_dissector_func(heur_dtbl_entry_t *hdtbl_entry, tvbuff_t *tvb,
+			 packet_info *pinfo, proto_tree *tree, void *data)
+{
+	if (G_UNLIKELY(instrumented))
+		return call_heur_dissector_instrumented(hdtbl_entry, tvb, pinfo, tree, data);
+	return (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+}
+
 /* This function will return
  *   >0  this protocol was successfully dissected and this was this protocol.
  *   0   this packet did not match this protocol.
@@ -882,18 +1259,10 @@ call_dissector_through_handle(dissector_handle_t handle, tvbuff_t *tvb,
 			proto_get_protocol_short_name(handle->protocol);
 	}
 
-	switch (handle->dissector_type) {
-
-	case DISSECTOR_TYPE_SIMPLE:
-		len = (handle->dissector_func.dissector_type_simple)(tvb, pinfo, tree, data);
-		break;
-
-	case DISSECTOR_TYPE_CALLBACK:
-		len = (handle->dissector_func.dissector_type_callback)(tvb, pinfo, tree, data, handle->dissector_data);
-		break;
-
-	default:
-		ws_assert_not_reached();
+	if (G_UNLIKELY(instrumented)) {
+		len = call_dissector_instrumented(handle, tvb, pinfo, tree, data);
+	} else {
+		len = call_dissector_func(handle, tvb, pinfo, tree, data);
 	}
 	pinfo->current_proto = saved_proto;
 	pinfo->curr_proto_layer_num = saved_proto_layer_num;
@@ -3066,7 +3435,7 @@ dissector_try_heuristic(heur_dissector_list_t sub_dissectors, tvbuff_t *tvb,
 		pinfo->heur_list_name = hdtbl_entry->list_name;
 
 		saved_desegment_len = pinfo->desegment_len;
-		len = (hdtbl_entry->dissector)(tvb, pinfo, tree, data);
+		len = call_heur_dissector_func(hdtbl_entry, tvb, pinfo, tree, data);
 		consumed_none = len == 0 || (pinfo->desegment_len != saved_desegment_len && pinfo->desegment_offset == 0);
 		if (hdtbl_entry->protocol != NULL &&
 			(consumed_none || (tree && saved_tree_count == tree->tree_data->count))) {
@@ -3437,6 +3806,8 @@ new_dissector_handle(const int proto, const char *name, const char *description)
 	handle->description	= description;
 	handle->protocol	= find_protocol_by_id(proto);
 	handle->pref_suffix     = NULL;
+	handle->profile		= NULL;
+	handle->mem_owner	= NULL;
 
 	if (handle->description == NULL) {
 		/*
@@ -3714,7 +4085,7 @@ void call_heur_dissector_direct(heur_dtbl_entry_t *heur_dtbl_entry, tvbuff_t *tv
 	pinfo->heur_list_name = heur_dtbl_entry->list_name;
 
 	/* call the dissector, in case of failure call data handle (might happen with exported PDUs) */
-	if (!(*heur_dtbl_entry->dissector)(tvb, pinfo, tree, data)) {
+	if (!call_heur_dissector_func(heur_dtbl_entry, tvb, pinfo, tree, data)) {
 		/*
 		 * We added a protocol layer above. The dissector
 		 * didn't accept the packet or it didn't add any
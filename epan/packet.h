@@ -1032,6 +1032,49 @@ WS_DLL_PUBLIC void increment_dissection_depth(packet_info *pinfo);
 
 WS_DLL_PUBLIC void decrement_dissection_depth(packet_info *pinfo);
 
+/** Per-dissector profile counters. */
+typedef struct {
+	const char *name;          /**< Dissector name, or protocol short name for unnamed dissectors */
+	bool        heuristic;     /**< true for a heuristic dissector */
+	uint64_t    calls;         /**< Number of calls */
+	uint64_t    accepted;      /**< Calls that accepted the packet */
+	uint64_t    exceptions;    /**< Exceptions thrown from the dissector itself */
+	uint64_t    inclusive_ns;  /**< Time spent in the dissector and its subdissectors */
+	uint64_t    exclusive_ns;  /**< Time spent in the dissector itself */
+	uint64_t    alloc_bytes;   /**< wmem bytes allocated by the dissector itself */
+} dissector_profile_entry_t;
+
+/** Turn dissector profiling on or off.
+ * When on, every call to a dissector handle or heuristic dissector is
+ * timed and counted. Profiling is off by default and costs one branch
+ * per call then.
+ */
+WS_DLL_PUBLIC void dissector_profile_set_enabled(bool enabled);
+
+/** Return true if dissector profiling is on. */
+WS_DLL_PUBLIC bool dissector_profile_is_enabled(void);
+
+/** Clear all the profile counters. */
+WS_DLL_PUBLIC void dissector_profile_reset(void);
+
+/** Get the profile counters of the dissectors that have been called.
+ * @return An array of const dissector_profile_entry_t pointers, sorted by
+ * exclusive time, most expensive first. Free it with g_ptr_array_free().
+ * The entries stay valid until epan is cleaned up.
+ */
+WS_DLL_PUBLIC GPtrArray *dissector_profile_get_entries(void);
+
+/** Count wmem allocations in the epan, file and packet scopes for the
+ * protocol of the dissector that made them. The counts are kept by the
+ * wmem owners; see wsutil/wmem/wmem_accounting.h.
+ * @param sample_rate 0 to stop counting, 1 to count every allocation,
+ * or N to count one allocation in N.
+ */
+WS_DLL_PUBLIC void dissector_mem_accounting_set_sample_rate(unsigned sample_rate);
+
+/** @return The sample rate, 0 if allocations aren't being counted. */
+WS_DLL_PUBLIC unsigned dissector_mem_accounting_get_sample_rate(void);
+
 /** @} */
 
 #ifdef __cplusplus
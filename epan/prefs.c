@@ -2164,7 +2164,7 @@ pref_unstash(pref_t *pref, void *unstash_data_p)
             fdata = (frame_data*)elem->data;
             if (fdata->tcp_snd_manual_analysis != *pref->varp.enump) {
                 unstash_data->module->prefs_changed_flags |= prefs_get_effect_flags(pref);
-                fdata->tcp_snd_manual_analysis = *pref->varp.enump;
+                fdata->tcp_snd_manual_analysis = (unsigned)*pref->varp.enump;
             }
         }
         break;
@@ -3991,6 +3991,12 @@ prefs_register_modules(void)
             "When enabled, exact machine-readable byte counts are displayed. "
             "When disabled, human readable numbers with SI prefixes are displayed.",
             &prefs.conv_machine_readable);
+    prefs_register_uint_preference(conv_module, "top_items",
+            "Number of conversations or endpoints to keep when limited",
+            "The number of the heaviest conversations or endpoints to keep when "
+            "only the top ones are to be kept, which bounds the memory used for "
+            "captures with very many of them. Their counts are then approximate.",
+            10, &prefs.conv_top_items);
 
     /* Protocols */
     protocols_module = prefs_register_module(NULL, "protocols", "Protocols",
@@ -4042,6 +4048,22 @@ prefs_register_modules(void)
             "of cache entries to maintain. A 0 means no limit.",
             10, &prefs.ignore_dup_frames_cache_entries);
 
+    prefs_register_uint_preference(protocols_module, "reassembly_memory_limit",
+            "Memory limit for incomplete reassemblies (MiB)",
+            "The most memory, in MiB, that each reassembly table may use for "
+            "reassemblies that are still missing fragments. When a table goes over "
+            "the limit, the reassemblies that have waited longest for a fragment are "
+            "dropped. A 0 means no limit.",
+            10, &prefs.reassembly_memory_limit);
+
+    prefs_register_uint_preference(protocols_module, "uncompress_cache_limit",
+            "Memory for decompressed data (MiB)",
+            "The most memory, in MiB, used to keep data that dissectors such as "
+            "HTTP, HTTP/2 and gRPC have decompressed, so that it doesn't have to be "
+            "decompressed again when a packet is dissected again. "
+            "A 0 turns this off.",
+            10, &prefs.uncompress_cache_limit);
+
 
     /* Obsolete preferences
      * These "modules" were reorganized/renamed to correspond to their GUI
@@ -4499,6 +4521,7 @@ pre_init_prefs(void)
     prefs.st_sort_defdescending = true;
     prefs.st_sort_showfullname = false;
     prefs.conv_machine_readable = false;
+    prefs.conv_top_items = 1000;
 
     /* protocols */
     prefs.display_hidden_proto_items = false;
@@ -4506,6 +4529,8 @@ pre_init_prefs(void)
     prefs.display_abs_time_ascii = ABS_TIME_ASCII_TREE;
     prefs.ignore_dup_frames = false;
     prefs.ignore_dup_frames_cache_entries = 10000;
+    prefs.reassembly_memory_limit = 0;
+    prefs.uncompress_cache_limit = 64;
 
     /* set the default values for the io graph dialog */
     prefs.gui_io_graph_automatic_update = true;
@@ -245,6 +245,8 @@ typedef struct _e_prefs {
   int          conversation_deinterlacing_key;
   bool         ignore_dup_frames;
   unsigned     ignore_dup_frames_cache_entries;
+  unsigned     reassembly_memory_limit;
+  unsigned     uncompress_cache_limit;
   bool         filter_expressions_old;  /* true if old filter expressions preferences were loaded. */
   bool         cols_hide_new; /* true if the new (index-based) gui.column.hide preference was loaded. */
   bool         gui_update_enabled;
@@ -283,6 +285,7 @@ typedef struct _e_prefs {
   bool         st_sort_showfullname;
   int          st_format;
   bool         conv_machine_readable;
+  unsigned     conv_top_items;
   bool         extcap_save_on_start;
 } e_prefs;
 
@@ -14,6 +14,7 @@
 
 #include <epan/packet.h>
 #include <epan/exceptions.h>
+#include <epan/prefs.h>
 #include <epan/reassemble.h>
 #include <epan/tvbuff-int.h>
 
@@ -32,6 +33,66 @@ typedef struct _fragment_addresses_key {
 
 GList* reassembly_table_list;
 
+/*
+ * Fragment data is allocated with GLib rather than wmem, so count it
+ * here for the memory statistics, and stop counting it when it is freed.
+ */
+static wmem_owner_t *reassembly_owner;
+
+static inline void
+reassembly_account(size_t size)
+{
+	wmem_owner_add(reassembly_owner, WMEM_ACCOUNTING_FILE_SCOPE, size);
+}
+
+static inline void
+reassembly_unaccount(size_t size)
+{
+	wmem_owner_sub(reassembly_owner, WMEM_ACCOUNTING_FILE_SCOPE, size);
+}
+
+/*
+ * Free fragment data and stop counting it. Data that is chained to
+ * another tvb or handed to the caller stops being counted then instead.
+ */
+static void
+reassembly_tvb_free(tvbuff_t *tvb)
+{
+	reassembly_unaccount(tvb_captured_length(tvb));
+	tvb_free(tvb);
+}
+
+static void
+fragment_item_free(fragment_item *fd)
+{
+	g_slice_free(fragment_item, fd);
+	reassembly_unaccount(sizeof(fragment_item));
+}
+
+static void
+fragment_head_free(fragment_head *fd_head)
+{
+	g_slice_free(fragment_head, fd_head);
+	reassembly_unaccount(sizeof(fragment_head));
+}
+
+/*
+ * The number of incomplete reassemblies evicted in each frame, for
+ * reassembly_get_evictions(). Evictions are rare, so this is small.
+ */
+static wmem_map_t *evictions_by_frame;
+
+/*
+ * Stop counting a reassembly against its table's memory limit, because
+ * it is leaving the table of in-progress reassemblies or is complete.
+ */
+static inline void
+reassembly_uncharge(reassembly_table *table, fragment_head *fd_head)
+{
+	table->memory -= MIN(fd_head->memory, table->memory);
+	fd_head->memory = 0;
+}
+
 static unsigned
 fragment_addresses_hash(const void *k)
 {
@@ -335,16 +396,16 @@ free_all_fragments(void *key_arg _U_, void *value, void *user_data _U_)
 	if (fd_head != NULL) {
 		fd_i = fd_head->next;
 		if(fd_head->tvb_data && !(fd_head->flags&FD_SUBSET_TVB))
-			tvb_free(fd_head->tvb_data);
-		g_slice_free(fragment_head, fd_head);
+			reassembly_tvb_free(fd_head->tvb_data);
+		fragment_head_free(fd_head);
 	}
 
 	for (; fd_i != NULL; fd_i = tmp_fd) {
 		tmp_fd=fd_i->next;
 
 		if(fd_i->tvb_data && !(fd_i->flags&FD_SUBSET_TVB))
-			tvb_free(fd_i->tvb_data);
-		g_slice_free(fragment_item, fd_i);
+			reassembly_tvb_free(fd_i->tvb_data);
+		fragment_item_free(fd_i);
 	}
 
 	return TRUE;
@@ -359,6 +420,7 @@ static fragment_head *new_head(const uint32_t flags)
 	* even if we want to keep it sorted
 	*/
 	fd_head=g_slice_new0(fragment_head);
+	reassembly_account(sizeof(fragment_head));
 
 	fd_head->flags=flags;
 	return fd_head;
@@ -376,17 +438,17 @@ free_fd_head(fragment_head *fd_head)
 	if (fd_head->flags & FD_SUBSET_TVB)
 		fd_head->tvb_data = NULL;
 	if (fd_head->tvb_data)
-		tvb_free(fd_head->tvb_data);
+		reassembly_tvb_free(fd_head->tvb_data);
 	for (fd_i = fd_head->next; fd_i; fd_i = tmp) {
 		tmp = fd_i->next;
 		if (fd_i->flags & FD_SUBSET_TVB)
 			fd_i->tvb_data = NULL;
 		if (fd_i->tvb_data) {
-			tvb_free(fd_i->tvb_data);
+			reassembly_tvb_free(fd_i->tvb_data);
 		}
-		g_slice_free(fragment_item, fd_i);
+		fragment_item_free(fd_i);
 	}
-	g_slice_free(fragment_head, fd_head);
+	fragment_head_free(fd_head);
 }
 
 static void
@@ -414,6 +476,8 @@ reassembled_table_insert(GHashTable *reassembled_table, reassembled_key *key, fr
 			 */
 			if (old_fd_head->tvb_data && fd_head->tvb_data) {
 				/* Free it when the new tvb is freed */
+				if (!(old_fd_head->flags & FD_SUBSET_TVB))
+					reassembly_unaccount(tvb_captured_length(old_fd_head->tvb_data));
 				tvb_set_child_real_data_tvbuff(fd_head->tvb_data, old_fd_head->tvb_data);
 			}
 			/* XXX: Set the old data to NULL regardless. If we
@@ -470,6 +534,9 @@ reassembly_table_init(reassembly_table *table,
 		table->persistent_key_func = funcs->persistent_key_func;
 	if (table->free_temporary_key_func == NULL)
 		table->free_temporary_key_func = funcs->free_temporary_key_func;
+	table->memory = 0;
+	table->memory_floor = 0;
+	table->evicted = 0;
 	if (table->fragment_table != NULL) {
 		/*
 		 * The fragment hash table exists.
@@ -515,6 +582,8 @@ reassembly_table_destroy(reassembly_table *table)
 	table->temporary_key_func = NULL;
 	table->persistent_key_func = NULL;
 	table->free_temporary_key_func = NULL;
+	table->memory = 0;
+	table->memory_floor = 0;
 	if (table->fragment_table != NULL) {
 		/*
 		 * The fragment hash table exists.
@@ -596,6 +665,100 @@ insert_fd_head(reassembly_table *table, fragment_head *fd_head,
 	return key;
 }
 
+typedef struct {
+	void *key;
+	fragment_head *fd_head;
+} eviction_candidate_t;
+
+static int
+eviction_candidate_compare(const void *a, const void *b)
+{
+	const eviction_candidate_t *c1 = (const eviction_candidate_t *)a;
+	const eviction_candidate_t *c2 = (const eviction_candidate_t *)b;
+
+	if (c1->fd_head->frame < c2->fd_head->frame)
+		return -1;
+	return c1->fd_head->frame > c2->fd_head->frame;
+}
+
+/*
+ * If the incomplete reassemblies in a table hold more memory than the
+ * limit set in the preferences, evict the ones that have gone longest
+ * without a new fragment until the table is down to three quarters of
+ * the limit.
+ *
+ * This is called before a fragment is added, so that reassembly code
+ * doesn't hold pointers to anything freed here. The reassembly the new
+ * fragment belongs to, and any reassembly that got a fragment earlier
+ * in this frame, are left alone.
+ */
+static void
+reassembly_table_check_memory(reassembly_table *table, const packet_info *pinfo,
+			      const uint32_t id, const void *data)
+{
+	size_t limit = (size_t)prefs.reassembly_memory_limit * 1024 * 1024;
+	size_t low_water = limit / 4 * 3;
+	fragment_head *current;
+	GArray *candidates;
+	GHashTableIter iter;
+	void *key, *value;
+	unsigned evicted = 0;
+
+	if (limit == 0 || table->memory <= limit) {
+		table->memory_floor = 0;
+		return;
+	}
+	/* Don't look again for every fragment if nothing could be evicted. */
+	if (pinfo->fd->visited || table->memory <= table->memory_floor)
+		return;
+
+	current = lookup_fd_head(table, pinfo, id, data, NULL);
+
+	candidates = g_array_new(false, false, sizeof(eviction_candidate_t));
+	g_hash_table_iter_init(&iter, table->fragment_table);
+	while (g_hash_table_iter_next(&iter, &key, &value)) {
+		eviction_candidate_t candidate;
+
+		candidate.key = key;
+		candidate.fd_head = (fragment_head *)value;
+		if (candidate.fd_head == current || candidate.fd_head->memory == 0 ||
+		    candidate.fd_head->frame >= pinfo->num ||
+		    candidate.fd_head->ref_count != 0 ||
+		    (candidate.fd_head->flags & FD_DEFRAGMENTED))
+			continue;
+		g_array_append_val(candidates, candidate);
+	}
+	g_array_sort(candidates, eviction_candidate_compare);
+
+	for (unsigned i = 0; i < candidates->len && table->memory > low_water; i++) {
+		eviction_candidate_t *candidate = &g_array_index(candidates, eviction_candidate_t, i);
+
+		reassembly_uncharge(table, candidate->fd_head);
+		g_hash_table_remove(table->fragment_table, candidate->key);
+		free_all_fragments(NULL, candidate->fd_head, NULL);
+		evicted++;
+	}
+	g_array_free(candidates, true);
+
+	table->memory_floor = table->memory > low_water ? table->memory + limit / 4 : 0;
+
+	if (evicted != 0) {
+		table->evicted += evicted;
+		if (evictions_by_frame) {
+			evicted += GPOINTER_TO_UINT(wmem_map_lookup(evictions_by_frame, GUINT_TO_POINTER(pinfo->num)));
+			wmem_map_insert(evictions_by_frame, GUINT_TO_POINTER(pinfo->num), GUINT_TO_POINTER(evicted));
+		}
+	}
+}
+
+unsigned
+reassembly_get_evictions(const packet_info *pinfo)
+{
+	if (evictions_by_frame == NULL)
+		return 0;
+	return GPOINTER_TO_UINT(wmem_map_lookup(evictions_by_frame, GUINT_TO_POINTER(pinfo->num)));
+}
+
 /* This function cleans up the stored state and removes the reassembly data and
  * (with one exception) all allocated memory for matching reassembly.
  *
@@ -630,11 +793,15 @@ fragment_delete(reassembly_table *table, const packet_info *pinfo,
 		tmp_fd=fd->next;
 
 		if (fd->tvb_data && !(fd->flags & FD_SUBSET_TVB))
-			tvb_free(fd->tvb_data);
-		g_slice_free(fragment_item, fd);
+			reassembly_tvb_free(fd->tvb_data);
+		fragment_item_free(fd);
 		fd=tmp_fd;
 	}
-	g_slice_free(fragment_head, fd_head);
+	/* The caller frees the reassembled data. */
+	if (fd_tvb_data && !(fd_head->flags & FD_SUBSET_TVB))
+		reassembly_unaccount(tvb_captured_length(fd_tvb_data));
+	reassembly_uncharge(table, fd_head);
+	fragment_head_free(fd_head);
 	g_hash_table_remove(table->fragment_table, key);
 
 	return fd_tvb_data;
@@ -900,9 +1067,12 @@ fragment_truncate(reassembly_table *table, const packet_info *pinfo,
 	old_tvb_data=fd_head->tvb_data;
 	fd_head->tvb_data = tvb_clone_offset_len(old_tvb_data, 0, tot_len);
 	tvb_set_free_cb(fd_head->tvb_data, g_free);
+	reassembly_account(tot_len);
 
-	if (old_tvb_data)
+	if (old_tvb_data) {
+		reassembly_unaccount(tvb_captured_length(old_tvb_data));
 		tvb_add_to_chain(fd_head->tvb_data, old_tvb_data);
+	}
 	fd_head->datalen = tot_len;
 
 	/* Keep the fragments before the split point, dividing any if
@@ -930,7 +1100,7 @@ fragment_truncate(reassembly_table *table, const packet_info *pinfo,
 		if (fd_i->flags & FD_SUBSET_TVB)
 			fd_i->flags &= ~FD_SUBSET_TVB;
 		else if (fd_i->tvb_data)
-			tvb_free(fd_i->tvb_data);
+			reassembly_tvb_free(fd_i->tvb_data);
 
 		fd_i->tvb_data=NULL;
 	}
@@ -948,8 +1118,8 @@ fragment_truncate(reassembly_table *table, const packet_info *pinfo,
 		tmp_fd=fd_i->next;
 
 		if (fd_i->tvb_data && !(fd_i->flags & FD_SUBSET_TVB))
-			tvb_free(fd_i->tvb_data);
-		g_slice_free(fragment_item, fd_i);
+			reassembly_tvb_free(fd_i->tvb_data);
+		fragment_item_free(fd_i);
 	}
 }
 
@@ -1010,6 +1180,15 @@ fragment_set_partial_reassembly(reassembly_table *table,
 static void
 fragment_unhash(reassembly_table *table, void *key)
 {
+	fragment_head *fd_head;
+
+	/*
+	 * It no longer counts against the table's memory limit.
+	 */
+	fd_head = (fragment_head *)g_hash_table_lookup(table->fragment_table, key);
+	if (fd_head != NULL)
+		reassembly_uncharge(table, fd_head);
+
 	/*
 	 * Remove the entry from the fragment table.
 	 */
@@ -1208,6 +1387,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 
 	/* create new fd describing this fragment */
 	fd = g_slice_new(fragment_item);
+	reassembly_account(sizeof(fragment_item));
 	fd->next = NULL;
 	fd->flags = 0;
 	fd->frame = frag_frame;
@@ -1240,7 +1420,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 				 * we'll run past the end of a buffer sooner
 				 * or later).
 				 */
-				g_slice_free(fragment_item, fd);
+				fragment_item_free(fd);
 
 				/*
 				 * This is an attempt to add a fragment to a
@@ -1348,10 +1528,12 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	 * Save all payload in a buffer until we can defragment.
 	 */
 	if (!tvb_bytes_exist(tvb, offset, fd->len)) {
-		g_slice_free(fragment_item, fd);
+		fragment_item_free(fd);
 		THROW(BoundsError);
 	}
 	fd->tvb_data = tvb_clone_offset_len(tvb, offset, fd->len);
+	reassembly_account(fd->len);
+	fd_head->memory += sizeof(fragment_item) + fd->len;
 	LINK_FRAG(fd_head,fd);
 
 
@@ -1378,6 +1560,7 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 	/* store old data just in case */
 	old_tvb_data=fd_head->tvb_data;
 	data = (uint8_t *) g_malloc(fd_head->datalen);
+	reassembly_account(fd_head->datalen);
 	fd_head->tvb_data = tvb_new_real_data(data, fd_head->datalen, fd_head->datalen);
 	tvb_set_free_cb(fd_head->tvb_data, g_free);
 
@@ -1497,14 +1680,17 @@ fragment_add_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 			if (fd_i->flags & FD_SUBSET_TVB)
 				fd_i->flags &= ~FD_SUBSET_TVB;
 			else if (fd_i->tvb_data)
-				tvb_free(fd_i->tvb_data);
+				reassembly_tvb_free(fd_i->tvb_data);
 
 			fd_i->tvb_data=NULL;
 		}
 	}
 
-	if (old_tvb_data)
+	if (old_tvb_data) {
+		/* It is freed with the packet's tvb. */
+		reassembly_unaccount(tvb_captured_length(old_tvb_data));
 		tvb_add_to_chain(tvb, old_tvb_data);
+	}
 	/* mark this packet as defragmented.
 	   allows us to skip any trailing fragments */
 	fd_head->flags |= FD_DEFRAGMENTED;
@@ -1530,6 +1716,8 @@ fragment_add_common(reassembly_table *table, tvbuff_t *tvb, const int offset,
 	fragment_head *fd_head;
 	fragment_item *fd_item;
 	bool already_added;
+	bool complete;
+	size_t memory;
 
 
 	/*
@@ -1541,6 +1729,8 @@ fragment_add_common(reassembly_table *table, tvbuff_t *tvb, const int offset,
 	 */
 	DISSECTOR_ASSERT(tvb_bytes_exist(tvb, offset, frag_data_len));
 
+	reassembly_table_check_memory(table, pinfo, id, data);
+
 	fd_head = lookup_fd_head(table, pinfo, id, data, NULL);
 
 #if 0
@@ -1696,11 +1886,15 @@ fragment_add_common(reassembly_table *table, tvbuff_t *tvb, const int offset,
 		insert_fd_head(table, fd_head, pinfo, id, data);
 	}
 
-	if (fragment_add_work(fd_head, tvb, offset, pinfo, frag_offset,
-		frag_data_len, more_frags, frag_frame, false)) {
+	memory = fd_head->memory;
+	complete = fragment_add_work(fd_head, tvb, offset, pinfo, frag_offset,
+		frag_data_len, more_frags, frag_frame, false);
+	table->memory += fd_head->memory - memory;
+	if (complete) {
 		/*
 		 * Reassembly is complete.
 		 */
+		reassembly_uncharge(table, fd_head);
 		return fd_head;
 	} else {
 		/*
@@ -1768,6 +1962,8 @@ fragment_add_check_with_fallback(reassembly_table *table, tvbuff_t *tvb, const i
 	fragment_head *fd_head;
 	void *orig_key;
 	bool late_retransmission = false;
+	bool complete;
+	size_t memory;
 
 	/*
 	 * If this isn't the first pass, look for this frame in the table
@@ -1779,6 +1975,8 @@ fragment_add_check_with_fallback(reassembly_table *table, tvbuff_t *tvb, const i
 		return (fragment_head *)g_hash_table_lookup(table->reassembled_table, &reass_key);
 	}
 
+	reassembly_table_check_memory(table, pinfo, id, data);
+
 	/* Looks up a key in the GHashTable, returning the original key and the associated value
 	 * and a bool which is true if the key was found. This is useful if you need to free
 	 * the memory allocated for the original key, for example before calling g_hash_table_remove()
@@ -1818,8 +2016,13 @@ fragment_add_check_with_fallback(reassembly_table *table, tvbuff_t *tvb, const i
 		return NULL;
 	}
 
-	if (fragment_add_work(fd_head, tvb, offset, pinfo, frag_offset,
-		frag_data_len, more_frags, pinfo->num, late_retransmission)) {
+	memory = fd_head->memory;
+	complete = fragment_add_work(fd_head, tvb, offset, pinfo, frag_offset,
+		frag_data_len, more_frags, pinfo->num, late_retransmission);
+	/* A late retransmission isn't in the table of in-progress reassemblies */
+	if (!late_retransmission)
+		table->memory += fd_head->memory - memory;
+	if (complete) {
 		/* Nothing left to do if it was a late retransmission */
 		if (late_retransmission) {
 			return fd_head;
@@ -1879,6 +2082,7 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 	/* store old data in case the fd_i->data pointers refer to it */
 	old_tvb_data=fd_head->tvb_data;
 	data = (uint8_t *) g_malloc(size);
+	reassembly_account(size);
 	fd_head->tvb_data = tvb_new_real_data(data, size, size);
 	tvb_set_free_cb(fd_head->tvb_data, g_free);
 	fd_head->len = size;		/* record size for caller	*/
@@ -1910,11 +2114,11 @@ fragment_defragment_and_free (fragment_head *fd_head, const packet_info *pinfo)
 		if (fd_i->flags & FD_SUBSET_TVB)
 			fd_i->flags &= ~FD_SUBSET_TVB;
 		else if (fd_i->tvb_data)
-			tvb_free(fd_i->tvb_data);
+			reassembly_tvb_free(fd_i->tvb_data);
 		fd_i->tvb_data=NULL;
 	}
 	if (old_tvb_data)
-		tvb_free(old_tvb_data);
+		reassembly_tvb_free(old_tvb_data);
 
 	/* mark this packet as defragmented.
 	 * allows us to skip any trailing fragments.
@@ -1985,6 +2189,7 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 
 	/* create new fd describing this fragment */
 	fd = g_slice_new(fragment_item);
+	reassembly_account(sizeof(fragment_item));
 	fd->next = NULL;
 	fd->flags = 0;
 	fd->frame = pinfo->num;
@@ -2120,11 +2325,13 @@ fragment_add_seq_work(fragment_head *fd_head, tvbuff_t *tvb, const int offset,
 		if (!tvb_bytes_exist(tvb, offset, fd->len)) {
 			/* abort if we didn't capture the entire fragment due
 			 * to a too-short snapshot length */
-			g_slice_free(fragment_item, fd);
+			fragment_item_free(fd);
 			return false;
 		}
 
 		fd->tvb_data = tvb_clone_offset_len(tvb, offset, fd->len);
+		reassembly_account(fd->len);
+		fd_head->memory += sizeof(fragment_item) + fd->len;
 	}
 	LINK_FRAG(fd_head,fd);
 
@@ -2193,6 +2400,10 @@ fragment_add_seq_common(reassembly_table *table, tvbuff_t *tvb,
 {
 	fragment_head *fd_head;
 	void *orig_key;
+	bool complete;
+	size_t memory;
+
+	reassembly_table_check_memory(table, pinfo, id, data);
 
 	fd_head = lookup_fd_head(table, pinfo, id, data, &orig_key);
 
@@ -2270,11 +2481,15 @@ fragment_add_seq_common(reassembly_table *table, tvbuff_t *tvb,
 		}
 	}
 
-	if (fragment_add_seq_work(fd_head, tvb, offset, pinfo,
-				  frag_number, frag_data_len, more_frags)) {
+	memory = fd_head->memory;
+	complete = fragment_add_seq_work(fd_head, tvb, offset, pinfo,
+				  frag_number, frag_data_len, more_frags);
+	table->memory += fd_head->memory - memory;
+	if (complete) {
 		/*
 		 * Reassembly is complete.
 		 */
+		reassembly_uncharge(table, fd_head);
 		return fd_head;
 	} else {
 		/*
@@ -2475,6 +2690,13 @@ fragment_add_seq_single_move(reassembly_table *table, const packet_info *pinfo,
 			}
 			/* Now remove and delete */
 			new_fh->next = NULL;
+			if (fh->flags & FD_DEFRAGMENTED) {
+				/* A completed reassembly isn't charged. */
+				table->memory -= MIN(new_fh->memory, table->memory);
+			} else {
+				fh->memory += new_fh->memory;
+			}
+			new_fh->memory = 0;
 			old_tvb_data = fragment_delete(table, pinfo, id+offset, data);
 			if (old_tvb_data)
 				tvb_free(old_tvb_data);
@@ -2644,8 +2866,8 @@ fragment_add_seq_single_work(reassembly_table *table, tvbuff_t *tvb,
 				tmp_fd=fd->next;
 
 				if (fd->tvb_data && !(fd->flags & FD_SUBSET_TVB))
-					tvb_free(fd->tvb_data);
-				g_slice_free(fragment_item, fd);
+					reassembly_tvb_free(fd->tvb_data);
+				fragment_item_free(fd);
 				fd=tmp_fd;
 			}
 		}
@@ -2763,6 +2985,7 @@ fragment_start_seq_check(reassembly_table *table, const packet_info *pinfo,
 	if (fd_head == NULL) {
 		/* Create list-head. */
 		fd_head = g_slice_new(fragment_head);
+		reassembly_account(sizeof(fragment_head));
 		fd_head->next = NULL;
 		fd_head->first_gap = NULL;
 		fd_head->contiguous_len = 0;
@@ -2775,6 +2998,7 @@ fragment_start_seq_check(reassembly_table *table, const packet_info *pinfo,
 		fd_head->flags = FD_BLOCKSEQUENCE|FD_DATALEN_SET;
 		fd_head->tvb_data = NULL;
 		fd_head->error = NULL;
+		fd_head->memory = 0;
 
 		insert_fd_head(table, fd_head, pinfo, id, data);
 	}
@@ -3155,6 +3379,7 @@ reassembly_table_init_reg_table(void *p, void *user_data _U_)
 static void
 reassembly_table_init_reg_tables(void)
 {
+	evictions_by_frame = wmem_map_new(wmem_file_scope(), g_direct_hash, g_direct_equal);
 	g_list_foreach(reassembly_table_list, reassembly_table_init_reg_table, NULL);
 }
 
@@ -3168,11 +3393,13 @@ reassembly_table_cleanup_reg_table(void *p, void *user_data _U_)
 static void
 reassembly_table_cleanup_reg_tables(void)
 {
+	evictions_by_frame = NULL;
 	g_list_foreach(reassembly_table_list, reassembly_table_cleanup_reg_table, NULL);
 }
 
 void reassembly_tables_init(void)
 {
+	reassembly_owner = wmem_owner_new("Reassembly");
 	register_init_routine(&reassembly_table_init_reg_tables);
 	register_cleanup_routine(&reassembly_table_cleanup_reg_tables);
 }
@@ -3192,6 +3419,66 @@ reassembly_table_cleanup(void)
 	g_list_free(reassembly_table_list);
 }
 
+typedef struct {
+	reassembly_table *table;
+	uint32_t before_frame;
+} expire_info_t;
+
+/*
+ * For a fragment hash table entry, free the fragments if none has been
+ * added since before the given frame. A reassembly without fragments
+ * has no frame number to go by, so it's kept.
+ */
+static gboolean
+expire_fragments(void *key_arg, void *value, void *user_data)
+{
+	fragment_head *fd_head = (fragment_head *)value;
+	expire_info_t *info = (expire_info_t *)user_data;
+
+	if (fd_head->next == NULL || fd_head->frame >= info->before_frame)
+		return FALSE;
+
+	reassembly_uncharge(info->table, fd_head);
+
+	/*
+	 * If it's in the reassembled table as well, it's freed
+	 * when the last reference there is dropped.
+	 */
+	if (fd_head->ref_count == 0)
+		free_all_fragments(key_arg, value, NULL);
+	return TRUE;
+}
+
+static gboolean
+expire_reassembled(void *key_arg, void *value _U_, void *user_data)
+{
+	const reassembled_key *key = (const reassembled_key *)key_arg;
+	const expire_info_t *info = (const expire_info_t *)user_data;
+
+	return key->frame < info->before_frame;
+}
+
+unsigned
+reassembly_tables_expire(const uint32_t before_frame)
+{
+	unsigned expired = 0;
+	expire_info_t info;
+
+	info.before_frame = before_frame;
+	for (GList *l = reassembly_table_list; l; l = l->next) {
+		info.table = ((register_reassembly_table_t *)l->data)->table;
+
+		if (info.table->fragment_table != NULL)
+			expired += g_hash_table_foreach_remove(info.table->fragment_table,
+							       expire_fragments, &info);
+		if (info.table->reassembled_table != NULL)
+			g_hash_table_foreach_remove(info.table->reassembled_table,
+						    expire_reassembled, &info);
+	}
+
+	return expired;
+}
+
 /* One instance of this structure is created for each pdu that spans across
  * multiple segments. (MSP) */
 typedef struct _multisegment_pdu_t {
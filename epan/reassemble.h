@@ -95,6 +95,8 @@ typedef struct _fragment_head {
 	 * an error, in which case it's the string for the error.
 	 */
 	const char *error;
+	size_t memory;			/**< bytes of fragment data counted against the
+					 * table's memory limit while incomplete */
 } fragment_head;
 
 /*
@@ -141,6 +143,9 @@ typedef struct {
 	fragment_temporary_key temporary_key_func;
 	fragment_persistent_key persistent_key_func;
 	GDestroyNotify free_temporary_key_func;		/* temporary key destruction function */
+	size_t memory;					/* bytes held by incomplete reassemblies */
+	size_t memory_floor;				/* don't look for reassemblies to evict below this */
+	unsigned evicted;				/* incomplete reassemblies evicted so far */
 } reassembly_table;
 
 /*
@@ -555,13 +560,31 @@ show_fragment_seq_tree(fragment_head *ipfd_head, const fragment_items *fit,
 
 /* Initialize internal structures
  */
-extern void reassembly_tables_init(void);
+WS_DLL_PUBLIC void reassembly_tables_init(void);
 
 /* Cleanup internal structures
  */
 extern void
 reassembly_table_cleanup(void);
 
+/*
+ * Free the reassemblies in all registered tables that haven't had a
+ * fragment added since before the given frame, and forget the completed
+ * reassemblies for those frames. Only for single-pass dissection, where
+ * earlier frames are never looked at again. Returns the number of
+ * reassemblies that were dropped before they were complete.
+ */
+WS_DLL_PUBLIC unsigned
+reassembly_tables_expire(const uint32_t before_frame);
+
+/*
+ * The number of incomplete reassemblies that were evicted while the
+ * frame was first dissected, because a table went over the memory
+ * limit set with the "protocols.reassembly_memory_limit" preference.
+ */
+WS_DLL_PUBLIC unsigned
+reassembly_get_evictions(const packet_info *pinfo);
+
 /* ===================== Streaming data reassembly helper ===================== */
 /**
  * Macro to help to define ett or hf items variables for reassembly (especially for streaming reassembly).
@@ -38,9 +38,11 @@
 
 #include <epan/packet.h>
 #include <epan/packet_info.h>
+#include <epan/prefs.h>
 #include <epan/proto.h>
 #include <epan/tvbuff.h>
 #include <epan/reassemble.h>
+#include <epan/wmem_scopes.h>
 
 #include "exceptions.h"
 
@@ -3203,6 +3205,83 @@ test_fragment_add_check_duplicate_conflict(void)
         print_fragment_table();
     }
 }
+
+/* Bytes of fragment data counted for the "Reassembly" wmem owner. */
+static uint64_t
+reassembly_owner_bytes(void)
+{
+    for (unsigned i = 0; i < wmem_owner_count(); i++) {
+        wmem_owner_t *owner = wmem_owner_get(i);
+
+        if (strcmp(owner->name, "Reassembly") == 0)
+            return owner->bytes[WMEM_ACCOUNTING_FILE_SCOPE];
+    }
+    return 0;
+}
+
+/**********************************************************************************
+ *
+ * fragment_add_check with a memory limit
+ *
+ *********************************************************************************/
+
+#define BIG_DATA_LEN (64*1024)
+#define BIG_REASSEMBLIES 20
+
+/* Starts 20 reassemblies of 64 KiB each, one per frame, with a limit of
+ * 1 MiB. The oldest ones are evicted to keep the table under the limit.
+ * When the others are completed or deleted, nothing is counted any more.
+ */
+static void
+test_fragment_add_check_memory_limit(void)
+{
+    fragment_head *fd_head;
+    uint8_t *big_data;
+    tvbuff_t *big_tvb;
+    unsigned old_limit = prefs.reassembly_memory_limit;
+    uint32_t id;
+
+    printf("Starting test test_fragment_add_check_memory_limit\n");
+
+    big_data = (uint8_t *)g_malloc0(BIG_DATA_LEN);
+    big_tvb = tvb_new_real_data(big_data, BIG_DATA_LEN, BIG_DATA_LEN);
+    prefs.reassembly_memory_limit = 1;
+
+    for (id = 1; id <= BIG_REASSEMBLIES; id++) {
+        pinfo.num = id;
+        fd_head=fragment_add_check(&test_reassembly_table, big_tvb, 0, &pinfo, id,
+                                   NULL, 0, BIG_DATA_LEN, true);
+        ASSERT_EQ_POINTER(NULL,fd_head);
+    }
+
+    /* The oldest reassemblies are gone, the newest ones are still there. */
+    ASSERT(test_reassembly_table.memory <= 1024*1024);
+    ASSERT(test_reassembly_table.evicted > 0);
+    ASSERT_EQ(BIG_REASSEMBLIES - test_reassembly_table.evicted,
+              g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ_POINTER(NULL,fragment_get(&test_reassembly_table, &pinfo, 1, NULL));
+    ASSERT_NE_POINTER(NULL,fragment_get(&test_reassembly_table, &pinfo, BIG_REASSEMBLIES, NULL));
+    ASSERT(reassembly_owner_bytes() >= test_reassembly_table.memory);
+
+    /* Complete the newest one, which is no longer counted against the
+     * limit, and delete the others. */
+    pinfo.num = BIG_REASSEMBLIES + 1;
+    fd_head=fragment_add_check(&test_reassembly_table, tvb, 0, &pinfo, BIG_REASSEMBLIES,
+                               NULL, BIG_DATA_LEN, 10, false);
+    ASSERT_NE_POINTER(NULL,fd_head);
+    ASSERT_EQ(BIG_DATA_LEN + 10,fd_head->datalen);
+
+    for (id = 1; id < BIG_REASSEMBLIES; id++) {
+        ASSERT_EQ_POINTER(NULL,fragment_delete(&test_reassembly_table, &pinfo, id, NULL));
+    }
+    ASSERT_EQ(0,g_hash_table_size(test_reassembly_table.fragment_table));
+    ASSERT_EQ(0,test_reassembly_table.memory);
+
+    prefs.reassembly_memory_limit = old_limit;
+    tvb_free(big_tvb);
+    g_free(big_data);
+}
+
 /**********************************************************************************
  *
  * main
@@ -3251,6 +3330,7 @@ main(int argc _U_, char **argv _U_)
         test_fragment_add_check_duplicate_last,
 #endif
         test_fragment_add_check_duplicate_conflict,
+        test_fragment_add_check_memory_limit,
     };
 
     /* a tvbuff for testing with */
@@ -3261,6 +3341,11 @@ main(int argc _U_, char **argv _U_)
     }
     tvb = tvb_new_real_data(data, DATA_LEN, DATA_LEN*2);
 
+    /* count the fragment data */
+    wmem_init();
+    wmem_accounting_set_sample_rate(1);
+    reassembly_tables_init();
+
     /* other test stuff */
     pinfo.fd = &fd;
     fd.visited = 0;
@@ -3281,12 +3366,16 @@ main(int argc _U_, char **argv _U_)
 
         /* Free memory used by the tables */
         reassembly_table_destroy(&test_reassembly_table);
+
+        /* Data that was handed to the caller isn't counted. */
+        ASSERT_EQ(0,reassembly_owner_bytes());
     }
 
     tvb_free(tvb);
     tvb = NULL;
     g_free(data);
     data = NULL;
+    wmem_cleanup();
 
     printf(failure?"FAILURE\n":"SUCCESS\n");
     return failure;
@@ -8,12 +8,16 @@
  * SPDX-License-Identifier: GPL-2.0-or-later
  */
 
+#include "config.h"
+#define WS_LOG_DOMAIN LOG_DOMAIN_EPAN
+
 #include "register-int.h"
 #include "ws_attributes.h"
 
 #include <glib.h>
 
 #include <epan/exceptions.h>
+#include <wsutil/wslog.h>
 
 #include "epan/dissectors/dissectors.h"
 
@@ -26,22 +30,76 @@ static GAsyncQueue *register_cb_done_q;
 
 #define CB_WAIT_TIME (150 * 1000) // microseconds
 
+/* Number of callbacks listed by the registration profile. */
+#define CB_PROFILE_SLOWEST 20
+
+typedef struct {
+    const char *cb_name;
+    int64_t usecs;
+} cb_time_t;
+
 static void set_cb_name(const char *proto) {
     g_mutex_lock(&cur_cb_name_mtx);
     cur_cb_name = proto;
     g_mutex_unlock(&cur_cb_name_mtx);
 }
 
+static int
+cb_time_compare(const void *a, const void *b)
+{
+    int64_t a_usecs = ((const cb_time_t *)a)->usecs;
+    int64_t b_usecs = ((const cb_time_t *)b)->usecs;
+
+    return (a_usecs < b_usecs) - (a_usecs > b_usecs);
+}
+
+/*
+ * Call the registration routines. If info messages are enabled for the
+ * "Epan" domain, time each one and log the total and the slowest ones,
+ * so that startup regressions can be tracked down (see
+ * tools/startup-benchmark.py).
+ */
+static void
+call_register_routines(const char *phase, const dissector_reg_t *reg, unsigned long count)
+{
+    cb_time_t *times = NULL;
+    int64_t start, total = 0;
+
+    if (ws_log_msg_is_active(WS_LOG_DOMAIN, LOG_LEVEL_INFO)) {
+        times = g_new(cb_time_t, count);
+        total = g_get_monotonic_time();
+    }
+
+    for (unsigned long i = 0; i < count; i++) {
+        set_cb_name(reg[i].cb_name);
+        if (times) {
+            start = g_get_monotonic_time();
+            reg[i].cb_func();
+            times[i].cb_name = reg[i].cb_name;
+            times[i].usecs = g_get_monotonic_time() - start;
+        } else {
+            reg[i].cb_func();
+        }
+    }
+
+    if (times) {
+        total = g_get_monotonic_time() - total;
+        ws_info("%s: %lu routines in %.3f ms", phase, count, total / 1000.0);
+        qsort(times, count, sizeof(cb_time_t), cb_time_compare);
+        for (unsigned long i = 0; i < count && i < CB_PROFILE_SLOWEST; i++) {
+            ws_info("%s: %8.3f ms %s", phase, times[i].usecs / 1000.0, times[i].cb_name);
+        }
+        g_free(times);
+    }
+}
+
 static void *
 register_all_protocols_worker(void *arg _U_)
 {
     void *volatile error_message = NULL;
 
     TRY {
-        for (unsigned long i = 0; i < dissector_reg_proto_count; i++) {
-            set_cb_name(dissector_reg_proto[i].cb_name);
-            dissector_reg_proto[i].cb_func();
-        }
+        call_register_routines("register", dissector_reg_proto, dissector_reg_proto_count);
     }
     CATCH(DissectorError) {
         /*
@@ -94,10 +152,7 @@ register_all_protocol_handoffs_worker(void *arg _U_)
     void *volatile error_message = NULL;
 
     TRY {
-        for (unsigned long i = 0; i < dissector_reg_handoff_count; i++) {
-            set_cb_name(dissector_reg_handoff[i].cb_name);
-            dissector_reg_handoff[i].cb_func();
-        }
+        call_register_routines("handoff", dissector_reg_handoff, dissector_reg_handoff_count);
     }
     CATCH(DissectorError) {
         /*
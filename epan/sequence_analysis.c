@@ -221,6 +221,11 @@ sequence_analysis_list_sort(seq_analysis_info_t *sainfo)
 {
     if (!sainfo) return;
     g_queue_sort(sainfo->items, sequence_analysis_sort_compare, NULL);
+
+    /* Items that haven't been looked at might have moved between the others. */
+    if (sainfo->nodes_scanned < g_queue_get_length(sainfo->items)) {
+        sequence_analysis_free_nodes(sainfo);
+    }
 }
 
 void
@@ -332,10 +337,15 @@ static void sequence_analysis_get_nodes_item_proc(void *data, void *user_data)
 int
 sequence_analysis_get_nodes(seq_analysis_info_t *sainfo)
 {
-    struct sainfo_counter sc = {sainfo, 0};
+    struct sainfo_counter sc = {sainfo, sainfo->nodes_num_items};
+    GList *list;
 
-    /* Fill the node array */
-    g_queue_foreach(sainfo->items, sequence_analysis_get_nodes_item_proc, &sc);
+    /* Fill the node array, starting after the items we've already seen */
+    for (list = g_queue_peek_nth_link(sainfo->items, sainfo->nodes_scanned); list; list = g_list_next(list)) {
+        sequence_analysis_get_nodes_item_proc(list->data, &sc);
+        sainfo->nodes_scanned++;
+    }
+    sainfo->nodes_num_items = sc.num_items;
 
     return sc.num_items;
 }
@@ -351,6 +361,8 @@ sequence_analysis_free_nodes(seq_analysis_info_t *sainfo)
         free_address(&sainfo->nodes[i]);
     }
     sainfo->num_nodes = 0;
+    sainfo->nodes_scanned = 0;
+    sainfo->nodes_num_items = 0;
 }
 
 /* Writing analysis to file */
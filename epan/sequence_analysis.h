@@ -75,6 +75,8 @@ typedef struct _seq_analysis_info {
     address nodes[MAX_NUM_NODES];      /**< horizontal node list */
     uint8_t occurrence[MAX_NUM_NODES]; /**< horizontal occurrence list 0|1 */
     uint32_t num_nodes;                /**< actual number of nodes */
+    unsigned nodes_scanned;            /**< number of items whose nodes are known */
+    int nodes_num_items;               /**< number of displayed items among them */
 } seq_analysis_info_t;
 
 /** Structure for information about a registered sequence analysis function */
@@ -177,9 +179,14 @@ WS_DLL_PUBLIC void sequence_analysis_list_sort(seq_analysis_info_t *sainfo);
 WS_DLL_PUBLIC void sequence_analysis_list_free(seq_analysis_info_t *sainfo);
 
 /** Fill in the node address list
+ *
+ * Only the items that were appended since the last call are looked at,
+ * so this can be called as items come in. If items were inserted or
+ * removed elsewhere, or their display flags were changed, call
+ * sequence_analysis_free_nodes() first.
  *
  * @param sainfo Sequence analysis information.
- * @return The number of transaction items (not nodes) processed.
+ * @return The number of displayed transaction items (not nodes).
  */
 WS_DLL_PUBLIC int sequence_analysis_get_nodes(seq_analysis_info_t *sainfo);
 
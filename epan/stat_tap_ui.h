@@ -135,6 +135,13 @@ typedef struct _stat_tap_table_ui {
     tap_param             *params;     /* pointer to table of parameter info */
     GArray                *tables;     /* An array of stat_tap_table* */
     unsigned               refcount;   /* a reference count for deallocation */
+    /* Optional. Called before the tables are drawn, for statistics that
+     * fill them in from data kept elsewhere rather than per packet. */
+    void (* stat_tap_draw_cb)(struct _stat_tap_table_ui* stat);
+    /* Optional. Called once for each call of stat_tap_init_cb, after the
+     * tap listener that was set up with it has been removed (or failed
+     * to be registered). */
+    void (* stat_tap_finish_cb)(struct _stat_tap_table_ui* stat);
 } stat_tap_table_ui;
 
 
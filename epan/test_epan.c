@@ -9,6 +9,18 @@
 #include "config.h"
 
 #include "strutil.h"
+#include "frame_data.h"
+#include "frame_data_sequence.h"
+#include "tvbuff.h"
+#include "in_cksum.h"
+#include "epan.h"
+#include "packet.h"
+#include "prefs.h"
+#include "conversation.h"
+#include "uncompress_cache.h"
+#include "wmem_scopes.h"
+#include <wiretap/wtap.h>
+#include <wsutil/filesystem.h>
 #include <wsutil/utf8_entities.h>
 
 /*
@@ -74,6 +86,321 @@ void test_label_escape_control(void)
     g_assert_cmpuint(pos, ==, strlen(dst));
 }
 
+static void
+init_frame(frame_data *fdata, uint32_t num)
+{
+    wtap_rec rec;
+
+    memset(&rec, 0, sizeof(rec));
+    rec.rec_type = REC_TYPE_PACKET;
+    rec.presence_flags = WTAP_HAS_TS;
+    rec.rec_header.packet_header.len = 60;
+    rec.rec_header.packet_header.caplen = 60;
+    frame_data_init(fdata, num, &rec, 0, 0);
+}
+
+void test_frame_data_size(void)
+{
+    g_test_message("frame_data: %zu bytes per frame", sizeof(frame_data));
+#if GLIB_SIZEOF_VOID_P == 8
+    /* Billions of these are kept for large captures; don't let it grow
+     * by accident. */
+    g_assert_cmpuint(sizeof(frame_data), <=, 80);
+#endif
+}
+
+void test_frame_data_cold(void)
+{
+    frame_data fdata;
+    nstime_t shift = NSTIME_INIT_SECS_NSECS(2, 500);
+    nstime_t no_shift = NSTIME_INIT_ZERO;
+
+    init_frame(&fdata, 10);
+    g_assert_null(fdata.cold);
+    g_assert_null(frame_data_get_dependent_frames(&fdata));
+    g_assert_true(nstime_is_zero(frame_data_get_shift_offset(&fdata)));
+
+    /* Setting a zero shift offset doesn't allocate anything. */
+    frame_data_set_shift_offset(&fdata, &no_shift);
+    g_assert_null(fdata.cold);
+
+    frame_data_add_dependent_frame(&fdata, 3);
+    frame_data_add_dependent_frame(&fdata, 7);
+    frame_data_add_dependent_frame(&fdata, 3);
+    g_assert_cmpuint(g_hash_table_size(frame_data_get_dependent_frames(&fdata)), ==, 2);
+
+    frame_data_set_shift_offset(&fdata, &shift);
+    g_assert_cmpint(nstime_cmp(frame_data_get_shift_offset(&fdata), &shift), ==, 0);
+
+    /* A redissection drops the dependencies but keeps the time shift. */
+    frame_data_reset(&fdata);
+    g_assert_null(frame_data_get_dependent_frames(&fdata));
+    g_assert_cmpint(nstime_cmp(frame_data_get_shift_offset(&fdata), &shift), ==, 0);
+
+    frame_data_set_shift_offset(&fdata, &no_shift);
+    g_assert_null(fdata.cold);
+
+    frame_data_add_dependent_frame(&fdata, 1);
+    frame_data_destroy(&fdata);
+    g_assert_null(fdata.cold);
+}
+
+static void check_frame_data_sequence(uint32_t count)
+{
+    frame_data_sequence *fds = new_frame_data_sequence();
+    frame_data fdata;
+    size_t cold_count = 0;
+
+    for (uint32_t num = 1; num <= count; num++) {
+        init_frame(&fdata, num);
+        /* About one frame in a hundred depends on an earlier one,
+         * which is typical of reassembly. */
+        if (num % 100 == 0)
+            frame_data_add_dependent_frame(&fdata, num - 1);
+        frame_data_sequence_add(fds, &fdata);
+    }
+    for (uint32_t num = 1; num <= count; num++) {
+        if (frame_data_sequence_find(fds, num)->cold != NULL)
+            cold_count++;
+    }
+    g_assert_cmpuint(cold_count, ==, count / 100);
+    g_test_message("%u frames: %zu KiB in the sequence, %zu cold records",
+            count, count * sizeof(frame_data) / 1024, cold_count);
+
+    free_frame_data_sequence(fds);
+}
+
+void test_frame_data_sequence_memory(void)
+{
+    /* Enough to fill a few leaves of 1024 frames and start another. */
+    check_frame_data_sequence(3 * 1024 + 100);
+}
+
+void test_frame_data_sequence_perf(void)
+{
+    check_frame_data_sequence(1024 * 1024);
+}
+
+/* RFC 1071 one word at a time, in host byte order. */
+static uint16_t in_cksum_reference(const uint8_t *p, size_t len)
+{
+    uint32_t sum = 0;
+
+    for (size_t i = 0; i + 1 < len; i += 2)
+        sum += (uint32_t)p[i] << 8 | p[i + 1];
+    if (len & 1)
+        sum += (uint32_t)p[len - 1] << 8;
+    while (sum >> 16)
+        sum = (sum & 0xffff) + (sum >> 16);
+    return (uint16_t)~sum;
+}
+
+void test_in_cksum(void)
+{
+    uint8_t buf[1 + 9000];
+    vec_t vec[3];
+    GRand *rand = g_rand_new_with_seed(0x1071);
+
+    for (size_t i = 0; i < sizeof buf; i++)
+        buf[i] = (uint8_t)g_rand_int_range(rand, 0, 256);
+
+    /* Both alignments, with lengths that leave every possible tail
+     * after the vector loops. */
+    for (int offset = 0; offset < 2; offset++) {
+        for (int len = 0; len < 300; len++) {
+            g_assert_cmphex(g_ntohs(ip_checksum(buf + offset, len)), ==,
+                            in_cksum_reference(buf + offset, len));
+        }
+        g_assert_cmphex(g_ntohs(ip_checksum(buf + offset, 9000)), ==,
+                        in_cksum_reference(buf + offset, 9000));
+    }
+
+    /* Vectors split at odd and even places must give the same sum as
+     * the data in one piece. */
+    for (int i = 0; i < 1000; i++) {
+        int len = g_rand_int_range(rand, 0, 2000);
+        int split1 = g_rand_int_range(rand, 0, len + 1);
+        int split2 = g_rand_int_range(rand, split1, len + 1);
+
+        SET_CKSUM_VEC_PTR(vec[0], buf, split1);
+        SET_CKSUM_VEC_PTR(vec[1], buf + split1, split2 - split1);
+        SET_CKSUM_VEC_PTR(vec[2], buf + split2, len - split2);
+        g_assert_cmphex(g_ntohs(in_cksum(vec, 3)), ==, in_cksum_reference(buf, len));
+    }
+
+    /* All ones sums to -0. */
+    memset(buf, 0xff, sizeof buf);
+    g_assert_cmphex(ip_checksum(buf, 9000), ==, 0);
+
+    g_rand_free(rand);
+}
+
+void test_in_cksum_perf(void)
+{
+#define CKSUM_LOOP_COUNT (100 * 1000)
+    uint8_t *buf = g_malloc(9000);
+    unsigned zero_count = 0;
+    double elapsed;
+
+    for (int i = 0; i < 9000; i++)
+        buf[i] = (uint8_t)i;
+
+    /* Jumbo frames, where the checksum costs the most. */
+    g_test_timer_start();
+    for (int i = 0; i < CKSUM_LOOP_COUNT; i++) {
+        buf[0] = (uint8_t)i;
+        if (ip_checksum(buf, 9000) == 0)
+            zero_count++;
+    }
+    elapsed = g_test_timer_elapsed();
+    g_assert_cmpuint(zero_count, <, CKSUM_LOOP_COUNT);
+    g_test_minimized_result(elapsed,
+        "ip_checksum(), 9000 bytes: %.3f s (%.1f MB/s)",
+        elapsed, 9000.0 * CKSUM_LOOP_COUNT / 1000000.0 / elapsed);
+
+    g_free(buf);
+}
+
+/*
+ * A conversation created from a template shares the template's dissector
+ * tree. Expiring the template must leave the tree to the conversation
+ * that is still in use.
+ */
+void test_conversation_expire_template(void)
+{
+    static const struct packet_provider_funcs funcs;
+    static const uint8_t server_ip[] = { 192, 0, 2, 1 };
+    static const uint8_t client_ip[] = { 192, 0, 2, 2 };
+    address server, client;
+    conversation_t *template_conv, *conv;
+    dissector_handle_t handle;
+    epan_t *session;
+
+    session = epan_new(NULL, &funcs);
+    epan_set_streaming(session, 1, 0);
+
+    handle = find_dissector("data");
+    g_assert_nonnull(handle);
+    set_address(&server, AT_IPv4, 4, server_ip);
+    set_address(&client, AT_IPv4, 4, client_ip);
+
+    /* An FTP-style listener that any client can connect to. */
+    template_conv = conversation_new(1, &server, NULL, CONVERSATION_TCP, 21, 0,
+                                     NO_ADDR2 | NO_PORT2 | CONVERSATION_TEMPLATE);
+    conversation_set_dissector(template_conv, handle);
+
+    conv = find_conversation(2, &server, &client, CONVERSATION_TCP, 21, 40000, 0);
+    g_assert_nonnull(conv);
+    g_assert_true(conv != template_conv);
+    g_assert_true(conversation_get_dissector(conv, 2) == handle);
+
+    /* The connection stays busy while the listener goes idle. */
+    g_assert_true(find_conversation(10, &server, &client, CONVERSATION_TCP, 21, 40000, 0) == conv);
+    g_assert_cmpuint(conversation_expire(5, 0), ==, 1);
+    g_assert_true(template_conv->expired);
+    g_assert_false(conv->expired);
+    g_assert_true(conversation_get_dissector(conv, 10) == handle);
+
+    g_assert_cmpuint(conversation_expire(11, 0), ==, 1);
+    g_assert_true(conv->expired);
+    g_assert_null(conv->dissector_tree);
+
+    epan_free(session);
+}
+
+#define UNCOMPRESSED_LEN (400 * 1024)
+
+static unsigned uncompress_calls;
+
+/* Stands in for a decompressor; the first input byte is repeated, and
+ * 0xff fails. */
+static tvbuff_t *
+test_uncompress(tvbuff_t *tvb, const int offset, int comprlen _U_)
+{
+    tvbuff_t *uncompr_tvb;
+    uint8_t *data;
+
+    uncompress_calls++;
+    if (tvb_get_uint8(tvb, offset) == 0xff)
+        return NULL;
+    data = (uint8_t *)g_malloc(UNCOMPRESSED_LEN);
+    memset(data, tvb_get_uint8(tvb, offset), UNCOMPRESSED_LEN);
+    uncompr_tvb = tvb_new_real_data(data, UNCOMPRESSED_LEN, UNCOMPRESSED_LEN);
+    tvb_set_free_cb(uncompr_tvb, g_free);
+    return uncompr_tvb;
+}
+
+static uint64_t
+uncompress_cache_bytes(void)
+{
+    for (unsigned i = 0; i < wmem_owner_count(); i++) {
+        wmem_owner_t *owner = wmem_owner_get(i);
+
+        if (strcmp(owner->name, "Decompressed data") == 0)
+            return owner->bytes[WMEM_ACCOUNTING_FILE_SCOPE];
+    }
+    return 0;
+}
+
+/*
+ * The second lookup of the same data is a hit that shares the cached
+ * data. With a limit of 1 MiB there is room for two results, so a third
+ * one drops the least recently used, whose tvbs stay valid.
+ */
+void test_uncompress_cache(void)
+{
+    static const struct packet_provider_funcs funcs;
+    static const uint8_t input[] = { 1, 2, 3, 0xff };
+    unsigned old_limit = prefs.uncompress_cache_limit;
+    epan_t *session;
+    packet_info pinfo;
+    tvbuff_t *tvb, *first, *hit;
+
+    prefs.uncompress_cache_limit = 1;
+    wmem_accounting_set_sample_rate(1);
+    session = epan_new(NULL, &funcs);
+    memset(&pinfo, 0, sizeof(pinfo));
+    tvb = tvb_new_real_data(input, sizeof(input), sizeof(input));
+    uncompress_calls = 0;
+
+    /* Miss, then hit. */
+    pinfo.num = 1;
+    first = tvb_child_uncompress_cached(&pinfo, tvb, tvb, 0, 1, test_uncompress);
+    g_assert_nonnull(first);
+    g_assert_cmpuint(uncompress_calls, ==, 1);
+    hit = tvb_child_uncompress_cached(&pinfo, tvb, tvb, 0, 1, test_uncompress);
+    g_assert_nonnull(hit);
+    g_assert_cmpuint(uncompress_calls, ==, 1);
+    g_assert_true(tvb_get_ptr(hit, 0, UNCOMPRESSED_LEN) == tvb_get_ptr(first, 0, UNCOMPRESSED_LEN));
+    g_assert_cmpuint(uncompress_cache_bytes(), >=, UNCOMPRESSED_LEN);
+
+    /* Failures are cached too. */
+    g_assert_null(tvb_child_uncompress_cached(&pinfo, tvb, tvb, 3, 1, test_uncompress));
+    g_assert_null(tvb_child_uncompress_cached(&pinfo, tvb, tvb, 3, 1, test_uncompress));
+    g_assert_cmpuint(uncompress_calls, ==, 2);
+
+    /* The third result evicts the first one. */
+    pinfo.num = 2;
+    g_assert_nonnull(tvb_child_uncompress_cached(&pinfo, tvb, tvb, 1, 1, test_uncompress));
+    pinfo.num = 3;
+    g_assert_nonnull(tvb_child_uncompress_cached(&pinfo, tvb, tvb, 2, 1, test_uncompress));
+    g_assert_cmpuint(uncompress_calls, ==, 4);
+    g_assert_cmpuint(uncompress_cache_bytes(), >=, 2 * UNCOMPRESSED_LEN);
+    g_assert_cmpuint(uncompress_cache_bytes(), <=, 1024 * 1024);
+    g_assert_cmpuint(tvb_get_uint8(first, UNCOMPRESSED_LEN - 1), ==, 1);
+    g_assert_cmpuint(tvb_get_uint8(hit, UNCOMPRESSED_LEN - 1), ==, 1);
+
+    pinfo.num = 1;
+    g_assert_nonnull(tvb_child_uncompress_cached(&pinfo, tvb, tvb, 0, 1, test_uncompress));
+    g_assert_cmpuint(uncompress_calls, ==, 5);
+
+    /* Frees the decompressed tvbs as well. */
+    tvb_free(tvb);
+    epan_free(session);
+    wmem_accounting_set_sample_rate(0);
+    prefs.uncompress_cache_limit = old_limit;
+}
+
 int main(int argc, char **argv)
 {
     int ret;
@@ -83,14 +410,39 @@ int main(int argc, char **argv)
 
     ws_log_init(NULL);
 
+    /* For the tests that load the dissectors. */
+    g_free(configuration_init(argv[0]));
+
     g_test_init(&argc, &argv, NULL);
 
     g_test_add_func("/label/strcat", test_label_strcat);
     g_test_add_func("/label/escape_whitespace", test_label_strcat_escape_whitespace);
     g_test_add_func("/label/escape_control", test_label_escape_control);
 
+    g_test_add_func("/frame_data/size", test_frame_data_size);
+    g_test_add_func("/frame_data/cold", test_frame_data_cold);
+    g_test_add_func("/frame_data/sequence_memory", test_frame_data_sequence_memory);
+    if (g_test_perf()) {
+        g_test_add_func("/frame_data/sequence_perf", test_frame_data_sequence_perf);
+    }
+
+    g_test_add_func("/in_cksum/ip_checksum", test_in_cksum);
+    if (g_test_perf()) {
+        g_test_add_func("/in_cksum/perf", test_in_cksum_perf);
+    }
+
+    g_test_add_func("/conversation/expire_template", test_conversation_expire_template);
+    g_test_add_func("/uncompress_cache/hit_miss_evict", test_uncompress_cache);
+
+    /* The tests that need dissectors start their own sessions. */
+    wtap_init(false);
+    g_assert_true(epan_init(NULL, NULL, false));
+
     ret = g_test_run();
 
+    epan_cleanup();
+    wtap_cleanup();
+
     return ret;
 }
 
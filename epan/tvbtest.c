@@ -701,8 +701,244 @@ varint_tests(void)
 	tvb_free_chain(tvb_parent);  /* should free all tvb's and associated data */
 }
 
+#define COMPOSITE_MEMBERS 200
+
+/* A composite with many small members, searched and copied across
+ * member boundaries before anything makes it flatten itself. */
+static void
+composite_tests(void)
+{
+	tvbuff_t	*tvb_parent, *tvb_comp, *member;
+	uint8_t		data[COMPOSITE_MEMBERS * 7];
+	uint8_t		copy[COMPOSITE_MEMBERS * 7];
+	unsigned	length = 0, offset, span_length, member_length, i;
+	const uint8_t	*span;
+	const uint8_t	*expected_ptr;
+	int		result, expected;
+	unsigned char	found_needle;
+	ws_mempbrk_pattern pattern;
+
+	tvb_parent = tvb_new_real_data((const uint8_t*)"", 0, 0);
+	tvb_comp = tvb_new_composite();
+	for (i = 0; i < COMPOSITE_MEMBERS; i++) {
+		member_length = 1 + i % 7;
+		for (unsigned j = 0; j < member_length; j++) {
+			/* Never 0xff, so there's a byte that isn't there */
+			data[length + j] = (uint8_t)((length + j) % 251);
+		}
+		member = tvb_new_child_real_data(tvb_parent, &data[length], member_length, member_length);
+		tvb_composite_append(tvb_comp, member);
+		length += member_length;
+	}
+	tvb_composite_finalize(tvb_comp);
+
+	/* Walking the spans gives back the members, not one flat buffer. */
+	for (offset = 0; offset < length; offset += span_length) {
+		span = tvb_get_span(tvb_comp, offset, length - offset, &span_length);
+		if (span_length == 0 || span_length > 7 || memcmp(span, &data[offset], span_length) != 0) {
+			printf("Failed composite span at offset %u, length %u\n", offset, span_length);
+			failed = true;
+			break;
+		}
+	}
+
+	for (offset = 0; offset < length; offset += 3) {
+		uint8_t needle = data[(offset * 7 + 3) % length];
+
+		expected_ptr = (const uint8_t *)memchr(&data[offset], needle, length - offset);
+		expected = expected_ptr ? (int)(expected_ptr - data) : -1;
+		result = tvb_find_uint8(tvb_comp, offset, -1, needle);
+		if (result != expected) {
+			printf("Failed composite find_uint8 %02x from offset %u: got %d, expected %d\n",
+			       needle, offset, result, expected);
+			failed = true;
+		}
+
+		/* Limited to fewer bytes than it takes to find it */
+		if (expected > (int)offset) {
+			result = tvb_find_uint8(tvb_comp, offset, expected - offset, needle);
+			if (result != -1) {
+				printf("Failed composite find_uint8 %02x from offset %u with limit: got %d\n",
+				       needle, offset, result);
+				failed = true;
+			}
+		}
+
+		char pattern_string[3] = {(char)0xff, (char)needle, '\0'};
+		ws_mempbrk_compile(&pattern, pattern_string);
+		result = tvb_ws_mempbrk_pattern_uint8(tvb_comp, offset, -1, &pattern, &found_needle);
+		if (result != expected || (result != -1 && found_needle != needle)) {
+			printf("Failed composite mempbrk %02x from offset %u: got %d, expected %d\n",
+			       needle, offset, result, expected);
+			failed = true;
+		}
+
+		member_length = MIN(length - offset, 20);
+		tvb_memcpy(tvb_comp, copy, offset, member_length);
+		if (memcmp(copy, &data[offset], member_length) != 0) {
+			printf("Failed composite memcpy of %u bytes from offset %u\n", member_length, offset);
+			failed = true;
+		}
+	}
+
+	if (tvb_find_uint8(tvb_comp, 0, -1, 0xff) != -1) {
+		printf("Failed composite find_uint8 for a missing byte\n");
+		failed = true;
+	}
+
+	/* Once it's been flattened, a span covers everything asked for. */
+	tvb_get_ptr(tvb_comp, 0, length);
+	span = tvb_get_span(tvb_comp, 1, length - 1, &span_length);
+	if (span_length != length - 1 || memcmp(span, &data[1], span_length) != 0) {
+		printf("Failed composite span after flattening: length %u\n", span_length);
+		failed = true;
+	}
+
+	if (!failed)
+		printf("Passed composite with %u members\n", COMPOSITE_MEMBERS);
+
+	tvb_free_chain(tvb_parent);  /* should free all tvb's and associated data */
+}
+
 #define DATA_AND_LEN(X) .data = X, .len = sizeof(X) - 1
 
+/* What ws_mempbrk_exec() and ws_memrpbrk_exec() should return. */
+static const uint8_t *
+mempbrk_reference(const uint8_t *haystack, size_t haystacklen, const char *needles, bool reverse)
+{
+	for (size_t i = 0; i < haystacklen; i++) {
+		size_t pos = reverse ? haystacklen - 1 - i : i;
+
+		if (haystack[pos] != '\0' && strchr(needles, haystack[pos]))
+			return &haystack[pos];
+	}
+	return NULL;
+}
+
+static void
+mempbrk_tests(void)
+{
+	/* The last two have more than eight distinct high nibbles. */
+	static const char *needles[] = {
+		"\r\n", "\r\n\"", " \r\n", ";,= \t", "\xff",
+		"ABCDEFGHIJKLMNOPQRSTUVWXYZ",
+		"\x01\x11\x21\x31\x41\x51\x61\x71\x81",
+		"\x80\x91\xa2\xb3\xc4\xd5\xe6\xf7\x08\x19",
+	};
+	ws_mempbrk_pattern pattern;
+	uint8_t haystack[32 + 200];
+	GRand *rand = g_rand_new_with_seed(0x9b7c);
+	unsigned char found_needle;
+	const uint8_t *result, *expected;
+
+	for (unsigned i = 0; i < array_length(needles); i++) {
+		size_t needles_len = strlen(needles[i]);
+
+		ws_mempbrk_compile(&pattern, needles[i]);
+		for (unsigned iter = 0; iter < 2000; iter++) {
+			/* Every length and alignment, with zero to two needles
+			 * and plenty of NULs, which aren't needles. */
+			size_t offset = g_rand_int_range(rand, 0, 32);
+			size_t len = g_rand_int_range(rand, 0, 200);
+			int count = g_rand_int_range(rand, 0, 3);
+
+			for (size_t j = 0; j < offset + len; j++) {
+				uint8_t c;
+
+				do {
+					c = g_rand_int_range(rand, 0, 8) == 0 ? 0 : (uint8_t)g_rand_int_range(rand, 0, 256);
+				} while (c != 0 && strchr(needles[i], c));
+				haystack[j] = c;
+			}
+			for (int j = 0; j < count && len > 0; j++) {
+				haystack[offset + g_rand_int_range(rand, 0, (int32_t)len)] =
+					needles[i][g_rand_int_range(rand, 0, (int32_t)needles_len)];
+			}
+
+			for (int reverse = 0; reverse < 2; reverse++) {
+				if (reverse)
+					result = ws_memrpbrk_exec(&haystack[offset], len, &pattern, &found_needle);
+				else
+					result = ws_mempbrk_exec(&haystack[offset], len, &pattern, &found_needle);
+				expected = mempbrk_reference(&haystack[offset], len, needles[i], reverse);
+				if (result != expected || (result != NULL && found_needle != *result)) {
+					printf("Failed %s with needles %u, offset %zu, length %zu: got %td, expected %td\n",
+					       reverse ? "memrpbrk" : "mempbrk", i, offset, len,
+					       result ? result - &haystack[offset] : -1,
+					       expected ? expected - &haystack[offset] : -1);
+					failed = true;
+				}
+			}
+		}
+	}
+	g_rand_free(rand);
+
+	if (!failed)
+		printf("Passed mempbrk\n");
+}
+
+/*
+ * Time tvb_find_line_end() on HTTP-style header lines and
+ * tvb_ws_mempbrk_pattern_uint8() and tvb_find_uint8() on a buffer
+ * without a match; run with "-b".
+ */
+static void
+search_benchmarks(void)
+{
+#define BENCH_BUF_SIZE (64 * 1024)
+#define BENCH_LOOP_COUNT 2000
+	static const char header_line[] = "Accept-Language: en-US,en;q=0.5\r\n";
+	uint8_t *buf = (uint8_t *)g_malloc(BENCH_BUF_SIZE);
+	tvbuff_t *tvb;
+	ws_mempbrk_pattern pattern;
+	int64_t start;
+	double elapsed;
+	int offset, next_offset, lines = 0, found = 0;
+
+	for (offset = 0; offset + (int)sizeof header_line - 1 <= BENCH_BUF_SIZE; offset += (int)sizeof header_line - 1)
+		memcpy(&buf[offset], header_line, sizeof header_line - 1);
+	memset(&buf[offset], 'x', BENCH_BUF_SIZE - offset);
+	tvb = tvb_new_real_data(buf, BENCH_BUF_SIZE, BENCH_BUF_SIZE);
+
+	start = g_get_monotonic_time();
+	for (int i = 0; i < BENCH_LOOP_COUNT; i++) {
+		for (offset = 0; tvb_find_line_end(tvb, offset, -1, &next_offset, true) >= 0; offset = next_offset)
+			lines++;
+	}
+	elapsed = (g_get_monotonic_time() - start) / 1000000.0;
+	printf("tvb_find_line_end: %.1f MB/s, %.1f ns per line\n",
+	       (double)BENCH_BUF_SIZE * BENCH_LOOP_COUNT / 1000000.0 / elapsed,
+	       elapsed * 1000000000.0 / lines);
+
+	memset(buf, 'x', BENCH_BUF_SIZE);
+	ws_mempbrk_compile(&pattern, "\r\n\"");
+	start = g_get_monotonic_time();
+	for (int i = 0; i < BENCH_LOOP_COUNT; i++) {
+		if (tvb_ws_mempbrk_pattern_uint8(tvb, i % 64, -1, &pattern, NULL) >= 0)
+			found++;
+	}
+	elapsed = (g_get_monotonic_time() - start) / 1000000.0;
+	printf("tvb_ws_mempbrk_pattern_uint8, no match: %.1f MB/s\n",
+	       (double)BENCH_BUF_SIZE * BENCH_LOOP_COUNT / 1000000.0 / elapsed);
+
+	start = g_get_monotonic_time();
+	for (int i = 0; i < BENCH_LOOP_COUNT; i++) {
+		if (tvb_find_uint8(tvb, i % 64, -1, '\n') >= 0)
+			found++;
+	}
+	elapsed = (g_get_monotonic_time() - start) / 1000000.0;
+	printf("tvb_find_uint8, no match: %.1f MB/s\n",
+	       (double)BENCH_BUF_SIZE * BENCH_LOOP_COUNT / 1000000.0 / elapsed);
+
+	if (found != 0) {
+		printf("Failed benchmark: found a byte that isn't there\n");
+		failed = true;
+	}
+
+	tvb_free(tvb);
+	g_free(buf);
+}
+
 static void
 zstd_tests (void) {
 #ifdef HAVE_ZSTD
@@ -806,7 +1042,7 @@ zstd_tests (void) {
 }
 /* Note: valgrind can be used to check for tvbuff memory leaks */
 int
-main(void)
+main(int argc, char **argv)
 {
 	/* For valgrind: See GLib documentation: "Running GLib Applications" */
 	g_setenv("G_DEBUG", "gc-friendly", 1);
@@ -814,8 +1050,12 @@ main(void)
 
 	except_init();
 	run_tests();
+	composite_tests();
+	mempbrk_tests();
 	varint_tests();
 	zstd_tests ();
+	if (argc > 1 && strcmp(argv[1], "-b") == 0)
+		search_benchmarks();
 	except_deinit();
 	return failed ? EXIT_FAILURE : EXIT_SUCCESS;
 }
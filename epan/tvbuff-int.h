@@ -25,6 +25,9 @@ struct tvb_ops {
 	int (*tvb_ws_mempbrk_pattern_uint8)(tvbuff_t *tvb, unsigned abs_offset, unsigned limit, const ws_mempbrk_pattern* pattern, unsigned char *found_needle);
 
 	tvbuff_t *(*tvb_clone)(tvbuff_t *tvb, unsigned abs_offset, unsigned abs_length);
+
+	/* Optional; without it, tvb_get_span() uses tvb_get_ptr */
+	const uint8_t *(*tvb_get_span)(tvbuff_t *tvb, unsigned abs_offset, unsigned abs_length, unsigned *span_length);
 };
 
 /*
@@ -1003,6 +1003,31 @@ tvb_get_ptr(tvbuff_t *tvb, const int offset, const int length)
 	return ensure_contiguous(tvb, offset, length);
 }
 
+const uint8_t*
+tvb_get_span(tvbuff_t *tvb, const int offset, const int length, unsigned *span_length)
+{
+	unsigned abs_offset = 0, abs_length = 0;
+
+	DISSECTOR_ASSERT(tvb && tvb->initialized);
+
+	check_offset_length(tvb, offset, length, &abs_offset, &abs_length);
+	if (abs_length == 0) {
+		*span_length = 0;
+		return NULL;
+	}
+
+	if (tvb->real_data) {
+		*span_length = abs_length;
+		return tvb->real_data + abs_offset;
+	}
+
+	if (tvb->ops->tvb_get_span)
+		return tvb->ops->tvb_get_span(tvb, abs_offset, abs_length, span_length);
+
+	*span_length = abs_length;
+	return tvb->ops->tvb_get_ptr(tvb, abs_offset, abs_length);
+}
+
 /* ---------------- */
 uint8_t
 tvb_get_uint8(tvbuff_t *tvb, const int offset)
@@ -597,6 +597,18 @@ WS_DLL_PUBLIC void *tvb_memdup(wmem_allocator_t *scope, tvbuff_t *tvb,
 WS_DLL_PUBLIC const uint8_t *tvb_get_ptr(tvbuff_t *tvb, const int offset,
     const int length);
 
+/** Like tvb_get_ptr(), but never copies data: return a pointer to as much
+ * of the data at 'offset', up to 'length' bytes, as is contiguous in memory,
+ * and set '*span_length' to the number of bytes the pointer is good for.
+ * Call it again at 'offset' + '*span_length' for the rest. For a composite
+ * tvbuff, that walks its members one at a time, where tvb_get_ptr() would
+ * copy them all into one buffer.
+ *
+ * Throws an exception if the tvbuff ends before 'offset' + 'length'.
+ * The same warnings as for tvb_get_ptr() apply. */
+WS_DLL_PUBLIC const uint8_t *tvb_get_span(tvbuff_t *tvb, const int offset,
+    const int length, unsigned *span_length);
+
 /** Find first occurrence of needle in tvbuff, starting at offset. Searches
  * at most maxlength number of bytes; if maxlength is -1, searches to
  * end of tvbuff.
@@ -18,14 +18,15 @@
 typedef struct {
 	GQueue		*tvbs;
 
-	/* Used for quick testing to see if this
-	 * is the tvbuff that a COMPOSITE is
-	 * interested in. */
+	/* The members and the offsets at which they start and end, set
+	 * by tvb_composite_finalize(). The offsets are in ascending order,
+	 * so the member that holds an offset can be found with a binary
+	 * search. */
+	tvbuff_t	**members;
+	unsigned	num_members;
 	unsigned		*start_offsets;
 	unsigned		*end_offsets;
 
-	unsigned	recursion_depth;
-
 } tvb_comp_t;
 
 struct tvb_composite {
@@ -42,6 +43,7 @@ composite_free(tvbuff_t *tvb)
 
 	g_queue_free(composite->tvbs);
 
+	g_free(composite->members);
 	g_free(composite->start_offsets);
 	g_free(composite->end_offsets);
 	g_free((void *)tvb->real_data);
@@ -53,13 +55,33 @@ composite_offset(const tvbuff_t *tvb _U_, const unsigned counter)
 	return counter;
 }
 
+/*
+ * Return the index of the member that holds abs_offset, or num_members
+ * if abs_offset is at the end of the composite.
+ */
+static unsigned
+composite_find_member(const tvb_comp_t *composite, unsigned abs_offset)
+{
+	unsigned low = 0, high = composite->num_members;
+
+	while (low < high) {
+		unsigned mid = low + (high - low) / 2;
+
+		if (composite->end_offsets[mid] < abs_offset)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+	return low;
+}
+
 static const uint8_t*
 composite_get_ptr(tvbuff_t *tvb, unsigned abs_offset, unsigned abs_length)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
 	unsigned	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	unsigned	member_offset;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
@@ -67,22 +89,15 @@ composite_get_ptr(tvbuff_t *tvb, unsigned abs_offset, unsigned abs_length)
 	/* Maybe the range specified by offset/length
 	 * is contiguous inside one of the member tvbuffs */
 	composite = &composite_tvb->composite;
-	GList *item = (GList*)composite->tvbs->head;
-
-
-	for (i = 0; i < g_queue_get_length(composite->tvbs); i++, item=item->next) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			member_tvb = (tvbuff_t *)item->data;
-			break;
-		}
-	}
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return "";
 	}
 
+	member_tvb = composite->members[i];
 	member_offset = abs_offset - composite->start_offsets[i];
 
 	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
@@ -93,7 +108,13 @@ composite_get_ptr(tvbuff_t *tvb, unsigned abs_offset, unsigned abs_length)
 		return tvb_get_ptr(member_tvb, member_offset, abs_length);
 	}
 	else {
-		/* Use a temporary variable as tvb_memcpy is also checking tvb->real_data pointer */
+		/*
+		 * Flatten the whole composite, once; from now on all
+		 * accesses use the flat copy.
+		 *
+		 * Use a temporary variable as tvb_memcpy is also checking
+		 * tvb->real_data pointer
+		 */
 		void *real_data = g_malloc(tvb->length);
 		tvb_memcpy(tvb, real_data, 0, tvb->length);
 		tvb->real_data = (const uint8_t *)real_data;
@@ -103,9 +124,7 @@ composite_get_ptr(tvbuff_t *tvb, unsigned abs_offset, unsigned abs_length)
 	DISSECTOR_ASSERT_NOT_REACHED();
 }
 
-#define MAX_RECURSION_DEPTH 500 // Arbitrary; matches prefs.gui_max_tree_depth
 static void *
-// NOLINTNEXTLINE(misc-no-recursion)
 composite_memcpy(tvbuff_t *tvb, void* _target, unsigned abs_offset, unsigned abs_length)
 {
 	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
@@ -113,64 +132,98 @@ composite_memcpy(tvbuff_t *tvb, void* _target, unsigned abs_offset, unsigned abs
 
 	unsigned	    i;
 	tvb_comp_t *composite;
-	tvbuff_t   *member_tvb = NULL;
+	tvbuff_t   *member_tvb;
 	unsigned	    member_offset, member_length;
 
 	/* DISSECTOR_ASSERT(tvb->ops == &tvb_composite_ops); */
 
-	/* Maybe the range specified by offset/length
-	 * is contiguous inside one of the member tvbuffs */
 	composite   = &composite_tvb->composite;
-
-	GList *item = (GList*)composite->tvbs->head;
-	for (i = 0; i < g_queue_get_length(composite->tvbs); i++, item=item->next) {
-		if (abs_offset <= composite->end_offsets[i]) {
-			member_tvb = (tvbuff_t *)item->data;
-			break;
-		}
-	}
+	i = composite_find_member(composite, abs_offset);
 
 	/* special case */
-	if (!member_tvb) {
+	if (i == composite->num_members) {
 		DISSECTOR_ASSERT(abs_offset == tvb->length && abs_length == 0);
 		return target;
 	}
 
+	/* Copy the part that's in each member in turn, until we have
+	 * copied all data. */
 	member_offset = abs_offset - composite->start_offsets[i];
+	while (abs_length > 0) {
+		DISSECTOR_ASSERT(i < composite->num_members);
+		member_tvb = composite->members[i];
+		member_length = MIN(abs_length, member_tvb->length - member_offset);
 
-	if (tvb_bytes_exist(member_tvb, member_offset, abs_length)) {
-		DISSECTOR_ASSERT(!tvb->real_data);
-		return tvb_memcpy(member_tvb, target, member_offset, abs_length);
+		tvb_memcpy(member_tvb, target, member_offset, member_length);
+		target		+= member_length;
+		abs_length	-= member_length;
+		member_offset	= 0;
+		i++;
 	}
-	else {
-		/* The requested data is non-contiguous inside
-		 * the member tvb. We have to memcpy() the part that's in the member tvb,
-		 * then iterate across the other member tvb's, copying their portions
-		 * until we have copied all data.
-		 */
-		member_length = tvb_captured_length_remaining(member_tvb, member_offset);
 
-		/* composite_memcpy() can't handle a member_length of zero. */
-		DISSECTOR_ASSERT(member_length > 0);
-		/* make sure we don't underflow below */
-		DISSECTOR_ASSERT(member_length <= abs_length);
+	return _target;
+}
 
-		tvb_memcpy(member_tvb, target, member_offset, member_length);
-		abs_offset	+= member_length;
-		abs_length	-= member_length;
+/*
+ * Search the members in turn rather than flattening the composite.
+ */
+static int
+composite_find_uint8(tvbuff_t *tvb, unsigned abs_offset, unsigned limit, uint8_t needle)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	unsigned	i, member_offset, member_length;
+	int		result;
+
+	i = composite_find_member(composite, abs_offset);
+	member_offset = abs_offset - (i < composite->num_members ? composite->start_offsets[i] : 0);
+	for (; limit > 0 && i < composite->num_members; i++) {
+		member_length = MIN(limit, composite->members[i]->length - member_offset);
+		result = tvb_find_uint8(composite->members[i], member_offset, member_length, needle);
+		if (result != -1)
+			return composite->start_offsets[i] + result;
+		limit -= member_length;
+		member_offset = 0;
+	}
 
-		/* Recurse */
-		if (abs_length > 0) {
-			composite->recursion_depth++;
-			DISSECTOR_ASSERT(composite->recursion_depth < MAX_RECURSION_DEPTH);
-			composite_memcpy(tvb, target + member_length, abs_offset, abs_length);
-			composite->recursion_depth--;
-		}
+	return -1;
+}
 
-		return target;
+static int
+composite_pbrk_uint8(tvbuff_t *tvb, unsigned abs_offset, unsigned limit, const ws_mempbrk_pattern* pattern, unsigned char *found_needle)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	unsigned	i, member_offset, member_length;
+	int		result;
+
+	i = composite_find_member(composite, abs_offset);
+	member_offset = abs_offset - (i < composite->num_members ? composite->start_offsets[i] : 0);
+	for (; limit > 0 && i < composite->num_members; i++) {
+		member_length = MIN(limit, composite->members[i]->length - member_offset);
+		result = tvb_ws_mempbrk_pattern_uint8(composite->members[i], member_offset, member_length, pattern, found_needle);
+		if (result != -1)
+			return composite->start_offsets[i] + result;
+		limit -= member_length;
+		member_offset = 0;
 	}
 
-	DISSECTOR_ASSERT_NOT_REACHED();
+	return -1;
+}
+
+static const uint8_t *
+composite_get_span(tvbuff_t *tvb, unsigned abs_offset, unsigned abs_length, unsigned *span_length)
+{
+	struct tvb_composite *composite_tvb = (struct tvb_composite *) tvb;
+	tvb_comp_t *composite = &composite_tvb->composite;
+	unsigned	i, member_offset;
+
+	i = composite_find_member(composite, abs_offset);
+	DISSECTOR_ASSERT(i < composite->num_members);
+	member_offset = abs_offset - composite->start_offsets[i];
+
+	return tvb_get_span(composite->members[i], member_offset,
+	    MIN(abs_length, composite->members[i]->length - member_offset), span_length);
 }
 
 static const struct tvb_ops tvb_composite_ops = {
@@ -180,9 +233,10 @@ static const struct tvb_ops tvb_composite_ops = {
 	composite_offset,     /* offset */
 	composite_get_ptr,    /* get_ptr */
 	composite_memcpy,     /* memcpy */
-	NULL,                 /* find_uint8 XXX */
-	NULL,                 /* pbrk_uint8 XXX */
+	composite_find_uint8, /* find_uint8 */
+	composite_pbrk_uint8, /* pbrk_uint8 */
 	NULL,                 /* clone */
+	composite_get_span,   /* get_span */
 };
 
 /*
@@ -205,9 +259,10 @@ tvb_new_composite(void)
 	tvb_comp_t *composite = &composite_tvb->composite;
 
 	composite->tvbs		 = g_queue_new();
+	composite->members	 = NULL;
+	composite->num_members	 = 0;
 	composite->start_offsets = NULL;
 	composite->end_offsets	 = NULL;
-	composite->recursion_depth = 0;
 
 	return tvb;
 }
@@ -284,12 +339,15 @@ tvb_composite_finalize(tvbuff_t *tvb)
 	 */
 	DISSECTOR_ASSERT(num_members);
 
+	composite->members = g_new(tvbuff_t *, num_members);
+	composite->num_members = num_members;
 	composite->start_offsets = g_new(unsigned, num_members);
 	composite->end_offsets = g_new(unsigned, num_members);
 
 	GList *item = (GList*)composite->tvbs->head;
 	for (i=0; i < num_members; i++, item=item->next) {
 		member_tvb = (tvbuff_t *)item->data;
+		composite->members[i] = member_tvb;
 		composite->start_offsets[i] = tvb->length;
 		tvb->length += member_tvb->length;
 		tvb->reported_length += member_tvb->reported_length;
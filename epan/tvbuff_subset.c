@@ -94,6 +94,14 @@ subset_pbrk_uint8(tvbuff_t *tvb, unsigned abs_offset, unsigned limit, const ws_m
 	return result - subset_tvb->subset.offset;
 }
 
+static const uint8_t *
+subset_get_span(tvbuff_t *tvb, unsigned abs_offset, unsigned abs_length, unsigned *span_length)
+{
+	struct tvb_subset *subset_tvb = (struct tvb_subset *) tvb;
+
+	return tvb_get_span(subset_tvb->subset.tvb, subset_tvb->subset.offset + abs_offset, abs_length, span_length);
+}
+
 static tvbuff_t *
 subset_clone(tvbuff_t *tvb, unsigned abs_offset, unsigned abs_length)
 {
@@ -112,6 +120,7 @@ static const struct tvb_ops tvb_subset_ops = {
 	subset_find_uint8,   /* find_uint8 */
 	subset_pbrk_uint8,   /* pbrk_uint8 */
 	subset_clone,         /* clone */
+	subset_get_span,      /* get_span */
 };
 
 static tvbuff_t *
@@ -0,0 +1,18 @@
+/** @file
+ * Internal definitions for the cache of decompressed data.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __UNCOMPRESS_CACHE_INT_H__
+#define __UNCOMPRESS_CACHE_INT_H__
+
+/* Set up the cache; called from epan_init(). */
+extern void
+uncompress_cache_init(void);
+
+#endif /* __UNCOMPRESS_CACHE_INT_H__ */
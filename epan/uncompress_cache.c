@@ -0,0 +1,299 @@
+/* uncompress_cache.c
+ * Cache of decompressed data, so that it isn't decompressed again
+ * every time a frame is dissected.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <stddef.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include <epan/packet.h>
+#include <epan/prefs.h>
+#include <epan/uncompress_cache.h>
+#include <epan/wmem_scopes.h>
+#include "uncompress_cache-int.h"
+#include <wsutil/crc32.h>
+
+/*
+ * Reassembled and other real-data tvbs all start at raw offset 0, so the
+ * position alone doesn't tell two bodies in the same frame apart; the
+ * compressed input is compared as well.
+ */
+typedef struct {
+    uint32_t frame;
+    uint8_t layer;
+    int position;
+    int comprlen;
+    tvb_uncompress_func func;
+    uint32_t input_crc;         /* CRC-32C of the compressed input */
+    const uint8_t *input;       /* the compressed input, comprlen bytes */
+} uncompress_cache_key_t;
+
+/*
+ * Decompressed data, shared by the cache entry and the tvbs handed out
+ * for it, so that it stays valid while a tvb uses it after the entry
+ * was dropped.
+ */
+typedef struct {
+    unsigned ref_count;
+    uint8_t data[];
+} uncompress_cache_data_t;
+
+typedef struct _uncompress_cache_entry_t {
+    uncompress_cache_key_t key; /* key.input points to a copy */
+    uncompress_cache_data_t *data; /* NULL if decompression failed */
+    unsigned len;
+    struct _uncompress_cache_entry_t *prev; /* more recently used */
+    struct _uncompress_cache_entry_t *next; /* less recently used */
+} uncompress_cache_entry_t;
+
+/* All entries, keyed by their key member. */
+static GHashTable *uncompress_cache;
+
+/* The entries in the order in which they were last used. */
+static uncompress_cache_entry_t *lru_head;
+static uncompress_cache_entry_t *lru_tail;
+
+/* The memory held by the entries. */
+static size_t uncompress_cache_memory;
+
+/*
+ * The data is allocated with GLib rather than wmem, so count it here
+ * for the memory statistics.
+ */
+static wmem_owner_t *uncompress_cache_owner;
+
+static unsigned
+uncompress_cache_key_hash(const void *k)
+{
+    const uncompress_cache_key_t *key = (const uncompress_cache_key_t *)k;
+    unsigned hash_val;
+
+    hash_val = key->frame;
+    hash_val = hash_val * 31 + key->layer;
+    hash_val = hash_val * 31 + (unsigned)key->position;
+    hash_val = hash_val * 31 + (unsigned)key->comprlen;
+    hash_val = hash_val * 31 + key->input_crc;
+    return hash_val;
+}
+
+static gboolean
+uncompress_cache_key_equal(const void *k1, const void *k2)
+{
+    const uncompress_cache_key_t *key1 = (const uncompress_cache_key_t *)k1;
+    const uncompress_cache_key_t *key2 = (const uncompress_cache_key_t *)k2;
+
+    return key1->frame == key2->frame && key1->layer == key2->layer &&
+           key1->position == key2->position && key1->comprlen == key2->comprlen &&
+           key1->func == key2->func && key1->input_crc == key2->input_crc &&
+           memcmp(key1->input, key2->input, key1->comprlen) == 0;
+}
+
+static void
+uncompress_cache_data_unref(uncompress_cache_data_t *data)
+{
+    if (--data->ref_count == 0)
+        g_free(data);
+}
+
+/* The free callback of the tvbs; p points to the data member. */
+static void
+uncompress_cache_data_free_cb(void *p)
+{
+    uncompress_cache_data_unref((uncompress_cache_data_t *)
+            ((uint8_t *)p - offsetof(uncompress_cache_data_t, data)));
+}
+
+static tvbuff_t *
+uncompress_cache_new_tvb(tvbuff_t *parent, const uncompress_cache_entry_t *entry)
+{
+    tvbuff_t *tvb;
+
+    tvb = tvb_new_child_real_data(parent, entry->data->data, entry->len, entry->len);
+    entry->data->ref_count++;
+    tvb_set_free_cb(tvb, uncompress_cache_data_free_cb);
+    return tvb;
+}
+
+static inline size_t
+uncompress_cache_entry_size(const uncompress_cache_entry_t *entry)
+{
+    return sizeof(uncompress_cache_entry_t) + entry->key.comprlen + entry->len;
+}
+
+/* Called when an entry is dropped or the cache is destroyed. */
+static void
+uncompress_cache_entry_free(void *p)
+{
+    uncompress_cache_entry_t *entry = (uncompress_cache_entry_t *)p;
+
+    uncompress_cache_memory -= uncompress_cache_entry_size(entry);
+    wmem_owner_sub(uncompress_cache_owner, WMEM_ACCOUNTING_FILE_SCOPE,
+                   uncompress_cache_entry_size(entry));
+    g_free((uint8_t *)entry->key.input);
+    if (entry->data)
+        uncompress_cache_data_unref(entry->data);
+    g_free(entry);
+}
+
+static void
+lru_unlink(uncompress_cache_entry_t *entry)
+{
+    if (entry->prev)
+        entry->prev->next = entry->next;
+    else
+        lru_head = entry->next;
+    if (entry->next)
+        entry->next->prev = entry->prev;
+    else
+        lru_tail = entry->prev;
+    entry->prev = entry->next = NULL;
+}
+
+static void
+lru_push(uncompress_cache_entry_t *entry)
+{
+    entry->prev = NULL;
+    entry->next = lru_head;
+    if (lru_head)
+        lru_head->prev = entry;
+    else
+        lru_tail = entry;
+    lru_head = entry;
+}
+
+/*
+ * Drop the least recently used entries until there's room for the
+ * given number of bytes.
+ */
+static void
+uncompress_cache_make_room(size_t limit, size_t size)
+{
+    while (lru_tail != NULL && uncompress_cache_memory + size > limit) {
+        uncompress_cache_entry_t *entry = lru_tail;
+
+        lru_unlink(entry);
+        g_hash_table_remove(uncompress_cache, &entry->key);
+    }
+}
+
+tvbuff_t *
+tvb_child_uncompress_cached(packet_info *pinfo, tvbuff_t *parent, tvbuff_t *tvb,
+        const int offset, int comprlen, tvb_uncompress_func func)
+{
+    size_t limit = (size_t)prefs.uncompress_cache_limit * 1024 * 1024;
+    uncompress_cache_key_t key;
+    uncompress_cache_entry_t *entry;
+    tvbuff_t *uncompr_tvb;
+    unsigned len;
+
+    if (limit == 0 || uncompress_cache == NULL || comprlen <= 0 ||
+            !tvb_bytes_exist(tvb, offset, comprlen)) {
+        uncompr_tvb = func(tvb, offset, comprlen);
+        if (uncompr_tvb)
+            tvb_set_child_real_data_tvbuff(parent, uncompr_tvb);
+        return uncompr_tvb;
+    }
+
+    key.frame = pinfo->num;
+    key.layer = pinfo->curr_layer_num;
+    key.position = tvb_raw_offset(tvb) + offset;
+    key.comprlen = comprlen;
+    key.func = func;
+    key.input = tvb_get_ptr(tvb, offset, comprlen);
+    key.input_crc = crc32c_calculate_no_swap(key.input, comprlen, CRC32C_PRELOAD);
+
+    entry = (uncompress_cache_entry_t *)g_hash_table_lookup(uncompress_cache, &key);
+    if (entry != NULL) {
+        lru_unlink(entry);
+        lru_push(entry);
+        if (entry->data == NULL)
+            return NULL;
+        return uncompress_cache_new_tvb(parent, entry);
+    }
+
+    uncompr_tvb = func(tvb, offset, comprlen);
+    len = uncompr_tvb ? tvb_captured_length(uncompr_tvb) : 0;
+
+    /*
+     * Something that doesn't fit at all is just not cached, and neither
+     * is empty output, which would look like a failure.
+     */
+    if (sizeof(uncompress_cache_entry_t) + (size_t)comprlen + len > limit ||
+            (uncompr_tvb && len == 0)) {
+        if (uncompr_tvb)
+            tvb_set_child_real_data_tvbuff(parent, uncompr_tvb);
+        return uncompr_tvb;
+    }
+
+    entry = g_new0(uncompress_cache_entry_t, 1);
+    entry->key = key;
+    entry->key.input = (const uint8_t *)g_memdup2(key.input, comprlen);
+    if (uncompr_tvb) {
+        /* Keep the data in one place, shared with the cache. */
+        entry->len = len;
+        entry->data = (uncompress_cache_data_t *)g_malloc(sizeof(uncompress_cache_data_t) + len);
+        entry->data->ref_count = 1;
+        tvb_memcpy(uncompr_tvb, entry->data->data, 0, len);
+        tvb_free(uncompr_tvb);
+    }
+
+    uncompress_cache_make_room(limit, uncompress_cache_entry_size(entry));
+    uncompress_cache_memory += uncompress_cache_entry_size(entry);
+    wmem_owner_add(uncompress_cache_owner, WMEM_ACCOUNTING_FILE_SCOPE,
+                   uncompress_cache_entry_size(entry));
+    g_hash_table_insert(uncompress_cache, &entry->key, entry);
+    lru_push(entry);
+
+    if (entry->data == NULL)
+        return NULL;
+    return uncompress_cache_new_tvb(parent, entry);
+}
+
+static void
+uncompress_cache_init_routine(void)
+{
+    uncompress_cache = g_hash_table_new_full(uncompress_cache_key_hash,
+            uncompress_cache_key_equal, NULL, uncompress_cache_entry_free);
+}
+
+static void
+uncompress_cache_cleanup_routine(void)
+{
+    if (uncompress_cache) {
+        g_hash_table_destroy(uncompress_cache);
+        uncompress_cache = NULL;
+    }
+    lru_head = lru_tail = NULL;
+    uncompress_cache_memory = 0;
+}
+
+void
+uncompress_cache_init(void)
+{
+    uncompress_cache_owner = wmem_owner_new("Decompressed data");
+    register_init_routine(&uncompress_cache_init_routine);
+    register_cleanup_routine(&uncompress_cache_cleanup_routine);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,74 @@
+/** @file
+ * Cache of decompressed data, so that it isn't decompressed again
+ * every time a frame is dissected.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __UNCOMPRESS_CACHE_H__
+#define __UNCOMPRESS_CACHE_H__
+
+#include <epan/packet_info.h>
+#include <epan/tvbuff.h>
+#include "ws_symbol_export.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/**
+ * A decompression function, such as tvb_uncompress_zlib().
+ */
+typedef tvbuff_t *(*tvb_uncompress_func)(tvbuff_t *tvb, const int offset, int comprlen);
+
+/**
+ * Decompress data with the given function and attach the result to
+ * parent, like tvb_child_uncompress_zlib() and its siblings do, but keep
+ * the result in a cache, so that the data isn't decompressed again when
+ * the frame is dissected again, e.g. when it's selected, when a filter
+ * is applied or when objects are exported.
+ *
+ * The cache lasts until the capture file is closed, and its size is
+ * limited by the "protocols.uncompress_cache_limit" preference; when it
+ * is full, the data that was used least recently is dropped. Failures
+ * are cached too.
+ *
+ * Data is looked up by the frame, the protocol layer, the position of
+ * the compressed data in its data source, the compressed data itself
+ * and the function. The returned tvb shares the data with the cache,
+ * and it stays valid after the entry is dropped from the cache.
+ *
+ * @param pinfo The packet info of the frame being dissected.
+ * @param parent The tvb to which the result is attached.
+ * @param tvb The tvb with the compressed data.
+ * @param offset The offset of the compressed data in tvb.
+ * @param comprlen The length of the compressed data.
+ * @param func The decompression function.
+ * @return The decompressed data, or NULL if decompression failed.
+ */
+WS_DLL_PUBLIC tvbuff_t *
+tvb_child_uncompress_cached(packet_info *pinfo, tvbuff_t *parent, tvbuff_t *tvb,
+        const int offset, int comprlen, tvb_uncompress_func func);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __UNCOMPRESS_CACHE_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -67,6 +67,7 @@ wmem_leave_packet_scope(void)
     ws_assert(wmem_in_scope(packet_scope));
 
     wmem_leave_scope(packet_scope);
+    wmem_accounting_reset(WMEM_ACCOUNTING_PACKET_SCOPE);
 }
 
 /* File Scope */
@@ -96,6 +97,7 @@ wmem_leave_file_scope(void)
     ws_assert(!wmem_in_scope(packet_scope));
 
     wmem_leave_scope(file_scope);
+    wmem_accounting_reset(WMEM_ACCOUNTING_FILE_SCOPE);
 
     /* this seems like a good time to do garbage collection */
     wmem_gc(file_scope);
@@ -112,6 +114,23 @@ wmem_epan_scope(void)
     return epan_scope;
 }
 
+/* Accounting */
+
+const char *
+wmem_accounting_scope_name(wmem_accounting_scope_t scope)
+{
+    switch (scope) {
+        case WMEM_ACCOUNTING_EPAN_SCOPE:
+            return "Epan scope";
+        case WMEM_ACCOUNTING_FILE_SCOPE:
+            return "File scope";
+        case WMEM_ACCOUNTING_PACKET_SCOPE:
+            return "Packet scope";
+        default:
+            return "Unknown scope";
+    }
+}
+
 /* Scope Management */
 
 void
@@ -127,6 +146,10 @@ wmem_init_scopes(void)
     file_scope   = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
     epan_scope   = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
 
+    wmem_allocator_set_accounting_scope(packet_scope, WMEM_ACCOUNTING_PACKET_SCOPE);
+    wmem_allocator_set_accounting_scope(file_scope, WMEM_ACCOUNTING_FILE_SCOPE);
+    wmem_allocator_set_accounting_scope(epan_scope, WMEM_ACCOUNTING_EPAN_SCOPE);
+
     /* Scopes are initialized to true by default on creation */
     wmem_leave_scope(packet_scope);
     wmem_leave_scope(file_scope);
@@ -63,6 +63,26 @@ WS_DLL_LOCAL
 void
 wmem_leave_file_scope(void);
 
+/**
+ * @brief Accounting scopes of the global scopes and pinfo->pool.
+ *
+ * See wmem_allocator_set_accounting_scope(). pinfo->pool is counted
+ * with the packet scope.
+ */
+typedef enum {
+    WMEM_ACCOUNTING_EPAN_SCOPE,
+    WMEM_ACCOUNTING_FILE_SCOPE,
+    WMEM_ACCOUNTING_PACKET_SCOPE,
+    WMEM_ACCOUNTING_NUM_SCOPES
+} wmem_accounting_scope_t;
+
+/**
+ * @brief The name of an accounting scope, for reports.
+ */
+WS_DLL_PUBLIC
+const char *
+wmem_accounting_scope_name(wmem_accounting_scope_t scope);
+
 /* Scope Management */
 
 WS_DLL_PUBLIC
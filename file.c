@@ -1228,12 +1228,12 @@ add_packet_to_packet_list(frame_data *fdata, capture_file *cf,
     if (fdata->passed_dfilter && dfcode != NULL) {
         fdata->passed_dfilter = dfilter_apply_edt(dfcode, edt) ? 1 : 0;
 
-        if (fdata->passed_dfilter && edt->pi.fd->dependent_frames) {
+        if (fdata->passed_dfilter && frame_data_get_dependent_frames(edt->pi.fd)) {
             /* This frame passed the display filter but it may depend on other
              * (potentially not displayed) frames.  Find those frames and mark them
              * as depended upon.
              */
-            g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+            g_hash_table_foreach(frame_data_get_dependent_frames(edt->pi.fd), find_and_mark_frame_depended_upon, cf->provider.frames);
         }
     }
 
@@ -5200,9 +5200,9 @@ save_record(capture_file *cf, frame_data *fdata, wtap_rec *rec, void *argsp)
     new_rec.block  = pkt_block;
     new_rec.block_was_modified = fdata->has_modified_block ? true : false;
 
-    if (!nstime_is_zero(&fdata->shift_offset)) {
+    if (!nstime_is_zero(frame_data_get_shift_offset(fdata))) {
         if (new_rec.presence_flags & WTAP_HAS_TS) {
-            nstime_add(&new_rec.ts, &fdata->shift_offset);
+            nstime_add(&new_rec.ts, frame_data_get_shift_offset(fdata));
         }
     }
 
@@ -5225,7 +5225,8 @@ save_record(capture_file *cf, frame_data *fdata, wtap_rec *rec, void *argsp)
      * If we're exporting to a different file, then don't do that.
      */
     if (!args->export && new_rec.presence_flags & WTAP_HAS_TS) {
-        nstime_set_zero(&fdata->shift_offset);
+        nstime_t no_shift = NSTIME_INIT_ZERO;
+        frame_data_set_shift_offset(fdata, &no_shift);
     }
 
     return true;
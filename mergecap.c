@@ -46,6 +46,7 @@
 #include "ui/failure_message.h"
 
 #define LONGOPT_COMPRESS                LONGOPT_BASE_APPLICATION+1
+#define LONGOPT_COMPRESS_THREADS        LONGOPT_BASE_APPLICATION+2
 
 /*
  * Show the usage
@@ -67,6 +68,8 @@ print_usage(FILE *output)
     fprintf(output, "  -I <IDB merge mode> set the merge mode for Interface Description Blocks; default is 'all'.\n");
     fprintf(output, "                    an empty \"-I\" option will list the merge modes.\n");
     fprintf(output, "  --compress <type> compress the output file using the type compression format.\n");
+    fprintf(output, "  --compress-threads <n> use <n> threads to compress the output file;\n");
+    fprintf(output, "                    0 is one per processor, default is 1.\n");
     fprintf(output, "\n");
     fprintf(output, "Miscellaneous:\n");
     fprintf(output, "  -h, --help        display this help and exit.\n");
@@ -187,6 +190,7 @@ main(int argc, char *argv[])
         {"help", ws_no_argument, NULL, 'h'},
         {"version", ws_no_argument, NULL, 'v'},
         {"compress", ws_required_argument, NULL, LONGOPT_COMPRESS},
+        {"compress-threads", ws_required_argument, NULL, LONGOPT_COMPRESS_THREADS},
         LONGOPT_WSLOG
         {0, 0, 0, 0 }
     };
@@ -196,6 +200,7 @@ main(int argc, char *argv[])
     bool                  verbose          = false;
     int                   in_file_count    = 0;
     uint32_t              snaplen          = 0;
+    uint32_t              compress_threads;
     int                   file_type        = WTAP_FILE_TYPE_SUBTYPE_UNKNOWN;
     char                  *out_filename    = NULL;
     bool                  status           = true;
@@ -309,6 +314,14 @@ main(int argc, char *argv[])
                     goto clean_exit;
                 }
                 break;
+
+            case LONGOPT_COMPRESS_THREADS:
+                if (!get_uint32(ws_optarg, "number of compression threads", &compress_threads)) {
+                    status = false;
+                    goto clean_exit;
+                }
+                wtap_set_compression_threads(compress_threads);
+                break;
             case '?':              /* Bad options if GNU getopt */
             default:
                 /* wslog arguments are okay */
@@ -12,6 +12,7 @@
 
 #include "config.h"
 
+#include <epan/packet.h>
 #include <epan/stats_tree.h>
 #include <epan/prefs.h>
 #include <epan/uat-int.h>
@@ -314,6 +315,149 @@ static tap_packet_status plen_stats_tree_packet(stats_tree *st, packet_info *pin
 	return TAP_PACKET_REDRAW;
 }
 
+/* memory usage stats_tree -- counts kept by wmem, see wmem_accounting.h */
+static const char *st_str_mem = "Memory Usage";
+static const char *st_str_mem_bytes = "Allocated KiB";
+static const char *st_str_mem_objects = "Allocations";
+static int st_node_mem_bytes = -1;
+static int st_node_mem_objects = -1;
+static unsigned mem_sample_rate = 1;
+
+/* Bytes and objects for each scope, for the scope totals and then for
+ * each owner. The trees keep the counts they show, so that only the
+ * nodes that changed have to be updated for each packet. The packet
+ * scope counts are reset after each packet, so the trees add them up. */
+#define MEM_COUNTS (WMEM_ACCOUNTING_NUM_SCOPES * 2)
+typedef struct {
+	GArray *shown;		/* uint64_t, MEM_COUNTS for the totals and for each owner */
+	GArray *packet_sums;	/* uint64_t, bytes and objects for each owner */
+} mem_tree_counts_t;
+static GHashTable *mem_trees;		/* stats_tree -> mem_tree_counts_t */
+static bool mem_accounting_started;
+
+static void mem_counts_free(void *p) {
+	mem_tree_counts_t *tc = (mem_tree_counts_t *)p;
+
+	g_array_free(tc->shown, true);
+	g_array_free(tc->packet_sums, true);
+	g_free(tc);
+}
+
+static void mem_stats_tree_init(stats_tree *st) {
+	st_node_mem_bytes = stats_tree_create_node(st, st_str_mem_bytes, 0, STAT_DT_INT, true);
+	st_node_mem_objects = stats_tree_create_node(st, st_str_mem_objects, 0, STAT_DT_INT, true);
+
+	/* The tree is empty, so everything has to be shown again */
+	if (mem_trees == NULL)
+		mem_trees = g_hash_table_new_full(NULL, NULL, NULL, mem_counts_free);
+	mem_tree_counts_t *tc = g_new(mem_tree_counts_t, 1);
+	tc->shown = g_array_new(false, true, sizeof(uint64_t));
+	tc->packet_sums = g_array_new(false, true, sizeof(uint64_t));
+	g_hash_table_replace(mem_trees, st, tc);
+
+	/* Counting may already have been started with WIRESHARK_MEM_ACCOUNTING */
+	if (dissector_mem_accounting_get_sample_rate() == 0) {
+		dissector_mem_accounting_set_sample_rate(mem_sample_rate > 0 ? mem_sample_rate : 1);
+		mem_accounting_started = true;
+	}
+}
+
+static void mem_stats_tree_cleanup(stats_tree *st) {
+	g_hash_table_remove(mem_trees, st);
+	if (g_hash_table_size(mem_trees) == 0 && mem_accounting_started) {
+		dissector_mem_accounting_set_sample_rate(0);
+		mem_accounting_started = false;
+	}
+}
+
+static bool mem_counts_update(uint64_t *shown, unsigned scope, uint64_t bytes, uint64_t objects) {
+	if (shown[scope * 2] == bytes && shown[scope * 2 + 1] == objects)
+		return false;
+	shown[scope * 2] = bytes;
+	shown[scope * 2 + 1] = objects;
+	return true;
+}
+
+static int mem_kib(uint64_t bytes) {
+	bytes = (bytes + 1023) / 1024;
+	return bytes > INT_MAX ? INT_MAX : (int)bytes;
+}
+
+static int mem_count(uint64_t count) {
+	return count > INT_MAX ? INT_MAX : (int)count;
+}
+
+static tap_packet_status mem_stats_tree_packet(stats_tree *st, packet_info *pinfo _U_, epan_dissect_t *edt _U_, const void *p _U_, tap_flags_t flags _U_) {
+	mem_tree_counts_t *tc = (mem_tree_counts_t *)g_hash_table_lookup(mem_trees, st);
+	unsigned num_owners = wmem_owner_count();
+	uint64_t totals[MEM_COUNTS] = { 0 };
+	int bytes_nodes[WMEM_ACCOUNTING_NUM_SCOPES];
+	int objects_nodes[WMEM_ACCOUNTING_NUM_SCOPES];
+	const wmem_owner_t *owner;
+	const char *scope_name;
+	uint64_t *counts, *sums, bytes, objects;
+	unsigned i, scope;
+
+	if (tc->shown->len < (num_owners + 1) * MEM_COUNTS)
+		g_array_set_size(tc->shown, (num_owners + 1) * MEM_COUNTS);
+	if (tc->packet_sums->len < num_owners * 2)
+		g_array_set_size(tc->packet_sums, num_owners * 2);
+	counts = (uint64_t *)(void *)tc->shown->data;
+	sums = (uint64_t *)(void *)tc->packet_sums->data;
+
+	/* This packet's allocations so far; the counts are reset after it */
+	for (i = 0; i < num_owners; i++) {
+		owner = wmem_owner_get(i);
+		sums[i * 2] += owner->bytes[WMEM_ACCOUNTING_PACKET_SCOPE];
+		sums[i * 2 + 1] += owner->objects[WMEM_ACCOUNTING_PACKET_SCOPE];
+	}
+
+	for (i = 0; i < num_owners; i++) {
+		owner = wmem_owner_get(i);
+		for (scope = 0; scope < WMEM_ACCOUNTING_NUM_SCOPES; scope++) {
+			if (scope == WMEM_ACCOUNTING_PACKET_SCOPE) {
+				totals[scope * 2] += sums[i * 2];
+				totals[scope * 2 + 1] += sums[i * 2 + 1];
+			} else {
+				totals[scope * 2] += owner->bytes[scope];
+				totals[scope * 2 + 1] += owner->objects[scope];
+			}
+		}
+	}
+
+	for (scope = 0; scope < WMEM_ACCOUNTING_NUM_SCOPES; scope++) {
+		if (!mem_counts_update(counts, scope, totals[scope * 2], totals[scope * 2 + 1])) {
+			bytes_nodes[scope] = -1;
+			continue;
+		}
+		scope_name = wmem_accounting_scope_name((wmem_accounting_scope_t)scope);
+		bytes_nodes[scope] = set_stat_node(st, scope_name, st_node_mem_bytes, true, mem_kib(totals[scope * 2]));
+		objects_nodes[scope] = set_stat_node(st, scope_name, st_node_mem_objects, true, mem_count(totals[scope * 2 + 1]));
+	}
+
+	for (i = 0; i < num_owners; i++) {
+		owner = wmem_owner_get(i);
+		for (scope = 0; scope < WMEM_ACCOUNTING_NUM_SCOPES; scope++) {
+			/* An owner's counts can only change along with the total */
+			if (bytes_nodes[scope] < 0)
+				continue;
+			if (scope == WMEM_ACCOUNTING_PACKET_SCOPE) {
+				bytes = sums[i * 2];
+				objects = sums[i * 2 + 1];
+			} else {
+				bytes = owner->bytes[scope];
+				objects = owner->objects[scope];
+			}
+			if (!mem_counts_update(counts + (i + 1) * MEM_COUNTS, scope, bytes, objects))
+				continue;
+			set_stat_node(st, owner->name, bytes_nodes[scope], false, mem_kib(bytes));
+			set_stat_node(st, owner->name, objects_nodes[scope], false, mem_count(objects));
+		}
+	}
+
+	return TAP_PACKET_REDRAW;
+}
+
 /* register all pinfo trees */
 void register_tap_listener_pinfo_stat_tree(void)
 {
@@ -340,6 +484,10 @@ void register_tap_listener_pinfo_stat_tree(void)
 	stats_tree_cfg *st_config = stats_tree_register("frame", "plen", st_str_plen, 0, plen_stats_tree_packet, plen_stats_tree_init, NULL);
 	stats_tree_set_group(st_config, REGISTER_STAT_GROUP_GENERIC);
 
+	st_config = stats_tree_register("frame", "mem", st_str_mem, 0, mem_stats_tree_packet, mem_stats_tree_init, mem_stats_tree_cleanup);
+	stats_tree_set_group(st_config, REGISTER_STAT_GROUP_GENERIC);
+	stats_tree_set_first_column_name(st_config, "Scope / Owner");
+
 	stat_module = prefs_register_stat("stat_tree", "Stats Tree", "Stats Tree", NULL);
 
 	plen_uat = uat_new("Packet Lengths",
@@ -359,6 +507,12 @@ void register_tap_listener_pinfo_stat_tree(void)
 
 	prefs_register_uat_preference(stat_module, "packet_lengths",
 		"Packet Lengths", "Delineated packet sizes to count", plen_uat);
+
+	prefs_register_uint_preference(stat_module, "mem_sample_rate",
+		"Memory Usage sample rate",
+		"Count only one in this many memory allocations for the Memory Usage statistics, "
+		"which is faster but less exact. 1 counts all of them.",
+		10, &mem_sample_rate);
 }
 
 /*
@@ -11,6 +11,7 @@
 #include <config.h>
 #define WS_LOG_DOMAIN  LOG_DOMAIN_MAIN
 
+#include <errno.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,6 +21,7 @@
 #include <wsutil/ws_getopt.h>
 
 #include <wiretap/wtap.h>
+#include <wiretap/merge.h>
 
 #include <wsutil/cmdarg_err.h>
 #include <wsutil/filesystem.h>
@@ -50,6 +52,11 @@ print_usage(FILE *output)
     fprintf(output, "\n");
     fprintf(output, "Options:\n");
     fprintf(output, "  -n                don't write to output file if the input file is ordered.\n");
+    fprintf(output, "  -w <frames>       sort in a window of the given number of frames, reading\n");
+    fprintf(output, "                    and writing sequentially; frames further out of order\n");
+    fprintf(output, "                    are sorted through temporary files.\n");
+    fprintf(output, "  -t <seconds>      like -w, but write a frame once a frame that is at least\n");
+    fprintf(output, "                    the given number of seconds later has been read.\n");
     fprintf(output, "  -h, --help        display this help and exit.\n");
     fprintf(output, "  -v, --version     print version information and exit.\n");
 }
@@ -133,6 +140,374 @@ frames_compare(const void *a, const void *b)
     return nstime_cmp(time1, time2);
 }
 
+/********************************************************************/
+/* Streaming mode.                                                  */
+/*                                                                  */
+/* The frames are read sequentially and held in a min-heap until    */
+/* the window is full, and then the earliest one is written. That   */
+/* puts the frames in order as long as no frame is further out of   */
+/* place than the window, needs no seeking, so that it works with   */
+/* pipes, and only keeps the window in memory.                      */
+/*                                                                  */
+/* A frame that is earlier than one already written can't go into   */
+/* the current output any more. It is held back for the next "run"  */
+/* instead, which is written to a temporary file once the frames of */
+/* the current run are gone from the window, and at the end all the */
+/* runs are merged into the output file. That's an external merge   */
+/* sort with replacement selection, so a window that is too small   */
+/* costs time and disk space, but the output is still in order.     */
+/********************************************************************/
+
+/* A frame in the window */
+typedef struct WindowFrame_t {
+    wtap_rec     rec;
+    unsigned     num;
+    unsigned     run;
+
+    nstime_t     frame_time;
+} WindowFrame_t;
+
+/* Ordered by run, then timestamp, then position in the input file, so
+   that frames with the same timestamp are left in their original order,
+   as g_ptr_array_sort() does. */
+static int
+window_frames_compare(const WindowFrame_t *frame1, const WindowFrame_t *frame2)
+{
+    int cmp;
+
+    if (frame1->run != frame2->run)
+        return frame1->run < frame2->run ? -1 : 1;
+    cmp = nstime_cmp(&frame1->frame_time, &frame2->frame_time);
+    if (cmp != 0)
+        return cmp;
+    if (frame1->num != frame2->num)
+        return frame1->num < frame2->num ? -1 : 1;
+    return 0;
+}
+
+static void
+window_push(GPtrArray *heap, WindowFrame_t *frame)
+{
+    unsigned pos = heap->len;
+
+    g_ptr_array_add(heap, frame);
+    while (pos > 0) {
+        unsigned parent = (pos - 1) / 2;
+        WindowFrame_t *parent_frame = (WindowFrame_t *)heap->pdata[parent];
+
+        if (window_frames_compare(parent_frame, frame) <= 0)
+            break;
+        heap->pdata[pos] = parent_frame;
+        pos = parent;
+    }
+    heap->pdata[pos] = frame;
+}
+
+static WindowFrame_t *
+window_pop(GPtrArray *heap)
+{
+    WindowFrame_t *top = (WindowFrame_t *)heap->pdata[0];
+    WindowFrame_t *last = (WindowFrame_t *)g_ptr_array_steal_index_fast(heap, heap->len - 1);
+    unsigned pos = 0;
+
+    if (heap->len == 0)
+        return top;
+    for (;;) {
+        unsigned child = 2 * pos + 1;
+        WindowFrame_t *child_frame;
+
+        if (child >= heap->len)
+            break;
+        child_frame = (WindowFrame_t *)heap->pdata[child];
+        if (child + 1 < heap->len &&
+            window_frames_compare((WindowFrame_t *)heap->pdata[child + 1], child_frame) < 0) {
+            child++;
+            child_frame = (WindowFrame_t *)heap->pdata[child];
+        }
+        if (window_frames_compare(last, child_frame) <= 0)
+            break;
+        heap->pdata[pos] = child_frame;
+        pos = child;
+    }
+    heap->pdata[pos] = last;
+    return top;
+}
+
+static void
+window_frame_free(void *data)
+{
+    WindowFrame_t *frame = (WindowFrame_t *)data;
+
+    wtap_rec_cleanup(&frame->rec);
+    g_free(frame);
+}
+
+/* Should the earliest frame in the window be written? */
+static bool
+window_full(GPtrArray *heap, unsigned window_frames, const nstime_t *window_time,
+            const nstime_t *latest)
+{
+    const WindowFrame_t *top = (const WindowFrame_t *)heap->pdata[0];
+    nstime_t age;
+
+    if (window_frames != 0 && heap->len > window_frames)
+        return true;
+    if (nstime_is_unset(window_time))
+        return false;
+    /* Frames without a time stamp sort first anyway */
+    if (nstime_is_unset(&top->frame_time))
+        return true;
+    nstime_delta(&age, latest, &top->frame_time);
+    return nstime_cmp(&age, window_time) >= 0;
+}
+
+typedef struct {
+    wtap           *wth;
+    const char     *infile;
+    const char     *outfile;
+    wtap_dump_params *params;
+
+    wtap_dumper    *pdh;
+    const char     *pdh_filename;   /* outfile, or the current run's file */
+    unsigned        run;
+    GPtrArray      *run_files;      /* temporary files of the runs after the first */
+    nstime_t        last_written;
+} ReorderStream_t;
+
+/* Start writing the next run to a temporary file */
+static bool
+stream_next_run(ReorderStream_t *stream)
+{
+    int    err;
+    char   *err_info;
+    char   *run_file;
+
+    if (!wtap_dump_close(stream->pdh, NULL, &err, &err_info)) {
+        cfile_close_failure_message(stream->pdh_filename, err, err_info);
+        stream->pdh = NULL;
+        return false;
+    }
+    stream->pdh = NULL;
+
+    if (strcmp(stream->outfile, "-") == 0) {
+        cmdarg_err("The input is too far out of order to be sorted within the window "
+                   "when writing to the standard output; use a larger window.");
+        return false;
+    }
+
+    stream->pdh = wtap_dump_open_tempfile(NULL, &run_file, "reordercap",
+                                          wtap_file_type_subtype(stream->wth),
+                                          WTAP_UNCOMPRESSED, stream->params,
+                                          &err, &err_info);
+    if (stream->pdh == NULL) {
+        cfile_dump_open_failure_message(run_file ? run_file : "temporary file",
+                                        err, err_info,
+                                        wtap_file_type_subtype(stream->wth));
+        g_free(run_file);
+        return false;
+    }
+    g_ptr_array_add(stream->run_files, run_file);
+    stream->pdh_filename = run_file;
+    stream->run++;
+    return true;
+}
+
+static bool
+stream_write(ReorderStream_t *stream, WindowFrame_t *frame)
+{
+    int    err;
+    char   *err_info;
+
+    if (frame->run != stream->run && !stream_next_run(stream))
+        return false;
+
+    if (!wtap_dump(stream->pdh, &frame->rec, &err, &err_info)) {
+        cfile_write_failure_message(stream->infile, stream->pdh_filename, err,
+                                    err_info, frame->num,
+                                    wtap_file_type_subtype(stream->wth));
+        return false;
+    }
+    stream->last_written = frame->frame_time;
+    return true;
+}
+
+/* Merge the output file with the later runs */
+static bool
+stream_merge_runs(ReorderStream_t *stream)
+{
+    const char **in_filenames;
+    char *out_dir;
+    char *merged_file = NULL;
+    bool ok;
+
+    in_filenames = g_new(const char *, stream->run_files->len + 1);
+    in_filenames[0] = stream->outfile;
+    for (unsigned i = 0; i < stream->run_files->len; i++)
+        in_filenames[i + 1] = (const char *)stream->run_files->pdata[i];
+
+    /* Merge into the output file's directory, so that it can be renamed */
+    out_dir = g_path_get_dirname(stream->outfile);
+    ok = merge_files_to_tempfile(out_dir, &merged_file, "reordercap",
+                                 wtap_file_type_subtype(stream->wth),
+                                 in_filenames, stream->run_files->len + 1,
+                                 false, IDB_MERGE_MODE_ALL_SAME, 0,
+                                 get_appname_and_version(), NULL);
+    if (ok && ws_rename(merged_file, stream->outfile) != 0) {
+        rename_failure_message(merged_file, stream->outfile, errno);
+        ok = false;
+    }
+    if (!ok && merged_file != NULL)
+        ws_unlink(merged_file);
+
+    g_free(merged_file);
+    g_free(out_dir);
+    g_free(in_filenames);
+    return ok;
+}
+
+static int
+reorder_stream(wtap *wth, const char *infile, const char *outfile,
+               unsigned window_frames, const nstime_t *window_time)
+{
+    ReorderStream_t stream;
+    wtap_dump_params params;
+    GPtrArray *heap;
+    GPtrArray *spare;
+    WindowFrame_t *frame;
+    nstime_t prev_time;
+    nstime_t latest;
+    unsigned frame_count = 0;
+    unsigned wrong_order_count = 0;
+    int err;
+    char *err_info;
+    int64_t data_offset;
+    FILE *msg;
+    int ret = EXIT_SUCCESS;
+
+    wtap_dump_params_init(&params, wth);
+
+    memset(&stream, 0, sizeof stream);
+    stream.wth = wth;
+    stream.infile = infile;
+    stream.outfile = outfile;
+    stream.params = &params;
+    stream.run_files = g_ptr_array_new_with_free_func(g_free);
+    nstime_set_unset(&stream.last_written);
+    nstime_set_unset(&prev_time);
+    nstime_set_unset(&latest);
+
+    /* Open outfile (same filetype/encap as input file) */
+    if (strcmp(outfile, "-") == 0) {
+        stream.pdh = wtap_dump_open_stdout(wtap_file_type_subtype(wth),
+                                           WTAP_UNCOMPRESSED, &params, &err, &err_info);
+    } else {
+        stream.pdh = wtap_dump_open(outfile, wtap_file_type_subtype(wth),
+                                    WTAP_UNCOMPRESSED, &params, &err, &err_info);
+    }
+    if (stream.pdh == NULL) {
+        cfile_dump_open_failure_message(outfile, err, err_info,
+                                        wtap_file_type_subtype(wth));
+        g_ptr_array_free(stream.run_files, TRUE);
+        wtap_dump_params_cleanup(&params);
+        return OUTPUT_FILE_ERROR;
+    }
+    stream.pdh_filename = outfile;
+
+    heap = g_ptr_array_new_with_free_func(window_frame_free);
+    spare = g_ptr_array_new_with_free_func(window_frame_free);
+
+    for (;;) {
+        if (spare->len > 0) {
+            frame = (WindowFrame_t *)g_ptr_array_steal_index_fast(spare, spare->len - 1);
+        } else {
+            frame = g_new(WindowFrame_t, 1);
+            wtap_rec_init(&frame->rec, 1514);
+        }
+        if (!wtap_read(wth, &frame->rec, &err, &err_info, &data_offset)) {
+            window_frame_free(frame);
+            break;
+        }
+
+        frame->num = ++frame_count;
+        if (frame->rec.presence_flags & WTAP_HAS_TS) {
+            frame->frame_time = frame->rec.ts;
+        } else {
+            nstime_set_unset(&frame->frame_time);
+        }
+        if (frame_count > 1 && nstime_cmp(&frame->frame_time, &prev_time) < 0) {
+            wrong_order_count++;
+        }
+        prev_time = frame->frame_time;
+
+        /* Too late for the current run? */
+        frame->run = stream.run;
+        if (!nstime_is_unset(&stream.last_written) &&
+            nstime_cmp(&frame->frame_time, &stream.last_written) < 0) {
+            frame->run++;
+        }
+        window_push(heap, frame);
+
+        if (nstime_cmp(&frame->frame_time, &latest) > 0)
+            latest = frame->frame_time;
+
+        /* Write out what has left the window */
+        while (heap->len > 0 && window_full(heap, window_frames, window_time, &latest)) {
+            WindowFrame_t *top;
+
+            top = window_pop(heap);
+            if (!stream_write(&stream, top)) {
+                window_frame_free(top);
+                ret = OUTPUT_FILE_ERROR;
+                goto done;
+            }
+            wtap_rec_reset(&top->rec);
+            g_ptr_array_add(spare, top);
+        }
+    }
+    if (err != 0) {
+        /* Print a message noting that the read failed somewhere along the line. */
+        cfile_read_failure_message(infile, err, err_info);
+    }
+
+    /* Flush the window */
+    while (heap->len > 0) {
+        frame = window_pop(heap);
+        if (!stream_write(&stream, frame)) {
+            window_frame_free(frame);
+            ret = OUTPUT_FILE_ERROR;
+            goto done;
+        }
+        window_frame_free(frame);
+    }
+
+done:
+    if (stream.pdh != NULL &&
+        !wtap_dump_close(stream.pdh, NULL, &err, &err_info)) {
+        cfile_close_failure_message(stream.pdh_filename, err, err_info);
+        ret = OUTPUT_FILE_ERROR;
+    }
+
+    if (ret == EXIT_SUCCESS && stream.run_files->len > 0 &&
+        !stream_merge_runs(&stream)) {
+        ret = OUTPUT_FILE_ERROR;
+    }
+    for (unsigned i = 0; i < stream.run_files->len; i++)
+        ws_unlink((const char *)stream.run_files->pdata[i]);
+
+    /* Don't mix the counts with the frames */
+    msg = strcmp(outfile, "-") == 0 ? stderr : stdout;
+    fprintf(msg, "%u frames, %u out of order", frame_count, wrong_order_count);
+    if (stream.run_files->len > 0)
+        fprintf(msg, ", merged from %u runs", stream.run_files->len + 1);
+    fprintf(msg, "\n");
+
+    g_ptr_array_free(stream.run_files, TRUE);
+    g_ptr_array_free(spare, TRUE);
+    g_ptr_array_free(heap, TRUE);
+    wtap_dump_params_cleanup(&params);
+    return ret;
+}
+
 /********************************************************************/
 /* Main function.                                                   */
 /********************************************************************/
@@ -148,6 +523,10 @@ main(int argc, char *argv[])
     int64_t data_offset;
     unsigned wrong_order_count = 0;
     bool write_output_regardless = true;
+    bool stream_mode = false;
+    uint32_t window_frames = 0;
+    nstime_t window_time = NSTIME_INIT_UNSET;
+    double window_secs;
     unsigned i;
     wtap_dump_params params;
     int                          ret = EXIT_SUCCESS;
@@ -162,7 +541,7 @@ main(int argc, char *argv[])
         LONGOPT_WSLOG
         {0, 0, 0, 0 }
     };
-#define OPTSTRING "hnv"
+#define OPTSTRING "hnt:vw:"
     static const char optstring[] = OPTSTRING;
     int file_count;
     char *infile;
@@ -211,6 +590,22 @@ main(int argc, char *argv[])
             case 'n':
                 write_output_regardless = false;
                 break;
+            case 't':
+                if (!get_positive_double(ws_optarg, "time window", &window_secs)) {
+                    ret = WS_EXIT_INVALID_OPTION;
+                    goto clean_exit;
+                }
+                window_time.secs = (time_t)window_secs;
+                window_time.nsecs = (int)((window_secs - (double)window_time.secs) * 1000000000.0);
+                stream_mode = true;
+                break;
+            case 'w':
+                if (!get_nonzero_uint32(ws_optarg, "window size", &window_frames)) {
+                    ret = WS_EXIT_INVALID_OPTION;
+                    goto clean_exit;
+                }
+                stream_mode = true;
+                break;
             case 'h':
                 show_help_header("Reorder timestamps of input file frames into output file.");
                 print_usage(stdout);
@@ -242,6 +637,13 @@ main(int argc, char *argv[])
         goto clean_exit;
     }
 
+    /* The output is written while the input is still being read */
+    if (stream_mode && !write_output_regardless) {
+        cmdarg_err("-n can't be used with -w or -t.");
+        ret = WS_EXIT_INVALID_OPTION;
+        goto clean_exit;
+    }
+
     /* Open infile */
     /* TODO: if reordercap is ever changed to give the user a choice of which
        open_routine reader to use, then the following needs to change. */
@@ -253,6 +655,12 @@ main(int argc, char *argv[])
     }
     DEBUG_PRINT("file_type_subtype is %d\n", wtap_file_type_subtype(wth));
 
+    if (stream_mode) {
+        ret = reorder_stream(wth, infile, outfile, window_frames, &window_time);
+        wtap_close(wth);
+        goto clean_exit;
+    }
+
     /* Allocate the array of frame pointers. */
     frames = g_ptr_array_new();
 
@@ -77,6 +77,7 @@ typedef struct _ringbuf_data {
     bool          group_read_access;   /**< true if files need to be opened with group read access */
     FILE         *name_h;              /**< write names of completed files to this handle */
     const char   *compress_type;       /**< compress type */
+    size_t        async_buffer_size;   /**< if non-zero, files are written by a separate thread */
 } ringbuf_data;
 
 static ringbuf_data rb_data;
@@ -155,6 +156,7 @@ ringbuf_init(const char *capfile_name, unsigned num_files, bool group_read_acces
     rb_data.group_read_access = group_read_access;
     rb_data.name_h = NULL;
     rb_data.compress_type = compress_type;
+    rb_data.async_buffer_size = 0;
 
     /* just to be sure ... */
     if (num_files <= RINGBUFFER_MAX_NUM_FILES) {
@@ -286,12 +288,19 @@ ringbuf_current_filename(void)
 }
 
 /*
- * Calls ws_fdopen() for the current ringbuffer file
+ * Calls ws_fdopen() for the current ringbuffer file, and remembers
+ * whether this and the following files are to be written by a separate
+ * thread
  */
 pcapio_writer*
-ringbuf_init_libpcap_fdopen(int *err)
+ringbuf_init_libpcap_fdopen(size_t async_buffer_size, int *err)
 {
-    rb_data.pdh = writecap_fdopen(rb_data.fd, wtap_name_to_compression_type(rb_data.compress_type), err);
+    rb_data.async_buffer_size = async_buffer_size;
+    if (async_buffer_size != 0) {
+        rb_data.pdh = writecap_fdopen_async(rb_data.fd, async_buffer_size, err);
+    } else {
+        rb_data.pdh = writecap_fdopen(rb_data.fd, wtap_name_to_compression_type(rb_data.compress_type), err);
+    }
 
     return rb_data.pdh;
 }
@@ -332,7 +341,7 @@ ringbuf_switch_file(pcapio_writer* *pdh, char **save_file, int *save_file_fd, in
         return false;
     }
 
-    if (ringbuf_init_libpcap_fdopen(err) == NULL) {
+    if (ringbuf_init_libpcap_fdopen(rb_data.async_buffer_size, err) == NULL) {
         return false;
     }
 
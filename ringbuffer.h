@@ -28,7 +28,7 @@ int ringbuf_init(const char *capture_name, unsigned num_files, bool group_read_a
                  const char *compress_type, bool nametimenum);
 bool ringbuf_is_initialized(void);
 const char *ringbuf_current_filename(void);
-pcapio_writer* ringbuf_init_libpcap_fdopen(int *err);
+pcapio_writer* ringbuf_init_libpcap_fdopen(size_t async_buffer_size, int *err);
 bool ringbuf_switch_file(pcapio_writer* *pdh, char **save_file, int *save_file_fd,
                              int *err);
 bool ringbuf_libpcap_dump_close(char **save_file, int *err);
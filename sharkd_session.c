@@ -63,6 +63,7 @@
 #include <epan/to_str.h>
 
 #include <epan/addr_resolv.h>
+#include <epan/app_mem_usage.h>
 #include <epan/dissectors/packet-rtp.h>
 #include <ui/rtp_media.h>
 #include <ui/mcast_stream.h>
@@ -1354,6 +1355,16 @@ sharkd_session_process_load(const char *buf, const jsmntok_t *tokens, int count)
  *                      'format'   - column format (%x or %Cus:<expr>:<occurrence> if COL_CUSTOM)
  *                      'visible'  - true if column is visible
  *                      'display'  - column display format; 'U', 'R' or 'D'
+ *   (o) memory      - only if memory accounting was turned on with WIRESHARK_MEM_ACCOUNTING:
+ *                     process memory usage in bytes, array of object with attributes:
+ *                      'name'     - what is measured, e.g. 'RSS'
+ *                      'value'    - number of bytes
+ *   (o) allocations - only if memory accounting is on: memory allocated with wmem,
+ *                     counted by owner, array of object with attributes:
+ *                      'scope'    - 'Epan scope', 'File scope' or 'Packet scope'
+ *                      'owner'    - protocol or subsystem
+ *                      'bytes'    - bytes allocated since the scope was last emptied
+ *                      'objects'  - number of allocations
  */
 static void
 sharkd_session_process_status(void)
@@ -1407,6 +1418,41 @@ sharkd_session_process_status(void)
         sharkd_json_array_close();
     }
 
+    if (dissector_mem_accounting_get_sample_rate() != 0)
+    {
+        const char *mem_name;
+        size_t mem_value;
+
+        sharkd_json_array_open("memory");
+        for (unsigned i = 0; (mem_name = memory_usage_get(i, &mem_value)) != NULL; i++)
+        {
+            sharkd_json_object_open(NULL);
+            sharkd_json_value_string("name", mem_name);
+            sharkd_json_value_anyf("value", "%zu", mem_value);
+            sharkd_json_object_close();
+        }
+        sharkd_json_array_close();
+
+        sharkd_json_array_open("allocations");
+        for (unsigned i = 0; i < wmem_owner_count(); i++)
+        {
+            const wmem_owner_t *owner = wmem_owner_get(i);
+
+            for (unsigned scope = 0; scope < WMEM_ACCOUNTING_NUM_SCOPES; scope++)
+            {
+                if (owner->objects[scope] == 0)
+                    continue;
+                sharkd_json_object_open(NULL);
+                sharkd_json_value_string("scope", wmem_accounting_scope_name((wmem_accounting_scope_t)scope));
+                sharkd_json_value_string("owner", owner->name);
+                sharkd_json_value_anyf("bytes", "%" PRIu64, owner->bytes[scope]);
+                sharkd_json_value_anyf("objects", "%" PRIu64, owner->objects[scope]);
+                sharkd_json_object_close();
+            }
+        }
+        sharkd_json_array_close();
+    }
+
     sharkd_json_result_epilogue();
 }
 
@@ -2594,6 +2640,9 @@ sharkd_session_process_tap_nstat_cb(void *arg)
     stat_data_t *stat_data = (stat_data_t *) arg;
     unsigned i, j, k;
 
+    if (stat_data->stat_tap_data->stat_tap_draw_cb)
+        stat_data->stat_tap_data->stat_tap_draw_cb(stat_data->stat_tap_data);
+
     json_dumper_begin_object(&dumper);
     sharkd_json_value_stringf("tap", "nstat:%s", stat_data->stat_tap_data->cli_string);
     sharkd_json_value_string("type", "nstat");
@@ -2675,6 +2724,8 @@ sharkd_session_free_tap_nstat_cb(void *arg)
 {
     stat_data_t *stat_data = (stat_data_t *) arg;
 
+    if (stat_data->stat_tap_data->stat_tap_finish_cb)
+        stat_data->stat_tap_data->stat_tap_finish_cb(stat_data->stat_tap_data);
     free_stat_tables(stat_data->stat_tap_data);
 }
 
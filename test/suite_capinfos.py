@@ -0,0 +1,85 @@
+#
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Capinfos tests'''
+
+import subprocesstest
+import pytest
+
+# A mix of formats, compressed files, comments and decryption secrets.
+capture_names = (
+    'dhcp.pcap',
+    'dhcp.pcapng',
+    'dhcp-nanosecond.pcapng',
+    'dhcp_big_endian.pcapng',
+    'comments.pcapng',
+    'dns+icmp.pcapng.gz',
+    'http-ooo.pcap',
+    'sample_control4_2012-03-24.pcap',
+    'sip-rtp.pcapng',
+    'tls-fragmented-handshakes.pcap.gz',
+    'tls12-dsb.pcapng',
+)
+
+
+@pytest.fixture
+def capture_files(capture_file):
+    return [capture_file(name) for name in capture_names]
+
+
+def run_capinfos(cmd_capinfos, args, files, env):
+    # Compare the output as bytes, not as decoded text.
+    return subprocesstest.run((cmd_capinfos,) + tuple(args) + tuple(files),
+        capture_output=True, encoding=None, env=env)
+
+
+def check_capinfos_parallel(cmd_capinfos, args, files, env, returncode=0):
+    '''Checks that -j gives the same output and exit status as serial processing.'''
+    serial_proc = run_capinfos(cmd_capinfos, args, files, env)
+    assert serial_proc.returncode == returncode
+    # More threads than files, and fewer, so that jobs are reused.
+    for threads in ('2', '16'):
+        parallel_proc = run_capinfos(cmd_capinfos, ('-j', threads) + tuple(args), files, env)
+        assert parallel_proc.returncode == serial_proc.returncode
+        assert parallel_proc.stdout == serial_proc.stdout
+        assert parallel_proc.stderr == serial_proc.stderr
+    return serial_proc
+
+
+class TestCapinfosParallel:
+    def test_capinfos_parallel_long(self, cmd_capinfos, capture_files, test_env):
+        '''The long report with -j matches the serial one'''
+        proc = check_capinfos_parallel(cmd_capinfos, (), capture_files, test_env)
+        assert proc.stdout.count(b'SHA256:') == len(capture_files)
+
+    def test_capinfos_parallel_table(self, cmd_capinfos, capture_files, test_env):
+        '''The table report with -j matches the serial one'''
+        check_capinfos_parallel(cmd_capinfos, ('-T',), capture_files, test_env)
+
+    def test_capinfos_parallel_no_hashes(self, cmd_capinfos, capture_files, test_env):
+        '''-j without hashes matches the serial report'''
+        proc = check_capinfos_parallel(cmd_capinfos, ('-c', '-s', '-u'), capture_files, test_env)
+        assert b'SHA256:' not in proc.stdout
+
+    def test_capinfos_parallel_single_file(self, cmd_capinfos, capture_file, test_env):
+        '''A single file is read and hashed at the same time'''
+        check_capinfos_parallel(cmd_capinfos, (), (capture_file('sip-rtp.pcapng'),), test_env)
+
+    def test_capinfos_parallel_failure(self, cmd_capinfos, capture_files, result_file, test_env):
+        '''A file that can't be opened is reported and the others still are'''
+        missing_file = result_file('missing.pcap')
+        files = capture_files[:3] + [missing_file] + capture_files[3:]
+        proc = check_capinfos_parallel(cmd_capinfos, (), files, test_env, returncode=2)
+        assert proc.stdout.count(b'File name:') == len(capture_files)
+        assert missing_file.encode() in proc.stderr
+
+    def test_capinfos_parallel_cancel(self, cmd_capinfos, capture_files, result_file, test_env):
+        '''-C stops at the file that can't be opened, even with -j'''
+        missing_file = result_file('missing.pcap')
+        files = capture_files[:3] + [missing_file] + capture_files[3:]
+        proc = check_capinfos_parallel(cmd_capinfos, ('-C',), files, test_env, returncode=2)
+        assert proc.stdout.count(b'File name:') == 3
+        for name in capture_names[3:]:
+            assert name.encode() not in proc.stdout
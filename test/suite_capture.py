@@ -305,6 +305,51 @@ def check_dumpcap_ringbuffer_stdin(cmd_dumpcap, cmd_capinfos, result_file):
     return check_dumpcap_ringbuffer_stdin_real
 
 
+@pytest.fixture
+def check_dumpcap_written_frames(cmd_dumpcap, cmd_tshark, capture_file, result_file):
+    def frame_list(capture, env):
+        proc = subprocesstest.check_run((cmd_tshark,
+            '-r', capture,
+            '-o', 'frame.generate_md5_hash:TRUE',
+            '-T', 'fields', '-e', 'frame.time_epoch', '-e', 'frame.md5_hash',
+        ), capture_output=True, env=env)
+        return proc.stdout.splitlines()
+
+    def check_dumpcap_written_frames_real(self, pcapng=True, ring_packets=None, env=None):
+        # Capture from a pcap (not pcapng) pipe to a file, which dumpcap
+        # writes from a separate thread, and check that every frame made it.
+        in_file = capture_file('sample_control4_2012-03-24.pcap')
+        out_unique = 'written_' + uuid.uuid4().hex[:6] # Random ID
+        suffix = 'pcapng' if pcapng else 'pcap'
+        testout_file = result_file('testout.{}.{}'.format(out_unique, suffix))
+        testout_glob = result_file('testout.{}_*.{}'.format(out_unique, suffix))
+
+        cmd_ = '"{}"'.format(cmd_dumpcap)
+        capture_cmd = ' '.join((cmd_,
+            '-i', '-',
+            '-w', testout_file,
+        ))
+        if not pcapng:
+            capture_cmd += ' -P'
+        if ring_packets is not None:
+            capture_cmd += ' -b packets:{}'.format(ring_packets)
+        if sysconfig.get_platform().startswith('mingw'):
+            pytest.skip('FIXME Pipes are broken with the MSYS2 shell')
+        subprocesstest.check_run(cat_cap_file_command(in_file) + ' | ' + capture_cmd, shell=True, env=env)
+
+        if ring_packets is None:
+            out_files = [testout_file]
+        else:
+            # The file names sort in the order they were written.
+            out_files = sorted(glob.glob(testout_glob))
+            assert len(out_files) == (155 + ring_packets - 1) // ring_packets
+        written = []
+        for out_file in out_files:
+            written += frame_list(out_file, env)
+        assert written == frame_list(in_file, env)
+    return check_dumpcap_written_frames_real
+
+
 @pytest.fixture
 def check_dumpcap_pcapng_sections(cmd_dumpcap, cmd_tshark, cmd_capinfos, capture_file, result_file):
     if sys.platform == 'win32':
@@ -574,6 +619,20 @@ class TestDumpcapRingbuffer:
         check_dumpcap_ringbuffer_stdin(self, packets=47, env=base_env) # Last prime before 50. Arbitrary.
 
 
+class TestDumpcapWrittenFrames:
+    def test_dumpcap_written_frames_pcapng(self, check_dumpcap_written_frames, base_env):
+        '''Capture from stdin using Dumpcap and check every frame in the pcapng file'''
+        check_dumpcap_written_frames(self, env=base_env)
+
+    def test_dumpcap_written_frames_pcap(self, check_dumpcap_written_frames, base_env):
+        '''Capture from stdin using Dumpcap and check every frame in the pcap file'''
+        check_dumpcap_written_frames(self, pcapng=False, env=base_env)
+
+    def test_dumpcap_written_frames_ringbuffer(self, check_dumpcap_written_frames, base_env):
+        '''Capture from stdin using Dumpcap and check every frame in the ring buffer files'''
+        check_dumpcap_written_frames(self, ring_packets=50, env=base_env)
+
+
 class TestDumpcapPcapngSections:
     def test_dumpcap_pcapng_single_in_single_out(self, check_dumpcap_pcapng_sections, base_env):
         '''Capture from a single pcapng source using Dumpcap and write a single file'''
@@ -315,6 +315,71 @@ class TestTsharkZExpert:
         assert not grep_output(proc.stdout, 'Chats')
 
 
+class TestTsharkZDissectorProfile:
+    def test_tshark_z_dissector_profile(self, cmd_tshark, capture_file, test_env):
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'dissector,profile',
+            '-r', capture_file('dhcp.pcap')), capture_output=True, env=test_env)
+        assert proc.returncode == 0
+        assert grep_output(proc.stdout, 'Dissector Profile:')
+        assert grep_output(proc.stdout, 'Dissector |Type |Calls |Accepted |Exceptions |Inclusive ms |Exclusive ms |Allocated KiB |')
+
+        rows = {}
+        exclusive_ms = []
+        for line in proc.stdout.splitlines():
+            fields = [field.strip() for field in line.split('|')]
+            if len(fields) != 9 or fields[1] not in ('handle', 'heuristic'):
+                continue
+            name, _, calls, accepted, exceptions, inclusive, exclusive, alloc_kib, _ = fields
+            rows[name] = (int(calls), int(accepted), int(exceptions), float(alloc_kib))
+            assert float(exclusive) <= float(inclusive)
+            exclusive_ms.append(float(exclusive))
+            # Growing a buffer must not count its old size again; four
+            # DHCP packets need nowhere near this much.
+            assert 0 <= float(alloc_kib) < 1024
+        assert exclusive_ms == sorted(exclusive_ms, reverse=True)
+
+        # dhcp.pcap has four DHCP packets over UDP.
+        assert rows['udp'][:3] == (4, 4, 0)
+        assert rows['dhcp'][:3] == (4, 4, 0)
+
+
+class TestTsharkZConv:
+    def test_tshark_z_conv(self, cmd_tshark, capture_file, test_env):
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'conv,ip',
+            '-r', capture_file('dhcp.pcap')), capture_output=True, env=test_env)
+        assert proc.returncode == 0
+        assert count_output(proc.stdout, '<->') == 2
+
+    def test_tshark_z_conv_top(self, cmd_tshark, capture_file, test_env):
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'conv,ip,top=1,udp',
+            '-r', capture_file('dhcp.pcap')), capture_output=True, env=test_env)
+        assert proc.returncode == 0
+        assert grep_output(proc.stdout, 'Filter:udp')
+        assert grep_output(proc.stdout, 'Top 1 by frames')
+        assert count_output(proc.stdout, '<->') == 1
+
+    def test_tshark_z_endpoints_topbytes(self, cmd_tshark, capture_file, test_env):
+        proc = subprocesstest.run((cmd_tshark, '-q', '-z', 'endpoints,ip,topbytes=2',
+            '-r', capture_file('dhcp.pcap')), capture_output=True, env=test_env)
+        assert proc.returncode == 0
+        assert grep_output(proc.stdout, 'Filter:<No Filter>')
+        assert grep_output(proc.stdout, 'Top 2 by bytes')
+        assert count_output(proc.stdout, r'\[\d+ \d+\]') == 2
+
+
+class TestTsharkStreaming:
+    def test_tshark_streaming_active_flow(self, cmd_tshark, capture_file, test_env):
+        '''A flow that lasts longer than the idle timeout but is never idle for that long is kept'''
+        # The RTP flow lasts 24 seconds, with at most 6 seconds between packets.
+        proc = subprocesstest.run((cmd_tshark, '--streaming', '10',
+            '-r', capture_file('sip-rtp.pcapng'), '-Y', 'udp.port == 8000',
+            '-T', 'fields', '-e', 'udp.stream'), capture_output=True, env=test_env)
+        assert proc.returncode == 0
+        streams = proc.stdout.split()
+        assert len(streams) == 548
+        assert len(set(streams)) == 1
+
+
 class TestTsharkExtcap:
     # dumpcap dependency has been added to run this test only with capture support
     def test_tshark_extcap_interfaces(self, cmd_tshark, cmd_dumpcap, test_env, home_path):
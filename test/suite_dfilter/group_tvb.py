@@ -41,6 +41,31 @@ class TestDfilterProtocol:
         dfilter = 'http contains "HEAD"'
         checkDFilterCount(dfilter, 1)
 
+    def test_contains_multi_1(self, checkDFilterCount):
+        dfilter = 'http contains "POST" || http contains "HEAD" || http contains "PUT"'
+        checkDFilterCount(dfilter, 1)
+
+    def test_contains_multi_2(self, checkDFilterCount):
+        dfilter = 'http contains "POST" || http contains "PUT" || http contains "DELETE"'
+        checkDFilterCount(dfilter, 0)
+
+    def test_contains_multi_3(self, checkDFilterCount):
+        dfilter = 'eth contains ff:ff:ff || ip.len == 1 || eth contains 09:6b:88'
+        checkDFilterCount(dfilter, 1)
+
+    def test_contains_multi_4(self, checkDFilterSucceed):
+        dfilter = 'frame contains "abc" || frame contains "def" || frame contains 01:02'
+        checkDFilterSucceed(dfilter, "ANY_CONTAINS_MULTI")
+
+    def test_contains_multi_5(self, checkDFilterCount):
+        # Only the needle with a first byte above 0x7f matches.
+        dfilter = 'eth contains ff:ff:ff || eth contains f5:c9'
+        checkDFilterCount(dfilter, 1)
+
+    def test_contains_multi_6(self, checkDFilterCount):
+        dfilter = 'eth contains ff:ff:ff || eth contains 01:02'
+        checkDFilterCount(dfilter, 0)
+
     def test_protocol_1(self, checkDFilterSucceed):
         dfilter = 'frame contains aa.bb.ff'
         checkDFilterSucceed(dfilter)
@@ -11,6 +11,7 @@
 import os.path
 from subprocesstest import count_output
 import subprocess
+import zlib
 import pytest
 from pathlib import PurePath
 
@@ -275,3 +276,63 @@ class TestFileFormatCllog:
             ), encoding='utf-8', env=test_env)
         assert ' '.join(proc_stdout.strip().splitlines()) == \
             '2015 2024 2015 2024 2015 2024 2015 2024'
+
+
+def count_gzip_members(path):
+    '''Return the number of gzip members in a file.'''
+    with open(path, 'rb') as f:
+        data = f.read()
+    members = 0
+    while data:
+        decomp = zlib.decompressobj(wbits=16 + zlib.MAX_WBITS)
+        decomp.decompress(data)
+        assert decomp.eof, 'Truncated gzip member'
+        members += 1
+        data = decomp.unused_data
+    return members
+
+
+@pytest.fixture
+def check_compressed_frames(cmd_tshark):
+    '''Check that two compressed files have the same frames.'''
+    def check_compressed_frames_real(single_file, par_file, env=None):
+        frame_args = ('-o', 'frame.generate_md5_hash:TRUE',
+            '-T', 'fields', '-e', 'frame.time_epoch', '-e', 'frame.md5_hash')
+        single_frames = subprocess.check_output((cmd_tshark, '-r', single_file) + frame_args,
+            encoding='utf-8', env=env)
+        par_frames = subprocess.check_output((cmd_tshark, '-r', par_file) + frame_args,
+            encoding='utf-8', env=env)
+        assert single_frames.count('\n') > 0
+        assert par_frames == single_frames
+        # Each 1 MiB block compressed by a thread is a gzip member.
+        assert count_gzip_members(single_file) == 1
+        assert count_gzip_members(par_file) > 1
+    return check_compressed_frames_real
+
+
+class TestFileFormatsCompressThreads:
+    def test_editcap_compress_threads(self, cmd_editcap, capture_file, result_file, check_compressed_frames, base_env):
+        '''Compress a file with several threads, and compare it with one thread.'''
+        single_file = result_file('single.pcapng.gz')
+        par_file = result_file('par.pcapng.gz')
+        for threads, outfile in (('1', single_file), ('4', par_file)):
+            subprocess.run((cmd_editcap,
+                '--compress', 'gzip',
+                '--compress-threads', threads,
+                capture_file('challenge01_ooo_stream.pcapng.gz'), outfile
+            ), check=True, env=base_env)
+        check_compressed_frames(single_file, par_file, env=base_env)
+
+    def test_mergecap_compress_threads(self, cmd_mergecap, capture_file, result_file, check_compressed_frames, base_env):
+        '''Merge files, compressing with several threads, and compare with one thread.'''
+        single_file = result_file('single.pcapng.gz')
+        par_file = result_file('par.pcapng.gz')
+        for threads, outfile in (('1', single_file), ('4', par_file)):
+            subprocess.run((cmd_mergecap,
+                '--compress', 'gzip',
+                '--compress-threads', threads,
+                '-w', outfile,
+                capture_file('challenge01_ooo_stream.pcapng.gz'),
+                capture_file('quic_follow_multistream.pcapng'),
+            ), check=True, env=base_env)
+        check_compressed_frames(single_file, par_file, env=base_env)
@@ -0,0 +1,154 @@
+#
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Reordercap tests'''
+
+import os.path
+import subprocess
+import subprocesstest
+import pytest
+
+ordered_pcap = 'sample_control4_2012-03-24.pcap'
+chunk_frames = 10
+
+
+@pytest.fixture
+def unordered_pcap(cmd_editcap, cmd_mergecap, capture_file, result_file, test_env):
+    '''Returns a capture with each pair of adjacent chunks of frames swapped.'''
+    # sample_control4_2012-03-24.pcap has 155 frames with distinct time stamps.
+    chunk_files = []
+    for start in range(1, 156, chunk_frames):
+        chunk_file = result_file('chunk{}.pcap'.format(len(chunk_files)))
+        subprocesstest.check_run((cmd_editcap,
+            '-r', capture_file(ordered_pcap), chunk_file,
+            '{}-{}'.format(start, start + chunk_frames - 1),
+        ), env=test_env)
+        chunk_files.append(chunk_file)
+    for i in range(0, len(chunk_files) - 1, 2):
+        chunk_files[i], chunk_files[i + 1] = chunk_files[i + 1], chunk_files[i]
+
+    unordered_file = result_file('unordered.pcap')
+    subprocesstest.check_run((cmd_mergecap,
+        '-a', '-F', 'pcap', '-w', unordered_file,
+    ) + tuple(chunk_files), env=test_env)
+    return unordered_file
+
+
+def frame_list(cmd_tshark, capture, env):
+    '''Returns the time stamp and hash of each frame in a capture.'''
+    return subprocess.check_output((cmd_tshark,
+        '-r', capture,
+        '-o', 'frame.generate_md5_hash:TRUE',
+        '-T', 'fields',
+        '-e', 'frame.time_epoch',
+        '-e', 'frame.md5_hash',
+    ), encoding='utf-8', env=env).splitlines()
+
+
+@pytest.fixture
+def sorted_frames(cmd_reordercap, cmd_tshark, unordered_pcap, capture_file, result_file, test_env):
+    '''Returns the frames of unordered_pcap as sorted by reordercap
+    without a window, checking them against the original capture.'''
+    sorted_file = result_file('sorted.pcap')
+    reorder_proc = subprocesstest.run((cmd_reordercap, unordered_pcap, sorted_file),
+        capture_output=True, env=test_env)
+    assert reorder_proc.returncode == 0
+    assert reorder_proc.stdout == '155 frames, 8 out of order\n'
+    frames = frame_list(cmd_tshark, sorted_file, test_env)
+    assert len(frames) == 155
+    assert frames == frame_list(cmd_tshark, capture_file(ordered_pcap), test_env)
+    return frames
+
+
+class TestReordercapStreaming:
+    def test_reordercap_window(self, cmd_reordercap, cmd_tshark, unordered_pcap, sorted_frames, result_file, test_env):
+        '''Frames that are out of order within the window are sorted in memory'''
+        testout_file = result_file('testout.pcap')
+        reorder_proc = subprocesstest.run((cmd_reordercap,
+            '-w', str(chunk_frames),
+            unordered_pcap, testout_file,
+        ), capture_output=True, env=test_env)
+        assert reorder_proc.returncode == 0
+        assert reorder_proc.stdout == '155 frames, 8 out of order\n'
+        assert frame_list(cmd_tshark, testout_file, test_env) == sorted_frames
+
+    def test_reordercap_window_overflow(self, cmd_reordercap, cmd_tshark, unordered_pcap, sorted_frames, result_file, test_env):
+        '''Frames that are out of order beyond the window are written to runs and merged'''
+        testout_file = result_file('testout.pcap')
+        reorder_proc = subprocesstest.run((cmd_reordercap,
+            '-w', '4',
+            unordered_pcap, testout_file,
+        ), capture_output=True, env=test_env)
+        assert reorder_proc.returncode == 0
+        assert reorder_proc.stdout.startswith('155 frames, 8 out of order, merged from ')
+        assert frame_list(cmd_tshark, testout_file, test_env) == sorted_frames
+        # The merged runs replace the output file; nothing else is left behind.
+        assert not [f for f in os.listdir(os.path.dirname(testout_file)) if f.startswith('reordercap')]
+
+    def test_reordercap_time_window(self, cmd_reordercap, cmd_tshark, unordered_pcap, sorted_frames, result_file, test_env):
+        '''A time window that spans the capture sorts it in memory'''
+        testout_file = result_file('testout.pcap')
+        reorder_proc = subprocesstest.run((cmd_reordercap,
+            '-t', '86400',
+            unordered_pcap, testout_file,
+        ), capture_output=True, env=test_env)
+        assert reorder_proc.returncode == 0
+        assert reorder_proc.stdout == '155 frames, 8 out of order\n'
+        assert frame_list(cmd_tshark, testout_file, test_env) == sorted_frames
+
+    def test_reordercap_time_window_overflow(self, cmd_reordercap, cmd_tshark, unordered_pcap, sorted_frames, result_file, test_env):
+        '''A short time window writes to runs and merges them'''
+        testout_file = result_file('testout.pcap')
+        reorder_proc = subprocesstest.run((cmd_reordercap,
+            '-t', '0.000001',
+            unordered_pcap, testout_file,
+        ), capture_output=True, env=test_env)
+        assert reorder_proc.returncode == 0
+        assert reorder_proc.stdout.startswith('155 frames, 8 out of order, merged from ')
+        assert frame_list(cmd_tshark, testout_file, test_env) == sorted_frames
+
+    def test_reordercap_stdin(self, cmd_reordercap, cmd_tshark, unordered_pcap, sorted_frames, result_file, test_env):
+        '''Read from stdin and sort through runs'''
+        testout_file = result_file('testout.pcap')
+        with open(unordered_pcap, 'rb') as stdin_file:
+            reorder_proc = subprocesstest.run((cmd_reordercap,
+                '-w', '4',
+                '-', testout_file,
+            ), stdin=stdin_file, capture_output=True, env=test_env)
+        assert reorder_proc.returncode == 0
+        assert reorder_proc.stdout.startswith('155 frames, 8 out of order, merged from ')
+        assert frame_list(cmd_tshark, testout_file, test_env) == sorted_frames
+
+    def test_reordercap_stdout(self, cmd_reordercap, cmd_tshark, unordered_pcap, sorted_frames, result_file, test_env):
+        '''Write to stdout within the window, with the counts on stderr'''
+        testout_file = result_file('testout.pcap')
+        with open(testout_file, 'wb') as stdout_file:
+            reorder_proc = subprocesstest.run((cmd_reordercap,
+                '-w', str(chunk_frames),
+                unordered_pcap, '-',
+            ), stdout=stdout_file, stderr=subprocess.PIPE, env=test_env)
+        assert reorder_proc.returncode == 0
+        assert reorder_proc.stderr == '155 frames, 8 out of order\n'
+        assert frame_list(cmd_tshark, testout_file, test_env) == sorted_frames
+
+    def test_reordercap_stdout_overflow(self, cmd_reordercap, unordered_pcap, result_file, test_env):
+        '''Writing to stdout fails if the window is too small'''
+        testout_file = result_file('testout.pcap')
+        with open(testout_file, 'wb') as stdout_file:
+            reorder_proc = subprocesstest.run((cmd_reordercap,
+                '-w', '4',
+                unordered_pcap, '-',
+            ), stdout=stdout_file, stderr=subprocess.PIPE, env=test_env)
+        assert reorder_proc.returncode == 1
+        assert 'use a larger window' in reorder_proc.stderr
+
+    def test_reordercap_no_write_window(self, cmd_reordercap, unordered_pcap, result_file, test_env):
+        '''-n requires the whole input in memory'''
+        reorder_proc = subprocesstest.run((cmd_reordercap,
+            '-n', '-w', str(chunk_frames),
+            unordered_pcap, result_file('testout.pcap'),
+        ), capture_output=True, env=test_env)
+        assert reorder_proc.returncode != 0
+        assert "-n can't be used with -w or -t." in reorder_proc.stderr
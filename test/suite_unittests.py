@@ -19,6 +19,12 @@ class TestUnitTests:
         '''exntest'''
         subprocess.check_call(program('exntest'), env=base_env)
 
+    def test_unit_mmdb_reader_test(self, program, capture_file, base_env):
+        '''mmdb_reader_test'''
+        subprocess.check_call((program('mmdb_reader_test'),
+            capture_file('maxmind-test.mmdb')
+        ), env=base_env)
+
     def test_unit_oids_test(self, program, base_env):
         '''oids_test'''
         subprocess.check_call(program('oids_test'), env=base_env)
@@ -51,6 +57,12 @@ class TestUnitTests:
             '--verbose'
         ), env=base_env)
 
+    def test_unit_wiretap(self, program, base_env):
+        '''wiretap unit tests'''
+        subprocess.check_call((program('test_wiretap'),
+            '--verbose'
+        ), env=base_env)
+
     def test_unit_wsutil(self, program, base_env):
         '''wsutil unit tests'''
         subprocess.check_call((program('test_wsutil'),
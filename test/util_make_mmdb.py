@@ -0,0 +1,210 @@
+#!/usr/bin/env python3
+#
+# Wireshark tests
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+#
+'''Write captures/maxmind-test.mmdb, the MaxMind DB used by mmdb_reader_test.'''
+
+import ipaddress
+import os.path
+import struct
+
+# Data field types.
+T_POINTER = 1
+T_UTF8_STRING = 2
+T_DOUBLE = 3
+T_UINT16 = 5
+T_UINT32 = 6
+T_MAP = 7
+T_INT32 = 8
+T_UINT64 = 9
+T_ARRAY = 11
+T_BOOLEAN = 14
+
+METADATA_MARKER = b'\xab\xcd\xefMaxMind.com'
+RECORD_SIZE = 28
+
+class Pointer:
+    def __init__(self, offset):
+        self.offset = offset
+
+class Uint:
+    def __init__(self, field_type, value):
+        self.field_type = field_type
+        self.value = value
+
+class Int32:
+    def __init__(self, value):
+        self.value = value
+
+def control(field_type, size):
+    if size < 29:
+        extra = b''
+    elif size < 285:
+        extra = bytes([size - 29])
+        size = 29
+    elif size < 65821:
+        extra = struct.pack('>H', size - 285)
+        size = 30
+    else:
+        extra = struct.pack('>I', size - 65821)[1:]
+        size = 31
+    if field_type <= T_MAP:
+        return bytes([(field_type << 5) | size]) + extra
+    return bytes([size, field_type - 7]) + extra
+
+def pointer(offset):
+    if offset < 2048:
+        return bytes([0x20 | (offset >> 8), offset & 0xff])
+    if offset < 526336:
+        offset -= 2048
+        return bytes([0x28 | (offset >> 16), (offset >> 8) & 0xff, offset & 0xff])
+    if offset < 134744064:
+        offset -= 526336
+        return bytes([0x30 | (offset >> 24)]) + struct.pack('>I', offset)[1:]
+    return bytes([0x38]) + struct.pack('>I', offset)
+
+class Section:
+    '''A data or metadata section. Strings that were already written are
+    replaced by pointers, so map keys after the first use are pointers.'''
+    def __init__(self):
+        self.data = b''
+        self.strings = {}
+
+    def write(self, value):
+        if isinstance(value, Pointer):
+            self.data += pointer(value.offset)
+        elif isinstance(value, bool):
+            self.data += control(T_BOOLEAN, int(value))
+        elif isinstance(value, str):
+            if value in self.strings:
+                self.data += pointer(self.strings[value])
+            else:
+                self.strings[value] = len(self.data)
+                encoded = value.encode()
+                self.data += control(T_UTF8_STRING, len(encoded)) + encoded
+        elif isinstance(value, float):
+            self.data += control(T_DOUBLE, 8) + struct.pack('>d', value)
+        elif isinstance(value, Uint):
+            encoded = value.value.to_bytes(8, 'big').lstrip(b'\0')
+            self.data += control(value.field_type, len(encoded)) + encoded
+        elif isinstance(value, Int32):
+            self.data += control(T_INT32, 4) + struct.pack('>i', value.value)
+        elif isinstance(value, list):
+            self.data += control(T_ARRAY, len(value))
+            for item in value:
+                self.write(item)
+        elif isinstance(value, dict):
+            self.data += control(T_MAP, len(value))
+            for key, item in value.items():
+                self.write(key)
+                self.write(item)
+        else:
+            raise TypeError(value)
+
+    def add(self, value):
+        '''Append a value and return its offset.'''
+        offset = len(self.data)
+        self.write(value)
+        return offset
+
+def build_tree(networks):
+    '''Build an IPv6 search tree. networks maps a network to a data offset,
+    or to None for an offset past the end of the data section.'''
+    nodes = [[None, None]]
+    for network, offset in networks:
+        address = int(network.network_address)
+        prefix_len = network.prefixlen
+        if network.version == 4:
+            # IPv4 networks live in ::/96.
+            prefix_len += 96
+        node = 0
+        for bit_index in range(prefix_len):
+            bit = (address >> (127 - bit_index)) & 1
+            if bit_index == prefix_len - 1:
+                nodes[node][bit] = ('data', offset)
+            else:
+                if not isinstance(nodes[node][bit], int):
+                    nodes.append([None, None])
+                    nodes[node][bit] = len(nodes) - 1
+                node = nodes[node][bit]
+    return nodes
+
+def main():
+    data = Section()
+    country = data.add({
+        'iso_code': 'US',
+        'names': {'en': 'United States', 'de': 'Vereinigte Staaten'},
+    })
+    city = data.add({
+        'city': {'geoname_id': Uint(T_UINT32, 4951305), 'names': {'en': 'Springfield'}},
+        'country': Pointer(country),
+        'location': {
+            'accuracy_radius': Uint(T_UINT16, 100),
+            'latitude': 42.1,
+            'longitude': -72.6,
+        },
+        'traits': {'is_anycast': True, 'offsets': [Int32(-5), Uint(T_UINT64, 1 << 40)]},
+    })
+    asn = data.add({
+        'autonomous_system_number': Uint(T_UINT32, 64500),
+        'autonomous_system_organization': 'Example AS',
+    })
+    ipv6_city = data.add({
+        'city': {'names': {'en': 'Documentation'}},
+        'country': Pointer(country),
+    })
+    # The organization points past the end of the data section.
+    bad_pointer = data.add({
+        'autonomous_system_organization': Pointer(0xfffffff0),
+        'autonomous_system_number': Uint(T_UINT32, 64501),
+    })
+
+    nodes = build_tree([
+        (ipaddress.ip_network('10.0.0.0/8'), city),
+        (ipaddress.ip_network('192.0.2.0/24'), asn),
+        (ipaddress.ip_network('198.51.100.0/24'), bad_pointer),
+        (ipaddress.ip_network('203.0.113.0/24'), None),
+        (ipaddress.ip_network('2001:db8::/32'), ipv6_city),
+    ])
+    node_count = len(nodes)
+
+    def record(value):
+        if value is None:
+            return node_count
+        if isinstance(value, int):
+            return value
+        offset = value[1]
+        if offset is None:
+            # Past the end of the data section.
+            offset = len(data.data) + 100
+        return node_count + 16 + offset
+
+    tree = b''
+    for left, right in nodes:
+        left = record(left)
+        right = record(right)
+        tree += (left & 0xffffff).to_bytes(3, 'big')
+        tree += bytes([((left >> 24) << 4) | (right >> 24)])
+        tree += (right & 0xffffff).to_bytes(3, 'big')
+
+    metadata = Section()
+    metadata.add({
+        'binary_format_major_version': Uint(T_UINT16, 2),
+        'binary_format_minor_version': Uint(T_UINT16, 0),
+        'build_epoch': Uint(T_UINT64, 1700000000),
+        'database_type': 'Wireshark-Test-City',
+        'description': {'en': 'Wireshark test database'},
+        'ip_version': Uint(T_UINT16, 6),
+        'languages': ['en', 'de'],
+        'node_count': Uint(T_UINT32, node_count),
+        'record_size': Uint(T_UINT16, RECORD_SIZE),
+    })
+
+    mmdb_path = os.path.join(os.path.dirname(__file__), 'captures', 'maxmind-test.mmdb')
+    with open(mmdb_path, 'wb') as mmdb_file:
+        mmdb_file.write(tree + b'\0' * 16 + data.data + METADATA_MARKER + metadata.data)
+
+if __name__ == '__main__':
+    main()
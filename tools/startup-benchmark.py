@@ -0,0 +1,64 @@
+#!/usr/bin/env python3
+# Wireshark - Network traffic analyzer
+# By Gerald Combs <gerald@wireshark.org>
+# Copyright 1998 Gerald Combs
+#
+# SPDX-License-Identifier: GPL-2.0-or-later
+
+'''Measure how long TShark takes to start up.
+
+Runs "tshark -r <capture>" on a one-packet capture several times and
+reports the wall clock time, which is dominated by epan_init(). With
+--profile, also shows the protocol registration and handoff routines
+that took the longest, as logged by epan/register.c.
+'''
+
+import argparse
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+
+def run(tshark, capture, config_dir, extra_args=None):
+    cmd = [tshark, '-n', '-r', capture] + (extra_args or [])
+    env = dict(os.environ)
+    # Don't let the user's profile affect the measurement.
+    env['WIRESHARK_CONFIG_DIR'] = config_dir
+    start = time.perf_counter()
+    proc = subprocess.run(cmd, env=env, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, encoding='utf-8', errors='replace')
+    elapsed = time.perf_counter() - start
+    if proc.returncode != 0:
+        sys.stderr.write(proc.stderr)
+        sys.exit('{} failed with exit status {}'.format(' '.join(cmd), proc.returncode))
+    return elapsed, proc.stderr
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Measure TShark startup time.')
+    parser.add_argument('tshark', help='path to the tshark executable')
+    parser.add_argument('--capture', help='capture file to read (default: test/captures/dhcp.pcap)',
+                        default=os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'test', 'captures', 'dhcp.pcap'))
+    parser.add_argument('-n', '--runs', type=int, default=10, help='number of runs (default: 10)')
+    parser.add_argument('--profile', action='store_true', help='show the slowest registration routines')
+    args = parser.parse_args()
+
+    with tempfile.TemporaryDirectory() as config_dir:
+        # Warm up the page cache.
+        run(args.tshark, args.capture, config_dir)
+
+        times = [run(args.tshark, args.capture, config_dir)[0] for _ in range(args.runs)]
+        print('{} runs: min {:.3f} s, median {:.3f} s, max {:.3f} s'.format(
+            args.runs, min(times), statistics.median(times), max(times)))
+
+        if args.profile:
+            _, log = run(args.tshark, args.capture, config_dir, ['--log-level', 'info', '--log-domains', 'Epan'])
+            for line in log.splitlines():
+                if ' register: ' in line or ' handoff: ' in line:
+                    print(line)
+
+
+if __name__ == '__main__':
+    main()
@@ -142,6 +142,7 @@
 #define LONGOPT_PRINT_TIMERS            LONGOPT_BASE_APPLICATION+9
 #define LONGOPT_GLOBAL_PROFILE          LONGOPT_BASE_APPLICATION+10
 #define LONGOPT_COMPRESS                LONGOPT_BASE_APPLICATION+11
+#define LONGOPT_STREAMING               LONGOPT_BASE_APPLICATION+12
 
 capture_file cfile;
 
@@ -153,6 +154,8 @@ static frame_data prev_cap_frame;
 static bool perform_two_pass_analysis;
 static uint32_t epan_auto_reset_count;
 static bool epan_auto_reset;
+static int32_t streaming_idle_timeout;
+static int32_t streaming_max_conversations;
 
 static uint32_t selected_frame_number;
 
@@ -364,6 +367,21 @@ list_output_compression_types(void) {
     g_slist_free(output_compression_types);
 }
 
+/* Parse "<idle seconds>[,<max conversations>]" for --streaming. */
+static bool
+parse_streaming_opt(const char *optarg)
+{
+    char **params = g_strsplit(optarg, ",", 2);
+    bool ok;
+
+    ok = get_positive_int(params[0], "streaming idle timeout", &streaming_idle_timeout);
+    if (ok && params[1] != NULL)
+        ok = get_positive_int(params[1], "streaming conversation limit", &streaming_max_conversations);
+
+    g_strfreev(params);
+    return ok;
+}
+
 struct string_elem {
     const char *sstr;   /* The short string */
     const char *lstr;   /* The long string */
@@ -482,6 +500,9 @@ print_usage(FILE *output)
     fprintf(output, "Processing:\n");
     fprintf(output, "  -2                       perform a two-pass analysis\n");
     fprintf(output, "  -M <packet count>        perform session auto reset\n");
+    fprintf(output, "  --streaming <idle seconds>[,<max conversations>]\n");
+    fprintf(output, "                           free conversations and reassemblies that are idle\n");
+    fprintf(output, "                           instead of resetting the session\n");
     fprintf(output, "  -R <read filter>, --read-filter <read filter>\n");
     fprintf(output, "                           packet Read filter in Wireshark display filter syntax\n");
     fprintf(output, "                           (requires -2)\n");
@@ -1061,6 +1082,7 @@ main(int argc, char *argv[])
         {"print-timers", ws_no_argument, NULL, LONGOPT_PRINT_TIMERS},
         {"global-profile", ws_no_argument, NULL, LONGOPT_GLOBAL_PROFILE},
         {"compress", ws_required_argument, NULL, LONGOPT_COMPRESS},
+        {"streaming", ws_required_argument, NULL, LONGOPT_STREAMING},
         {0, 0, 0, 0}
     };
     bool                 arg_error = false;
@@ -1421,6 +1443,10 @@ main(int argc, char *argv[])
                     cmdarg_err("-2 does not support auto session reset.");
                     arg_error=true;
                 }
+                if(streaming_idle_timeout){
+                    cmdarg_err("-2 does not support streaming.");
+                    arg_error=true;
+                }
                 perform_two_pass_analysis = true;
                 break;
             case 'M':
@@ -1433,6 +1459,14 @@ main(int argc, char *argv[])
 
                 epan_auto_reset = true;
                 break;
+            case LONGOPT_STREAMING:
+                if(perform_two_pass_analysis){
+                    cmdarg_err("--streaming does not support two-pass analysis.");
+                    arg_error=true;
+                }
+                if (!parse_streaming_opt(ws_optarg))
+                    arg_error = true;
+                break;
             case 'a':        /* autostop criteria */
             case 'b':        /* Ringbuffer option */
             case 'f':        /* capture filter */
@@ -2942,7 +2976,12 @@ tshark_epan_new(capture_file *cf)
         NULL,
     };
 
-    return epan_new(&cf->provider, &funcs);
+    epan_t *session = epan_new(&cf->provider, &funcs);
+
+    if (streaming_idle_timeout > 0)
+        epan_set_streaming(session, streaming_idle_timeout, streaming_max_conversations);
+
+    return session;
 }
 
 #ifdef HAVE_LIBPCAP
@@ -3486,15 +3525,15 @@ process_packet_first_pass(capture_file *cf, epan_dissect_t *edt,
         cf->provider.prev_cap = cf->provider.prev_dis = frame_data_sequence_add(cf->provider.frames, &fdlocal);
 
         /* If we're not doing dissection then there won't be any dependent frames.
-         * More importantly, edt.pi.fd.dependent_frames won't be initialized because
+         * More importantly, edt.pi.fd's dependent frames won't be initialized because
          * epan hasn't been initialized.
          * if we *are* doing dissection, then mark the dependent frames, but only
          * if a display filter was given and it matches this packet.
          */
         if (edt && cf->dfcode) {
             elapsed_start = g_get_monotonic_time();
-            if (dfilter_apply_edt(cf->dfcode, edt) && edt->pi.fd->dependent_frames) {
-                g_hash_table_foreach(edt->pi.fd->dependent_frames, find_and_mark_frame_depended_upon, cf->provider.frames);
+            if (dfilter_apply_edt(cf->dfcode, edt) && frame_data_get_dependent_frames(edt->pi.fd)) {
+                g_hash_table_foreach(frame_data_get_dependent_frames(edt->pi.fd), find_and_mark_frame_depended_upon, cf->provider.frames);
             }
 
             if (selected_frame_number != 0 && selected_frame_number == cf->count + 1) {
@@ -41,6 +41,10 @@ endpoints_draw(void *arg)
 	printf("================================================================================\n");
 	printf("%s Endpoints\n", iu->type);
 	printf("Filter:%s\n", iu->filter ? iu->filter : "<No Filter>");
+	if (iu->hash.top_items) {
+		printf("Top %u by %s; counts may be short by up to the frames and bytes given in brackets\n",
+			iu->hash.top_items, iu->hash.top_by_bytes ? "bytes" : "frames");
+	}
 
 	printf("                       | %sPackets | |  Bytes  | | Tx Packets | | Tx Bytes | | Rx Packets | | Rx Bytes |\n",
 		display_port ? " Port  | | " : "");
@@ -89,7 +93,7 @@ endpoints_draw(void *arg)
 					total_bytes = format_size(endpoint->tx_bytes + endpoint->rx_bytes, FORMAT_SIZE_UNIT_BYTES, 0);
 					printf("     %8" PRIu64 "   %-11s"
 						"  %8" PRIu64 "      %-11s"
-						"   %8" PRIu64 "      %-11s \n",
+						"   %8" PRIu64 "      %-11s ",
 						endpoint->tx_frames+endpoint->rx_frames,
 						total_bytes,
 						endpoint->tx_frames, tx_bytes,
@@ -100,11 +104,16 @@ endpoints_draw(void *arg)
 				} else {
 					printf("     %8" PRIu64 "   %9" PRIu64
 						"    %8" PRIu64 "      %9" PRIu64
-						"     %8" PRIu64 "      %9" PRIu64 "  \n",
+						"     %8" PRIu64 "      %9" PRIu64 "  ",
 						endpoint->tx_frames+endpoint->rx_frames, endpoint->tx_bytes+endpoint->rx_bytes,
 						endpoint->tx_frames, endpoint->tx_bytes,
 						endpoint->rx_frames, endpoint->rx_bytes);
 				}
+				if (iu->hash.top_items) {
+					printf("  [%" PRIu64 " %" PRIu64 "]",
+						endpoint->frames_error, endpoint->bytes_error);
+				}
+				printf("\n");
 			}
 		}
 		max_frames = last_frames;
@@ -119,6 +128,7 @@ void init_endpoints(struct register_ct *ct, const char *filter)
 
 	iu = g_new0(endpoints_t, 1);
 	iu->type = proto_get_protocol_short_name(find_protocol_by_id(get_conversation_proto_id(ct)));
+	filter = conversation_table_parse_top_option(&iu->hash, filter);
 	iu->filter = g_strdup(filter);
 	iu->hash.user_data = iu;
 
@@ -41,6 +41,10 @@ iousers_draw(void *arg)
 	printf("================================================================================\n");
 	printf("%s Conversations\n", iu->type);
 	printf("Filter:%s\n", iu->filter ? iu->filter : "<No Filter>");
+	if (iu->hash.top_items) {
+		printf("Top %u by %s; counts may be short by up to the frames and bytes given in brackets\n",
+			iu->hash.top_items, iu->hash.top_by_bytes ? "bytes" : "frames");
+	}
 
 	switch (timestamp_get_type()) {
 	case TS_ABSOLUTE:
@@ -232,8 +236,13 @@ iousers_draw(void *arg)
 						nstime_to_sec(&iui->start_time));
 					break;
 				}
-				printf("   %12.4f\n",
+				printf("   %12.4f",
 					 nstime_to_sec(&iui->stop_time) - nstime_to_sec(&iui->start_time));
+				if (iu->hash.top_items) {
+					printf("   [%" PRIu64 " %" PRIu64 "]",
+						iui->frames_error, iui->bytes_error);
+				}
+				printf("\n");
 			}
 		}
 		max_frames = last_frames;
@@ -248,6 +257,7 @@ void init_iousers(struct register_ct *ct, const char *filter)
 
 	iu = g_new0(io_users_t, 1);
 	iu->type = proto_get_protocol_short_name(find_protocol_by_id(get_conversation_proto_id(ct)));
+	filter = conversation_table_parse_top_option(&iu->hash, filter);
 	iu->filter = g_strdup(filter);
 	iu->hash.user_data = iu;
 
@@ -36,6 +36,9 @@ simple_draw(void *arg)
 	stat_tap_table_item_type* field_data;
 	char fmt_string[250];
 
+	if (stat_data->stat_tap_data->stat_tap_draw_cb)
+		stat_data->stat_tap_data->stat_tap_draw_cb(stat_data->stat_tap_data);
+
 	/* printing results */
 	printf("\n");
 	printf("=====================================================================================================\n");
@@ -93,6 +96,8 @@ static void simple_finish(void *tapdata)
 {
 	stat_data_t *stat_data = (stat_data_t *)tapdata;
 
+	if (stat_data->stat_tap_data->stat_tap_finish_cb)
+		stat_data->stat_tap_data->stat_tap_finish_cb(stat_data->stat_tap_data);
 	g_free(stat_data->user_data);
 }
 
@@ -116,6 +121,8 @@ init_stat_table(stat_tap_table_ui *stat_tap, const char *filter)
 /*		free_rtd_table(&ui->rtd.stat_table); */
 		cmdarg_err("Couldn't register tap: %s", error_string->str);
 		g_string_free(error_string, TRUE);
+		if (stat_tap->stat_tap_finish_cb)
+			stat_tap->stat_tap_finish_cb(stat_tap);
 		return false;
 	}
 
@@ -31,11 +31,12 @@ depended_frames_add(GHashTable* depended_table, frame_data_sequence *frames, fra
     if (depth > prefs.gui_max_tree_depth) {
         return;
     }
-    if (g_hash_table_add(depended_table, GUINT_TO_POINTER(frame->num)) && frame->dependent_frames) {
+    GHashTable *dependent_frames = frame_data_get_dependent_frames(frame);
+    if (g_hash_table_add(depended_table, GUINT_TO_POINTER(frame->num)) && dependent_frames) {
         GHashTableIter iter;
         void *key;
         frame_data *depended_fd;
-        g_hash_table_iter_init(&iter, frame->dependent_frames);
+        g_hash_table_iter_init(&iter, dependent_frames);
         while (g_hash_table_iter_next(&iter, &key, NULL)) {
             depended_fd = frame_data_sequence_find(frames, GPOINTER_TO_UINT(key));
             depended_frames_add(depended_table, frames, depended_fd, depth + 1);
@@ -14,6 +14,7 @@
 #include <wsutil/ws_assert.h>
 
 #include <ui/qt/widgets/qcustomplot.h>
+#include <ui/qt/widgets/qcp_decimator.h>
 
 //#include <QMessageBox>
 
@@ -40,7 +41,8 @@ IOGraph::IOGraph(QCustomPlot* parent) :
     hf_index_(-1),
     interval_(0),
     asAOT_(false),
-    cur_idx_(-1)
+    cur_idx_(-1),
+    decimator_(new QCPDecimator(this))
 {
     GString* error_string;
     error_string = register_tap_listener("frame",
@@ -323,6 +325,7 @@ void IOGraph::clearAllData()
         reset_io_graph_items(&items_[0], items_.size(), hf_index_);
     }
     nstime_set_zero(&start_time_);
+    decimator_->clear();
     Graph::clearAllData();
 }
 
@@ -333,12 +336,7 @@ void IOGraph::recalcGraphData(capture_file* cap_file)
     unsigned int mavg_to_remove = 0, mavg_to_add = 0;
     double mavg_cumulated = 0;
 
-    if (graph_) {
-        graph_->data()->clear();
-    }
-    if (bars_) {
-        bars_->data()->clear();
-    }
+    QVector<double> keys, values;
 
     if (moving_avg_period_ > 0 && cur_idx_ >= 0) {
         /* "Warm-up phase" - calculate average on some data not displayed;
@@ -389,15 +387,19 @@ void IOGraph::recalcGraphData(capture_file* cap_file)
 
         if (hasItemToShow(i, val))
         {
-            if (graph_) {
-                graph_->addData(ts, val);
-            }
-            if (bars_) {
-                bars_->addData(ts, val);
-            }
+            keys.append(ts);
+            values.append(val);
         }
     }
 
+    // Small intervals over a long capture give millions of items, more
+    // than can be drawn; the decimator plots only what can be seen.
+    if (graph_) {
+        decimator_->setData(graph_, keys, values);
+    } else if (bars_) {
+        decimator_->setData(bars_, keys, values);
+    }
+
     emit requestReplot();
 }
 
@@ -22,6 +22,7 @@
 #include <vector>
 
 class QCPBars;
+class QCPDecimator;
 class QCPGraph;
 class QCustomPlot;
 
@@ -132,6 +133,9 @@ private:
     // much as is feasible.
     std::vector<io_graph_item_t> items_;
     int cur_idx_;
+
+    // Full-resolution data for graph_ or bars_
+    QCPDecimator *decimator_;
 };
 
 #endif // IO_GRAPH_H
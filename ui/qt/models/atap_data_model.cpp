@@ -41,6 +41,9 @@ ATapDataModel::ATapDataModel(dataModelType type, int protoId, QString filter, QO
     hash_.conv_array = nullptr;
     hash_.hashtable = nullptr;
     hash_.user_data = this;
+    hash_.top_items = 0;
+    hash_.top_by_bytes = false;
+    hash_.top = nullptr;
 
     storage_ = nullptr;
     _resolveNames = false;
@@ -179,6 +182,13 @@ void ATapDataModel::limitToDisplayFilter(bool limit)
     set_tap_flags(&hash_, _tapFlags);
 }
 
+void ATapDataModel::setTopItems(unsigned items, bool byBytes)
+{
+    /* Takes effect when the table is emptied for the next retap */
+    hash_.top_items = items;
+    hash_.top_by_bytes = byBytes;
+}
+
 int ATapDataModel::rowCount(const QModelIndex &parent) const
 {
     return (storage_ && !parent.isValid()) ? (int) storage_->len : 0;
@@ -531,6 +541,11 @@ QVariant EndpointDataModel::data(const QModelIndex &idx, int role) const
         return gchar_free_to_qstring(get_endpoint_filter(item));
     } else if (role == ATapDataModel::ROW_IS_FILTERED) {
         return (bool)item->filtered && showTotalColumn();
+    } else if (role == Qt::ToolTipRole) {
+        if ((idx.column() == ENDP_COLUMN_PACKETS || idx.column() == ENDP_COLUMN_BYTES) &&
+                (item->frames_error > 0 || item->bytes_error > 0))
+            return QObject::tr("Up to %Ln more packet(s) and %1 bytes may have been missed.", "", (int)item->frames_error)
+                    .arg(QLocale().toString((qulonglong)item->bytes_error));
     }
 #ifdef HAVE_MAXMINDDB
     else if (role == ATapDataModel::GEODATA_AVAILABLE) {
@@ -857,6 +872,10 @@ QVariant ConversationDataModel::data(const QModelIndex &idx, int role) const
     } else if (role == Qt::ToolTipRole) {
         if (idx.column() == CONV_COLUMN_START || idx.column() == CONV_COLUMN_DURATION)
             return QObject::tr("Bars show the relative timeline for each conversation.");
+        if ((idx.column() == CONV_COLUMN_PACKETS || idx.column() == CONV_COLUMN_BYTES) &&
+                (conv_item->frames_error > 0 || conv_item->bytes_error > 0))
+            return QObject::tr("Up to %Ln more packet(s) and %1 bytes may have been missed.", "", (int)conv_item->frames_error)
+                    .arg(QLocale().toString((qulonglong)conv_item->bytes_error));
     } else if (role == Qt::TextAlignmentRole) {
         if (idx.column() == CONV_COLUMN_SRC_ADDR || idx.column() == CONV_COLUMN_DST_ADDR)
             return Qt::AlignLeft;
@@ -166,6 +166,17 @@ public:
 
     void limitToDisplayFilter(bool limit);
 
+    /**
+     * @brief Keep only the heaviest conversations or endpoints
+     *
+     * Bounds the memory used for captures with very many of them, at the
+     * cost of approximate counts. Takes effect with the next retap.
+     *
+     * @param items the number of items to keep, 0 to keep all of them
+     * @param byBytes keep the items with the most bytes rather than packets
+     */
+    void setTopItems(unsigned items, bool byBytes);
+
     /**
      * @brief Are ports hidden for this model
      *
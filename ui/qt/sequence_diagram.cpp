@@ -18,6 +18,9 @@
 #include <ui/qt/widgets/qcp_axis_ticker_elided.h>
 #include "ui/recent.h"
 
+#include <algorithm>
+#include <cmath>
+
 #include <QFont>
 #include <QFontMetrics>
 #include <QPalette>
@@ -29,29 +32,18 @@ const int max_comment_em_width_ = 20;
 // UML-like network node sequence diagrams.
 // https://developer.ibm.com/articles/the-sequence-diagram/
 
-WSCPSeqData::WSCPSeqData() :
-  key(0),
-  value(NULL)
-{
-}
-
-WSCPSeqData::WSCPSeqData(double key, struct _seq_analysis_item *value) :
-  key(key),
-  value(value)
-{
-}
-
 SequenceDiagram::SequenceDiagram(QCPAxis *keyAxis, QCPAxis *valueAxis, QCPAxis *commentAxis) :
     QCPAbstractPlottable(keyAxis, valueAxis),
     key_axis_(keyAxis),
     value_axis_(valueAxis),
     comment_axis_(commentAxis),
-    data_(NULL),
+    items_sorted_(true),
+    first_tick_key_(1),
+    last_tick_key_(0),
     sainfo_(NULL),
     selected_packet_(0),
     selected_key_(-1.0)
 {
-    data_ = new WSCPSeqDataMap();
     // xaxis (value): Address
     // yaxis (key): Time
     // yaxis2 (comment): Extra info ("Comment" in GTK+)
@@ -100,87 +92,60 @@ SequenceDiagram::SequenceDiagram(QCPAxis *keyAxis, QCPAxis *valueAxis, QCPAxis *
 
 //    setTickVectorLabels
     //    valueAxis->setTickLabelRotation(30);
+
+    // The time and comment labels are only set for the rows around the
+    // visible ones. Do that before the axes set up their ticks.
+    connect(mParentPlot, &QCustomPlot::beforeReplot, this, &SequenceDiagram::plotBeforeReplot);
 }
 
 SequenceDiagram::~SequenceDiagram()
 {
-    delete data_;
 }
 
 int SequenceDiagram::adjacentPacket(bool next)
 {
-    int adjacent_packet = -1;
-    WSCPSeqDataMap::const_iterator it;
+    int adjacent_key;
 
-    if (data_->size() < 1) return adjacent_packet;
+    if (items_.isEmpty()) return -1;
 
     if (selected_packet_ < 1) {
-        if (next) {
-            it = data_->constBegin();
-        } else {
-            it = data_->constEnd();
-            --it;
-        }
-        selected_key_ = it.value().key;
-        return it.value().value->frame_number;
-    }
-
-    if (next) {
-        for (it = data_->constBegin(); it != data_->constEnd(); ++it) {
-            if (it.value().value->frame_number == selected_packet_) {
-                ++it;
-                if (it != data_->constEnd()) {
-                    adjacent_packet = it.value().value->frame_number;
-                    selected_key_ = it.value().key;
-                }
-                break;
-            }
-        }
+        adjacent_key = next ? 0 : static_cast<int>(items_.size()) - 1;
     } else {
-        it = data_->constEnd();
-        --it;
-        while (it != data_->constBegin()) {
-            uint32_t prev_frame = it.value().value->frame_number;
-            --it;
-            if (prev_frame == selected_packet_) {
-                adjacent_packet = it.value().value->frame_number;
-                selected_key_ = it.value().key;
-                break;
-            }
-        }
+        // If a packet has several items, step over all of them.
+        int cur_key = indexOfPacket(selected_packet_, next);
+        if (cur_key < 0) return -1;
+
+        adjacent_key = next ? cur_key + 1 : cur_key - 1;
+        if (adjacent_key < 0 || adjacent_key >= items_.size()) return -1;
     }
 
-    return adjacent_packet;
+    selected_key_ = adjacent_key;
+    return items_.at(adjacent_key)->frame_number;
 }
 
 void SequenceDiagram::setData(_seq_analysis_info *sainfo)
 {
-    data_->clear();
+    clearData();
     sainfo_ = sainfo;
     if (!sainfo) return;
 
-    double cur_key = 0.0;
-    QVector<double> key_ticks, val_ticks;
-    QVector<QString> key_labels, val_labels, com_labels;
+    QVector<double> val_ticks;
+    QVector<QString> val_labels;
     char* addr_str;
+    uint32_t prev_frame = 0;
 
+    items_.reserve(g_queue_get_length(sainfo->items));
     for (GList *cur = g_queue_peek_nth_link(sainfo->items, 0); cur; cur = gxx_list_next(cur)) {
         seq_analysis_item_t *sai = gxx_list_data(seq_analysis_item_t *, cur);
         if (sai->display) {
-            WSCPSeqData new_data;
-
-            new_data.key = cur_key;
-            new_data.value = sai;
-            data_->insert(new_data.key, new_data);
-
-            key_ticks.append(cur_key);
-            key_labels.append(sai->time_str);
-
-            com_labels.append(sai->comment);
-
-            cur_key++;
+            if (sai->frame_number < prev_frame) {
+                items_sorted_ = false;
+            }
+            prev_frame = sai->frame_number;
+            items_.append(sai);
         }
     }
+    items_.squeeze();
 
     for (unsigned int i = 0; i < sainfo_->num_nodes; i++) {
         val_ticks.append(i);
@@ -193,12 +158,18 @@ void SequenceDiagram::setData(_seq_analysis_info *sainfo)
         wmem_free(Q_NULLPTR, addr_str);
     }
 
-    QSharedPointer<QCPAxisTickerText> key_ticker = qSharedPointerCast<QCPAxisTickerText>(keyAxis()->ticker());
-    key_ticker->setTicks(key_ticks, key_labels);
     QSharedPointer<QCPAxisTickerText> value_ticker = qSharedPointerCast<QCPAxisTickerText>(valueAxis()->ticker());
     value_ticker->setTicks(val_ticks, val_labels);
-    QSharedPointer<QCPAxisTickerText> comment_ticker = qSharedPointerCast<QCPAxisTickerText>(comment_axis_->ticker());
-    comment_ticker->setTicks(key_ticks, com_labels);
+
+    selected_key_ = selected_packet_ > 0 ? indexOfPacket(selected_packet_, false) : -1;
+}
+
+void SequenceDiagram::clearData()
+{
+    items_.clear();
+    items_sorted_ = true;
+    first_tick_key_ = 1;
+    last_tick_key_ = 0;
 }
 
 void SequenceDiagram::setSelectedPacket(int selected_packet)
@@ -206,6 +177,7 @@ void SequenceDiagram::setSelectedPacket(int selected_packet)
     selected_key_ = -1;
     if (selected_packet > 0) {
         selected_packet_ = selected_packet;
+        selected_key_ = indexOfPacket(selected_packet_, false);
     } else {
         selected_packet_ = 0;
     }
@@ -216,8 +188,8 @@ _seq_analysis_item *SequenceDiagram::itemForPosY(int ypos)
 {
     double key_pos = qRound(key_axis_->pixelToCoord(ypos));
 
-    if (key_pos >= 0 && key_pos < data_->size()) {
-        return data_->value(key_pos).value;
+    if (key_pos >= 0 && key_pos < items_.size()) {
+        return items_.at(static_cast<int>(key_pos));
     }
     return NULL;
 }
@@ -240,7 +212,7 @@ double SequenceDiagram::selectTest(const QPointF &pos, bool, QVariant *) const
 {
     double key_pos = qRound(key_axis_->pixelToCoord(pos.y()));
 
-    if (key_pos >= 0 && key_pos < data_->size()) {
+    if (key_pos >= 0 && key_pos < items_.size()) {
         return 1.0;
     }
 
@@ -268,17 +240,17 @@ void SequenceDiagram::draw(QCPPainter *painter)
     painter->restore();
     fg_pen = pen();
 
-    WSCPSeqDataMap::const_iterator it;
-    for (it = data_->constBegin(); it != data_->constEnd(); ++it) {
-        double cur_key = it.key();
-        seq_analysis_item_t *sai = it.value().value;
+    // Only the rows that are at least partly visible.
+    int first_key, last_key;
+    visibleKeys(first_key, last_key, 0.5);
+    for (int cur_key = first_key; cur_key <= last_key; cur_key++) {
+        seq_analysis_item_t *sai = items_.at(cur_key);
         QColor bg_color;
 
         if (sai->frame_number == selected_packet_) {
             QPalette sel_pal;
             fg_pen.setColor(sel_pal.color(QPalette::HighlightedText));
             bg_color = sel_pal.color(QPalette::Highlight);
-            selected_key_ = cur_key;
         } else if ((sai->has_color_filter) && (recent.packet_list_colorize)) {
             fg_pen.setColor(QColor().fromRgb(sai->fg_color));
             bg_color = QColor().fromRgb(sai->bg_color);
@@ -384,22 +356,13 @@ void SequenceDiagram::drawLegendIcon(QCPPainter *, const QRectF &) const
 QCPRange SequenceDiagram::getKeyRange(bool &validRange, QCP::SignDomain) const
 {
     QCPRange range;
-    bool valid = false;
 
-    WSCPSeqDataMap::const_iterator it = data_->constBegin();
-    while (it != data_->constEnd()) {
-        double cur_key = it.key();
-        if (!valid) {
-            range.lower = range.upper = cur_key;
-            valid = true;
-        } else if (cur_key < range.lower) {
-            range.lower = cur_key;
-        } else if (cur_key > range.upper) {
-            range.upper = cur_key;
-        }
-        ++it;
+    // The keys are the indexes of items_.
+    validRange = !items_.isEmpty();
+    if (validRange) {
+        range.lower = 0;
+        range.upper = items_.size() - 1;
     }
-    validRange = valid;
     return range;
 }
 
@@ -410,9 +373,91 @@ QCPRange SequenceDiagram::getValueRange(bool &validRange, QCP::SignDomain, const
 
     if (sainfo_) {
         range.lower = 0;
-        range.upper = data_->size();
+        range.upper = items_.size();
         valid = true;
     }
     validRange = valid;
     return range;
 }
+
+void SequenceDiagram::plotBeforeReplot()
+{
+    updateTickLabels();
+}
+
+void SequenceDiagram::updateTickLabels()
+{
+    int first_key, last_key;
+
+    visibleKeys(first_key, last_key, 0.5);
+    if (first_key >= first_tick_key_ && last_key <= last_tick_key_) {
+        return;
+    }
+
+    // Label a page above and below the visible rows as well, so that
+    // scrolling doesn't have to redo this for every line.
+    visibleKeys(first_key, last_key, key_axis_->range().size() + 0.5);
+
+    QVector<double> key_ticks;
+    QVector<QString> key_labels, com_labels;
+
+    for (int cur_key = first_key; cur_key <= last_key; cur_key++) {
+        seq_analysis_item_t *sai = items_.at(cur_key);
+
+        key_ticks.append(cur_key);
+        key_labels.append(sai->time_str);
+        com_labels.append(sai->comment);
+    }
+
+    QSharedPointer<QCPAxisTickerText> key_ticker = qSharedPointerCast<QCPAxisTickerText>(keyAxis()->ticker());
+    key_ticker->setTicks(key_ticks, key_labels);
+    QSharedPointer<QCPAxisTickerText> comment_ticker = qSharedPointerCast<QCPAxisTickerText>(comment_axis_->ticker());
+    comment_ticker->setTicks(key_ticks, com_labels);
+
+    first_tick_key_ = first_key;
+    last_tick_key_ = last_key;
+}
+
+// The index of the first (or last) item for a packet, or -1 if it has none.
+int SequenceDiagram::indexOfPacket(uint32_t frame_number, bool last) const
+{
+    if (items_sorted_) {
+        if (last) {
+            auto it = std::upper_bound(items_.cbegin(), items_.cend(), frame_number,
+                                       [](uint32_t frame, const seq_analysis_item_t *sai) { return frame < sai->frame_number; });
+            if (it != items_.cbegin() && (*(it - 1))->frame_number == frame_number) {
+                return static_cast<int>(it - items_.cbegin()) - 1;
+            }
+        } else {
+            auto it = std::lower_bound(items_.cbegin(), items_.cend(), frame_number,
+                                       [](const seq_analysis_item_t *sai, uint32_t frame) { return sai->frame_number < frame; });
+            if (it != items_.cend() && (*it)->frame_number == frame_number) {
+                return static_cast<int>(it - items_.cbegin());
+            }
+        }
+        return -1;
+    }
+
+    if (last) {
+        for (int i = static_cast<int>(items_.size()) - 1; i >= 0; i--) {
+            if (items_.at(i)->frame_number == frame_number) return i;
+        }
+    } else {
+        for (int i = 0; i < items_.size(); i++) {
+            if (items_.at(i)->frame_number == frame_number) return i;
+        }
+    }
+    return -1;
+}
+
+// The keys of the items within margin of the visible key range. last is
+// less than first if there are none.
+void SequenceDiagram::visibleKeys(int &first, int &last, double margin) const
+{
+    const QCPRange range = key_axis_->range();
+
+    const double max_key = items_.size() - 1.0;
+
+    first = static_cast<int>(qBound(0.0, std::ceil(range.lower - margin), max_key + 1));
+    last = static_cast<int>(qBound(-1.0, std::floor(range.upper + margin), max_key));
+}
@@ -15,24 +15,12 @@
 #include <epan/address.h>
 
 #include <QObject>
-#include <QMultiMap>
+#include <QVector>
 #include <ui/qt/widgets/qcustomplot.h>
 
 struct _seq_analysis_info;
 struct _seq_analysis_item;
 
-// Some of this is probably unnecessary
-class WSCPSeqData
-{
-public:
-  WSCPSeqData();
-  WSCPSeqData(double key, _seq_analysis_item *value);
-  double key;
-  struct _seq_analysis_item *value;
-};
-
-typedef QMultiMap<double, WSCPSeqData> WSCPSeqDataMap;
-
 class SequenceDiagram : public QCPAbstractPlottable
 {
     Q_OBJECT
@@ -53,14 +41,21 @@ public:
     struct _seq_analysis_item *itemForPosY(int ypos);
     bool inComment(QPoint pos) const;
     QString elidedComment(const QString &text) const;
+    // Set the time and comment labels for the rows in the key range, if
+    // they aren't set yet. This happens before each replot; call it after
+    // changing the range without replotting, e.g. to export the diagram.
+    void updateTickLabels();
 
     // reimplemented virtual methods:
-    virtual void clearData() { data_->clear(); }
+    virtual void clearData();
     virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=0) const Q_DECL_OVERRIDE;
 
 public slots:
     void setSelectedPacket(int selected_packet);
 
+private slots:
+    void plotBeforeReplot();
+
 protected:
     virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
     virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
@@ -71,10 +66,19 @@ private:
     QCPAxis *key_axis_;
     QCPAxis *value_axis_;
     QCPAxis *comment_axis_;
-    WSCPSeqDataMap *data_;
+    // The displayed items in order. An item's key is its index, so only
+    // the ones in the visible key range need to be looked at.
+    QVector<struct _seq_analysis_item *> items_;
+    bool items_sorted_;
+    // The key range for which the time and comment ticks were set.
+    int first_tick_key_;
+    int last_tick_key_;
     struct _seq_analysis_info *sainfo_;
     uint32_t selected_packet_;
     double selected_key_;
+
+    int indexOfPacket(uint32_t frame_number, bool last) const;
+    void visibleKeys(int &first, int &last, double margin) const;
 };
 
 #endif // SEQUENCE_DIAGRAM_H
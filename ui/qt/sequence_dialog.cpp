@@ -583,6 +583,8 @@ void SequenceDialog::exportDiagram()
         QCPRange new_yrange(old_yrange.lower, old_yrange.lower + range_span);
         new_yrange = new_yrange.bounded(min_top_, num_items_);
         sp->yAxis->setRange(new_yrange);
+        // Saving draws without replotting, so label the exported rows here.
+        seq_diagram_->updateTickLabels();
         // margins of 0.5 on left and right for port number, etc.
         sp->xAxis2->setRange(min_left_, info_->sainfo()->num_nodes - 0.5);
         // As seen in resetAxes(), we have an item take ~ 1.5*one_em_ pixels.
@@ -633,11 +635,11 @@ void SequenceDialog::fillDiagram()
         if (analysis != NULL)
         {
             GString *error_string;
-            const char *filter = NULL;
-            if (ui->displayFilterCheckBox->checkState() == Qt::Checked)
-                filter = cap_file_.capFile()->dfilter;
 
-            error_string = register_tap_listener(sequence_analysis_get_tap_listener_name(analysis), info_->sainfo(), filter, sequence_analysis_get_tap_flags(analysis),
+            // Tap every packet. The display filter is applied afterwards
+            // in filterDiagram(), so that toggling it doesn't mean
+            // dissecting the whole file again.
+            error_string = register_tap_listener(sequence_analysis_get_tap_listener_name(analysis), info_->sainfo(), NULL, sequence_analysis_get_tap_flags(analysis),
                                        NULL, sequence_analysis_get_packet_func(analysis), NULL, NULL);
             if (error_string) {
                 report_failure("Sequence dialog - tap registration failed: %s", error_string->str);
@@ -647,8 +649,8 @@ void SequenceDialog::fillDiagram()
             cf_retap_packets(cap_file_.capFile());
             remove_tap_listener(info_->sainfo());
 
-            num_items_ = sequence_analysis_get_nodes(info_->sainfo());
-            seq_diagram_->setData(info_->sainfo());
+            filterDiagram();
+            return;
         }
     }
 
@@ -661,6 +663,38 @@ void SequenceDialog::fillDiagram()
     sp->setFocus();
 }
 
+// Show the items of the packets that match the display filter, or all of
+// them, without tapping again.
+void SequenceDialog::filterDiagram()
+{
+    if (!info_->sainfo() || file_closed_) return;
+
+    seq_analysis_info_t *sainfo = info_->sainfo();
+    capture_file *cf = cap_file_.capFile();
+    bool filtered = ui->displayFilterCheckBox->checkState() == Qt::Checked && cf->dfilter;
+
+    for (GList *cur = g_queue_peek_nth_link(sainfo->items, 0); cur; cur = gxx_list_next(cur)) {
+        seq_analysis_item_t *sai = gxx_list_data(seq_analysis_item_t *, cur);
+        if (filtered) {
+            frame_data *fdata = frame_data_sequence_find(cf->provider.frames, sai->frame_number);
+            sai->display = fdata && fdata->passed_dfilter;
+        } else {
+            sai->display = true;
+        }
+    }
+
+    sequence_analysis_free_nodes(sainfo);
+    num_items_ = sequence_analysis_get_nodes(sainfo);
+    seq_diagram_->setData(sainfo);
+
+    sequence_w_ = one_em_ * 15; // Arbitrary
+
+    mouseMoved(NULL);
+    resetAxes();
+
+    ui->sequencePlot->setFocus();
+}
+
 void SequenceDialog::panAxes(int x_pixels, int y_pixels)
 {
     // We could simplify this quite a bit if we set the scroll bar values instead.
@@ -826,7 +860,11 @@ void SequenceDialog::goToAdjacentPacket(bool next)
 
 void SequenceDialog::displayFilterCheckBoxToggled(bool)
 {
-    fillDiagram();
+    if (info_->sainfo() && strcmp(info_->sainfo()->name, "voip") == 0) {
+        fillDiagram();
+    } else {
+        filterDiagram();
+    }
 }
 
 void SequenceDialog::on_flowComboBox_activated(int index)
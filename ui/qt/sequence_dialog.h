@@ -77,6 +77,7 @@ private slots:
     void mouseWheeled(QWheelEvent *event);
 
     void fillDiagram();
+    void filterDiagram();
     void resetView();
     void exportDiagram();
     void layoutAxisLabels();
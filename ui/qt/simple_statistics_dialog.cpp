@@ -234,6 +234,9 @@ void SimpleStatisticsDialog::tapDraw(void *sd_ptr)
     SimpleStatisticsDialog *ss_dlg = static_cast<SimpleStatisticsDialog *>(sd->user_data);
     if (!ss_dlg) return;
 
+    if (sd->stat_tap_data->stat_tap_draw_cb) {
+        sd->stat_tap_data->stat_tap_draw_cb(sd->stat_tap_data);
+    }
     ss_dlg->addMissingRows(sd);
 
     QTreeWidgetItemIterator it(ss_dlg->statsTreeWidget());
@@ -266,6 +269,9 @@ void SimpleStatisticsDialog::fillTree()
                              tapReset,
                              stu_->packet_func,
                              tapDraw)) {
+        if (stu_->stat_tap_finish_cb) {
+            stu_->stat_tap_finish_cb(stu_);
+        }
         free_stat_tables(stu_);
         reject(); // XXX Stay open instead?
         return;
@@ -286,6 +292,9 @@ void SimpleStatisticsDialog::fillTree()
     statsTreeWidget()->setSortingEnabled(true);
 
     removeTapListeners();
+    if (stu_->stat_tap_finish_cb) {
+        stu_->stat_tap_finish_cb(stu_);
+    }
 }
 
 // This is how an item is represented for exporting.
@@ -612,6 +612,9 @@ void TCPStreamDialog::fillGraph(bool reset_axes, bool set_focus)
     base_graph_->setLineStyle(QCPGraph::lsNone);
     tracer_->setGraph(NULL);
 
+    for (QCPDecimator *decimator : decimators_) {
+        decimator->clear();
+    }
     // base_graph_ is always visible.
     for (int i = 0; i < sp->graphCount(); i++) {
         sp->graph(i)->data()->clear();
@@ -877,6 +880,24 @@ void TCPStreamDialog::panAxes(int x_pixels, int y_pixels)
     }
 }
 
+// Plot a graph through its decimator, so that streams with millions of
+// segments stay responsive. All of the points are plotted once the
+// graph is zoomed in far enough.
+void TCPStreamDialog::setGraphData(QCPGraph *graph, const QVector<double> &keys, const QVector<double> &values,
+                                   QCPErrorBars *error_bars, const QVector<double> &errors)
+{
+    QCPDecimator *decimator = decimators_.value(graph);
+    if (!decimator) {
+        decimator = new QCPDecimator(this);
+        decimators_.insert(graph, decimator);
+    }
+    if (error_bars) {
+        decimator->setData(graph, error_bars, keys, values, errors);
+    } else {
+        decimator->setData(graph, keys, values);
+    }
+}
+
 void TCPStreamDialog::resetAxes()
 {
     QCustomPlot *sp = ui->streamPlot;
@@ -930,7 +951,7 @@ void TCPStreamDialog::fillStevens()
         rel_time.append(ts - ts_offset_);
         seq.append(seg->th_seq - seq_offset_);
     }
-    base_graph_->setData(rel_time, seq);
+    setGraphData(base_graph_, rel_time, seq);
 }
 
 void TCPStreamDialog::fillTcptrace()
@@ -1029,18 +1050,15 @@ void TCPStreamDialog::fillTcptrace()
             rwin.append(ackno + seg->th_win);
         }
     }
-    base_graph_->setData(pkt_time, pkt_seqnums, true);
-    ack_graph_->setData(ackrwin_time, ack, true);
-    seg_graph_->setData(sb_time, sb_center, true);
-    seg_eb_->setData(sb_span);
-    sack_graph_->setData(sack_time, sack_center, true);
-    sack_eb_->setData(sack_span);
-    sack2_graph_->setData(sack2_time, sack2_center, true);
-    sack2_eb_->setData(sack2_span);
+    setGraphData(base_graph_, pkt_time, pkt_seqnums);
+    setGraphData(ack_graph_, ackrwin_time, ack);
+    setGraphData(seg_graph_, sb_time, sb_center, seg_eb_, sb_span);
+    setGraphData(sack_graph_, sack_time, sack_center, sack_eb_, sack_span);
+    setGraphData(sack2_graph_, sack2_time, sack2_center, sack2_eb_, sack2_span);
     rwin_graph_->setValueAxis(sp->yAxis);
-    rwin_graph_->setData(ackrwin_time, rwin, true);
-    dup_ack_graph_->setData(dup_ack_time, dup_ack, true);
-    zero_win_graph_->setData(zero_win_time, zero_win, true);
+    setGraphData(rwin_graph_, ackrwin_time, rwin);
+    setGraphData(dup_ack_graph_, dup_ack_time, dup_ack);
+    setGraphData(zero_win_graph_, zero_win_time, zero_win);
 }
 
 // If the current implementation of incorporating SACKs in goodput calc
@@ -1468,9 +1486,9 @@ void TCPStreamDialog::fillThroughput()
             r_Xput_times.append(ts);
         }
     }
-    base_graph_->setData(seg_rel_times, seg_lens);
-    tput_graph_->setData(tput_times, tputs);
-    goodput_graph_->setData(gput_times, gputs);
+    setGraphData(base_graph_, seg_rel_times, seg_lens);
+    setGraphData(tput_graph_, tput_times, tputs);
+    setGraphData(goodput_graph_, gput_times, gputs);
 }
 
 // rtt_selectively_ack_range:
@@ -1725,7 +1743,7 @@ void TCPStreamDialog::fillRoundTripTime()
     }
     // it's possible there's still unacked segs - so be sure to free list!
     rtt_destroy_unack_list(&unack_list);
-    base_graph_->setData(x_vals, rtt);
+    setGraphData(base_graph_, x_vals, rtt);
 }
 
 void TCPStreamDialog::fillWindowScale()
@@ -1805,9 +1823,9 @@ void TCPStreamDialog::fillWindowScale()
      *
      * We'll put the graphs on the same axis so they'll use the same scale.
      */
-    base_graph_->setData(cwnd_time, cwnd_size);
+    setGraphData(base_graph_, cwnd_time, cwnd_size);
     rwin_graph_->setValueAxis(sp->yAxis);
-    rwin_graph_->setData(rel_time, win_size);
+    setGraphData(rwin_graph_, rel_time, win_size);
 
     /* The left axis has the color and label for the unacked bytes,
      * and the right axis will have the color and label for the window size.
@@ -22,6 +22,8 @@
 #include "geometry_state_dialog.h"
 
 #include <ui/qt/widgets/qcustomplot.h>
+#include <ui/qt/widgets/qcp_decimator.h>
+#include <QHash>
 #include <QMenu>
 #include <QRubberBand>
 #include <QTimer>
@@ -89,6 +91,7 @@ private:
     QCPGraph *rwin_graph_;
     QCPGraph *dup_ack_graph_;
     QCPGraph *zero_win_graph_;
+    QHash<QCPGraph *, QCPDecimator *> decimators_;
     QCPItemTracer *tracer_;
     QRectF axis_bounds_;
     uint32_t packet_num_;
@@ -130,6 +133,8 @@ private:
     void zoomYAxis(bool in);
     void panAxes(int x_pixels, int y_pixels);
     void resetAxes();
+    void setGraphData(QCPGraph *graph, const QVector<double> &keys, const QVector<double> &values,
+                      QCPErrorBars *error_bars = nullptr, const QVector<double> &errors = QVector<double>());
     void fillStevens();
     void fillTcptrace();
     void fillThroughput();
@@ -61,6 +61,11 @@ TrafficTableDialog::TrafficTableDialog(QWidget &parent, CaptureFile &cf, const Q
     ui->trafficTab->setFocus();
     ui->trafficTab->useNanosecondTimestamps(cf.timestampPrecision() == WTAP_TSPREC_NSEC || cf.timestampPrecision() == WTAP_TSPREC_PER_PACKET);
     connect(ui->displayFilterCheckBox, &QCheckBox::toggled, this, &TrafficTableDialog::displayFilterCheckBoxToggled);
+    ui->topItemsCheckBox->setText(tr("Limit to top %Ln", "", (int)prefs.conv_top_items));
+    ui->topItemsCheckBox->setEnabled(prefs.conv_top_items > 0);
+    ui->topItemsByComboBox->setEnabled(prefs.conv_top_items > 0);
+    connect(ui->topItemsCheckBox, &QCheckBox::toggled, this, &TrafficTableDialog::topItemsCheckBoxToggled);
+    connect(ui->topItemsByComboBox, &QComboBox::currentIndexChanged, this, &TrafficTableDialog::topItemsByComboBoxChanged);
     connect(ui->trafficList, &TrafficTypesList::protocolsChanged, ui->trafficTab, &TrafficTab::setOpenTabs);
     connect(ui->trafficTab, &TrafficTab::tabsChanged, ui->trafficList, &TrafficTypesList::selectProtocols);
 
@@ -175,6 +180,27 @@ void TrafficTableDialog::displayFilterCheckBoxToggled(bool set_filter)
     cap_file_.retapPackets();
 }
 
+void TrafficTableDialog::topItemsCheckBoxToggled(bool checked)
+{
+    if (!cap_file_.isValid()) {
+        return;
+    }
+
+    ui->trafficTab->setTopItems(checked ? prefs.conv_top_items : 0,
+                                ui->topItemsByComboBox->currentIndex() == 1);
+    cap_file_.retapPackets();
+}
+
+void TrafficTableDialog::topItemsByComboBoxChanged(int index)
+{
+    if (!cap_file_.isValid() || !ui->topItemsCheckBox->isChecked()) {
+        return;
+    }
+
+    ui->trafficTab->setTopItems(prefs.conv_top_items, index == 1);
+    cap_file_.retapPackets();
+}
+
 void TrafficTableDialog::captureEvent(CaptureEvent e)
 {
     if (e.captureContext() == CaptureEvent::Retap)
@@ -183,9 +209,13 @@ void TrafficTableDialog::captureEvent(CaptureEvent e)
         {
         case CaptureEvent::Started:
             ui->displayFilterCheckBox->setEnabled(false);
+            ui->topItemsCheckBox->setEnabled(false);
+            ui->topItemsByComboBox->setEnabled(false);
             break;
         case CaptureEvent::Finished:
             ui->displayFilterCheckBox->setEnabled(true);
+            ui->topItemsCheckBox->setEnabled(prefs.conv_top_items > 0);
+            ui->topItemsByComboBox->setEnabled(prefs.conv_top_items > 0);
             break;
         default:
             break;
@@ -78,6 +78,8 @@ protected slots:
 private slots:
     void on_nameResolutionCheckBox_toggled(bool checked);
     void displayFilterCheckBoxToggled(bool checked);
+    void topItemsCheckBoxToggled(bool checked);
+    void topItemsByComboBoxChanged(int index);
     void aggregationSummaryOnlyCheckBoxToggled(bool checked);
     void captureEvent(CaptureEvent e);
 
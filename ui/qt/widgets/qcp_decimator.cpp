@@ -0,0 +1,226 @@
+/** @file
+ *
+ * Level of detail for QCustomPlot graphs with many points.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <ui/qt/widgets/qcp_decimator.h>
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+// Below this many points per pixel column, all of them are plotted.
+static const int full_points_per_column = 4;
+
+QCPDecimator::QCPDecimator(QObject *parent) :
+    QObject(parent),
+    mColumns(0),
+    mFull(false)
+{
+}
+
+void QCPDecimator::setData(QCPAbstractPlottable *plottable, const QVector<double> &keys, const QVector<double> &values)
+{
+    setPlottable(plottable);
+    mErrorBars = nullptr;
+    mKeys = keys;
+    mValues = values;
+    mErrors.clear();
+    sortData();
+    decimate(true);
+}
+
+void QCPDecimator::setData(QCPGraph *graph, QCPErrorBars *errorBars, const QVector<double> &keys,
+                           const QVector<double> &values, const QVector<double> &errors)
+{
+    setPlottable(graph);
+    mErrorBars = errorBars;
+    mKeys = keys;
+    mValues = values;
+    mErrors = errors;
+    sortData();
+    decimate(true);
+}
+
+void QCPDecimator::clear()
+{
+    mKeys.clear();
+    mValues.clear();
+    mErrors.clear();
+    mErrorBars = nullptr;
+    mFull = false;
+}
+
+void QCPDecimator::setPlottable(QCPAbstractPlottable *plottable)
+{
+    if (mPlottable && mPlottable->parentPlot()) {
+        disconnect(mPlottable->parentPlot(), &QCustomPlot::afterLayout, this, &QCPDecimator::plotAfterLayout);
+    }
+    mPlottable = plottable;
+    if (mPlottable && mPlottable->parentPlot()) {
+        connect(mPlottable->parentPlot(), &QCustomPlot::afterLayout, this, &QCPDecimator::plotAfterLayout);
+    }
+}
+
+void QCPDecimator::sortData()
+{
+    if (mValues.size() != mKeys.size()) {
+        mValues.resize(mKeys.size());
+    }
+    if (!mErrors.isEmpty() && mErrors.size() != mKeys.size()) {
+        mErrors.resize(mKeys.size());
+    }
+    if (std::is_sorted(mKeys.constBegin(), mKeys.constEnd())) {
+        return;
+    }
+
+    QVector<int> order(mKeys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return mKeys[a] < mKeys[b]; });
+
+    QVector<double> keys, values, errors;
+    keys.reserve(order.size());
+    values.reserve(order.size());
+    errors.reserve(mErrors.isEmpty() ? 0 : order.size());
+    for (int idx : order) {
+        keys.append(mKeys[idx]);
+        values.append(mValues[idx]);
+        if (!mErrors.isEmpty()) {
+            errors.append(mErrors[idx]);
+        }
+    }
+    mKeys = keys;
+    mValues = values;
+    mErrors = errors;
+}
+
+// Add the first, lowest, highest and last of the points in [begin, end).
+void QCPDecimator::addExtremes(QVector<int> &indices, int begin, int end) const
+{
+    if (begin >= end) {
+        return;
+    }
+
+    int low_idx = begin;
+    int high_idx = begin;
+    double low = mValues[begin] - (mErrors.isEmpty() ? 0 : mErrors[begin]);
+    double high = mValues[begin] + (mErrors.isEmpty() ? 0 : mErrors[begin]);
+    for (int i = begin + 1; i < end; i++) {
+        double error = mErrors.isEmpty() ? 0 : mErrors[i];
+        // NaN values (gaps) compare false and are skipped
+        if (mValues[i] - error < low) {
+            low = mValues[i] - error;
+            low_idx = i;
+        }
+        if (mValues[i] + error > high) {
+            high = mValues[i] + error;
+            high_idx = i;
+        }
+    }
+
+    int group[] = { begin, low_idx, high_idx, end - 1 };
+    std::sort(group, group + 4);
+    for (int j = 0; j < 4; j++) {
+        if (indices.isEmpty() || indices.last() != group[j]) {
+            indices.append(group[j]);
+        }
+    }
+}
+
+void QCPDecimator::decimate(bool force)
+{
+    if (!mPlottable || !mPlottable->keyAxis()) {
+        return;
+    }
+
+    QCPAxis *key_axis = mPlottable->keyAxis();
+    QCPRange range = key_axis->range();
+    int columns = 1;
+    if (key_axis->axisRect()) {
+        QRect rect = key_axis->axisRect()->rect();
+        columns = std::max(1, key_axis->orientation() == Qt::Horizontal ? rect.width() : rect.height());
+    }
+    int count = static_cast<int>(mKeys.size());
+    bool full = count <= columns * full_points_per_column;
+
+    // Stacked bars are matched up by key, so they all need every key.
+    QCPBars *bars = qobject_cast<QCPBars *>(mPlottable.data());
+    if (bars && (bars->barBelow() || bars->barAbove())) {
+        full = true;
+    }
+
+    if (!force && (full ? mFull : (!mFull && range == mRange && columns == mColumns))) {
+        return;
+    }
+    mRange = range;
+    mColumns = columns;
+    mFull = full;
+
+    QVector<int> indices;
+    if (!full) {
+        int begin = static_cast<int>(std::lower_bound(mKeys.constBegin(), mKeys.constEnd(), range.lower) - mKeys.constBegin());
+        int end = static_cast<int>(std::upper_bound(mKeys.constBegin(), mKeys.constEnd(), range.upper) - mKeys.constBegin());
+
+        indices.reserve(columns * full_points_per_column + 8);
+        addExtremes(indices, 0, begin);
+        if (end - begin <= columns * full_points_per_column) {
+            for (int i = begin; i < end; i++) {
+                indices.append(i);
+            }
+        } else {
+            int group_begin = begin;
+            int group_column = static_cast<int>(std::floor(key_axis->coordToPixel(mKeys[begin])));
+            for (int i = begin + 1; i < end; i++) {
+                int column = static_cast<int>(std::floor(key_axis->coordToPixel(mKeys[i])));
+                if (column != group_column) {
+                    addExtremes(indices, group_begin, i);
+                    group_begin = i;
+                    group_column = column;
+                }
+            }
+            addExtremes(indices, group_begin, end);
+        }
+        addExtremes(indices, end, count);
+    }
+
+    QVector<double> keys, values, errors;
+    if (full) {
+        keys = mKeys;
+        values = mValues;
+        errors = mErrors;
+    } else {
+        keys.reserve(indices.size());
+        values.reserve(indices.size());
+        errors.reserve(mErrors.isEmpty() ? 0 : indices.size());
+        for (int idx : indices) {
+            keys.append(mKeys[idx]);
+            values.append(mValues[idx]);
+            if (!mErrors.isEmpty()) {
+                errors.append(mErrors[idx]);
+            }
+        }
+    }
+
+    if (QCPGraph *graph = qobject_cast<QCPGraph *>(mPlottable.data())) {
+        graph->setData(keys, values, true);
+    } else if (bars) {
+        bars->setData(keys, values, true);
+    }
+    if (mErrorBars) {
+        mErrorBars->setData(errors);
+    }
+}
+
+void QCPDecimator::plotAfterLayout()
+{
+    if (mKeys.isEmpty()) {
+        return;
+    }
+    decimate(false);
+}
@@ -0,0 +1,70 @@
+/** @file
+ *
+ * Level of detail for QCustomPlot graphs with many points.
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef QCP_DECIMATOR_H
+#define QCP_DECIMATOR_H
+
+#include <ui/qt/widgets/qcustomplot.h>
+
+#include <QPointer>
+#include <QVector>
+
+/*
+ * Keeps the full data of a QCPGraph or QCPBars and gives the plottable
+ * only the points that make a difference at the current zoom level:
+ * for each pixel column of the key axis the first, lowest, highest and
+ * last point, and all of the points once few enough of them are visible.
+ * Points outside the visible key range are reduced to the same four, so
+ * that rescaleAxes() still sees the full extent of the data.
+ *
+ * The points that are plotted are real data points, so tracers and
+ * lookups by key keep working. The data is decimated again during each
+ * replot, after the layout is updated and before anything is drawn, if
+ * the key range or the size of the axis rect has changed.
+ */
+class QCPDecimator : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QCPDecimator(QObject *parent = nullptr);
+
+    // The keys don't need to be sorted.
+    void setData(QCPAbstractPlottable *plottable, const QVector<double> &keys, const QVector<double> &values);
+    // As above, with error bars, which are taken into account as part
+    // of the value when looking for the lowest and highest points.
+    void setData(QCPGraph *graph, QCPErrorBars *errorBars, const QVector<double> &keys,
+                 const QVector<double> &values, const QVector<double> &errors);
+    // Forget the data. The plottable is left alone.
+    void clear();
+    int dataCount() const { return static_cast<int>(mKeys.size()); }
+
+private slots:
+    void plotAfterLayout();
+
+private:
+    void setPlottable(QCPAbstractPlottable *plottable);
+    void sortData();
+    void addExtremes(QVector<int> &indices, int begin, int end) const;
+    void decimate(bool force);
+
+    QPointer<QCPAbstractPlottable> mPlottable;
+    QPointer<QCPErrorBars> mErrorBars;
+    QVector<double> mKeys;
+    QVector<double> mValues;
+    QVector<double> mErrors;
+
+    // What the plottable was last given
+    QCPRange mRange;
+    int mColumns;
+    bool mFull;
+};
+
+#endif
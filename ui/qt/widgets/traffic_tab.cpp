@@ -74,6 +74,8 @@ TrafficTab::TrafficTab(QWidget * parent) :
     _nameResolution = false;
     _absoluteTime = false;
     _limitToDisplayFilter = false;
+    _topItems = 0;
+    _topByBytes = false;
     _nanoseconds = false;
     _machineReadable = false;
     setTabBasename(QString());
@@ -121,6 +123,7 @@ QTreeView * TrafficTab::createTree(int protoId)
         ATapDataModel * model = _createModel(protoId, "");
         model->useAbsoluteTime(_absoluteTime);
         model->limitToDisplayFilter(_limitToDisplayFilter);
+        model->setTopItems(_topItems, _topByBytes);
         model->useNanosecondTimestamps(_nanoseconds);
         model->setResolveNames(_nameResolution);
         model->setParent(tree);
@@ -233,6 +236,21 @@ void TrafficTab::limitToDisplayFilter(bool limit)
     }
 }
 
+void TrafficTab::setTopItems(unsigned items, bool byBytes)
+{
+    if (items == _topItems && byBytes == _topByBytes)
+        return;
+
+    _topItems = items;
+    _topByBytes = byBytes;
+    for(int idx = 0; idx < count(); idx++)
+    {
+        ATapDataModel * atdm = dataModelForTabIndex(idx);
+        if (atdm)
+            atdm->setTopItems(items, byBytes);
+    }
+}
+
 void TrafficTab::setMachineReadable(bool machine)
 {
     if (machine == _machineReadable)
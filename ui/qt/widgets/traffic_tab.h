@@ -218,6 +218,7 @@ public slots:
      */
     void useAbsoluteTime(bool absolute);
     void limitToDisplayFilter(bool limit);
+    void setTopItems(unsigned items, bool byBytes);
     void setMachineReadable(bool machine);
 
     void setOpenTabs(QList<int> protocols);
@@ -247,6 +248,8 @@ private:
     bool _nameResolution;
     bool _absoluteTime;
     bool _limitToDisplayFilter;
+    unsigned _topItems;
+    bool _topByBytes;
     bool _nanoseconds;
     bool _machineReadable;
 
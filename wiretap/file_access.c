@@ -2173,7 +2173,7 @@ static bool wtap_dump_open_finish(wtap_dumper *wdh, int *err,
 
 static WFILE_T wtap_dump_file_open(wtap_dumper *wdh, const char *filename);
 static WFILE_T wtap_dump_file_fdopen(wtap_dumper *wdh, int fd);
-static int wtap_dump_file_close(wtap_dumper *wdh);
+static int wtap_dump_file_close(wtap_dumper *wdh, const char **err_info);
 
 static wtap_dumper *
 wtap_dump_init_dumper(int file_type_subtype, wtap_compression_type compression_type,
@@ -2325,7 +2325,7 @@ wtap_dump_open(const char *filename, int file_type_subtype,
 	if (!wtap_dump_open_finish(wdh, err, err_info)) {
 		/* Get rid of the file we created; we couldn't finish
 		   opening it. */
-		wtap_dump_file_close(wdh);
+		wtap_dump_file_close(wdh, NULL);
 		ws_unlink(filename);
 		g_free(wdh);
 		return NULL;
@@ -2387,7 +2387,7 @@ wtap_dump_open_tempfile(const char *tmpdir, char **filenamep, const char *pfx,
 	if (!wtap_dump_open_finish(wdh, err, err_info)) {
 		/* Get rid of the file we created; we couldn't finish
 		   opening it. */
-		wtap_dump_file_close(wdh);
+		wtap_dump_file_close(wdh, NULL);
 		ws_unlink(*filenamep);
 		g_free(wdh);
 		return NULL;
@@ -2423,7 +2423,7 @@ wtap_dump_fdopen(int fd, int file_type_subtype, wtap_compression_type compressio
 	wdh->fh = fh;
 
 	if (!wtap_dump_open_finish(wdh, err, err_info)) {
-		wtap_dump_file_close(wdh);
+		wtap_dump_file_close(wdh, NULL);
 		g_free(wdh);
 		return NULL;
 	}
@@ -2572,6 +2572,7 @@ wtap_dump_close(wtap_dumper *wdh, bool *needs_reload,
     int *err, char **err_info)
 {
 	bool ret = true;
+	const char *close_err_info = NULL;
 
 	*err = 0;
 	*err_info = NULL;
@@ -2581,13 +2582,15 @@ wtap_dump_close(wtap_dumper *wdh, bool *needs_reload,
 			ret = false;
 	}
 	errno = WTAP_ERR_CANT_CLOSE;
-	if (wtap_dump_file_close(wdh) == EOF) {
+	if (wtap_dump_file_close(wdh, &close_err_info) == EOF) {
 		if (ret) {
 			/* The per-format finish function succeeded,
 			   but the stream close didn't.  Save the
 			   reason why, if our caller asked for it. */
-			if (err != NULL)
+			if (err != NULL) {
 				*err = errno;
+				*err_info = g_strdup(close_err_info);
+			}
 		}
 		ret = false;
 	}
@@ -2769,22 +2772,33 @@ wtap_dump_file_write(wtap_dumper *wdh, const void *buf, size_t bufsize, int *err
 	return true;
 }
 
-/* internally close a file for writing (compressed or not) */
+/* internally close a file for writing (compressed or not); like fclose(),
+   returns EOF and sets errno on failure, and also sets *err_info if
+   err_info isn't NULL and there's more to say about the error */
 static int
-wtap_dump_file_close(wtap_dumper *wdh)
+wtap_dump_file_close(wtap_dumper *wdh, const char **err_info)
 {
+	int err = 0;
+
 	switch (wdh->compression_type) {
 #if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
 	case WTAP_GZIP_COMPRESSED:
-		return gzwfile_close((GZWFILE_T)wdh->fh);
+		err = gzwfile_close((GZWFILE_T)wdh->fh, err_info);
+		break;
 #endif
 #ifdef HAVE_LZ4FRAME_H
 	case WTAP_LZ4_COMPRESSED:
-		return lz4wfile_close((LZ4WFILE_T)wdh->fh);
+		err = lz4wfile_close((LZ4WFILE_T)wdh->fh, err_info);
+		break;
 #endif /* HAVE_LZ4FRAME_H */
 	default:
 		return fclose((FILE *)wdh->fh);
 	}
+	if (err != 0) {
+		errno = err;
+		return EOF;
+	}
+	return 0;
 }
 
 int64_t
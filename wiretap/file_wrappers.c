@@ -98,6 +98,20 @@ wtap_can_write_compression_type(wtap_compression_type compression_type)
     return false;
 }
 
+/*
+ * Number of threads used to compress output files; 0 means one per
+ * processor, up to MAX_COMPRESSION_THREADS. The default of 1 compresses
+ * the output as a single stream, in the thread writing it.
+ */
+#define MAX_COMPRESSION_THREADS 16
+static unsigned compression_threads = 1;
+
+void
+wtap_set_compression_threads(unsigned threads)
+{
+    compression_threads = threads;
+}
+
 wtap_compression_type
 wtap_get_compression_type(wtap *wth)
 {
@@ -2563,7 +2577,245 @@ file_close(FILE_T file)
         ws_close(fd);
 }
 
+#if defined (USE_ZLIB_OR_ZLIBNG) || defined (HAVE_LZ4FRAME_H)
+/*
+ * Parallel block compression for writing, as done by pigz.
+ *
+ * The uncompressed data is cut into fixed-size blocks, and each block
+ * is compressed by a thread pool into a self-contained unit (a gzip
+ * member or an LZ4 frame). The compressed blocks are written in order
+ * by the thread calling write or close. A file made of several
+ * concatenated gzip members or LZ4 frames is read like a single one,
+ * and each of them is a fast seek point.
+ */
+typedef struct {
+    unsigned char *in;
+    size_t in_len;
+    unsigned char *out;
+    size_t out_len;
+    int err;
+    const char *err_info;
+    bool done;
+} comp_block;
+
+/* Compress blk->in into blk->out, which has room for out_bound bytes.
+ * Runs on a worker thread. On failure, sets blk->err. */
+typedef void (*comp_block_func)(comp_block *blk, size_t out_bound, void *data);
+
+typedef struct {
+    int fd;
+    GThreadPool *pool;
+    GMutex mutex;
+    GCond cond;
+    GQueue blocks;          /* submitted blocks, in file order */
+    unsigned max_blocks;    /* limit on submitted blocks, to bound memory */
+    comp_block *cur;        /* block being filled */
+    size_t block_size;
+    size_t out_bound;
+    comp_block_func compress;
+    void *compress_data;
+    int err;
+    const char *err_info;
+} par_writer;
+
+static unsigned
+get_compression_threads(void)
+{
+    if (compression_threads != 0)
+        return compression_threads;
+    return MIN((unsigned)g_get_num_processors(), MAX_COMPRESSION_THREADS);
+}
+
+static void
+par_writer_worker(void *data, void *user_data)
+{
+    comp_block *blk = (comp_block *)data;
+    par_writer *pw = (par_writer *)user_data;
+
+    pw->compress(blk, pw->out_bound, pw->compress_data);
+
+    g_mutex_lock(&pw->mutex);
+    blk->done = true;
+    g_cond_broadcast(&pw->cond);
+    g_mutex_unlock(&pw->mutex);
+}
+
+static par_writer *
+par_writer_new(int fd, unsigned threads, size_t block_size, size_t out_bound,
+               comp_block_func compress, void *compress_data)
+{
+    par_writer *pw = g_new0(par_writer, 1);
+
+    pw->fd = fd;
+    g_mutex_init(&pw->mutex);
+    g_cond_init(&pw->cond);
+    g_queue_init(&pw->blocks);
+    pw->max_blocks = 2 * threads;
+    pw->block_size = block_size;
+    pw->out_bound = out_bound;
+    pw->compress = compress;
+    pw->compress_data = compress_data;
+    pw->pool = g_thread_pool_new(par_writer_worker, pw, threads, false, NULL);
+    return pw;
+}
+
+static void
+comp_block_free(comp_block *blk)
+{
+    g_free(blk->in);
+    g_free(blk->out);
+    g_free(blk);
+}
+
+/* Write the compressed blocks at the head of the queue that are done.
+ * If all is true, wait for and write every submitted block; otherwise
+ * wait only while more than max_blocks are queued. */
+static bool
+par_writer_drain(par_writer *pw, bool all)
+{
+    comp_block *blk;
+    ssize_t got;
+
+    g_mutex_lock(&pw->mutex);
+    while ((blk = (comp_block *)g_queue_peek_head(&pw->blocks)) != NULL) {
+        if (!blk->done) {
+            if (!all && g_queue_get_length(&pw->blocks) <= pw->max_blocks)
+                break;
+            g_cond_wait(&pw->cond, &pw->mutex);
+            continue;
+        }
+        g_queue_pop_head(&pw->blocks);
+        g_mutex_unlock(&pw->mutex);
+
+        if (pw->err == 0) {
+            if (blk->err != 0) {
+                pw->err = blk->err;
+                pw->err_info = blk->err_info;
+            } else if (blk->out_len != 0) {
+                got = ws_write(pw->fd, blk->out, (unsigned)blk->out_len);
+                if (got < 0) {
+                    pw->err = errno;
+                } else if ((size_t)got != blk->out_len) {
+                    pw->err = WTAP_ERR_SHORT_WRITE;
+                }
+            }
+        }
+        comp_block_free(blk);
+        g_mutex_lock(&pw->mutex);
+    }
+    g_mutex_unlock(&pw->mutex);
+    return pw->err == 0;
+}
+
+/* Hand the block being filled to the thread pool. */
+static bool
+par_writer_submit(par_writer *pw)
+{
+    comp_block *blk = pw->cur;
+
+    if (blk == NULL || blk->in_len == 0)
+        return true;
+    pw->cur = NULL;
+    blk->out = (unsigned char *)g_try_malloc(pw->out_bound);
+    if (blk->out == NULL) {
+        comp_block_free(blk);
+        pw->err = ENOMEM;
+        return false;
+    }
+    g_mutex_lock(&pw->mutex);
+    g_queue_push_tail(&pw->blocks, blk);
+    g_mutex_unlock(&pw->mutex);
+    g_thread_pool_push(pw->pool, blk, NULL);
+    return par_writer_drain(pw, false);
+}
+
+static bool
+par_writer_write(par_writer *pw, const void *buf, size_t len)
+{
+    size_t n;
+
+    if (pw->err != 0)
+        return false;
+    while (len != 0) {
+        if (pw->cur == NULL) {
+            pw->cur = g_new0(comp_block, 1);
+            pw->cur->in = (unsigned char *)g_try_malloc(pw->block_size);
+            if (pw->cur->in == NULL) {
+                g_free(pw->cur);
+                pw->cur = NULL;
+                pw->err = ENOMEM;
+                return false;
+            }
+        }
+        n = MIN(len, pw->block_size - pw->cur->in_len);
+        memcpy(pw->cur->in + pw->cur->in_len, buf, n);
+        pw->cur->in_len += n;
+        buf = (const char *)buf + n;
+        len -= n;
+        if (pw->cur->in_len == pw->block_size && !par_writer_submit(pw))
+            return false;
+    }
+    return true;
+}
+
+/* Compress and write everything written so far. */
+static bool
+par_writer_flush(par_writer *pw)
+{
+    if (pw->err != 0)
+        return false;
+    if (!par_writer_submit(pw))
+        return false;
+    return par_writer_drain(pw, true);
+}
+
+/* Write the blocks that were submitted, stop the threads and free the
+ * writer. The block being filled, if any, is dropped. The file descriptor
+ * is not closed. Returns 0 or an error code. */
+static int
+par_writer_free(par_writer *pw, const char **err_info)
+{
+    int err;
+
+    g_thread_pool_free(pw->pool, false, true);
+    par_writer_drain(pw, true);
+    if (pw->cur != NULL)
+        comp_block_free(pw->cur);
+    g_mutex_clear(&pw->mutex);
+    g_cond_clear(&pw->cond);
+    err = pw->err;
+    if (err_info)
+        *err_info = pw->err_info;
+    g_free(pw);
+    return err;
+}
+
+/* Flush, stop the threads and free the writer. The file descriptor
+ * is not closed. Returns 0 or an error code. */
+static int
+par_writer_close(par_writer *pw, const char **err_info)
+{
+    par_writer_flush(pw);
+    return par_writer_free(pw, err_info);
+}
+
+/* Write the blocks that were submitted, stop the threads and free the
+ * writer, and hand back the block being filled, or NULL, so that its
+ * data can be compressed as part of a stream. Returns 0 or an error
+ * code. */
+static int
+par_writer_detach(par_writer *pw, comp_block **cur, const char **err_info)
+{
+    *cur = pw->cur;
+    pw->cur = NULL;
+    return par_writer_free(pw, err_info);
+}
+#endif /* USE_ZLIB_OR_ZLIBNG || HAVE_LZ4FRAME_H */
+
 #ifdef USE_ZLIB_OR_ZLIBNG
+/* Size of the blocks compressed in parallel. Each one becomes a gzip member. */
+#define GZ_PAR_BLOCK_SIZE   (1024 * 1024)
+
 /* internal gzip file state data structure for writing */
 struct wtap_writer {
     int fd;                 /* file descriptor */
@@ -2579,8 +2831,57 @@ struct wtap_writer {
     const char *err_info;   /* additional error information string for some errors */
     /* zlib deflate stream */
     zlib_stream strm;          /* stream structure in-place (not a pointer) */
+    par_writer *par;        /* parallel compression, or NULL */
 };
 
+/* The most that a GZ_PAR_BLOCK_SIZE block can compress to, including
+   the gzip header and trailer, or 0 on error. */
+static size_t
+gz_par_out_bound(GZWFILE_T state)
+{
+    zlib_stream strm;
+    size_t bound;
+
+    memset(&strm, 0, sizeof(strm));
+    if (ZLIB_PREFIX(deflateInit2)(&strm, state->level, Z_DEFLATED,
+                       15 + 16, 8, state->strategy) != Z_OK)
+        return 0;
+    bound = ZLIB_PREFIX(deflateBound)(&strm, GZ_PAR_BLOCK_SIZE);
+    (void)ZLIB_PREFIX(deflateEnd)(&strm);
+    return bound;
+}
+
+static void
+gz_comp_block(comp_block *blk, size_t out_bound, void *data)
+{
+    GZWFILE_T state = (GZWFILE_T)data;
+    zlib_stream strm;
+    int ret;
+
+    memset(&strm, 0, sizeof(strm));
+    ret = ZLIB_PREFIX(deflateInit2)(&strm, state->level, Z_DEFLATED,
+                       15 + 16, 8, state->strategy);
+    if (ret != Z_OK) {
+        blk->err = (ret == Z_MEM_ERROR) ? ENOMEM : WTAP_ERR_INTERNAL;
+        blk->err_info = "Unknown error from deflateInit2()";
+        return;
+    }
+DIAG_OFF(cast-qual)
+    strm.next_in = (Bytef *)blk->in;
+DIAG_ON(cast-qual)
+    strm.avail_in = (unsigned)blk->in_len;
+    strm.next_out = blk->out;
+    strm.avail_out = (unsigned)out_bound;
+    ret = ZLIB_PREFIX(deflate)(&strm, Z_FINISH);
+    if (ret != Z_STREAM_END) {
+        /* This "shouldn't happen"; the output buffer is big enough. */
+        blk->err = WTAP_ERR_INTERNAL;
+        blk->err_info = "Unexpected result from deflate()";
+    }
+    blk->out_len = out_bound - strm.avail_out;
+    (void)ZLIB_PREFIX(deflateEnd)(&strm);
+}
+
 GZWFILE_T
 gzwfile_open(const char *path)
 {
@@ -2604,6 +2905,8 @@ GZWFILE_T
 gzwfile_fdopen(int fd)
 {
     GZWFILE_T state;
+    unsigned threads;
+    size_t out_bound;
 
     /* allocate wtap_writer structure to return */
     state = (GZWFILE_T)g_try_malloc(sizeof *state);
@@ -2622,6 +2925,13 @@ gzwfile_fdopen(int fd)
     state->pos = 0;                 /* no uncompressed data yet */
     state->strm.avail_in = 0;       /* no input data yet */
 
+    threads = get_compression_threads();
+    state->par = NULL;
+    if (threads > 1 && (out_bound = gz_par_out_bound(state)) != 0) {
+        state->par = par_writer_new(fd, threads, GZ_PAR_BLOCK_SIZE,
+                                    out_bound, gz_comp_block, state);
+    }
+
     /* return stream */
     return state;
 }
@@ -2757,6 +3067,16 @@ gzwfile_write(GZWFILE_T state, const void *buf, unsigned len)
     if (len == 0)
         return 0;
 
+    if (state->par) {
+        if (!par_writer_write(state->par, buf, len)) {
+            state->err = state->par->err;
+            state->err_info = state->par->err_info;
+            return 0;
+        }
+        state->pos += len;
+        return put;
+    }
+
     /* allocate memory if this is the first time through */
     if (state->size == 0 && gz_init(state) == -1)
         return 0;
@@ -2808,6 +3128,29 @@ DIAG_ON(cast-qual)
     return (int)put;
 }
 
+/* Stop compressing in parallel, and compress the data that wasn't handed
+   to the threads yet, and everything after it, as a stream.  Returns -1,
+   and sets state->err, on failure; returns 0 on success. */
+static int
+gz_par_to_stream(GZWFILE_T state)
+{
+    comp_block *cur;
+    int err;
+
+    err = par_writer_detach(state->par, &cur, &state->err_info);
+    state->par = NULL;
+    if (err != 0) {
+        state->err = err;
+    } else if (cur != NULL) {
+        /* gzwfile_write() counts these bytes again. */
+        state->pos -= cur->in_len;
+        gzwfile_write(state, cur->in, (unsigned)cur->in_len);
+    }
+    if (cur != NULL)
+        comp_block_free(cur);
+    return state->err == Z_OK ? 0 : -1;
+}
+
 /* Flush out what we've written so far.  Returns -1, and sets state->err,
    on failure; returns 0 on success. */
 int
@@ -2817,6 +3160,13 @@ gzwfile_flush(GZWFILE_T state)
     if (state->err != Z_OK)
         return -1;
 
+    /* Flushing is done when the data has to be in the file as it comes,
+       as in a live capture. With parallel compression, each flush would
+       end a gzip member and wait for the threads, so go on as a single
+       stream instead. */
+    if (state->par && gz_par_to_stream(state) == -1)
+        return -1;
+
     /* compress remaining data with Z_SYNC_FLUSH */
     gz_comp(state, Z_SYNC_FLUSH);
     if (state->err != Z_OK)
@@ -2825,15 +3175,32 @@ gzwfile_flush(GZWFILE_T state)
 }
 
 /* Flush out all data written, and close the file.  Returns a Wiretap
-   error on failure; returns 0 on success. */
+   error, and sets *err_info if err_info isn't NULL, on failure; returns
+   0 on success. */
 int
-gzwfile_close(GZWFILE_T state)
+gzwfile_close(GZWFILE_T state, const char **err_info)
 {
     int ret = 0;
 
+    if (state->par) {
+        ret = par_writer_close(state->par, &state->err_info);
+        if (state->err != Z_OK)
+            ret = state->err;
+        state->err = Z_OK;
+        if (ret != 0 && err_info != NULL)
+            *err_info = state->err_info;
+        if (ws_close(state->fd) == -1 && ret == 0)
+            ret = errno;
+        g_free(state);
+        return ret;
+    }
+
     /* flush, free memory, and close file */
-    if (gz_comp(state, Z_FINISH) == -1)
+    if (gz_comp(state, Z_FINISH) == -1) {
         ret = state->err;
+        if (err_info != NULL)
+            *err_info = state->err_info;
+    }
     (void)ZLIB_PREFIX(deflateEnd)(&(state->strm));
     g_free(state->out);
     g_free(state->in);
@@ -2865,8 +3232,25 @@ struct lz4_writer {
     const char *err_info;   /* additional error information string for some errors */
     LZ4F_preferences_t lz4_prefs;
     LZ4F_cctx *lz4_cctx;
+    par_writer *par;        /* parallel compression, or NULL */
 };
 
+/* Compress a block into a complete LZ4 frame. */
+static void
+lz4_comp_block(comp_block *blk, size_t out_bound, void *data)
+{
+    LZ4WFILE_T state = (LZ4WFILE_T)data;
+    size_t ret;
+
+    ret = LZ4F_compressFrame(blk->out, out_bound, blk->in, blk->in_len, &state->lz4_prefs);
+    if (LZ4F_isError(ret)) {
+        blk->err = WTAP_ERR_CANT_WRITE; // XXX - WTAP_ERR_COMPRESS?
+        blk->err_info = LZ4F_getErrorName(ret);
+        return;
+    }
+    blk->out_len = ret;
+}
+
 LZ4WFILE_T
 lz4wfile_open(const char *path)
 {
@@ -2890,6 +3274,7 @@ LZ4WFILE_T
 lz4wfile_fdopen(int fd)
 {
     LZ4WFILE_T state;
+    unsigned threads;
 
     /* allocate wtap_writer structure to return */
     state = (LZ4WFILE_T)g_try_malloc(sizeof *state);
@@ -2931,6 +3316,15 @@ lz4wfile_fdopen(int fd)
     state->pos = 0;                 /* no uncompressed data yet */
     state->pos_out = 0;
 
+    /* Each block becomes a separate frame. */
+    threads = get_compression_threads();
+    state->par = NULL;
+    if (threads > 1) {
+        state->par = par_writer_new(fd, threads, state->want,
+                                    LZ4F_compressFrameBound(state->want, &state->lz4_prefs),
+                                    lz4_comp_block, state);
+    }
+
     /* return stream */
     return state;
 }
@@ -3014,6 +3408,16 @@ lz4wfile_write(LZ4WFILE_T state, const void *buf, size_t len)
     if (len == 0)
         return 0;
 
+    if (state->par) {
+        if (!par_writer_write(state->par, buf, len)) {
+            state->err = state->par->err;
+            state->err_info = state->par->err_info;
+            return 0;
+        }
+        state->pos += len;
+        return put;
+    }
+
     /* allocate memory if this is the first time through */
     if (state->size_out == 0 && lz4_init(state) == -1)
         return 0;
@@ -3038,6 +3442,29 @@ lz4wfile_write(LZ4WFILE_T state, const void *buf, size_t len)
     return put;
 }
 
+/* Stop compressing in parallel, and compress the data that wasn't handed
+   to the threads yet, and everything after it, as a stream.  Returns -1,
+   and sets state->err, on failure; returns 0 on success. */
+static int
+lz4_par_to_stream(LZ4WFILE_T state)
+{
+    comp_block *cur;
+    int err;
+
+    err = par_writer_detach(state->par, &cur, &state->err_info);
+    state->par = NULL;
+    if (err != 0) {
+        state->err = err;
+    } else if (cur != NULL) {
+        /* lz4wfile_write() counts these bytes again. */
+        state->pos -= cur->in_len;
+        lz4wfile_write(state, cur->in, cur->in_len);
+    }
+    if (cur != NULL)
+        comp_block_free(cur);
+    return state->err == 0 ? 0 : -1;
+}
+
 /* Flush out what we've written so far.  Returns -1, and sets state->err,
    on failure; returns 0 on success. */
 int
@@ -3048,6 +3475,15 @@ lz4wfile_flush(LZ4WFILE_T state)
     if (state->err != 0)
         return -1;
 
+    /* As with gzip, go on as a single stream rather than ending a frame
+       at each flush. */
+    if (state->par && lz4_par_to_stream(state) == -1)
+        return -1;
+
+    /* allocate memory if nothing was written as a stream yet */
+    if (state->size_out == 0 && lz4_init(state) == -1)
+        return -1;
+
     bytesWritten = LZ4F_flush(state->lz4_cctx, state->out, state->size_out, NULL);
     if (LZ4F_isError(bytesWritten)) {
         // Should never happen if size_out >= LZ4F_compressBound(0, prefsPtr)
@@ -3061,12 +3497,25 @@ lz4wfile_flush(LZ4WFILE_T state)
 }
 
 /* Flush out all data written, and close the file.  Returns a Wiretap
-   error on failure; returns 0 on success. */
+   error, and sets *err_info if err_info isn't NULL, on failure; returns
+   0 on success. */
 int
-lz4wfile_close(LZ4WFILE_T state)
+lz4wfile_close(LZ4WFILE_T state, const char **err_info)
 {
     int ret = 0;
 
+    if (state->par) {
+        ret = par_writer_close(state->par, &state->err_info);
+        if (state->err != 0)
+            ret = state->err;
+        if (ret != 0 && err_info != NULL)
+            *err_info = state->err_info;
+        if (ws_close(state->fd) == -1 && ret == 0)
+            ret = errno;
+        g_free(state);
+        return ret;
+    }
+
     /* flush, free memory, and close file */
     size_t bytesWritten = LZ4F_compressEnd(state->lz4_cctx, state->out, state->size_out, NULL);
     if (LZ4F_isError(bytesWritten)) {
@@ -3075,6 +3524,8 @@ lz4wfile_close(LZ4WFILE_T state)
     }
     if (!lz4_write_out(state, bytesWritten)) {
         ret = state->err;
+        if (err_info != NULL)
+            *err_info = state->err_info;
     }
     g_free(state->out);
     LZ4F_freeCompressionContext(state->lz4_cctx);
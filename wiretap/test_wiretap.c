@@ -0,0 +1,179 @@
+/* test_wiretap.c
+ * Wiretap unit tests
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include <glib/gstdio.h>
+
+#include "wtap.h"
+
+#define PACKET_LEN  1500
+
+typedef struct {
+    wtap_compression_type compression_type;
+    unsigned packets;       /* Packets to write */
+    unsigned flush_after;   /* Flush after this many packets, or 0 */
+} compressed_write_test;
+
+/* Compressible, but different for each packet. */
+static void
+fill_packet(uint8_t *pd, unsigned num)
+{
+    for (unsigned i = 0; i < PACKET_LEN; i++)
+        pd[i] = (uint8_t)(num * 7 + i / 16);
+}
+
+static char *
+write_compressed_file(const char *dir, const compressed_write_test *t, unsigned threads)
+{
+    wtap_dump_params params = WTAP_DUMP_PARAMS_INIT;
+    wtap_dumper *wdh;
+    wtap_rec rec;
+    char *path;
+    int err;
+    char *err_info = NULL;
+
+    path = g_strdup_printf("%s%c%u-threads.pcap", dir, G_DIR_SEPARATOR, threads);
+    params.encap = WTAP_ENCAP_ETHERNET;
+    params.snaplen = PACKET_LEN;
+    wtap_set_compression_threads(threads);
+    wdh = wtap_dump_open(path, wtap_pcap_file_type_subtype(), t->compression_type,
+                         &params, &err, &err_info);
+    g_assert_nonnull(wdh);
+
+    wtap_rec_init(&rec, PACKET_LEN);
+    wtap_setup_packet_rec(&rec, WTAP_ENCAP_ETHERNET);
+    rec.presence_flags = WTAP_HAS_TS;
+    rec.rec_header.packet_header.caplen = PACKET_LEN;
+    rec.rec_header.packet_header.len = PACKET_LEN;
+    for (unsigned num = 1; num <= t->packets; num++) {
+        ws_buffer_clean(&rec.data);
+        ws_buffer_assure_space(&rec.data, PACKET_LEN);
+        fill_packet(ws_buffer_start_ptr(&rec.data), num);
+        ws_buffer_increase_length(&rec.data, PACKET_LEN);
+        rec.ts.secs = num;
+        g_assert_true(wtap_dump(wdh, &rec, &err, &err_info));
+        if (num == t->flush_after)
+            g_assert_true(wtap_dump_flush(wdh, &err));
+    }
+    wtap_rec_cleanup(&rec);
+
+    g_assert_true(wtap_dump_close(wdh, NULL, &err, &err_info));
+    wtap_set_compression_threads(1);
+    return path;
+}
+
+/* Read a file back and check that it has the packets that were written. */
+static void
+check_compressed_file(const char *path, const compressed_write_test *t)
+{
+    wtap *wth;
+    wtap_rec rec;
+    uint8_t expected[PACKET_LEN];
+    int64_t offset;
+    unsigned num = 0;
+    int err;
+    char *err_info = NULL;
+
+    wth = wtap_open_offline(path, WTAP_TYPE_AUTO, &err, &err_info, false);
+    g_assert_nonnull(wth);
+    g_assert_cmpint(wtap_get_compression_type(wth), ==, t->compression_type);
+
+    wtap_rec_init(&rec, PACKET_LEN);
+    while (wtap_read(wth, &rec, &err, &err_info, &offset)) {
+        num++;
+        fill_packet(expected, num);
+        g_assert_cmpint(rec.ts.secs, ==, num);
+        g_assert_cmpmem(ws_buffer_start_ptr(&rec.data), ws_buffer_length(&rec.data),
+                        expected, PACKET_LEN);
+        wtap_rec_reset(&rec);
+    }
+    g_assert_cmpint(err, ==, 0);
+    g_assert_cmpuint(num, ==, t->packets);
+    wtap_rec_cleanup(&rec);
+    wtap_close(wth);
+}
+
+static void
+test_compressed_write(const void *data)
+{
+    const compressed_write_test *t = (const compressed_write_test *)data;
+    GError *gerr = NULL;
+    char *dir;
+    char *single_path, *par_path;
+
+    if (!wtap_can_write_compression_type(t->compression_type)) {
+        g_test_skip("compression type not supported");
+        return;
+    }
+
+    dir = g_dir_make_tmp("test_wiretap-XXXXXX", &gerr);
+    g_assert_no_error(gerr);
+
+    single_path = write_compressed_file(dir, t, 1);
+    par_path = write_compressed_file(dir, t, 4);
+    check_compressed_file(single_path, t);
+    check_compressed_file(par_path, t);
+
+    g_unlink(single_path);
+    g_unlink(par_path);
+    g_rmdir(dir);
+    g_free(single_path);
+    g_free(par_path);
+    g_free(dir);
+}
+
+/*
+ * The parallel writers compress 1 MiB (gzip) or 4 MiB (LZ4) blocks.
+ * The first flush writes the blocks that were submitted and goes on
+ * as a stream, starting with the data that wasn't submitted yet.
+ */
+static const compressed_write_test gzip_blocks = { WTAP_GZIP_COMPRESSED, 2200, 0 };
+static const compressed_write_test gzip_flush_first = { WTAP_GZIP_COMPRESSED, 2200, 1 };
+static const compressed_write_test gzip_flush_after_blocks = { WTAP_GZIP_COMPRESSED, 2200, 1500 };
+static const compressed_write_test lz4_blocks = { WTAP_LZ4_COMPRESSED, 8600, 0 };
+static const compressed_write_test lz4_flush_first = { WTAP_LZ4_COMPRESSED, 8600, 1 };
+static const compressed_write_test lz4_flush_after_blocks = { WTAP_LZ4_COMPRESSED, 8600, 5700 };
+
+int
+main(int argc, char **argv)
+{
+    int ret;
+
+    g_test_init(&argc, &argv, NULL);
+
+    wtap_init(false);
+
+    g_test_add_data_func("/file_wrappers/gzip/blocks", &gzip_blocks, test_compressed_write);
+    g_test_add_data_func("/file_wrappers/gzip/flush_first", &gzip_flush_first, test_compressed_write);
+    g_test_add_data_func("/file_wrappers/gzip/flush_after_blocks", &gzip_flush_after_blocks, test_compressed_write);
+    g_test_add_data_func("/file_wrappers/lz4/blocks", &lz4_blocks, test_compressed_write);
+    g_test_add_data_func("/file_wrappers/lz4/flush_first", &lz4_flush_first, test_compressed_write);
+    g_test_add_data_func("/file_wrappers/lz4/flush_after_blocks", &lz4_flush_after_blocks, test_compressed_write);
+
+    ret = g_test_run();
+
+    wtap_cleanup();
+
+    return ret;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -2039,6 +2039,17 @@ WS_DLL_PUBLIC
 GSList *wtap_get_all_output_compression_type_names_list(void);
 WS_DLL_PUBLIC
 bool wtap_can_write_compression_type(wtap_compression_type compression_type);
+/**
+ * Set the number of threads used to compress files being written.
+ * With more than one, the output is compressed in independent blocks
+ * (gzip members or LZ4 frames) in parallel, until the file is first
+ * flushed; from then on, it is compressed as a single stream, so that
+ * flushing doesn't end a member or frame each time. 0 uses one thread
+ * per processor, up to a limit. 1, the default, compresses the output
+ * as a single stream in the calling thread.
+ */
+WS_DLL_PUBLIC
+void wtap_set_compression_threads(unsigned threads);
 
 /*** get various information snippets about the current file ***/
 
@@ -33,6 +33,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <errno.h>
+#include <limits.h>
 #include <string.h>
 #ifdef HAVE_SYS_TIME_H
 #include <sys/time.h>
@@ -52,10 +53,34 @@
 
 typedef void* WFILE_T;
 
+/*
+ * Background writer for uncompressed files. Output is collected in one
+ * of two buffers; when it is full or flushed it is handed to a writer
+ * thread and the other buffer is filled in the meantime, so the caller
+ * only waits for the disk if it gets a whole buffer ahead of it.
+ */
+typedef struct {
+    int fd;
+    GThread *thread;
+    GMutex mutex;
+    GCond cond;
+    uint8_t *bufs[2];
+    size_t buf_size;
+    unsigned cur;           /* Buffer being filled */
+    size_t fill;
+    size_t pending_len;     /* Bytes of the other buffer not yet written */
+    uint64_t handed_off;    /* Bytes handed to the writer thread */
+    uint64_t written;       /* Bytes the writer thread has written */
+    uint64_t flush_mark;    /* Bytes that are in the file once the last flush is done */
+    bool quit;
+    int err;
+} async_writer;
+
 struct pcapio_writer {
     WFILE_T fh;
     char* io_buffer;
     wtap_compression_type ctype;
+    async_writer* async;
 };
 
 /* Magic numbers in "libpcap" files.
@@ -302,6 +327,207 @@ writecap_fdopen(int fd, wtap_compression_type ctype, int *err)
     return pfile;
 }
 
+static void *
+async_writer_thread(void *data)
+{
+    async_writer* aw = (async_writer*)data;
+    const uint8_t *buf;
+    size_t len;
+    int err;
+
+    g_mutex_lock(&aw->mutex);
+    for (;;) {
+        while (aw->pending_len == 0 && !aw->quit) {
+            g_cond_wait(&aw->cond, &aw->mutex);
+        }
+        if (aw->pending_len == 0) {
+            break;
+        }
+        buf = aw->bufs[aw->cur ^ 1];
+        len = aw->pending_len;
+        g_mutex_unlock(&aw->mutex);
+
+        err = 0;
+        while (len > 0) {
+            ssize_t nwritten = ws_write(aw->fd, buf, (unsigned)MIN(len, INT_MAX));
+            if (nwritten < 0) {
+                if (errno == EINTR)
+                    continue;
+                err = errno;
+                break;
+            }
+            if (nwritten == 0) {
+                err = WTAP_ERR_SHORT_WRITE;
+                break;
+            }
+            buf += nwritten;
+            len -= nwritten;
+        }
+
+        g_mutex_lock(&aw->mutex);
+        if (err != 0 && aw->err == 0) {
+            aw->err = err;
+        }
+        if (err == 0) {
+            aw->written += aw->pending_len;
+        }
+        aw->pending_len = 0;
+        g_cond_broadcast(&aw->cond);
+    }
+    g_mutex_unlock(&aw->mutex);
+    return NULL;
+}
+
+/* Hand the current buffer to the writer thread if it isn't busy with
+ * the other one. Called with the mutex held. */
+static void
+async_writer_hand_off(async_writer* aw)
+{
+    if (aw->pending_len == 0 && aw->fill != 0 && aw->err == 0) {
+        aw->pending_len = aw->fill;
+        aw->handed_off += aw->fill;
+        aw->cur ^= 1;
+        aw->fill = 0;
+        g_cond_broadcast(&aw->cond);
+    }
+}
+
+/* Hand the current buffer to the writer thread. If the thread is still
+ * writing the other buffer, wait for it if wait is true; otherwise leave
+ * the buffer to be handed off later. */
+static bool
+async_writer_submit(async_writer* aw, bool wait, int *err)
+{
+    g_mutex_lock(&aw->mutex);
+    while (wait && aw->pending_len != 0) {
+        g_cond_wait(&aw->cond, &aw->mutex);
+    }
+    async_writer_hand_off(aw);
+    *err = aw->err;
+    g_mutex_unlock(&aw->mutex);
+    return *err == 0;
+}
+
+/* Start writing everything that has been written so far, without
+ * waiting for it. */
+static bool
+async_writer_flush(async_writer* aw, int *err)
+{
+    g_mutex_lock(&aw->mutex);
+    aw->flush_mark = aw->handed_off + aw->fill;
+    async_writer_hand_off(aw);
+    *err = aw->err;
+    g_mutex_unlock(&aw->mutex);
+    return *err == 0;
+}
+
+/* Returns true if everything up to the last flush is in the file. A part
+ * that couldn't be handed off at the flush because the thread was busy
+ * is handed off now. If wait is true, waits until it is all written or
+ * writing fails. */
+static bool
+async_writer_flushed(async_writer* aw, bool wait)
+{
+    bool flushed;
+
+    g_mutex_lock(&aw->mutex);
+    for (;;) {
+        flushed = aw->written >= aw->flush_mark;
+        if (flushed || aw->err != 0) {
+            break;
+        }
+        if (aw->handed_off < aw->flush_mark) {
+            async_writer_hand_off(aw);
+        }
+        if (!wait) {
+            break;
+        }
+        g_cond_wait(&aw->cond, &aw->mutex);
+    }
+    g_mutex_unlock(&aw->mutex);
+    return flushed;
+}
+
+static bool
+async_writer_write(async_writer* aw, const uint8_t* data, size_t data_length, int *err)
+{
+    while (data_length > 0) {
+        size_t n = MIN(data_length, aw->buf_size - aw->fill);
+
+        memcpy(aw->bufs[aw->cur] + aw->fill, data, n);
+        aw->fill += n;
+        data += n;
+        data_length -= n;
+        if (aw->fill == aw->buf_size && !async_writer_submit(aw, true, err)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int
+async_writer_close(async_writer* aw)
+{
+    int err;
+
+    /* The thread writes what it has been handed before it quits. */
+    async_writer_submit(aw, true, &err);
+    g_mutex_lock(&aw->mutex);
+    aw->quit = true;
+    g_cond_broadcast(&aw->cond);
+    g_mutex_unlock(&aw->mutex);
+    g_thread_join(aw->thread);
+
+    err = aw->err;
+    if (ws_close(aw->fd) == -1 && err == 0) {
+        err = errno;
+    }
+    g_mutex_clear(&aw->mutex);
+    g_cond_clear(&aw->cond);
+    g_free(aw->bufs[0]);
+    g_free(aw->bufs[1]);
+    g_free(aw);
+    return err;
+}
+
+pcapio_writer*
+writecap_fdopen_async(int fd, size_t buffer_size, int *err)
+{
+    pcapio_writer* pfile;
+    async_writer* aw;
+
+    *err = 0;
+    aw = g_new0(async_writer, 1);
+    aw->fd = fd;
+    aw->buf_size = buffer_size;
+    aw->bufs[0] = (uint8_t *)g_try_malloc(buffer_size);
+    aw->bufs[1] = (uint8_t *)g_try_malloc(buffer_size);
+    if (aw->bufs[0] == NULL || aw->bufs[1] == NULL) {
+        *err = ENOMEM;
+        goto fail;
+    }
+    g_mutex_init(&aw->mutex);
+    g_cond_init(&aw->cond);
+    aw->thread = g_thread_try_new("writecap", async_writer_thread, aw, NULL);
+    if (aw->thread == NULL) {
+        *err = EAGAIN;
+        g_mutex_clear(&aw->mutex);
+        g_cond_clear(&aw->cond);
+        goto fail;
+    }
+
+    pfile = g_new0(struct pcapio_writer, 1);
+    pfile->ctype = WTAP_UNCOMPRESSED;
+    pfile->async = aw;
+    return pfile;
+
+fail:
+    g_free(aw->bufs[0]);
+    g_free(aw->bufs[1]);
+    g_free(aw);
+    return NULL;
+}
+
 pcapio_writer*
 writecap_open_stdout(wtap_compression_type ctype, int *err)
 {
@@ -340,6 +566,18 @@ writecap_open_stdout(wtap_compression_type ctype, int *err)
 bool
 writecap_flush(pcapio_writer* pfile, int *err)
 {
+    if (pfile->async) {
+        int async_err;
+
+        if (!async_writer_flush(pfile->async, &async_err)) {
+            if (err) {
+                *err = async_err;
+            }
+            return false;
+        }
+        return true;
+    }
+
     switch (pfile->ctype) {
 #if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
         case WTAP_GZIP_COMPRESSED:
@@ -372,27 +610,40 @@ writecap_flush(pcapio_writer* pfile, int *err)
     return true;
 }
 
+bool
+writecap_flushed(pcapio_writer* pfile, bool wait)
+{
+    if (pfile->async) {
+        return async_writer_flushed(pfile->async, wait);
+    }
+    return true;
+}
+
 bool
 writecap_close(pcapio_writer* pfile, int *errp)
 {
     int err = 0;
 
     errno = WTAP_ERR_CANT_CLOSE;
-    switch (pfile->ctype) {
+    if (pfile->async) {
+        err = async_writer_close(pfile->async);
+    } else {
+        switch (pfile->ctype) {
 #if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
-        case WTAP_GZIP_COMPRESSED:
-            err = gzwfile_close(pfile->fh);
-            break;
+            case WTAP_GZIP_COMPRESSED:
+                err = gzwfile_close(pfile->fh, NULL);
+                break;
 #endif
 #ifdef HAVE_LZ4FRAME_H
-        case WTAP_LZ4_COMPRESSED:
-            err = lz4wfile_close(pfile->fh);
-            break;
+            case WTAP_LZ4_COMPRESSED:
+                err = lz4wfile_close(pfile->fh, NULL);
+                break;
 #endif /* HAVE_LZ4FRAME_H */
-        default:
-            if (fclose(pfile->fh) == EOF) {
-                err = errno;
-            }
+            default:
+                if (fclose(pfile->fh) == EOF) {
+                    err = errno;
+                }
+        }
     }
 
     g_free(pfile->io_buffer);
@@ -410,6 +661,14 @@ write_to_file(pcapio_writer* pfile, const uint8_t* data, size_t data_length,
 {
     size_t nwritten;
 
+    if (pfile->async) {
+        if (!async_writer_write(pfile->async, data, data_length, err)) {
+            return false;
+        }
+        (*bytes_written) += data_length;
+        return true;
+    }
+
     switch (pfile->ctype) {
 #if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
         case WTAP_GZIP_COMPRESSED:
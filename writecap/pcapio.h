@@ -24,12 +24,28 @@ writecap_fopen(const char *filename, wtap_compression_type ctype, int *err);
 extern pcapio_writer*
 writecap_fdopen(int fd, wtap_compression_type ctype, int *err);
 
+/** Open an uncompressed output file whose writes are done by a separate
+ * thread, through two buffers of buffer_size bytes each. Writing a
+ * packet only waits for the disk if both buffers are full.
+ * writecap_flush() hands what has been written so far to the thread
+ * without waiting for it; writecap_flushed() tells when it is in the
+ * file, and writecap_close() waits for everything to be written.
+ * Not suitable for pipes that need each packet to be flushed. */
+extern pcapio_writer*
+writecap_fdopen_async(int fd, size_t buffer_size, int *err);
+
 extern pcapio_writer*
 writecap_open_stdout(wtap_compression_type ctype, int *err);
 
 extern bool
 writecap_flush(pcapio_writer* pfile, int *err);
 
+/** Returns true if everything written up to the last writecap_flush()
+ * is in the file. If wait is true, waits until it is, unless writing
+ * fails. Only files opened with writecap_fdopen_async() can lag behind. */
+extern bool
+writecap_flushed(pcapio_writer* pfile, bool wait);
+
 /* Close open file handles and frees memory associated with pfile.
  *
  * Return true on success, returns false and sets err (optional) on failure.
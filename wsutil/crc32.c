@@ -15,9 +15,23 @@
 
 #include "config.h"
 
+#include <string.h>
+
+#include <glib.h>
+
 #include <wsutil/crc32.h>
+#include <wsutil/pint.h>
 #include <wsutil/zlib_compat.h>
 
+#ifdef HAVE_SSE4_2
+#include "ws_cpuid.h"
+#endif
+#include "crc32_int.h"
+
+#ifdef __ARM_FEATURE_CRC32
+#include <arm_acle.h>
+#endif
+
 #define CRC32_ACCUMULATE(c,d,table) (c=(c>>8)^(table)[(c^(d))&0xFF])
 
 /*****************************************************************/
@@ -353,6 +367,111 @@ static const uint32_t crc32_5D6DCB[] =
 		0x0098206c, 0x00c54da7, 0x0022fbfa, 0x007f9631
 };
 
+/*
+ * Tables for slicing-by-8, which handles eight bytes per step instead
+ * of one; see "Novel Table Lookup-Based Algorithms for High-Performance
+ * CRC Generation" by Kounavis and Berry. Table 0 is the byte-at-a-time
+ * table above, and table n advances a CRC over a byte followed by n
+ * zero bytes. They are filled in by crc32_init().
+ */
+static uint32_t crc32c_slice_table[8][256];
+#if !defined (HAVE_ZLIB) && !defined (HAVE_ZLIBNG)
+static uint32_t crc32_ccitt_slice_table[8][256];
+#endif
+static uint32_t crc32_mpeg2_slice_table[8][256];
+
+#ifdef HAVE_SSE4_2
+static bool crc32c_use_sse42;
+#endif
+
+static void
+crc32_reflected_slice_table_init(uint32_t (*table)[256], const uint32_t *base)
+{
+	unsigned i, n;
+
+	memcpy(table[0], base, sizeof table[0]);
+	for (n = 1; n < 8; n++) {
+		for (i = 0; i < 256; i++) {
+			uint32_t crc = table[n - 1][i];
+			table[n][i] = (crc >> 8) ^ base[crc & 0xff];
+		}
+	}
+}
+
+static void
+crc32_init(void)
+{
+	static size_t initialized;
+
+	if (g_once_init_enter(&initialized)) {
+		unsigned i, n;
+
+		crc32_reflected_slice_table_init(crc32c_slice_table, crc32c_table);
+#if !defined (HAVE_ZLIB) && !defined (HAVE_ZLIBNG)
+		crc32_reflected_slice_table_init(crc32_ccitt_slice_table, crc32_ccitt_table);
+#endif
+		memcpy(crc32_mpeg2_slice_table[0], crc32_mpeg2_table, sizeof crc32_mpeg2_slice_table[0]);
+		for (n = 1; n < 8; n++) {
+			for (i = 0; i < 256; i++) {
+				uint32_t crc = crc32_mpeg2_slice_table[n - 1][i];
+				crc32_mpeg2_slice_table[n][i] = (crc << 8) ^ crc32_mpeg2_table[crc >> 24];
+			}
+		}
+#ifdef HAVE_SSE4_2
+		crc32c_use_sse42 = ws_cpuid_sse42() != 0;
+#endif
+		g_once_init_leave(&initialized, 1);
+	}
+}
+
+/*
+ * Slicing-by-8 for the bit-reflected CRCs, i.e. CRC32C and the CCITT CRC,
+ * which take the data in little-endian order.
+ */
+static uint32_t
+crc32_reflected_slice8(uint32_t (*table)[256], const uint8_t *buf, size_t len, uint32_t crc)
+{
+	while (len >= 8) {
+		uint32_t lo = crc ^ pletoh32(buf);
+		uint32_t hi = pletoh32(buf + 4);
+
+		crc = table[7][lo & 0xff] ^ table[6][(lo >> 8) & 0xff] ^
+		      table[5][(lo >> 16) & 0xff] ^ table[4][lo >> 24] ^
+		      table[3][hi & 0xff] ^ table[2][(hi >> 8) & 0xff] ^
+		      table[1][(hi >> 16) & 0xff] ^ table[0][hi >> 24];
+		buf += 8;
+		len -= 8;
+	}
+
+	while (len-- != 0)
+		CRC32_ACCUMULATE(crc, *buf++, table[0]);
+
+	return crc;
+}
+
+/*
+ * Update a CRC32C with the fastest code available: the CRC instructions
+ * of ARMv8 if we're built for them, the SSE4.2 crc32 instruction if the
+ * CPU we're running on has it, and slicing-by-8 otherwise.
+ */
+static uint32_t
+crc32c_update(const uint8_t *buf, size_t len, uint32_t crc)
+{
+	crc32_init();
+#if defined(__ARM_FEATURE_CRC32)
+	while (len >= 8) {
+		crc = __crc32cd(crc, pletoh64(buf));
+		buf += 8;
+		len -= 8;
+	}
+	/* The last few bytes, if any, are done below. */
+#elif defined(HAVE_SSE4_2)
+	if (crc32c_use_sse42)
+		return crc32c_sse42(buf, len, crc);
+#endif
+	return crc32_reflected_slice8(crc32c_slice_table, buf, len, crc);
+}
+
 uint32_t
 crc32c_table_lookup (unsigned char pos)
 {
@@ -368,23 +487,21 @@ crc32_ccitt_table_lookup (unsigned char pos)
 uint32_t
 crc32c_calculate(const void *buf, int len, uint32_t crc)
 {
-	const uint8_t *p = (const uint8_t *)buf;
+	if (len <= 0)
+		return crc;
+
 	crc = CRC32C_SWAP(crc);
-	while (len-- > 0) {
-		CRC32C(crc, *p++);
-	}
+	crc = crc32c_update((const uint8_t *)buf, (size_t)len, crc);
 	return CRC32C_SWAP(crc);
 }
 
 uint32_t
 crc32c_calculate_no_swap(const void *buf, int len, uint32_t crc)
 {
-	const uint8_t *p = (const uint8_t *)buf;
-	while (len-- > 0) {
-		CRC32C(crc, *p++);
-	}
+	if (len <= 0)
+		return crc;
 
-	return crc;
+	return crc32c_update((const uint8_t *)buf, (size_t)len, crc);
 }
 
 uint32_t
@@ -397,28 +514,38 @@ uint32_t
 crc32_ccitt_seed(const uint8_t *buf, unsigned len, uint32_t seed)
 {
 #if defined (HAVE_ZLIB) || defined (HAVE_ZLIBNG)
+	/* zlib has its own fast implementations, including ones using PCLMULQDQ. */
 	return (unsigned)ZLIB_PREFIX(crc32)(~seed, buf, len);
 #else /* USE_ZLIB_OR_ZLIBNG */
-	unsigned i;
-	uint32_t crc32 = seed;
-
-	for (i = 0; i < len; i++)
-		CRC32_ACCUMULATE(crc32, buf[i], crc32_ccitt_table);
-
-	return ( ~crc32 );
+	crc32_init();
+	return ( ~crc32_reflected_slice8(crc32_ccitt_slice_table, buf, len, seed) );
 #endif /* USE_ZLIB_OR_ZLIBNG */
 }
 
 uint32_t
 crc32_mpeg2_seed(const uint8_t *buf, unsigned len, uint32_t seed)
 {
-	unsigned i;
+	uint32_t (*table)[256] = crc32_mpeg2_slice_table;
 	uint32_t crc32;
 
+	crc32_init();
 	crc32 = seed;
 
-	for (i = 0; i < len; i++)
-		crc32 = (crc32 << 8) ^ crc32_mpeg2_table[((crc32 >> 24) ^ buf[i]) & 0xff];
+	/* Slicing-by-8; this CRC isn't reflected, so take the data in network order. */
+	while (len >= 8) {
+		uint32_t hi = crc32 ^ pntoh32(buf);
+		uint32_t lo = pntoh32(buf + 4);
+
+		crc32 = table[7][hi >> 24] ^ table[6][(hi >> 16) & 0xff] ^
+			table[5][(hi >> 8) & 0xff] ^ table[4][hi & 0xff] ^
+			table[3][lo >> 24] ^ table[2][(lo >> 16) & 0xff] ^
+			table[1][(lo >> 8) & 0xff] ^ table[0][lo & 0xff];
+		buf += 8;
+		len -= 8;
+	}
+
+	while (len-- != 0)
+		crc32 = (crc32 << 8) ^ crc32_mpeg2_table[((crc32 >> 24) ^ *buf++) & 0xff];
 
 	return ( crc32 );
 }
@@ -0,0 +1,21 @@
+/** @file
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __CRC32_INT_H__
+#define __CRC32_INT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef HAVE_SSE4_2
+/* CRC32C with the SSE4.2 crc32 instruction, without pre- or post-conditioning. */
+uint32_t crc32c_sse42(const uint8_t *buf, size_t len, uint32_t crc);
+#endif
+
+#endif /* __CRC32_INT_H__ */
@@ -14,11 +14,32 @@
 #include <pcre2.h>
 
 
+/*
+ * Scratch space for pcre2_match(). Creating it for every match costs
+ * two allocations (more with JIT), so each regex keeps one around. A
+ * regex can be used by several threads at once; a thread takes the
+ * cached block with an atomic exchange and puts it back when it is done,
+ * and threads that find the cache empty use a private block instead.
+ */
+typedef struct {
+    pcre2_match_data *match_data;
+    pcre2_match_context *match_context;
+    pcre2_jit_stack *jit_stack;
+} match_scratch_t;
+
 struct _ws_regex {
     pcre2_code *code;
     char *pattern;
+    bool jit;
+    match_scratch_t *scratch;
 };
 
+/* The default JIT stack is 32 KiB on the machine stack, which some
+ * patterns with a lot of backtracking can exhaust. Matches that need
+ * more than the maximum fall back to the interpreter. */
+#define JIT_STACK_START_SIZE    (32 * 1024)
+#define JIT_STACK_MAX_SIZE      (512 * 1024)
+
 #define ERROR_MAXLEN_IN_CODE_UNITS   128
 
 static char *
@@ -92,6 +113,11 @@ ws_regex_compile_ex(const char *patt, ssize_t size, char **errmsg, unsigned flag
     ws_regex_t *re = g_new(ws_regex_t, 1);
     re->code = code;
     re->pattern = ws_escape_string_len(NULL, patt, size, false);
+    /* JIT compilation fails if PCRE2 was built without JIT support or
+     * the platform doesn't support it. In that case the interpreter
+     * is used. */
+    re->jit = pcre2_jit_compile(code, PCRE2_JIT_COMPLETE) == 0;
+    re->scratch = NULL;
     return re;
 }
 
@@ -103,9 +129,68 @@ ws_regex_compile(const char *patt, char **errmsg)
 }
 
 
+static match_scratch_t *
+scratch_new(const ws_regex_t *re)
+{
+    match_scratch_t *scratch = g_new0(match_scratch_t, 1);
+
+    /* We don't use the matched substrings but pcre2_match requires
+     * at least one pair of offsets. */
+    scratch->match_data = pcre2_match_data_create(1, NULL);
+    if (re->jit) {
+        scratch->jit_stack = pcre2_jit_stack_create(JIT_STACK_START_SIZE,
+                                                    JIT_STACK_MAX_SIZE, NULL);
+        if (scratch->jit_stack != NULL) {
+            scratch->match_context = pcre2_match_context_create(NULL);
+            pcre2_jit_stack_assign(scratch->match_context, NULL, scratch->jit_stack);
+        }
+    }
+    return scratch;
+}
+
+
+static void
+scratch_free(match_scratch_t *scratch)
+{
+    if (scratch == NULL)
+        return;
+    pcre2_match_data_free(scratch->match_data);
+    pcre2_match_context_free(scratch->match_context);
+    pcre2_jit_stack_free(scratch->jit_stack);
+    g_free(scratch);
+}
+
+
+static match_scratch_t *
+scratch_acquire(const ws_regex_t *re)
+{
+    ws_regex_t *mut_re = (ws_regex_t *)re;
+    match_scratch_t *scratch;
+
+    do {
+        scratch = g_atomic_pointer_get(&mut_re->scratch);
+        if (scratch == NULL)
+            return scratch_new(re);
+    } while (!g_atomic_pointer_compare_and_exchange(&mut_re->scratch, scratch, NULL));
+
+    return scratch;
+}
+
+
+static void
+scratch_release(const ws_regex_t *re, match_scratch_t *scratch)
+{
+    ws_regex_t *mut_re = (ws_regex_t *)re;
+
+    /* If another thread has put its own block back first, drop ours. */
+    if (!g_atomic_pointer_compare_and_exchange(&mut_re->scratch, NULL, scratch))
+        scratch_free(scratch);
+}
+
+
 static bool
 match_pcre2(pcre2_code *code, const char *subject, ssize_t subj_length,
-                size_t subj_offset, pcre2_match_data *match_data)
+                size_t subj_offset, match_scratch_t *scratch)
 {
     PCRE2_SIZE length;
     int rc;
@@ -120,8 +205,21 @@ match_pcre2(pcre2_code *code, const char *subject, ssize_t subj_length,
                     length,
                     (PCRE2_SIZE)subj_offset,
                     0,          /* default options */
-                    match_data,
-                    NULL);
+                    scratch->match_data,
+                    scratch->match_context);
+
+    if (rc == PCRE2_ERROR_JIT_STACKLIMIT) {
+        /* The JIT stack is too small for this pattern and subject. The
+         * interpreter keeps its backtracking frames on the heap instead,
+         * so try again with that rather than report no match. */
+        rc = pcre2_match(code,
+                        subject,
+                        length,
+                        (PCRE2_SIZE)subj_offset,
+                        PCRE2_NO_JIT,
+                        scratch->match_data,
+                        scratch->match_context);
+    }
 
     if (rc < 0) {
         /* No match */
@@ -152,16 +250,14 @@ ws_regex_matches_length(const ws_regex_t *re,
                         const char *subj, ssize_t subj_length)
 {
     bool matched;
-    pcre2_match_data *match_data;
+    match_scratch_t *scratch;
 
     ws_return_val_if(!re, false);
     ws_return_val_if(!subj, false);
 
-    /* We don't use the matched substring but pcre2_match requires
-     * at least one pair of offsets. */
-    match_data = pcre2_match_data_create(1, NULL);
-    matched = match_pcre2(re->code, subj, subj_length, 0, match_data);
-    pcre2_match_data_free(match_data);
+    scratch = scratch_acquire(re);
+    matched = match_pcre2(re->code, subj, subj_length, 0, scratch);
+    scratch_release(re, scratch);
     return matched;
 }
 
@@ -172,19 +268,19 @@ ws_regex_matches_pos(const ws_regex_t *re,
                         size_t subj_offset, size_t pos_vect[2])
 {
     bool matched;
-    pcre2_match_data *match_data;
+    match_scratch_t *scratch;
 
     ws_return_val_if(!re, false);
     ws_return_val_if(!subj, false);
 
-    match_data = pcre2_match_data_create(1, NULL);
-    matched = match_pcre2(re->code, subj, subj_length, subj_offset, match_data);
+    scratch = scratch_acquire(re);
+    matched = match_pcre2(re->code, subj, subj_length, subj_offset, scratch);
     if (matched && pos_vect) {
-        PCRE2_SIZE *ovect = pcre2_get_ovector_pointer(match_data);
+        PCRE2_SIZE *ovect = pcre2_get_ovector_pointer(scratch->match_data);
         pos_vect[0] = ovect[0];
         pos_vect[1] = ovect[1];
     }
-    pcre2_match_data_free(match_data);
+    scratch_release(re, scratch);
     return matched;
 }
 
@@ -192,6 +288,7 @@ ws_regex_matches_pos(const ws_regex_t *re,
 void
 ws_regex_free(ws_regex_t *re)
 {
+    scratch_free(re->scratch);
     pcre2_code_free(re->code);
     g_free(re->pattern);
     g_free(re);
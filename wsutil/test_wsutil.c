@@ -665,6 +665,328 @@ void test_nstime_from_iso8601(void)
     g_assert_cmpint(result.nsecs, ==, expect.nsecs);
 }
 
+#include "ws_multipattern.h"
+
+static void test_multipattern(void)
+{
+    ws_multipattern_t *mp;
+    const char *haystack = "GET /index.html HTTP/1.1\r\nUser-Agent: curl\r\n";
+    const uint8_t *found;
+    unsigned idx;
+
+    mp = ws_multipattern_new();
+    g_assert_cmpint(ws_multipattern_add(mp, "POST", 4), ==, 0);
+    g_assert_cmpint(ws_multipattern_add(mp, "curl", 4), ==, 1);
+    g_assert_cmpint(ws_multipattern_add(mp, "index", 5), ==, 2);
+    g_assert_cmpint(ws_multipattern_add(mp, "", 0), ==, -1);
+    ws_multipattern_compile(mp);
+    g_assert_cmpuint(ws_multipattern_count(mp), ==, 3);
+
+    found = ws_multipattern_exec(mp, haystack, strlen(haystack), &idx);
+    g_assert_nonnull(found);
+    g_assert_cmpuint(idx, ==, 2);
+    g_assert_true(found == (const uint8_t *)haystack + 5);
+
+    /* Search from the middle of the haystack. */
+    found = ws_multipattern_exec(mp, haystack + 20, strlen(haystack) - 20, &idx);
+    g_assert_nonnull(found);
+    g_assert_cmpuint(idx, ==, 1);
+
+    found = ws_multipattern_exec(mp, haystack, 8, NULL);
+    g_assert_null(found);
+    ws_multipattern_free(mp);
+}
+
+static void test_multipattern_overlap(void)
+{
+    ws_multipattern_t *mp;
+    /* Needles with shared prefixes and suffixes, and a NUL first byte. */
+    const uint8_t haystack[] = { 'a', 'b', 'a', 'b', 'c', 0x00, 0xff, 'x' };
+    const uint8_t nul_ff[] = { 0x00, 0xff };
+    const uint8_t *found;
+    unsigned idx;
+
+    mp = ws_multipattern_new();
+    ws_multipattern_add(mp, "abac", 4);
+    ws_multipattern_add(mp, "babc", 4);
+    ws_multipattern_add(mp, "bc", 2);
+    ws_multipattern_add(mp, nul_ff, sizeof(nul_ff));
+    ws_multipattern_compile(mp);
+
+    found = ws_multipattern_exec(mp, haystack, sizeof(haystack), &idx);
+    g_assert_nonnull(found);
+    g_assert_cmpuint(idx, ==, 1);
+    g_assert_true(found == haystack + 1);
+
+    found = ws_multipattern_exec(mp, haystack + 4, sizeof(haystack) - 4, &idx);
+    g_assert_nonnull(found);
+    g_assert_cmpuint(idx, ==, 3);
+    g_assert_true(found == haystack + 5);
+    ws_multipattern_free(mp);
+}
+
+static void test_multipattern_high_byte(void)
+{
+    ws_multipattern_t *mp;
+    /* First bytes above 0x7f, so that the prefilter is used with them. */
+    const uint8_t haystack[] = { 0x00, 0xe0, 0x81, 0x00, 0x6b, 0x88, 0xf5, 0xc9 };
+    const uint8_t ff_ff[] = { 0xff, 0xff };
+    const uint8_t f5_c9[] = { 0xf5, 0xc9 };
+    const uint8_t one_two[] = { 0x01, 0x02 };
+    const uint8_t *found;
+    unsigned idx;
+
+    mp = ws_multipattern_new();
+    ws_multipattern_add(mp, ff_ff, sizeof(ff_ff));
+    ws_multipattern_add(mp, f5_c9, sizeof(f5_c9));
+    ws_multipattern_compile(mp);
+    found = ws_multipattern_exec(mp, haystack, sizeof(haystack), &idx);
+    g_assert_nonnull(found);
+    g_assert_cmpuint(idx, ==, 1);
+    g_assert_true(found == haystack + 6);
+    ws_multipattern_free(mp);
+
+    mp = ws_multipattern_new();
+    ws_multipattern_add(mp, ff_ff, sizeof(ff_ff));
+    ws_multipattern_add(mp, one_two, sizeof(one_two));
+    ws_multipattern_compile(mp);
+    g_assert_null(ws_multipattern_exec(mp, haystack, sizeof(haystack), NULL));
+    ws_multipattern_free(mp);
+}
+
+static void test_multipattern_perf(void)
+{
+#define NEEDLE_COUNT 2000
+#define HAYSTACK_SIZE (1024 * 1024)
+    ws_multipattern_t *mp;
+    char **needles;
+    uint8_t *haystack;
+    double start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+    double memmem_ms;
+    GRand *rand;
+    int i;
+
+    rand = g_rand_new_with_seed(0x5eed);
+    haystack = g_malloc(HAYSTACK_SIZE);
+    for (i = 0; i < HAYSTACK_SIZE; i++) {
+        haystack[i] = (uint8_t)g_rand_int_range(rand, 0, 256);
+    }
+    needles = g_new(char *, NEEDLE_COUNT);
+    mp = ws_multipattern_new();
+    for (i = 0; i < NEEDLE_COUNT; i++) {
+        needles[i] = g_strdup_printf("ioc-%08x.example", g_rand_int(rand));
+        ws_multipattern_add(mp, needles[i], strlen(needles[i]));
+    }
+    ws_multipattern_compile(mp);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < NEEDLE_COUNT; i++) {
+        g_assert_null(ws_memmem(haystack, HAYSTACK_SIZE, needles[i], strlen(needles[i])));
+    }
+    RESOURCE_USAGE_END;
+    memmem_ms = utime_ms + stime_ms;
+
+    RESOURCE_USAGE_START;
+    g_assert_null(ws_multipattern_exec(mp, haystack, HAYSTACK_SIZE, NULL));
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "ws_multipattern_exec(): u %.3f ms s %.3f ms (ws_memmem() per needle: %.3f ms)",
+        utime_ms, stime_ms, memmem_ms);
+
+    ws_multipattern_free(mp);
+    for (i = 0; i < NEEDLE_COUNT; i++) {
+        g_free(needles[i]);
+    }
+    g_free(needles);
+    g_free(haystack);
+    g_rand_free(rand);
+}
+
+#include "regex.h"
+
+static void test_regex(void)
+{
+    ws_regex_t *re;
+    char *errmsg = NULL;
+    size_t pos[2];
+
+    re = ws_regex_compile_ex("fo+", -1, &errmsg, WS_REGEX_CASELESS);
+    g_assert_nonnull(re);
+    g_assert_null(errmsg);
+    g_assert_true(ws_regex_matches(re, "xxFOOxx"));
+    g_assert_false(ws_regex_matches(re, "xxFxOxx"));
+    /* Embedded NUL. */
+    g_assert_true(ws_regex_matches_length(re, "x\0foo", 5));
+    g_assert_false(ws_regex_matches_length(re, "x\0foo", 3));
+    g_assert_true(ws_regex_matches_pos(re, "fo foooo", -1, 1, pos));
+    g_assert_cmpuint(pos[0], ==, 3);
+    g_assert_cmpuint(pos[1], ==, 8);
+    ws_regex_free(re);
+
+    re = ws_regex_compile("(unbalanced", &errmsg);
+    g_assert_null(re);
+    g_assert_nonnull(errmsg);
+    g_free(errmsg);
+}
+
+static void test_regex_jit_stack(void)
+{
+    ws_regex_t *re;
+    char *subj;
+    size_t subj_len = 100000;
+
+    /* Backtracking over a long subject needs more than the maximum JIT
+     * stack; it must still match. */
+    re = ws_regex_compile("(a|b)*c", NULL);
+    g_assert_nonnull(re);
+    subj = g_malloc(subj_len + 1);
+    memset(subj, 'a', subj_len);
+    subj[subj_len - 1] = 'c';
+    subj[subj_len] = '\0';
+    g_assert_true(ws_regex_matches(re, subj));
+    subj[subj_len - 1] = 'a';
+    g_assert_false(ws_regex_matches(re, subj));
+    g_free(subj);
+    ws_regex_free(re);
+}
+
+static void test_regex_perf(void)
+{
+#define REGEX_LOOP_COUNT (1 * 1000 * 1000)
+    ws_regex_t *re;
+    double start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+    size_t subj_len;
+    int i, count = 0;
+
+    const char *subj = "Mozilla/5.0 (X11; Linux x86_64; rv:109.0) Gecko/20100101 Firefox/115.0";
+
+    re = ws_regex_compile_ex("(curl|wget|python-requests)/[0-9.]+|bot\\b", -1, NULL,
+                             WS_REGEX_CASELESS|WS_REGEX_NEVER_UTF);
+    g_assert_nonnull(re);
+    subj_len = strlen(subj);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < REGEX_LOOP_COUNT; i++) {
+        if (ws_regex_matches_length(re, subj, subj_len))
+            count++;
+    }
+    RESOURCE_USAGE_END;
+    g_assert_cmpint(count, ==, 0);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "ws_regex_matches_length(): u %.3f ms s %.3f ms (%.1f MB/s)",
+        utime_ms, stime_ms,
+        (double)subj_len * REGEX_LOOP_COUNT / 1000.0 / (utime_ms + stime_ms));
+
+    ws_regex_free(re);
+}
+
+#include "crc32.h"
+
+/* Bit-at-a-time CRCs to check the table-driven and hardware code against. */
+static uint32_t crc32c_reference(const uint8_t *buf, size_t len, uint32_t crc)
+{
+    while (len-- != 0) {
+        crc ^= *buf++;
+        for (int k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (0x82F63B78 & (0 - (crc & 1)));
+    }
+    return crc;
+}
+
+static uint32_t crc32_ccitt_reference(const uint8_t *buf, size_t len, uint32_t crc)
+{
+    while (len-- != 0) {
+        crc ^= *buf++;
+        for (int k = 0; k < 8; k++)
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+}
+
+static uint32_t crc32_mpeg2_reference(const uint8_t *buf, size_t len, uint32_t crc)
+{
+    while (len-- != 0) {
+        crc ^= (uint32_t)*buf++ << 24;
+        for (int k = 0; k < 8; k++)
+            crc = (crc << 1) ^ (0x04C11DB7 & (0 - (crc >> 31)));
+    }
+    return crc;
+}
+
+static void test_crc32(void)
+{
+    const uint8_t check[] = "123456789";
+    uint8_t buf[8 + 200];
+    uint32_t seed, swapped, expect;
+    GRand *rand;
+
+    /* The standard check values. */
+    g_assert_cmphex(crc32c_calculate_no_swap(check, 9, CRC32C_PRELOAD) ^ 0xFFFFFFFF, ==, 0xE3069283);
+    g_assert_cmphex(crc32_ccitt(check, 9), ==, 0xCBF43926);
+    g_assert_cmphex(crc32_mpeg2_seed(check, 9, CRC32_MPEG2_SEED), ==, 0x0376E6E7);
+
+    /* Every alignment and every length up to a few blocks, to cover both
+     * the block loops and the code that handles the bytes left over. */
+    rand = g_rand_new_with_seed(0xC4C32);
+    for (size_t i = 0; i < sizeof buf; i++) {
+        buf[i] = (uint8_t)g_rand_int_range(rand, 0, 256);
+    }
+    for (unsigned offset = 0; offset < 8; offset++) {
+        for (unsigned len = 0; len <= 200; len++) {
+            seed = g_rand_int(rand);
+
+            g_assert_cmphex(crc32c_calculate_no_swap(buf + offset, len, seed), ==,
+                            crc32c_reference(buf + offset, len, seed));
+
+            swapped = CRC32C_SWAP(seed);
+            expect = crc32c_reference(buf + offset, len, swapped);
+            g_assert_cmphex(crc32c_calculate(buf + offset, len, seed), ==, CRC32C_SWAP(expect));
+
+            g_assert_cmphex(crc32_ccitt_seed(buf + offset, len, seed), ==,
+                            crc32_ccitt_reference(buf + offset, len, seed));
+            g_assert_cmphex(crc32_mpeg2_seed(buf + offset, len, seed), ==,
+                            crc32_mpeg2_reference(buf + offset, len, seed));
+        }
+    }
+    g_rand_free(rand);
+}
+
+static void test_crc32_perf(void)
+{
+#define CRC_BUF_SIZE (64 * 1024)
+#define CRC_LOOP_COUNT 4096
+    uint8_t *buf;
+    uint32_t crc = 0;
+    double start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+    double mbytes = (double)CRC_BUF_SIZE * CRC_LOOP_COUNT / (1000.0 * 1000.0);
+    int i;
+
+    buf = g_malloc(CRC_BUF_SIZE);
+    for (i = 0; i < CRC_BUF_SIZE; i++) {
+        buf[i] = (uint8_t)i;
+    }
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CRC_LOOP_COUNT; i++) {
+        crc = crc32c_calculate(buf, CRC_BUF_SIZE, crc);
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "crc32c_calculate(): u %.3f ms s %.3f ms (%.1f MB/s)",
+        utime_ms, stime_ms, mbytes * 1000.0 / (utime_ms + stime_ms));
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < CRC_LOOP_COUNT; i++) {
+        crc = crc32_mpeg2_seed(buf, CRC_BUF_SIZE, crc);
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "crc32_mpeg2_seed(): u %.3f ms s %.3f ms (%.1f MB/s)",
+        utime_ms, stime_ms, mbytes * 1000.0 / (utime_ms + stime_ms));
+
+    g_free(buf);
+}
+
 #include "ws_getopt.h"
 
 #define ARGV_MAX 31
@@ -900,6 +1222,27 @@ int main(int argc, char **argv)
 
     g_test_add_func("/nstime/from_iso8601", test_nstime_from_iso8601);
 
+    g_test_add_func("/ws_multipattern/exec", test_multipattern);
+    g_test_add_func("/ws_multipattern/overlap", test_multipattern_overlap);
+    g_test_add_func("/ws_multipattern/high_byte", test_multipattern_high_byte);
+
+    if (g_test_perf()) {
+        g_test_add_func("/ws_multipattern/perf", test_multipattern_perf);
+    }
+
+    g_test_add_func("/regex/matches", test_regex);
+    g_test_add_func("/regex/jit_stack", test_regex_jit_stack);
+
+    if (g_test_perf()) {
+        g_test_add_func("/regex/perf", test_regex_perf);
+    }
+
+    g_test_add_func("/crc32/calculate", test_crc32);
+
+    if (g_test_perf()) {
+        g_test_add_func("/crc32/perf", test_crc32_perf);
+    }
+
     g_test_add_func("/ws_getopt/basic1", test_getopt_long_basic1);
     g_test_add_func("/ws_getopt/basic2", test_getopt_long_basic2);
     g_test_add_func("/ws_getopt/optional1", test_getopt_optional_argument1);
@@ -280,6 +280,30 @@ ws_clock_get_realtime(struct timespec *ts)
 #endif
 }
 
+uint64_t
+ws_clock_get_monotonic_ns(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+
+	if (frequency.QuadPart == 0)
+		QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+	/* Split the division so that the multiplication can't overflow. */
+	return (uint64_t)(counter.QuadPart / frequency.QuadPart) * 1000000000 +
+		(uint64_t)(counter.QuadPart % frequency.QuadPart) * 1000000000 / frequency.QuadPart;
+#else
+#if defined(HAVE_CLOCK_GETTIME)
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+		return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+#endif
+	return (uint64_t)g_get_monotonic_time() * 1000;
+#endif
+}
+
 struct tm *
 ws_localtime_r(const time_t *timep, struct tm *result)
 {
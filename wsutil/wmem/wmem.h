@@ -13,6 +13,7 @@
 #ifndef __WMEM_H__
 #define __WMEM_H__
 
+#include "wmem_accounting.h"
 #include "wmem_array.h"
 #include "wmem_core.h"
 #include "wmem_list.h"
@@ -0,0 +1,181 @@
+/* wmem_accounting.c
+ * Wireshark Memory Manager Allocation Accounting
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <string.h>
+#include <glib.h>
+
+#include "wmem-int.h"
+#include "wmem_accounting.h"
+#include "wmem_accounting_int.h"
+#include "wmem_allocator.h"
+
+unsigned wmem_accounting_rate;
+
+/* Counts down to the next sampled allocation. */
+static unsigned accounting_countdown;
+
+/* All owners; the one at index 0 stands in for "no owner". */
+static GPtrArray *owners;
+static wmem_owner_t *current_owner;
+
+void
+wmem_accounting_count(wmem_allocator_t *allocator, size_t size, bool new_object)
+{
+    wmem_owner_t *owner;
+
+    if (--accounting_countdown != 0) {
+        return;
+    }
+    accounting_countdown = wmem_accounting_rate;
+
+    owner = current_owner ? current_owner : (wmem_owner_t *)g_ptr_array_index(owners, 0);
+    owner->bytes[allocator->accounting_scope] += (uint64_t)size * wmem_accounting_rate;
+    if (new_object) {
+        owner->objects[allocator->accounting_scope] += wmem_accounting_rate;
+    }
+}
+
+static void
+free_owner(void *data)
+{
+    wmem_owner_t *owner = (wmem_owner_t *)data;
+
+    g_free((char *)owner->name);
+    g_free(owner);
+}
+
+wmem_owner_t *
+wmem_owner_new(const char *name)
+{
+    wmem_owner_t *owner = g_new0(wmem_owner_t, 1);
+
+    owner->name = g_strdup(name);
+    g_ptr_array_add(owners, owner);
+    return owner;
+}
+
+unsigned
+wmem_owner_count(void)
+{
+    return owners->len;
+}
+
+wmem_owner_t *
+wmem_owner_get(unsigned idx)
+{
+    if (idx >= owners->len) {
+        return NULL;
+    }
+    return (wmem_owner_t *)g_ptr_array_index(owners, idx);
+}
+
+wmem_owner_t *
+wmem_owner_set_current(wmem_owner_t *owner)
+{
+    wmem_owner_t *prev = current_owner;
+
+    current_owner = owner;
+    return prev;
+}
+
+void
+wmem_owner_add(wmem_owner_t *owner, unsigned scope, size_t size)
+{
+    ws_assert(scope < WMEM_ACCOUNTING_MAX_SCOPES);
+
+    if (wmem_accounting_rate == 0) {
+        return;
+    }
+    owner->bytes[scope] += size;
+    owner->objects[scope]++;
+}
+
+void
+wmem_owner_sub(wmem_owner_t *owner, unsigned scope, size_t size)
+{
+    ws_assert(scope < WMEM_ACCOUNTING_MAX_SCOPES);
+
+    if (wmem_accounting_rate == 0) {
+        return;
+    }
+    owner->bytes[scope] -= MIN(size, owner->bytes[scope]);
+    if (owner->objects[scope] > 0) {
+        owner->objects[scope]--;
+    }
+}
+
+void
+wmem_allocator_set_accounting_scope(wmem_allocator_t *allocator, int scope)
+{
+    ws_assert(scope < WMEM_ACCOUNTING_MAX_SCOPES);
+
+    allocator->accounting_scope = scope < 0 ? -1 : scope;
+}
+
+void
+wmem_accounting_set_sample_rate(unsigned sample_rate)
+{
+    wmem_accounting_rate = sample_rate;
+    accounting_countdown = sample_rate;
+}
+
+unsigned
+wmem_accounting_get_sample_rate(void)
+{
+    return wmem_accounting_rate;
+}
+
+void
+wmem_accounting_reset(int scope)
+{
+    ws_assert(scope < WMEM_ACCOUNTING_MAX_SCOPES);
+
+    for (unsigned i = 0; i < owners->len; i++) {
+        wmem_owner_t *owner = (wmem_owner_t *)g_ptr_array_index(owners, i);
+
+        if (scope < 0) {
+            memset(owner->bytes, 0, sizeof(owner->bytes));
+            memset(owner->objects, 0, sizeof(owner->objects));
+        }
+        else {
+            owner->bytes[scope] = 0;
+            owner->objects[scope] = 0;
+        }
+    }
+}
+
+void
+wmem_init_accounting(void)
+{
+    owners = g_ptr_array_new_with_free_func(free_owner);
+    wmem_owner_new("Other");
+}
+
+void
+wmem_cleanup_accounting(void)
+{
+    wmem_accounting_rate = 0;
+    current_owner = NULL;
+    g_ptr_array_free(owners, true);
+    owners = NULL;
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
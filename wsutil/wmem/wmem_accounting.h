@@ -0,0 +1,158 @@
+/** @file
+ * Definitions for the Wireshark Memory Manager Allocation Accounting
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WMEM_ACCOUNTING_H__
+#define __WMEM_ACCOUNTING_H__
+
+#include <glib.h>
+
+#include "wmem_core.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** @addtogroup wmem
+ *  @{
+ *    @defgroup wmem-accounting Allocation Accounting
+ *
+ *    Counts the bytes and objects requested from wmem, broken down by
+ *    the "owner" (a protocol or subsystem) that was current when they
+ *    were requested and by the accounting scope of the allocator they
+ *    came from. Only allocators that have been given a scope with
+ *    wmem_allocator_set_accounting_scope() are counted, and nothing is
+ *    counted until wmem_accounting_set_sample_rate() turns accounting on.
+ *
+ *    The counters are totals since the last wmem_accounting_reset() of
+ *    the scope; memory given back with wmem_free() is not subtracted, and
+ *    wmem_realloc() counts only the growth. Memory counted with
+ *    wmem_owner_add() is subtracted again with wmem_owner_sub().
+ *
+ *    @{
+ */
+
+/** The number of accounting scopes. What they stand for is up to the
+ * caller; epan uses them for the epan, file and packet scopes. */
+#define WMEM_ACCOUNTING_MAX_SCOPES 4
+
+typedef struct _wmem_owner_t {
+    const char *name;
+    uint64_t bytes[WMEM_ACCOUNTING_MAX_SCOPES];
+    uint64_t objects[WMEM_ACCOUNTING_MAX_SCOPES];
+} wmem_owner_t;
+
+/** Create a new owner. Owners live until wmem_cleanup().
+ *
+ * @param name The name shown in reports; it is copied.
+ * @return The new owner.
+ */
+WS_DLL_PUBLIC
+wmem_owner_t *
+wmem_owner_new(const char *name);
+
+/** @return The number of owners, including the owner with index 0,
+ * which counts allocations made while no owner was current.
+ */
+WS_DLL_PUBLIC
+unsigned
+wmem_owner_count(void);
+
+/** @return The owner with the given index, or NULL if there is none. */
+WS_DLL_PUBLIC
+wmem_owner_t *
+wmem_owner_get(unsigned idx);
+
+/** Make an owner current, so that the following allocations are counted
+ * for it.
+ *
+ * @param owner The new owner, or NULL for none.
+ * @return The previous owner, to be passed back here when done.
+ */
+WS_DLL_PUBLIC
+wmem_owner_t *
+wmem_owner_set_current(wmem_owner_t *owner);
+
+/** Count memory that was allocated without wmem, e.g. with g_malloc(),
+ * but is to be reported with it. Not subject to sampling.
+ *
+ * @param owner The owner of the memory.
+ * @param scope The accounting scope in which to count it.
+ * @param size  The number of bytes.
+ */
+WS_DLL_PUBLIC
+void
+wmem_owner_add(wmem_owner_t *owner, unsigned scope, size_t size);
+
+/** Stop counting memory counted with wmem_owner_add(), because it was
+ * freed. The counts don't go below zero, as the memory may have been
+ * added while accounting was off or before a wmem_accounting_reset().
+ *
+ * @param owner The owner of the memory.
+ * @param scope The accounting scope in which it was counted.
+ * @param size  The number of bytes.
+ */
+WS_DLL_PUBLIC
+void
+wmem_owner_sub(wmem_owner_t *owner, unsigned scope, size_t size);
+
+/** Count the allocations from an allocator in an accounting scope.
+ *
+ * @param allocator The allocator.
+ * @param scope     The scope, or -1 not to count its allocations.
+ */
+WS_DLL_PUBLIC
+void
+wmem_allocator_set_accounting_scope(wmem_allocator_t *allocator, int scope);
+
+/** Turn accounting on or off.
+ *
+ * @param sample_rate 0 to turn accounting off, 1 to count every
+ * allocation, or N to count only one allocation in N as if it had
+ * happened N times. Sampling keeps the cost down if there are many
+ * small allocations.
+ */
+WS_DLL_PUBLIC
+void
+wmem_accounting_set_sample_rate(unsigned sample_rate);
+
+/** @return The current sample rate, 0 if accounting is off. */
+WS_DLL_PUBLIC
+unsigned
+wmem_accounting_get_sample_rate(void);
+
+/** Zero the counters of all owners in a scope.
+ *
+ * @param scope The scope, or -1 for all scopes.
+ */
+WS_DLL_PUBLIC
+void
+wmem_accounting_reset(int scope);
+
+/**   @}
+ *  @} */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WMEM_ACCOUNTING_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,63 @@
+/** @file
+ *
+ * Definitions for the Wireshark Memory Manager Allocation Accounting Internals
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WMEM_ACCOUNTING_INT_H__
+#define __WMEM_ACCOUNTING_INT_H__
+
+#include "wmem_allocator.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/* Non-zero while accounting is on; checked on every allocation. */
+WS_DLL_LOCAL
+extern unsigned wmem_accounting_rate;
+
+WS_DLL_LOCAL
+void
+wmem_accounting_count(wmem_allocator_t *allocator, size_t size, bool new_object);
+
+/* Count an allocation, if accounting is on and the allocator is counted. */
+static inline void
+wmem_accounting_check(wmem_allocator_t *allocator, size_t size, bool new_object)
+{
+    if (G_UNLIKELY(wmem_accounting_rate != 0) && allocator->accounting_scope >= 0) {
+        wmem_accounting_count(allocator, size, new_object);
+    }
+}
+
+WS_DLL_LOCAL
+void
+wmem_init_accounting(void);
+
+WS_DLL_LOCAL
+void
+wmem_cleanup_accounting(void);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WMEM_ACCOUNTING_INT_H__ */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -29,6 +29,7 @@ struct _wmem_allocator_t {
     void *(*walloc)(void *private_data, const size_t size);
     void  (*wfree)(void *private_data, void *ptr);
     void *(*wrealloc)(void *private_data, void *ptr, const size_t size);
+    size_t (*wsize)(void *private_data, void *ptr);
 
     /* Producer/Manager functions */
     void  (*free_all)(void *private_data);
@@ -42,6 +43,10 @@ struct _wmem_allocator_t {
     void                        *private_data;
     enum _wmem_allocator_type_t  type;
     bool                         in_scope;
+
+    /* Statistics */
+    uint64_t                     bytes_requested;
+    int                          accounting_scope;  /* -1 if not counted */
 };
 
 #ifdef __cplusplus
@@ -141,9 +141,11 @@
  * also a nice power of two, of course. */
 #define WMEM_BLOCK_SIZE (8 * 1024 * 1024)
 
-/* The header for an entire OS-level 'block' of memory */
+/* The header for an entire OS-level 'block' of memory. jumbo_len is the
+ * size of the allocation if the block contains a single jumbo chunk. */
 typedef struct _wmem_block_hdr_t {
     struct _wmem_block_hdr_t *prev, *next;
+    size_t jumbo_len;
 } wmem_block_hdr_t;
 
 /* The header for a single 'chunk' of memory as returned from alloc/realloc.
@@ -785,6 +787,7 @@ wmem_block_alloc_jumbo(wmem_block_allocator_t *allocator, const size_t size)
 
     /* add it to the block list */
     wmem_block_add_to_block_list(allocator, block);
+    block->jumbo_len = size;
 
     /* the new block contains a single jumbo chunk */
     chunk = WMEM_BLOCK_TO_CHUNK(block);
@@ -825,6 +828,7 @@ wmem_block_realloc_jumbo(wmem_block_allocator_t *allocator,
     block = (wmem_block_hdr_t *) wmem_realloc(NULL, block, size
             + WMEM_BLOCK_HEADER_SIZE
             + WMEM_CHUNK_HEADER_SIZE);
+    block->jumbo_len = size;
 
     if (block->next) {
         block->next->prev = block;
@@ -913,6 +917,19 @@ wmem_block_free(void *private_data, void *ptr)
     wmem_block_cycle_recycler(allocator);
 }
 
+static size_t
+wmem_block_size(void *private_data _U_, void *ptr)
+{
+    wmem_block_chunk_t *chunk;
+
+    chunk = WMEM_DATA_TO_CHUNK(ptr);
+
+    if (chunk->jumbo) {
+        return WMEM_CHUNK_TO_BLOCK(chunk)->jumbo_len;
+    }
+    return WMEM_CHUNK_DATA_LEN(chunk);
+}
+
 static void *
 wmem_block_realloc(void *private_data, void *ptr, const size_t size)
 {
@@ -1099,6 +1116,7 @@ wmem_block_allocator_init(wmem_allocator_t *allocator)
     allocator->walloc   = &wmem_block_alloc;
     allocator->wrealloc = &wmem_block_realloc;
     allocator->wfree    = &wmem_block_free;
+    allocator->wsize    = &wmem_block_size;
 
     allocator->free_all = &wmem_block_free_all;
     allocator->gc       = &wmem_block_gc;
@@ -57,6 +57,7 @@ typedef struct {
 #define JUMBO_MAGIC 0xFFFFFFFF
 typedef struct _wmem_block_fast_jumbo {
     struct _wmem_block_fast_jumbo *prev, *next;
+    size_t size;
 } wmem_block_fast_jumbo_t;
 #define WMEM_JUMBO_HEADER_SIZE WMEM_ALIGN_SIZE(sizeof(wmem_block_fast_jumbo_t))
 
@@ -101,6 +102,7 @@ wmem_block_fast_alloc(void *private_data, const size_t size)
             block->next->prev = block;
         }
         block->prev = NULL;
+        block->size = size;
         allocator->jumbo_list = block;
 
         chunk = ((wmem_block_fast_chunk_t*)((uint8_t*)(block) + WMEM_JUMBO_HEADER_SIZE));
@@ -146,6 +148,7 @@ wmem_block_fast_realloc(void *private_data, void *ptr, const size_t size)
         block = ((wmem_block_fast_jumbo_t*)((uint8_t*)(chunk) - WMEM_JUMBO_HEADER_SIZE));
         block =  (wmem_block_fast_jumbo_t*)wmem_realloc(NULL, block,
                 size + WMEM_JUMBO_HEADER_SIZE + WMEM_CHUNK_HEADER_SIZE);
+        block->size = size;
         if (block->prev) {
             block->prev->next = block;
         }
@@ -173,6 +176,19 @@ wmem_block_fast_realloc(void *private_data, void *ptr, const size_t size)
     return ptr;
 }
 
+static size_t
+wmem_block_fast_size(void *private_data _U_, void *ptr)
+{
+    wmem_block_fast_chunk_t *chunk;
+
+    chunk = WMEM_DATA_TO_CHUNK(ptr);
+
+    if (chunk->len == JUMBO_MAGIC) {
+        return ((wmem_block_fast_jumbo_t*)((uint8_t*)(chunk) - WMEM_JUMBO_HEADER_SIZE))->size;
+    }
+    return chunk->len;
+}
+
 static void
 wmem_block_fast_free_all(void *private_data)
 {
@@ -236,6 +252,7 @@ wmem_block_fast_allocator_init(wmem_allocator_t *allocator)
     allocator->walloc   = &wmem_block_fast_alloc;
     allocator->wrealloc = &wmem_block_fast_realloc;
     allocator->wfree    = &wmem_block_fast_free;
+    allocator->wsize    = &wmem_block_fast_size;
 
     allocator->free_all = &wmem_block_fast_free_all;
     allocator->gc       = &wmem_block_fast_gc;
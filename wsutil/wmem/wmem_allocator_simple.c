@@ -25,6 +25,7 @@ typedef struct _wmem_simple_allocator_t {
     int size;
     int count;
     void **ptrs;
+    size_t *sizes;
 } wmem_simple_allocator_t;
 
 static void *
@@ -38,8 +39,11 @@ wmem_simple_alloc(void *private_data, const size_t size)
         allocator->size *= 2;
         allocator->ptrs = (void**)wmem_realloc(NULL, allocator->ptrs,
                 sizeof(void*) * allocator->size);
+        allocator->sizes = (size_t*)wmem_realloc(NULL, allocator->sizes,
+                sizeof(size_t) * allocator->size);
     }
 
+    allocator->sizes[allocator->count] = size;
     return allocator->ptrs[allocator->count++] = wmem_alloc(NULL, size);
 }
 
@@ -58,6 +62,7 @@ wmem_simple_free(void *private_data, void *ptr)
         if (ptr == allocator->ptrs[i]) {
             if (i < allocator->count) {
                 allocator->ptrs[i] = allocator->ptrs[allocator->count];
+                allocator->sizes[i] = allocator->sizes[allocator->count];
             }
             return;
         }
@@ -76,6 +81,7 @@ wmem_simple_realloc(void *private_data, void *ptr, const size_t size)
 
     for (i=allocator->count-1; i>=0; i--) {
         if (ptr == allocator->ptrs[i]) {
+            allocator->sizes[i] = size;
             return allocator->ptrs[i] = wmem_realloc(NULL, allocator->ptrs[i], size);
         }
     }
@@ -85,6 +91,25 @@ wmem_simple_realloc(void *private_data, void *ptr, const size_t size)
     return NULL;
 }
 
+static size_t
+wmem_simple_size(void *private_data, void *ptr)
+{
+    int                      i;
+    wmem_simple_allocator_t *allocator;
+
+    allocator = (wmem_simple_allocator_t*) private_data;
+
+    for (i=allocator->count-1; i>=0; i--) {
+        if (ptr == allocator->ptrs[i]) {
+            return allocator->sizes[i];
+        }
+    }
+
+    g_assert_not_reached();
+    /* not reached */
+    return 0;
+}
+
 static void
 wmem_simple_free_all(void *private_data)
 {
@@ -113,6 +138,7 @@ wmem_simple_allocator_cleanup(void *private_data)
     allocator = (wmem_simple_allocator_t*) private_data;
 
     wmem_free(NULL, allocator->ptrs);
+    wmem_free(NULL, allocator->sizes);
     wmem_free(NULL, allocator);
 }
 
@@ -126,6 +152,7 @@ wmem_simple_allocator_init(wmem_allocator_t *allocator)
     allocator->walloc   = &wmem_simple_alloc;
     allocator->wrealloc = &wmem_simple_realloc;
     allocator->wfree    = &wmem_simple_free;
+    allocator->wsize    = &wmem_simple_size;
 
     allocator->free_all = &wmem_simple_free_all;
     allocator->gc       = &wmem_simple_gc;
@@ -136,6 +163,7 @@ wmem_simple_allocator_init(wmem_allocator_t *allocator)
     simple_allocator->count = 0;
     simple_allocator->size = DEFAULT_ALLOCS;
     simple_allocator->ptrs = wmem_alloc_array(NULL, void*, DEFAULT_ALLOCS);
+    simple_allocator->sizes = wmem_alloc_array(NULL, size_t, DEFAULT_ALLOCS);
 }
 
 /*
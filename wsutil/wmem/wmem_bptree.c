@@ -0,0 +1,550 @@
+/* wmem_bptree.c
+ * Wireshark Memory Manager B+tree for 32-bit keys
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+/*
+ * The entries of a wmem_tree_t that are inserted with a 32-bit key live
+ * in a B+tree rather than in the red-black tree, so that looking up a
+ * key touches a few wide nodes instead of one node per level. Keys
+ * (mostly frame numbers and sequence numbers) usually arrive in
+ * increasing order, so:
+ *
+ * - A key greater than every other key is appended to the rightmost
+ *   leaf without walking down the tree, and when that leaf is full it
+ *   is split so that the old leaf stays full rather than half empty.
+ * - Lookups first try the leaf of the previous lookup (the "finger")
+ *   and the rightmost leaf.
+ *
+ * The leaves are linked in key order for the _le/_ge lookups and for
+ * wmem_tree_foreach(). Removal just takes the entry out of its leaf;
+ * nodes are never merged, and a leaf can become empty. Separator keys
+ * stay valid bounds after a removal, so lookups only have to step over
+ * empty leaves. All the nodes are freed when the last entry goes.
+ *
+ * A tree with a single leaf starts out small and grows the leaf as
+ * needed, because a lot of trees only ever hold a handful of entries.
+ */
+
+#include "config.h"
+
+#include <string.h>
+#include <stdio.h>
+#include <glib.h>
+
+#include "wmem-int.h"
+#include "wmem_core.h"
+#include "wmem_tree.h"
+#include "wmem_tree-int.h"
+
+#define BPTREE_LEAF_MIN     4   /* Initial capacity of the root leaf */
+#define BPTREE_LEAF_MAX     32
+#define BPTREE_INNER_MAX    32  /* Children per inner node */
+#define BPTREE_MAX_HEIGHT   16
+
+struct _wmem_bptree_leaf_t {
+    unsigned            count;
+    unsigned            capacity;
+    wmem_bptree_leaf_t *prev;
+    wmem_bptree_leaf_t *next;
+    /* These point into the same allocation as the leaf. */
+    void              **values;
+    uint32_t           *keys;
+    uint8_t            *is_subtree;
+};
+
+typedef struct _wmem_bptree_inner_t {
+    unsigned  count;                        /* Number of children */
+    /* Every key in children[i] is < keys[i] <= every key in children[i+1] */
+    uint32_t  keys[BPTREE_INNER_MAX - 1];
+    void     *children[BPTREE_INNER_MAX];
+} wmem_bptree_inner_t;
+
+#define CREATE_DATA(TRANSFORM, DATA) ((TRANSFORM) ? (TRANSFORM)(DATA) : (DATA))
+
+/* Index of the first key > key. */
+static inline unsigned
+bptree_upper_bound(const uint32_t *keys, unsigned n, uint32_t key)
+{
+    unsigned lo = 0;
+
+    while (n > 0) {
+        unsigned half = n / 2;
+        if (keys[lo + half] <= key) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+/* Index of the first key >= key. */
+static inline unsigned
+bptree_lower_bound(const uint32_t *keys, unsigned n, uint32_t key)
+{
+    unsigned lo = 0;
+
+    while (n > 0) {
+        unsigned half = n / 2;
+        if (keys[lo + half] < key) {
+            lo += half + 1;
+            n -= half + 1;
+        } else {
+            n = half;
+        }
+    }
+    return lo;
+}
+
+static wmem_bptree_leaf_t *
+bptree_leaf_new(wmem_allocator_t *allocator, unsigned capacity)
+{
+    wmem_bptree_leaf_t *leaf;
+
+    leaf = (wmem_bptree_leaf_t *)wmem_alloc(allocator, sizeof(wmem_bptree_leaf_t) +
+            capacity * (sizeof(void *) + sizeof(uint32_t) + sizeof(uint8_t)));
+    leaf->count = 0;
+    leaf->capacity = capacity;
+    leaf->prev = NULL;
+    leaf->next = NULL;
+    leaf->values = (void **)(leaf + 1);
+    leaf->keys = (uint32_t *)(leaf->values + capacity);
+    leaf->is_subtree = (uint8_t *)(leaf->keys + capacity);
+
+    return leaf;
+}
+
+/* Copy n entries from src[from] to dst[to]. The ranges may overlap. */
+static inline void
+bptree_leaf_move(wmem_bptree_leaf_t *dst, unsigned to,
+        const wmem_bptree_leaf_t *src, unsigned from, unsigned n)
+{
+    memmove(&dst->values[to], &src->values[from], n * sizeof(void *));
+    memmove(&dst->keys[to], &src->keys[from], n * sizeof(uint32_t));
+    memmove(&dst->is_subtree[to], &src->is_subtree[from], n * sizeof(uint8_t));
+}
+
+static void
+bptree_leaf_insert_at(wmem_bptree_leaf_t *leaf, unsigned pos, uint32_t key,
+        void *data, bool is_subtree)
+{
+    bptree_leaf_move(leaf, pos + 1, leaf, pos, leaf->count - pos);
+    leaf->values[pos] = data;
+    leaf->keys[pos] = key;
+    leaf->is_subtree[pos] = is_subtree;
+    leaf->count++;
+}
+
+static void
+bptree_free_node(wmem_allocator_t *allocator, void *node, unsigned height)
+{
+    if (height > 0) {
+        wmem_bptree_inner_t *inner = (wmem_bptree_inner_t *)node;
+        for (unsigned i = 0; i < inner->count; i++) {
+            bptree_free_node(allocator, inner->children[i], height - 1);
+        }
+    }
+    wmem_free(allocator, node);
+}
+
+static void
+bptree_clear(wmem_tree_t *tree)
+{
+    if (tree->bptree.root) {
+        bptree_free_node(tree->data_allocator, tree->bptree.root, tree->bptree.height);
+    }
+    memset(&tree->bptree, 0, sizeof(tree->bptree));
+}
+
+static wmem_bptree_leaf_t *
+bptree_find_leaf(const wmem_bptree_t *bpt, uint32_t key,
+        wmem_bptree_inner_t **path, unsigned *slot)
+{
+    void *node = bpt->root;
+
+    for (unsigned depth = 0; depth < bpt->height; depth++) {
+        wmem_bptree_inner_t *inner = (wmem_bptree_inner_t *)node;
+        unsigned i = bptree_upper_bound(inner->keys, inner->count - 1, key);
+        if (path) {
+            path[depth] = inner;
+            slot[depth] = i;
+        }
+        node = inner->children[i];
+    }
+    return (wmem_bptree_leaf_t *)node;
+}
+
+/*
+ * Find a leaf such that every key in the leaves before it is < key and
+ * every key in the leaves after it is > key. The tree must not be empty.
+ */
+static wmem_bptree_leaf_t *
+bptree_lookup_leaf(wmem_bptree_t *bpt, uint32_t key)
+{
+    wmem_bptree_leaf_t *leaf;
+
+    leaf = bpt->finger;
+    if (leaf && leaf->count > 0 && leaf->keys[0] <= key &&
+            (leaf->next == NULL ||
+             (leaf->next->count > 0 && key < leaf->next->keys[0]))) {
+        return leaf;
+    }
+
+    leaf = bpt->tail;
+    if (leaf->count > 0 && leaf->keys[0] <= key) {
+        return leaf;
+    }
+
+    leaf = bptree_find_leaf(bpt, key, NULL, NULL);
+    bpt->finger = leaf;
+    return leaf;
+}
+
+/*
+ * Add a child to the right of path[depth-1]->children[slot[depth-1]],
+ * splitting inner nodes as needed.
+ */
+static void
+bptree_insert_child(wmem_tree_t *tree, wmem_bptree_inner_t **path, unsigned *slot,
+        unsigned depth, uint32_t sep, void *child, bool append)
+{
+    wmem_bptree_t *bpt = &tree->bptree;
+    wmem_bptree_inner_t *inner, *right;
+    uint32_t keys[BPTREE_INNER_MAX];
+    void *children[BPTREE_INNER_MAX + 1];
+    unsigned i, left_count;
+
+    while (depth > 0) {
+        depth--;
+        inner = path[depth];
+        i = slot[depth];
+
+        if (inner->count < BPTREE_INNER_MAX) {
+            memmove(&inner->keys[i + 1], &inner->keys[i],
+                    (inner->count - 1 - i) * sizeof(uint32_t));
+            memmove(&inner->children[i + 2], &inner->children[i + 1],
+                    (inner->count - 1 - i) * sizeof(void *));
+            inner->keys[i] = sep;
+            inner->children[i + 1] = child;
+            inner->count++;
+            return;
+        }
+
+        memcpy(keys, inner->keys, i * sizeof(uint32_t));
+        keys[i] = sep;
+        memcpy(&keys[i + 1], &inner->keys[i], (BPTREE_INNER_MAX - 1 - i) * sizeof(uint32_t));
+        memcpy(children, inner->children, (i + 1) * sizeof(void *));
+        children[i + 1] = child;
+        memcpy(&children[i + 2], &inner->children[i + 1], (BPTREE_INNER_MAX - 1 - i) * sizeof(void *));
+
+        /* When appending, leave the full node alone and start a new one. */
+        left_count = append ? BPTREE_INNER_MAX : (BPTREE_INNER_MAX + 1) / 2;
+
+        right = wmem_new(tree->data_allocator, wmem_bptree_inner_t);
+        right->count = BPTREE_INNER_MAX + 1 - left_count;
+        memcpy(right->children, &children[left_count], right->count * sizeof(void *));
+        memcpy(right->keys, &keys[left_count], (right->count - 1) * sizeof(uint32_t));
+
+        inner->count = left_count;
+        memcpy(inner->children, children, left_count * sizeof(void *));
+        memcpy(inner->keys, keys, (left_count - 1) * sizeof(uint32_t));
+
+        sep = keys[left_count - 1];
+        child = right;
+    }
+
+    /* The root was split. */
+    ws_assert(bpt->height < BPTREE_MAX_HEIGHT);
+    inner = wmem_new(tree->data_allocator, wmem_bptree_inner_t);
+    inner->count = 2;
+    inner->keys[0] = sep;
+    inner->children[0] = bpt->root;
+    inner->children[1] = child;
+    bpt->root = inner;
+    bpt->height++;
+}
+
+void *
+wmem_bptree_insert(wmem_tree_t *tree, uint32_t key, void*(*func)(void*),
+        void *data, bool is_subtree, bool replace)
+{
+    wmem_bptree_t *bpt = &tree->bptree;
+    wmem_bptree_inner_t *path[BPTREE_MAX_HEIGHT];
+    unsigned slot[BPTREE_MAX_HEIGHT];
+    wmem_bptree_leaf_t *leaf, *right;
+    unsigned pos, split;
+    bool append;
+
+    if (!bpt->root) {
+        leaf = bptree_leaf_new(tree->data_allocator, BPTREE_LEAF_MIN);
+        bpt->root = bpt->head = bpt->tail = leaf;
+    }
+
+    /* Fast path: the key is greater than all the others and fits in the
+     * rightmost leaf. */
+    leaf = bpt->tail;
+    if (leaf->count > 0 && leaf->count < leaf->capacity &&
+            key > leaf->keys[leaf->count - 1]) {
+        data = CREATE_DATA(func, data);
+        bptree_leaf_insert_at(leaf, leaf->count, key, data, is_subtree);
+        bpt->count++;
+        return data;
+    }
+
+    leaf = bptree_find_leaf(bpt, key, path, slot);
+    pos = bptree_lower_bound(leaf->keys, leaf->count, key);
+    if (pos < leaf->count && leaf->keys[pos] == key) {
+        if (replace) {
+            leaf->values[pos] = CREATE_DATA(func, data);
+        }
+        return leaf->values[pos];
+    }
+
+    data = CREATE_DATA(func, data);
+    bpt->count++;
+
+    if (leaf->count < leaf->capacity) {
+        bptree_leaf_insert_at(leaf, pos, key, data, is_subtree);
+        return data;
+    }
+
+    if (leaf->capacity < BPTREE_LEAF_MAX) {
+        /* Only a lone root leaf is allowed to be smaller. */
+        right = bptree_leaf_new(tree->data_allocator, MIN(leaf->capacity * 2, BPTREE_LEAF_MAX));
+        bptree_leaf_move(right, 0, leaf, 0, leaf->count);
+        right->count = leaf->count;
+        wmem_free(tree->data_allocator, leaf);
+        bpt->root = bpt->head = bpt->tail = right;
+        bpt->finger = NULL;
+        bptree_leaf_insert_at(right, pos, key, data, is_subtree);
+        return data;
+    }
+
+    /* Split the leaf. When appending, leave the full leaf alone and
+     * start a new one, so that increasing keys fill the leaves. */
+    append = (leaf == bpt->tail && pos == leaf->count);
+    split = append ? leaf->count : leaf->count / 2;
+
+    right = bptree_leaf_new(tree->data_allocator, BPTREE_LEAF_MAX);
+    bptree_leaf_move(right, 0, leaf, split, leaf->count - split);
+    right->count = leaf->count - split;
+    leaf->count = split;
+
+    right->prev = leaf;
+    right->next = leaf->next;
+    if (leaf->next) {
+        leaf->next->prev = right;
+    } else {
+        bpt->tail = right;
+    }
+    leaf->next = right;
+
+    if (pos >= split) {
+        bptree_leaf_insert_at(right, pos - split, key, data, is_subtree);
+    } else {
+        bptree_leaf_insert_at(leaf, pos, key, data, is_subtree);
+    }
+
+    bptree_insert_child(tree, path, slot, bpt->height, right->keys[0], right, append);
+
+    return data;
+}
+
+bool
+wmem_bptree_lookup(wmem_tree_t *tree, uint32_t key, void **data)
+{
+    wmem_bptree_leaf_t *leaf;
+    unsigned pos;
+
+    if (!tree->bptree.root) {
+        return false;
+    }
+
+    leaf = bptree_lookup_leaf(&tree->bptree, key);
+    pos = bptree_lower_bound(leaf->keys, leaf->count, key);
+    if (pos == leaf->count || leaf->keys[pos] != key) {
+        return false;
+    }
+
+    if (data) {
+        *data = leaf->values[pos];
+    }
+    return true;
+}
+
+bool
+wmem_bptree_lookup_le(wmem_tree_t *tree, uint32_t key, uint32_t *orig_key, void **data)
+{
+    wmem_bptree_leaf_t *leaf;
+    unsigned pos;
+
+    if (!tree->bptree.root) {
+        return false;
+    }
+
+    leaf = bptree_lookup_leaf(&tree->bptree, key);
+    pos = bptree_upper_bound(leaf->keys, leaf->count, key);
+    while (pos == 0) {
+        leaf = leaf->prev;
+        if (!leaf) {
+            return false;
+        }
+        pos = leaf->count;
+    }
+
+    *orig_key = leaf->keys[pos - 1];
+    *data = leaf->values[pos - 1];
+    return true;
+}
+
+bool
+wmem_bptree_lookup_ge(wmem_tree_t *tree, uint32_t key, uint32_t *orig_key, void **data)
+{
+    wmem_bptree_leaf_t *leaf;
+    unsigned pos;
+
+    if (!tree->bptree.root) {
+        return false;
+    }
+
+    leaf = bptree_lookup_leaf(&tree->bptree, key);
+    pos = bptree_lower_bound(leaf->keys, leaf->count, key);
+    while (pos == leaf->count) {
+        leaf = leaf->next;
+        if (!leaf) {
+            return false;
+        }
+        pos = 0;
+    }
+
+    *orig_key = leaf->keys[pos];
+    *data = leaf->values[pos];
+    return true;
+}
+
+void *
+wmem_bptree_remove(wmem_tree_t *tree, uint32_t key)
+{
+    wmem_bptree_leaf_t *leaf;
+    unsigned pos;
+    void *data;
+
+    if (!tree->bptree.root) {
+        return NULL;
+    }
+
+    leaf = bptree_lookup_leaf(&tree->bptree, key);
+    pos = bptree_lower_bound(leaf->keys, leaf->count, key);
+    if (pos == leaf->count || leaf->keys[pos] != key) {
+        return NULL;
+    }
+
+    data = leaf->values[pos];
+    bptree_leaf_move(leaf, pos, leaf, pos + 1, leaf->count - pos - 1);
+    leaf->count--;
+
+    if (--tree->bptree.count == 0) {
+        bptree_clear(tree);
+    }
+
+    return data;
+}
+
+bool
+wmem_bptree_foreach(wmem_tree_t *tree, wmem_foreach_func callback, void *user_data)
+{
+    for (wmem_bptree_leaf_t *leaf = tree->bptree.head; leaf; leaf = leaf->next) {
+        for (unsigned i = 0; i < leaf->count; i++) {
+            bool stop_traverse;
+
+            if (leaf->is_subtree[i]) {
+                stop_traverse = wmem_tree_foreach((wmem_tree_t *)leaf->values[i],
+                        callback, user_data);
+            } else {
+                stop_traverse = callback(GUINT_TO_POINTER(leaf->keys[i]),
+                        leaf->values[i], user_data);
+            }
+            if (stop_traverse) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+void
+wmem_bptree_destroy(wmem_tree_t *tree, bool free_keys, bool free_values)
+{
+    for (wmem_bptree_leaf_t *leaf = tree->bptree.head; leaf; leaf = leaf->next) {
+        for (unsigned i = 0; i < leaf->count; i++) {
+            /* The keys are integers, so there is nothing to free for
+             * them at this level. */
+            if (leaf->is_subtree[i]) {
+                wmem_tree_destroy((wmem_tree_t *)leaf->values[i], free_keys, free_values);
+            } else if (free_values) {
+                wmem_free(tree->data_allocator, leaf->values[i]);
+            }
+        }
+    }
+
+    bptree_clear(tree);
+}
+
+void
+wmem_bptree_print(wmem_tree_t *tree, uint32_t level, wmem_printer_func key_printer,
+        wmem_printer_func data_printer)
+{
+    const wmem_bptree_t *bpt = &tree->bptree;
+
+    if (!bpt->root) {
+        return;
+    }
+
+    wmem_print_indent(level);
+    printf("B+TREE:%p height:%u count:%u\n", bpt->root, bpt->height, bpt->count);
+
+    for (wmem_bptree_leaf_t *leaf = bpt->head; leaf; leaf = leaf->next) {
+        wmem_print_indent(level + 1);
+        printf("LEAF:%p prev:%p next:%p count:%u\n",
+                (void *)leaf, (void *)leaf->prev, (void *)leaf->next, leaf->count);
+        for (unsigned i = 0; i < leaf->count; i++) {
+            wmem_print_indent(level + 2);
+            printf("key:%u %s:%p\n", leaf->keys[i],
+                    leaf->is_subtree[i]?"tree":"data", leaf->values[i]);
+            if (key_printer) {
+                wmem_print_indent(level + 2);
+                key_printer(GUINT_TO_POINTER(leaf->keys[i]));
+                printf("\n");
+            }
+            if (leaf->is_subtree[i]) {
+                wmem_print_subtree((wmem_tree_t *)leaf->values[i], level + 3,
+                        key_printer, data_printer);
+            } else if (data_printer) {
+                wmem_print_indent(level + 2);
+                data_printer(leaf->values[i]);
+                printf("\n");
+            }
+        }
+    }
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
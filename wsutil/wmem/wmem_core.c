@@ -15,6 +15,7 @@
 
 #include "wmem-int.h"
 #include "wmem_core.h"
+#include "wmem_accounting_int.h"
 #include "wmem_map_int.h"
 #include "wmem_user_cb_int.h"
 #include "wmem_allocator.h"
@@ -41,6 +42,9 @@ wmem_alloc(wmem_allocator_t *allocator, const size_t size)
         return NULL;
     }
 
+    allocator->bytes_requested += size;
+    wmem_accounting_check(allocator, size, true);
+
     return allocator->walloc(allocator->private_data, size);
 }
 
@@ -78,6 +82,8 @@ wmem_free(wmem_allocator_t *allocator, void *ptr)
 void *
 wmem_realloc(wmem_allocator_t *allocator, void *ptr, const size_t size)
 {
+    size_t old_size;
+
     if (allocator == NULL) {
         return g_realloc(ptr, size);
     }
@@ -93,6 +99,13 @@ wmem_realloc(wmem_allocator_t *allocator, void *ptr, const size_t size)
 
     ws_assert(allocator->in_scope);
 
+    /* Only the growth is newly requested memory. */
+    old_size = allocator->wsize(allocator->private_data, ptr);
+    if (size > old_size) {
+        allocator->bytes_requested += size - old_size;
+        wmem_accounting_check(allocator, size - old_size, false);
+    }
+
     return allocator->wrealloc(allocator->private_data, ptr, size);
 }
 
@@ -116,6 +129,16 @@ wmem_gc(wmem_allocator_t *allocator)
     allocator->gc(allocator->private_data);
 }
 
+uint64_t
+wmem_bytes_requested(wmem_allocator_t *allocator)
+{
+    if (allocator == NULL) {
+        return 0;
+    }
+
+    return allocator->bytes_requested;
+}
+
 void
 wmem_destroy_allocator(wmem_allocator_t *allocator)
 {
@@ -142,6 +165,8 @@ wmem_allocator_new(const wmem_allocator_type_t type)
     allocator->type      = real_type;
     allocator->callbacks = NULL;
     allocator->in_scope  = true;
+    allocator->bytes_requested = 0;
+    allocator->accounting_scope = -1;
 
     switch (real_type) {
         case WMEM_ALLOCATOR_SIMPLE:
@@ -199,11 +224,13 @@ wmem_init(void)
     }
 
     wmem_init_hashing();
+    wmem_init_accounting();
 }
 
 void
 wmem_cleanup(void)
 {
+    wmem_cleanup_accounting();
 }
 
 void
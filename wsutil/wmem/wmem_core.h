@@ -186,6 +186,17 @@ WS_DLL_PUBLIC
 void
 wmem_gc(wmem_allocator_t *allocator);
 
+/** Get the number of bytes requested from the allocator with wmem_alloc()
+ * and wmem_realloc() since it was created. Freeing memory does not decrease
+ * the count; compare two readings to see how much was allocated in between.
+ *
+ * @param allocator The allocator to query.
+ * @return The number of bytes, or 0 for the NULL allocator.
+ */
+WS_DLL_PUBLIC
+uint64_t
+wmem_bytes_requested(wmem_allocator_t *allocator);
+
 /** Destroy the given allocator, freeing all memory allocated in it. Once this
  * function has been called, no memory allocated with the allocator is valid.
  *
@@ -18,7 +18,18 @@
 #include "wmem_map_int.h"
 #include "wmem_user_cb.h"
 
-static uint32_t x; /* Used for universal integer hashing (see the HASH macro) */
+#include <string.h>
+#include <wsutil/bits_ctz.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define WMEM_MAP_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define WMEM_MAP_NEON
+#endif
+
+static uint64_t x; /* Used for universal integer hashing (see wmem_map_hash) */
 
 /* Used for the wmem_strong_hash() function */
 static uint32_t preseed;
@@ -27,30 +38,63 @@ static uint32_t postseed;
 void
 wmem_init_hashing(void)
 {
-    x = g_random_int();
-    if (G_UNLIKELY(x == 0))
-        x = 1;
+    /* Multiply-shift hashing needs an odd multiplier. */
+    x = ((uint64_t)g_random_int() << 32 | g_random_int()) | 1;
 
     preseed  = g_random_int();
     postseed = g_random_int();
 }
 
-typedef struct _wmem_map_item_t {
+/*
+ * The map is an open-addressing hash table in the style of Abseil's
+ * SwissTable. Slots are divided into groups of 16, and every slot has a
+ * control byte that is either EMPTY, DELETED, or (if the high bit is
+ * clear) the low 7 bits of the key's hash, "H2". A lookup starts at the
+ * group picked by the other hash bits, "H1", compares the 16 control
+ * bytes of the group against H2 at once with SSE2 or NEON, and only calls
+ * the equality function for the slots that match. It stops at the first
+ * group with an EMPTY slot; otherwise it moves on to another group with
+ * triangular probing, which visits every group of a power-of-2 table.
+ *
+ * A table is never more than 7/8 full, counting DELETED slots. When it
+ * fills up, a new table is allocated (twice the size, or the same size if
+ * most of the slots are DELETED) and the entries are moved over a group
+ * at a time on each following insertion, so that no single insertion
+ * has to rehash the whole map. Until that finishes, lookups and removals
+ * check both tables.
+ *
+ * Moving entries is only done on insertion, so it is safe to remove
+ * entries while iterating over the map.
+ */
+
+#define CTRL_EMPTY      0x80
+#define CTRL_DELETED    0xFE
+#define CTRL_IS_FULL(c) (((c) & 0x80) == 0)
+
+#define GROUP_SIZE      16
+
+typedef struct _wmem_map_slot_t {
     const void *key;
     void *value;
-    struct _wmem_map_item_t *next;
-} wmem_map_item_t;
+} wmem_map_slot_t;
+
+typedef struct _wmem_map_table_t {
+    uint8_t *ctrl;              /* GROUP_SIZE << groups_log2 control bytes */
+    wmem_map_slot_t *slots;     /* Allocated with ctrl */
+    unsigned groups_log2;
+    unsigned count;             /* Full slots */
+    unsigned growth_left;       /* Empty slots that can still be filled */
+} wmem_map_table_t;
 
 struct _wmem_map_t {
     unsigned count; /* number of items stored */
 
-    /* The base-2 logarithm of the actual size of the table. We store this
-     * value for efficiency in hashing, since finding the actual capacity
-     * becomes just a left-shift (see the CAPACITY macro) whereas taking
-     * logarithms is expensive. */
-    size_t capacity;
+    wmem_map_table_t table;
 
-    wmem_map_item_t **table;
+    /* The previous table, while its entries are being moved to 'table';
+     * old.ctrl is NULL otherwise. */
+    wmem_map_table_t old;
+    size_t migrate_pos;         /* Next group of 'old' to move */
 
     GHashFunc  hash_func;
     GEqualFunc eql_func;
@@ -62,26 +106,136 @@ struct _wmem_map_t {
     wmem_allocator_t *data_allocator;
 };
 
-/* As per the comment on the 'capacity' member of the wmem_map_t struct, this is
- * the base-2 logarithm, meaning the actual default capacity is 2^5 = 32 */
-#define WMEM_MAP_DEFAULT_CAPACITY 5
+/* The base-2 logarithm of the number of groups in a new table, meaning the
+ * actual default capacity is 2 * 16 = 32 slots */
+#define WMEM_MAP_DEFAULT_GROUPS_LOG2 1
+
+#define TABLE_GROUPS(TBL)   (((size_t)1) << (TBL)->groups_log2)
+#define TABLE_CAPACITY(TBL) (TABLE_GROUPS(TBL) * GROUP_SIZE)
+
+/* Maximum load factor of 7/8 */
+#define MAX_LOAD(CAP)       ((CAP) - (CAP) / 8)
+
+/* Bit masks with one bit per matching slot of a group, iterated with
+ * GROUP_MASK_NEXT. NEON has no movemask, so its masks have 4 bits per
+ * slot, of which only the highest is kept. */
+#ifdef WMEM_MAP_NEON
+typedef uint64_t group_mask_t;
+#define GROUP_MASK_SHIFT    2
+#else
+typedef uint32_t group_mask_t;
+#define GROUP_MASK_SHIFT    0
+#endif
+
+#define GROUP_MASK_NEXT(MASK, I) \
+    ((I) = (unsigned)ws_ctz(MASK) >> GROUP_MASK_SHIFT, (MASK) &= (MASK) - 1)
+
+#if defined(WMEM_MAP_SSE2)
+
+static inline group_mask_t
+group_match(const uint8_t *ctrl, uint8_t h2)
+{
+    __m128i group = _mm_loadu_si128((const __m128i *)ctrl);
+    return (group_mask_t)_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8((char)h2)));
+}
+
+static inline group_mask_t
+group_match_empty_or_deleted(const uint8_t *ctrl)
+{
+    /* Both have the high bit set. */
+    return (group_mask_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+}
+
+#elif defined(WMEM_MAP_NEON)
+
+static inline group_mask_t
+neon_mask(uint8x16_t bytes)
+{
+    /* Narrow each 0x00/0xFF byte to a nibble. */
+    uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(bytes), 4);
+    return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & UINT64_C(0x8888888888888888);
+}
+
+static inline group_mask_t
+group_match(const uint8_t *ctrl, uint8_t h2)
+{
+    return neon_mask(vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(h2)));
+}
+
+static inline group_mask_t
+group_match_empty_or_deleted(const uint8_t *ctrl)
+{
+    return neon_mask(vtstq_u8(vld1q_u8(ctrl), vdupq_n_u8(0x80)));
+}
+
+#else
+
+static inline group_mask_t
+group_match(const uint8_t *ctrl, uint8_t h2)
+{
+    group_mask_t mask = 0;
+
+    for (unsigned i = 0; i < GROUP_SIZE; i++) {
+        if (ctrl[i] == h2)
+            mask |= 1U << i;
+    }
+    return mask;
+}
+
+static inline group_mask_t
+group_match_empty_or_deleted(const uint8_t *ctrl)
+{
+    group_mask_t mask = 0;
+
+    for (unsigned i = 0; i < GROUP_SIZE; i++) {
+        if (!CTRL_IS_FULL(ctrl[i]))
+            mask |= 1U << i;
+    }
+    return mask;
+}
+
+#endif
 
-/* Macro for calculating the real capacity of the map by using a left-shift to
- * do the 2^x operation. */
-#define CAPACITY(MAP) (((size_t)1) << (MAP)->capacity)
+static inline group_mask_t
+group_match_empty(const uint8_t *ctrl)
+{
+    return group_match(ctrl, CTRL_EMPTY);
+}
 
 /* Efficient universal integer hashing:
  * https://en.wikipedia.org/wiki/Universal_hashing#Avoiding_modular_arithmetic
- */
-#define HASH(MAP, KEY) \
-    ((uint32_t)(((MAP)->hash_func(KEY) * x) >> (32 - (MAP)->capacity)))
+ * The top 7 bits are H2, and the bits below them pick the first group. */
+static inline uint64_t
+wmem_map_hash(const wmem_map_t *map, const void *key)
+{
+    return (uint64_t)map->hash_func(key) * x;
+}
+
+#define HASH_H2(HASH)       ((uint8_t)((HASH) >> 57))
+#define HASH_GROUP(HASH, TBL) \
+    ((size_t)((HASH) >> (57 - (TBL)->groups_log2)) & (TABLE_GROUPS(TBL) - 1))
 
 static void
-wmem_map_init_table(wmem_map_t *map)
+wmem_map_alloc_table(wmem_map_t *map, wmem_map_table_t *tbl, unsigned groups_log2)
+{
+    size_t capacity = ((size_t)GROUP_SIZE) << groups_log2;
+
+    tbl->ctrl = (uint8_t *)wmem_alloc(map->data_allocator,
+            capacity * (1 + sizeof(wmem_map_slot_t)));
+    tbl->slots = (wmem_map_slot_t *)(tbl->ctrl + capacity);
+    memset(tbl->ctrl, CTRL_EMPTY, capacity);
+    tbl->groups_log2 = groups_log2;
+    tbl->count = 0;
+    tbl->growth_left = (unsigned)MAX_LOAD(capacity);
+}
+
+static inline void
+wmem_map_clear_tables(wmem_map_t *map)
 {
-    map->count     = 0;
-    map->capacity  = WMEM_MAP_DEFAULT_CAPACITY;
-    map->table     = wmem_alloc0_array(map->data_allocator, wmem_map_item_t*, CAPACITY(map));
+    map->count = 0;
+    memset(&map->table, 0, sizeof(map->table));
+    memset(&map->old, 0, sizeof(map->old));
+    map->migrate_pos = 0;
 }
 
 wmem_map_t *
@@ -96,8 +250,7 @@ wmem_map_new(wmem_allocator_t *allocator,
     map->eql_func  = eql_func;
     map->metadata_allocator    = allocator;
     map->data_allocator = allocator;
-    map->count = 0;
-    map->table = NULL;
+    wmem_map_clear_tables(map);
 
     return map;
 }
@@ -108,8 +261,7 @@ wmem_map_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event,
 {
     wmem_map_t *map = (wmem_map_t*)user_data;
 
-    map->count = 0;
-    map->table = NULL;
+    wmem_map_clear_tables(map);
 
     if (event == WMEM_CB_DESTROY_EVENT) {
         wmem_unregister_callback(map->metadata_allocator, map->metadata_scope_cb_id);
@@ -142,8 +294,7 @@ wmem_map_new_autoreset(wmem_allocator_t *metadata_scope, wmem_allocator_t *data_
     map->eql_func  = eql_func;
     map->metadata_allocator = metadata_scope;
     map->data_allocator = data_scope;
-    map->count = 0;
-    map->table = NULL;
+    wmem_map_clear_tables(map);
 
     map->metadata_scope_cb_id = wmem_register_callback(metadata_scope, wmem_map_destroy_cb, map);
     map->data_scope_cb_id  = wmem_register_callback(data_scope, wmem_map_reset_cb, map);
@@ -151,313 +302,387 @@ wmem_map_new_autoreset(wmem_allocator_t *metadata_scope, wmem_allocator_t *data_
     return map;
 }
 
-static inline void
-wmem_map_grow(wmem_map_t *map)
-{
-    wmem_map_item_t **old_table, *cur, *nxt;
-    size_t            old_cap, i;
-    unsigned          slot;
-
-    /* store the old table and capacity */
-    old_table = map->table;
-    old_cap   = CAPACITY(map);
-
-    /* double the size (capacity is base-2 logarithm, so this just means
-     * increment it) and allocate new table */
-    map->capacity++;
-    map->table = wmem_alloc0_array(map->data_allocator, wmem_map_item_t*, CAPACITY(map));
-
-    /* copy all the elements over from the old table */
-    for (i=0; i<old_cap; i++) {
-        cur = old_table[i];
-        while (cur) {
-            nxt              = cur->next;
-            slot             = HASH(map, cur->key);
-            cur->next        = map->table[slot];
-            map->table[slot] = cur;
-            cur              = nxt;
+/* Returns the slot holding key in tbl, or NULL. */
+static inline wmem_map_slot_t *
+wmem_map_table_find(const wmem_map_t *map, const wmem_map_table_t *tbl,
+        const void *key, uint64_t hash)
+{
+    const uint8_t *ctrl = tbl->ctrl;
+    wmem_map_slot_t *slots = tbl->slots;
+    size_t   group_mask = TABLE_GROUPS(tbl) - 1;
+    size_t   group = HASH_GROUP(hash, tbl);
+    size_t   step;
+    uint8_t  h2 = HASH_H2(hash);
+
+    for (step = 1; ; step++) {
+        group_mask_t match = group_match(ctrl + group * GROUP_SIZE, h2);
+        unsigned     i;
+
+        while (match) {
+            GROUP_MASK_NEXT(match, i);
+            if (map->eql_func(key, slots[group * GROUP_SIZE + i].key)) {
+                return &slots[group * GROUP_SIZE + i];
+            }
         }
+        if (G_LIKELY(group_match_empty(ctrl + group * GROUP_SIZE))) {
+            return NULL;
+        }
+        /* The table is never full, so this terminates. */
+        group = (group + step) & group_mask;
     }
-
-    /* free the old table */
-    wmem_free(map->data_allocator, old_table);
 }
 
-void *
-wmem_map_insert(wmem_map_t *map, const void *key, void *value)
+/* Looks for key in both tables. */
+static inline wmem_map_slot_t *
+wmem_map_find_slot(const wmem_map_t *map, const void *key,
+        wmem_map_table_t **tbl_ret)
 {
-    wmem_map_item_t **item;
-    void *old_val;
+    wmem_map_slot_t *slot;
+    uint64_t hash;
 
-    /* Make sure we have a table */
-    if (map->table == NULL) {
-        wmem_map_init_table(map);
+    if (map == NULL || map->table.ctrl == NULL) {
+        return NULL;
+    }
+
+    hash = wmem_map_hash(map, key);
+    slot = wmem_map_table_find(map, &map->table, key, hash);
+    if (slot) {
+        if (tbl_ret) {
+            *tbl_ret = (wmem_map_table_t *)&map->table;
+        }
+        return slot;
+    }
+    if (G_UNLIKELY(map->old.ctrl != NULL)) {
+        slot = wmem_map_table_find(map, &map->old, key, hash);
+        if (slot && tbl_ret) {
+            *tbl_ret = (wmem_map_table_t *)&map->old;
+        }
     }
+    return slot;
+}
 
-    /* get a pointer to the slot */
-    item = &(map->table[HASH(map, key)]);
+/* Puts a key that isn't in tbl into the first free slot of its probe
+ * sequence. */
+static inline void
+wmem_map_table_insert(wmem_map_table_t *tbl, const void *key, void *value,
+        uint64_t hash)
+{
+    size_t   group_mask = TABLE_GROUPS(tbl) - 1;
+    size_t   group = HASH_GROUP(hash, tbl);
+    size_t   step, idx;
+    group_mask_t free_slots;
+    unsigned i;
 
-    /* check existing items in that slot */
-    while (*item) {
-        if (map->eql_func(key, (*item)->key)) {
-            /* replace and return old value for this key */
-            old_val = (*item)->value;
-            (*item)->value = value;
-            return old_val;
+    for (step = 1; ; step++) {
+        free_slots = group_match_empty_or_deleted(tbl->ctrl + group * GROUP_SIZE);
+        if (free_slots) {
+            break;
         }
-        item = &((*item)->next);
+        group = (group + step) & group_mask;
     }
 
-    /* insert new item */
-    (*item) = wmem_new(map->data_allocator, wmem_map_item_t);
+    GROUP_MASK_NEXT(free_slots, i);
+    idx = group * GROUP_SIZE + i;
+    if (tbl->ctrl[idx] == CTRL_EMPTY) {
+        tbl->growth_left--;
+    }
+    tbl->ctrl[idx] = HASH_H2(hash);
+    tbl->slots[idx].key = key;
+    tbl->slots[idx].value = value;
+    tbl->count++;
+}
 
-    (*item)->key   = key;
-    (*item)->value = value;
-    (*item)->next  = NULL;
+static void
+wmem_map_table_erase(wmem_map_table_t *tbl, size_t idx)
+{
+    size_t group = idx / GROUP_SIZE;
+
+    /* If this group has an EMPTY slot, no probe sequence ever continued
+     * past it, so the slot can be made EMPTY again instead of leaving a
+     * tombstone. */
+    if (group_match_empty(tbl->ctrl + group * GROUP_SIZE)) {
+        tbl->ctrl[idx] = CTRL_EMPTY;
+        tbl->growth_left++;
+    } else {
+        tbl->ctrl[idx] = CTRL_DELETED;
+    }
+    tbl->count--;
+}
 
-    map->count++;
+/* Moves the next group of entries from the old table to the new one. */
+static void
+wmem_map_migrate_step(wmem_map_t *map)
+{
+    wmem_map_table_t *old = &map->old;
+    size_t base = map->migrate_pos * GROUP_SIZE;
+    unsigned i;
 
-    /* increase size if we are over-full */
-    if (map->count >= CAPACITY(map)) {
-        wmem_map_grow(map);
+    for (i = 0; i < GROUP_SIZE; i++) {
+        if (CTRL_IS_FULL(old->ctrl[base + i])) {
+            wmem_map_slot_t *slot = &old->slots[base + i];
+            wmem_map_table_insert(&map->table, slot->key, slot->value,
+                    wmem_map_hash(map, slot->key));
+            /* Leave a tombstone, so lookups still probe past it. */
+            old->ctrl[base + i] = CTRL_DELETED;
+            old->count--;
+        }
     }
 
-    /* no previous entry, return NULL */
-    return NULL;
+    if (++map->migrate_pos == TABLE_GROUPS(old)) {
+        wmem_free(map->data_allocator, old->ctrl);
+        memset(old, 0, sizeof(*old));
+        map->migrate_pos = 0;
+    }
 }
 
-bool
-wmem_map_contains(wmem_map_t *map, const void *key)
+/* Called when the table is full: start moving the entries to a new one. */
+static void
+wmem_map_start_resize(wmem_map_t *map)
 {
-    wmem_map_item_t *item;
+    unsigned groups_log2 = map->table.groups_log2;
 
-    /* Make sure we have map and a table */
-    if (map == NULL || map->table == NULL) {
-        return false;
+    /* Shouldn't happen, as entries are moved faster than the new table
+     * fills up, but make sure. */
+    while (map->old.ctrl != NULL) {
+        wmem_map_migrate_step(map);
     }
 
-    /* find correct slot */
-    item = map->table[HASH(map, key)];
-
-    /* scan list of items in this slot for the correct value */
-    while (item) {
-        if (map->eql_func(key, item->key)) {
-            return true;
-        }
-        item = item->next;
+    /* Double the size, unless most of the used slots are only tombstones.
+     * Either way the entries are moved well before the new table fills:
+     * there are TABLE_GROUPS steps to do, and at least 7/16 of the new
+     * table's capacity is left for new entries. */
+    if (map->table.count >= MAX_LOAD(TABLE_CAPACITY(&map->table)) / 2) {
+        groups_log2++;
     }
 
-    return false;
+    map->old = map->table;
+    map->migrate_pos = 0;
+    wmem_map_alloc_table(map, &map->table, groups_log2);
 }
 
 void *
-wmem_map_lookup(wmem_map_t *map, const void *key)
+wmem_map_insert(wmem_map_t *map, const void *key, void *value)
 {
-    wmem_map_item_t *item;
+    wmem_map_slot_t *slot;
+    void *old_val;
 
-    /* Make sure we have map and a table */
-    if (map == NULL || map->table == NULL) {
-        return NULL;
+    /* Make sure we have a table */
+    if (map->table.ctrl == NULL) {
+        wmem_map_alloc_table(map, &map->table, WMEM_MAP_DEFAULT_GROUPS_LOG2);
     }
 
-    /* find correct slot */
-    item = map->table[HASH(map, key)];
+    slot = wmem_map_find_slot(map, key, NULL);
+    if (slot) {
+        /* replace and return old value for this key */
+        old_val = slot->value;
+        slot->value = value;
+        return old_val;
+    }
 
-    /* scan list of items in this slot for the correct value */
-    while (item) {
-        if (map->eql_func(key, item->key)) {
-            return item->value;
-        }
-        item = item->next;
+    /* make room if we are full */
+    if (map->table.growth_left == 0) {
+        wmem_map_start_resize(map);
+    }
+
+    /* insert new item */
+    wmem_map_table_insert(&map->table, key, value, wmem_map_hash(map, key));
+    map->count++;
+
+    if (map->old.ctrl != NULL) {
+        wmem_map_migrate_step(map);
     }
 
+    /* no previous entry, return NULL */
     return NULL;
 }
 
+bool
+wmem_map_contains(wmem_map_t *map, const void *key)
+{
+    return wmem_map_find_slot(map, key, NULL) != NULL;
+}
+
+void *
+wmem_map_lookup(wmem_map_t *map, const void *key)
+{
+    wmem_map_slot_t *slot = wmem_map_find_slot(map, key, NULL);
+
+    return slot ? slot->value : NULL;
+}
+
 bool
 wmem_map_lookup_extended(wmem_map_t *map, const void *key, const void **orig_key, void **value)
 {
-    wmem_map_item_t *item;
+    wmem_map_slot_t *slot = wmem_map_find_slot(map, key, NULL);
 
-    /* Make sure we have map and a table */
-    if (map == NULL || map->table == NULL) {
+    if (slot == NULL) {
         return false;
     }
-
-    /* find correct slot */
-    item = map->table[HASH(map, key)];
-
-    /* scan list of items in this slot for the correct value */
-    while (item) {
-        if (map->eql_func(key, item->key)) {
-            if (orig_key) {
-                *orig_key = item->key;
-            }
-            if (value) {
-                *value = item->value;
-            }
-            return true;
-        }
-        item = item->next;
+    if (orig_key) {
+        *orig_key = slot->key;
     }
-
-    return false;
+    if (value) {
+        *value = slot->value;
+    }
+    return true;
 }
 
 void *
 wmem_map_remove(wmem_map_t *map, const void *key)
 {
-    wmem_map_item_t **item, *tmp;
-    void *value;
+    wmem_map_table_t *tbl;
+    wmem_map_slot_t  *slot;
 
-    /* Make sure we have map and a table */
-    if (map == NULL || map->table == NULL) {
+    slot = wmem_map_find_slot(map, key, &tbl);
+    if (slot == NULL) {
         return NULL;
     }
 
-    /* get a pointer to the slot */
-    item = &(map->table[HASH(map, key)]);
-
-    /* check the items in that slot */
-    while (*item) {
-        if (map->eql_func(key, (*item)->key)) {
-            /* found it */
-            tmp     = (*item);
-            value   = tmp->value;
-            (*item) = tmp->next;
-            wmem_free(map->data_allocator, tmp);
-            map->count--;
-            return value;
-        }
-        item = &((*item)->next);
-    }
-
-    /* didn't find it */
-    return NULL;
+    wmem_map_table_erase(tbl, (size_t)(slot - tbl->slots));
+    map->count--;
+    return slot->value;
 }
 
 bool
 wmem_map_steal(wmem_map_t *map, const void *key)
 {
-    wmem_map_item_t **item, *tmp;
+    wmem_map_table_t *tbl;
+    wmem_map_slot_t  *slot;
 
-    /* Make sure we have map and a table */
-    if (map == NULL || map->table == NULL) {
+    slot = wmem_map_find_slot(map, key, &tbl);
+    if (slot == NULL) {
         return false;
     }
 
-    /* get a pointer to the slot */
-    item = &(map->table[HASH(map, key)]);
-
-    /* check the items in that slot */
-    while (*item) {
-        if (map->eql_func(key, (*item)->key)) {
-            /* found it */
-            tmp     = (*item);
-            (*item) = tmp->next;
-            map->count--;
-            return true;
+    wmem_map_table_erase(tbl, (size_t)(slot - tbl->slots));
+    map->count--;
+    return true;
+}
+
+/* Iterates over the full slots of both tables. The callback returns true
+ * to stop. */
+typedef bool (*wmem_map_slot_func)(wmem_map_t *map, wmem_map_table_t *tbl, size_t idx, void *data);
+
+static void
+wmem_map_foreach_slot(wmem_map_t *map, wmem_map_slot_func func, void *data)
+{
+    wmem_map_table_t *tables[2];
+    size_t capacity, i;
+    unsigned t;
+
+    if (map == NULL || map->table.ctrl == NULL) {
+        return;
+    }
+
+    tables[0] = &map->old;
+    tables[1] = &map->table;
+    for (t = 0; t < 2; t++) {
+        if (tables[t]->ctrl == NULL) {
+            continue;
+        }
+        capacity = TABLE_CAPACITY(tables[t]);
+        for (i = 0; i < capacity; i++) {
+            if (CTRL_IS_FULL(tables[t]->ctrl[i]) && func(map, tables[t], i, data)) {
+                return;
+            }
         }
-        item = &((*item)->next);
     }
+}
 
-    /* didn't find it */
+static bool
+get_keys_cb(wmem_map_t *map _U_, wmem_map_table_t *tbl, size_t idx, void *data)
+{
+    wmem_list_prepend((wmem_list_t *)data, (void *)tbl->slots[idx].key);
     return false;
 }
 
 wmem_list_t*
 wmem_map_get_keys(wmem_allocator_t *list_allocator, wmem_map_t *map)
 {
-    size_t capacity, i;
-    wmem_map_item_t *cur;
     wmem_list_t* list = wmem_list_new(list_allocator);
 
-    if (map->table != NULL) {
-        capacity = CAPACITY(map);
-
-        /* copy all the elements into the list over from table */
-        for (i=0; i<capacity; i++) {
-            cur = map->table[i];
-            while (cur) {
-                wmem_list_prepend(list, (void*)cur->key);
-                cur = cur->next;
-            }
-        }
-    }
+    /* copy all the keys into the list */
+    wmem_map_foreach_slot(map, get_keys_cb, list);
 
     return list;
 }
 
+typedef struct {
+    union {
+        GHFunc  foreach_func;
+        GHRFunc find_func;
+    } func;
+    void *user_data;
+    void *result;
+    unsigned deleted;
+} wmem_map_foreach_data_t;
+
+static bool
+foreach_cb(wmem_map_t *map _U_, wmem_map_table_t *tbl, size_t idx, void *data)
+{
+    wmem_map_foreach_data_t *fd = (wmem_map_foreach_data_t *)data;
+
+    fd->func.foreach_func((void *)tbl->slots[idx].key, tbl->slots[idx].value, fd->user_data);
+    return false;
+}
+
 void
 wmem_map_foreach(wmem_map_t *map, GHFunc foreach_func, void * user_data)
 {
-    wmem_map_item_t *cur;
-    unsigned i;
+    wmem_map_foreach_data_t fd;
 
-    /* Make sure we have a table */
-    if (map == NULL || map->table == NULL) {
-        return;
-    }
+    fd.func.foreach_func = foreach_func;
+    fd.user_data = user_data;
+    wmem_map_foreach_slot(map, foreach_cb, &fd);
+}
 
-    for (i = 0; i < CAPACITY(map); i++) {
-        cur = map->table[i];
-        while (cur) {
-            foreach_func((void *)cur->key, (void *)cur->value, user_data);
-            cur = cur->next;
-        }
+static bool
+find_cb(wmem_map_t *map _U_, wmem_map_table_t *tbl, size_t idx, void *data)
+{
+    wmem_map_foreach_data_t *fd = (wmem_map_foreach_data_t *)data;
+
+    if (fd->func.find_func((void *)tbl->slots[idx].key, tbl->slots[idx].value, fd->user_data)) {
+        fd->result = tbl->slots[idx].value;
+        return true;
     }
+    return false;
 }
 
 void*
 wmem_map_find(wmem_map_t *map, GHRFunc foreach_func, void * user_data)
 {
-    wmem_map_item_t **item;
-    unsigned i;
+    wmem_map_foreach_data_t fd;
 
-    /* Make sure we have a table */
-    if (map == NULL || map->table == NULL) {
-        return 0;
-    }
+    fd.func.find_func = foreach_func;
+    fd.user_data = user_data;
+    fd.result = NULL;
+    wmem_map_foreach_slot(map, find_cb, &fd);
+    return fd.result;
+}
 
-    for (i = 0; i < CAPACITY(map); i++) {
-        item = &(map->table[i]);
-        while (*item) {
-            if (foreach_func((void *)(*item)->key, (void *)(*item)->value, user_data)) {
-                return (*item)->value;
-            } else {
-                item = &((*item)->next);
-            }
-        }
+static bool
+foreach_remove_cb(wmem_map_t *map, wmem_map_table_t *tbl, size_t idx, void *data)
+{
+    wmem_map_foreach_data_t *fd = (wmem_map_foreach_data_t *)data;
+
+    if (fd->func.find_func((void *)tbl->slots[idx].key, tbl->slots[idx].value, fd->user_data)) {
+        wmem_map_table_erase(tbl, idx);
+        map->count--;
+        fd->deleted++;
     }
-    return NULL;
+    return false;
 }
 
 unsigned
 wmem_map_foreach_remove(wmem_map_t *map, GHRFunc foreach_func, void * user_data)
 {
-    wmem_map_item_t **item, *tmp;
-    unsigned i, deleted = 0;
+    wmem_map_foreach_data_t fd;
 
-    /* Make sure we have a table */
-    if (map == NULL || map->table == NULL) {
-        return 0;
-    }
-
-    for (i = 0; i < CAPACITY(map); i++) {
-        item = &(map->table[i]);
-        while (*item) {
-            if (foreach_func((void *)(*item)->key, (void *)(*item)->value, user_data)) {
-                tmp   = *item;
-                *item = tmp->next;
-                wmem_free(map->data_allocator, tmp);
-                map->count--;
-                deleted++;
-            } else {
-                item = &((*item)->next);
-            }
-        }
-    }
-    return deleted;
+    fd.func.find_func = foreach_func;
+    fd.user_data = user_data;
+    fd.deleted = 0;
+    wmem_map_foreach_slot(map, foreach_remove_cb, &fd);
+    return fd.deleted;
 }
 
 unsigned
@@ -26,10 +26,10 @@ extern "C" {
  *    @defgroup wmem-map Hash Map
  *
  *    A hash map implementation on top of wmem. Provides insertion, deletion and
- *    lookup in expected amortized constant time. Uses universal hashing to map
- *    keys into buckets, and provides a generic strong hash function that makes
- *    it secure against algorithmic complexity attacks, and suitable for use
- *    even with untrusted data.
+ *    lookup in expected constant time. Uses universal hashing to map keys into
+ *    an open-addressing table, and provides a generic strong hash function that
+ *    makes it secure against algorithmic complexity attacks, and suitable for
+ *    use even with untrusted data.
  *
  *    @{
  */
@@ -43,6 +43,8 @@ wmem_allocator_force_new(const wmem_allocator_type_t type)
     allocator->type = type;
     allocator->callbacks = NULL;
     allocator->in_scope = true;
+    allocator->bytes_requested = 0;
+    allocator->accounting_scope = -1;
 
     switch (type) {
         case WMEM_ALLOCATOR_SIMPLE:
@@ -194,6 +196,111 @@ wmem_test_allocator_callbacks(void)
     g_assert_true(cb_called_count == 3);
 }
 
+static void
+wmem_test_allocator_accounting(void)
+{
+    wmem_allocator_t *allocator, *other;
+    wmem_owner_t     *owner, *prev;
+    void             *ptr;
+    int               i;
+
+    allocator = wmem_allocator_force_new(WMEM_ALLOCATOR_STRICT);
+    other = wmem_allocator_force_new(WMEM_ALLOCATOR_STRICT);
+    wmem_allocator_set_accounting_scope(allocator, 1);
+
+    owner = wmem_owner_new("test");
+    g_assert_true(wmem_owner_get(wmem_owner_count() - 1) == owner);
+    g_assert_null(wmem_owner_get(wmem_owner_count()));
+
+    /* Nothing is counted while accounting is off. */
+    prev = wmem_owner_set_current(owner);
+    wmem_alloc(allocator, 10);
+    wmem_owner_add(owner, 0, 100);
+    g_assert_true(owner->bytes[1] == 0 && owner->bytes[0] == 0);
+
+    wmem_accounting_set_sample_rate(1);
+    g_assert_true(wmem_accounting_get_sample_rate() == 1);
+    ptr = wmem_alloc(allocator, 10);
+    ptr = wmem_realloc(allocator, ptr, 20);
+    wmem_realloc(allocator, ptr, 5);
+    wmem_alloc(other, 1000);
+    wmem_owner_add(owner, 0, 100);
+    g_assert_true(owner->bytes[1] == 20);
+    g_assert_true(owner->objects[1] == 1);
+    g_assert_true(owner->bytes[0] == 100);
+    g_assert_true(owner->objects[0] == 1);
+
+    /* Memory counted by hand is uncounted when it's freed. */
+    wmem_owner_add(owner, 0, 50);
+    wmem_owner_sub(owner, 0, 100);
+    g_assert_true(owner->bytes[0] == 50);
+    g_assert_true(owner->objects[0] == 1);
+    wmem_owner_sub(owner, 0, 50);
+    wmem_owner_sub(owner, 0, 50);
+    g_assert_true(owner->bytes[0] == 0);
+    g_assert_true(owner->objects[0] == 0);
+    wmem_owner_add(owner, 0, 100);
+
+    /* Allocations without an owner go to the first one. */
+    wmem_owner_set_current(NULL);
+    wmem_alloc(allocator, 7);
+    g_assert_true(wmem_owner_get(0)->bytes[1] == 7);
+    wmem_owner_set_current(owner);
+
+    wmem_accounting_reset(1);
+    g_assert_true(owner->bytes[1] == 0 && owner->objects[1] == 0);
+    g_assert_true(owner->bytes[0] == 100);
+
+    /* With sampling, one allocation in N is counted N times. */
+    wmem_accounting_set_sample_rate(4);
+    for (i = 0; i < 16; i++) {
+        wmem_alloc(allocator, 8);
+    }
+    g_assert_true(owner->bytes[1] == 128);
+    g_assert_true(owner->objects[1] == 16);
+
+    wmem_accounting_set_sample_rate(0);
+    wmem_accounting_reset(-1);
+    g_assert_true(owner->bytes[0] == 0);
+    g_assert_true(wmem_owner_set_current(prev) == owner);
+
+    wmem_destroy_allocator(allocator);
+    wmem_destroy_allocator(other);
+}
+
+static void
+wmem_test_allocator_realloc_requested(void)
+{
+    const wmem_allocator_type_t types[] = {
+        WMEM_ALLOCATOR_SIMPLE,
+        WMEM_ALLOCATOR_BLOCK,
+        WMEM_ALLOCATOR_BLOCK_FAST,
+        WMEM_ALLOCATOR_STRICT,
+    };
+    /* Growing up to and between jumbo sizes of the block allocators */
+    const size_t sizes[] = { 10, 100, 3000, 10*1024*1024, 12*1024*1024 };
+    const size_t max_size = 12*1024*1024;
+
+    for (size_t t = 0; t < G_N_ELEMENTS(types); t++) {
+        wmem_allocator_t *allocator = wmem_allocator_force_new(types[t]);
+        void *ptr = NULL;
+
+        for (size_t i = 0; i < G_N_ELEMENTS(sizes); i++) {
+            ptr = wmem_realloc(allocator, ptr, sizes[i]);
+        }
+        /* Only growth is counted; the block allocator rounds sizes up,
+         * so it may count a little less. */
+        g_assert_cmpuint(wmem_bytes_requested(allocator), <=, max_size);
+        g_assert_cmpuint(wmem_bytes_requested(allocator), >, max_size - 64);
+        if (types[t] != WMEM_ALLOCATOR_BLOCK) {
+            g_assert_cmpuint(wmem_bytes_requested(allocator), ==, max_size);
+        }
+
+        wmem_free(allocator, ptr);
+        wmem_destroy_allocator(allocator);
+    }
+}
+
 static void
 wmem_test_allocator_det(wmem_allocator_t *allocator, wmem_verify_func verify,
         unsigned len)
@@ -271,6 +378,13 @@ wmem_test_allocator(wmem_allocator_type_t type, wmem_verify_func verify,
 
     if (verify) (*verify)(allocator);
 
+    g_assert_true(wmem_bytes_requested(allocator) == 0);
+    ptrs[0] = (char *)wmem_alloc(allocator, 10);
+    ptrs[0] = (char *)wmem_realloc(allocator, ptrs[0], 20);
+    wmem_free(allocator, ptrs[0]);
+    wmem_free_all(allocator);
+    g_assert_true(wmem_bytes_requested(allocator) == 30);
+
     /* start with some fairly simple deterministic tests */
 
     wmem_test_allocator_det(allocator, verify, 8);
@@ -914,6 +1028,7 @@ wmem_test_map(void)
     unsigned int     *key_ret;
     unsigned int     *value_ret;
     void             *ret;
+    GHashTable       *ref;
 
     allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
     extra_allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
@@ -1015,10 +1130,151 @@ wmem_test_map(void)
     }
     g_assert_true(wmem_map_size(map) == CONTAINER_ITERS/2);
 
+    /* random insertions and removals, checked against a GHashTable, so
+     * that entries are removed and re-inserted while the map is moving
+     * them to a bigger table */
+    map = wmem_map_new(allocator, g_direct_hash, g_direct_equal);
+    ref = g_hash_table_new(g_direct_hash, g_direct_equal);
+    for (i=0; i<CONTAINER_ITERS*10; i++) {
+        unsigned key = g_test_rand_int_range(1, CONTAINER_ITERS);
+        if (g_test_rand_bit() || g_test_rand_bit()) {
+            ret = wmem_map_insert(map, GUINT_TO_POINTER(key), GUINT_TO_POINTER(i+1));
+            g_assert_true((ret != NULL) == g_hash_table_contains(ref, GUINT_TO_POINTER(key)));
+            g_assert_true(ret == g_hash_table_lookup(ref, GUINT_TO_POINTER(key)));
+            g_hash_table_insert(ref, GUINT_TO_POINTER(key), GUINT_TO_POINTER(i+1));
+        } else {
+            ret = wmem_map_remove(map, GUINT_TO_POINTER(key));
+            g_assert_true(ret == g_hash_table_lookup(ref, GUINT_TO_POINTER(key)));
+            g_hash_table_remove(ref, GUINT_TO_POINTER(key));
+        }
+        g_assert_true(wmem_map_size(map) == g_hash_table_size(ref));
+    }
+    for (i=1; i<CONTAINER_ITERS; i++) {
+        g_assert_true(wmem_map_lookup(map, GUINT_TO_POINTER(i)) == g_hash_table_lookup(ref, GUINT_TO_POINTER(i)));
+    }
+    g_hash_table_destroy(ref);
+
     wmem_destroy_allocator(extra_allocator);
     wmem_destroy_allocator(allocator);
 }
 
+/* NOTE: You have to run "wmem_test -m perf" to run the performance tests. */
+static void
+wmem_test_mapperf(void)
+{
+#define MAP_PERF_KEYS (1 * 1000 * 1000)
+    wmem_allocator_t   *allocator;
+    wmem_map_t         *map;
+    GHashTable         *hash_table;
+    char              **str_keys;
+    char                str_miss[32];
+    unsigned            i;
+    void               *ret = NULL;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+
+    /* Integer keys, as used for frame numbers */
+
+    map = wmem_map_new(allocator, g_direct_hash, g_direct_equal);
+    RESOURCE_USAGE_START;
+    for (i = 1; i <= MAP_PERF_KEYS; i++) {
+        wmem_map_insert(map, GUINT_TO_POINTER(i), GUINT_TO_POINTER(i));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_map_insert() integer keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 1; i <= MAP_PERF_KEYS; i++) {
+        ret = wmem_map_lookup(map, GUINT_TO_POINTER(i));
+    }
+    RESOURCE_USAGE_END;
+    g_assert_true(ret == GUINT_TO_POINTER(MAP_PERF_KEYS));
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_map_lookup() integer keys, hit: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = MAP_PERF_KEYS + 1; i <= 2 * MAP_PERF_KEYS; i++) {
+        ret = wmem_map_lookup(map, GUINT_TO_POINTER(i));
+    }
+    RESOURCE_USAGE_END;
+    g_assert_true(ret == NULL);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_map_lookup() integer keys, miss: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 1; i <= MAP_PERF_KEYS; i++) {
+        wmem_map_remove(map, GUINT_TO_POINTER(i));
+    }
+    RESOURCE_USAGE_END;
+    g_assert_true(wmem_map_size(map) == 0);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_map_remove() integer keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    wmem_free_all(allocator);
+
+    /* The same with GHashTable, for comparison */
+
+    hash_table = g_hash_table_new(g_direct_hash, g_direct_equal);
+    RESOURCE_USAGE_START;
+    for (i = 1; i <= MAP_PERF_KEYS; i++) {
+        g_hash_table_insert(hash_table, GUINT_TO_POINTER(i), GUINT_TO_POINTER(i));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "g_hash_table_insert() integer keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 1; i <= MAP_PERF_KEYS; i++) {
+        ret = g_hash_table_lookup(hash_table, GUINT_TO_POINTER(i));
+    }
+    RESOURCE_USAGE_END;
+    g_assert_true(ret == GUINT_TO_POINTER(MAP_PERF_KEYS));
+    g_test_minimized_result(utime_ms + stime_ms,
+        "g_hash_table_lookup() integer keys, hit: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+    g_hash_table_destroy(hash_table);
+
+    /* String keys, as used for names and addresses */
+
+    str_keys = g_new(char *, MAP_PERF_KEYS);
+    for (i = 0; i < MAP_PERF_KEYS; i++) {
+        str_keys[i] = wmem_strdup_printf(allocator, "key-%u", i);
+    }
+
+    map = wmem_map_new(allocator, wmem_str_hash, g_str_equal);
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MAP_PERF_KEYS; i++) {
+        wmem_map_insert(map, str_keys[i], GUINT_TO_POINTER(i + 1));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_map_insert() string keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MAP_PERF_KEYS; i++) {
+        ret = wmem_map_lookup(map, str_keys[i]);
+    }
+    RESOURCE_USAGE_END;
+    g_assert_true(ret == GUINT_TO_POINTER(MAP_PERF_KEYS));
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_map_lookup() string keys, hit: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < MAP_PERF_KEYS; i++) {
+        snprintf(str_miss, sizeof(str_miss), "miss-%u", i);
+        ret = wmem_map_lookup(map, str_miss);
+    }
+    RESOURCE_USAGE_END;
+    g_assert_true(ret == NULL);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_map_lookup() string keys, miss: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    g_free(str_keys);
+    wmem_destroy_allocator(allocator);
+#undef MAP_PERF_KEYS
+}
+
 static void
 wmem_test_queue(void)
 {
@@ -1180,6 +1436,16 @@ wmem_test_strbuf_validate(void)
     wmem_strbuf_destroy(strbuf);
 }
 
+static bool
+wmem_test_tree_order_cb(const void *key, void *value _U_, void *user_data)
+{
+    int64_t *last_key = (int64_t *)user_data;
+
+    g_assert_true((int64_t)GPOINTER_TO_UINT(key) > *last_key);
+    *last_key = GPOINTER_TO_UINT(key);
+    return false;
+}
+
 static void
 wmem_test_tree(void)
 {
@@ -1195,6 +1461,12 @@ wmem_test_tree(void)
 #define WMEM_TREE_MAX_KEY_LEN   4
     int                 key_count;
     wmem_tree_key_t     keys[WMEM_TREE_MAX_KEY_COUNT];
+#define WMEM_TREE_RAND_KEYS     1024
+    bool                present[WMEM_TREE_RAND_KEYS];
+    unsigned            present_count;
+    uint32_t            ref_key;
+    int64_t             last_key;
+    void               *ret;
 
     allocator       = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
     extra_allocator = wmem_allocator_new(WMEM_ALLOCATOR_STRICT);
@@ -1239,6 +1511,80 @@ wmem_test_tree(void)
     g_assert_true(wmem_tree_count(tree) == CONTAINER_ITERS);
     wmem_free_all(allocator);
 
+    /* test random operations on a small key space against a reference */
+    tree = wmem_tree_new(allocator);
+    memset(present, 0, sizeof(present));
+    present_count = 0;
+    for (i=0; i<10*CONTAINER_ITERS; i++) {
+        rand_int = g_test_rand_int_range(0, WMEM_TREE_RAND_KEYS);
+        switch (g_test_rand_int_range(0, 4)) {
+            case 0:
+            case 1:
+                if (!present[rand_int]) {
+                    present[rand_int] = true;
+                    present_count++;
+                }
+                wmem_tree_insert32(tree, rand_int, GUINT_TO_POINTER(rand_int + 1));
+                break;
+            case 2:
+                ret = wmem_tree_remove32(tree, rand_int);
+                g_assert_true(ret == (present[rand_int] ? GUINT_TO_POINTER(rand_int + 1) : NULL));
+                if (present[rand_int]) {
+                    present[rand_int] = false;
+                    present_count--;
+                }
+                break;
+            default:
+                g_assert_true(wmem_tree_contains32(tree, rand_int) == present[rand_int]);
+                break;
+        }
+
+        rand_int = g_test_rand_int_range(0, WMEM_TREE_RAND_KEYS);
+        for (ref_key = rand_int; ref_key != UINT32_MAX && !present[ref_key]; ref_key--)
+            ;
+        ret = wmem_tree_lookup32_le_full(tree, rand_int, &int_key);
+        if (ref_key == UINT32_MAX) {
+            g_assert_true(ret == NULL);
+        } else {
+            g_assert_true(ret == GUINT_TO_POINTER(ref_key + 1));
+            g_assert_true(int_key == ref_key);
+        }
+        for (ref_key = rand_int; ref_key < WMEM_TREE_RAND_KEYS && !present[ref_key]; ref_key++)
+            ;
+        ret = wmem_tree_lookup32_ge_full(tree, rand_int, &int_key);
+        if (ref_key == WMEM_TREE_RAND_KEYS) {
+            g_assert_true(ret == NULL);
+        } else {
+            g_assert_true(ret == GUINT_TO_POINTER(ref_key + 1));
+            g_assert_true(int_key == ref_key);
+        }
+        g_assert_true(wmem_tree_is_empty(tree) == (present_count == 0));
+    }
+    g_assert_true(wmem_tree_count(tree) == present_count);
+    last_key = -1;
+    wmem_tree_foreach(tree, wmem_test_tree_order_cb, &last_key);
+    for (i=0; i<WMEM_TREE_RAND_KEYS; i++) {
+        if (present[i]) {
+            wmem_tree_remove32(tree, i);
+        }
+    }
+    g_assert_true(wmem_tree_is_empty(tree));
+    g_assert_true(wmem_tree_lookup32_le(tree, WMEM_TREE_RAND_KEYS) == NULL);
+    wmem_free_all(allocator);
+
+    /* test decreasing keys and destroying a tree that owns its values */
+    tree = wmem_tree_new(NULL);
+    for (i=CONTAINER_ITERS; i>0; i--) {
+        wmem_tree_insert32(tree, i, g_strdup_printf("%u", i));
+        g_assert_true(wmem_tree_lookup32_le(tree, i + 1) == wmem_tree_lookup32(tree, i));
+    }
+    g_assert_true(wmem_tree_lookup32_ge(tree, 0) == wmem_tree_lookup32(tree, 1));
+    g_assert_true(wmem_tree_lookup32_le(tree, 0) == NULL);
+    last_key = -1;
+    wmem_tree_foreach(tree, wmem_test_tree_order_cb, &last_key);
+    g_assert_true(last_key == CONTAINER_ITERS);
+    wmem_tree_destroy(tree, false, true);
+
     /* test auto-reset functionality */
     tree = wmem_tree_new_autoreset(allocator, extra_allocator);
     for (i=0; i<CONTAINER_ITERS; i++) {
@@ -1353,6 +1699,79 @@ wmem_test_tree(void)
     wmem_destroy_allocator(allocator);
 }
 
+/* NOTE: You have to run "wmem_test -m perf" to run the performance tests. */
+static void
+wmem_test_treeperf(void)
+{
+#define TREE_PERF_KEYS (1 * 1000 * 1000)
+    wmem_allocator_t   *allocator;
+    wmem_tree_t        *tree;
+    uint32_t           *rand_keys;
+    unsigned            i;
+    void               *ret = NULL;
+    double              start_utime, start_stime, end_utime, end_stime, utime_ms, stime_ms;
+
+    allocator = wmem_allocator_new(WMEM_ALLOCATOR_BLOCK);
+
+    /* Increasing keys with gaps, like TCP sequence numbers */
+
+    tree = wmem_tree_new(allocator);
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        wmem_tree_insert32(tree, i * 1460, GUINT_TO_POINTER(i + 1));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_insert32() increasing keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        ret = wmem_tree_lookup32_le(tree, i * 1460 + 100);
+    }
+    RESOURCE_USAGE_END;
+    g_assert_true(ret == GUINT_TO_POINTER(TREE_PERF_KEYS));
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_lookup32_le() increasing keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    rand_keys = g_new(uint32_t, TREE_PERF_KEYS);
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        rand_keys[i] = g_test_rand_int_range(0, TREE_PERF_KEYS) * 1460 + 100;
+    }
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        ret = wmem_tree_lookup32_le(tree, rand_keys[i]);
+    }
+    RESOURCE_USAGE_END;
+    g_assert_true(ret == GUINT_TO_POINTER((rand_keys[TREE_PERF_KEYS - 1] - 100) / 1460 + 1));
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_lookup32_le() random keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    wmem_free_all(allocator);
+
+    /* Random keys */
+
+    tree = wmem_tree_new(allocator);
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        wmem_tree_insert32(tree, rand_keys[i], GUINT_TO_POINTER(i + 1));
+    }
+    RESOURCE_USAGE_END;
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_insert32() random keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    RESOURCE_USAGE_START;
+    for (i = 0; i < TREE_PERF_KEYS; i++) {
+        ret = wmem_tree_lookup32(tree, rand_keys[i]);
+    }
+    RESOURCE_USAGE_END;
+    g_assert_true(ret != NULL);
+    g_test_minimized_result(utime_ms + stime_ms,
+        "wmem_tree_lookup32() random keys: u %.3f ms s %.3f ms", utime_ms, stime_ms);
+
+    g_free(rand_keys);
+    wmem_destroy_allocator(allocator);
+#undef TREE_PERF_KEYS
+}
 
 /* to be used as userdata in the callback wmem_test_itree_check_overlap_cb*/
 typedef struct wmem_test_itree_user_data {
@@ -1470,6 +1889,8 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/allocator/simple",    wmem_test_allocator_simple);
     g_test_add_func("/wmem/allocator/strict",    wmem_test_allocator_strict);
     g_test_add_func("/wmem/allocator/callbacks", wmem_test_allocator_callbacks);
+    g_test_add_func("/wmem/allocator/accounting", wmem_test_allocator_accounting);
+    g_test_add_func("/wmem/allocator/realloc_requested", wmem_test_allocator_realloc_requested);
 
     g_test_add_func("/wmem/utils/misc",    wmem_test_miscutls);
     g_test_add_func("/wmem/utils/strings", wmem_test_strutls);
@@ -1481,11 +1902,17 @@ main(int argc, char **argv)
     g_test_add_func("/wmem/datastruct/array",  wmem_test_array);
     g_test_add_func("/wmem/datastruct/list",   wmem_test_list);
     g_test_add_func("/wmem/datastruct/map",    wmem_test_map);
+    if (g_test_perf()) {
+        g_test_add_func("/wmem/datastruct/mapperf", wmem_test_mapperf);
+    }
     g_test_add_func("/wmem/datastruct/queue",  wmem_test_queue);
     g_test_add_func("/wmem/datastruct/stack",  wmem_test_stack);
     g_test_add_func("/wmem/datastruct/strbuf", wmem_test_strbuf);
     g_test_add_func("/wmem/datastruct/strbuf/validate", wmem_test_strbuf_validate);
     g_test_add_func("/wmem/datastruct/tree",   wmem_test_tree);
+    if (g_test_perf()) {
+        g_test_add_func("/wmem/datastruct/treeperf", wmem_test_treeperf);
+    }
     g_test_add_func("/wmem/datastruct/itree",  wmem_test_itree);
 
     ret = g_test_run();
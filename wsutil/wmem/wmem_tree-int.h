@@ -45,10 +45,23 @@ typedef struct _wmem_tree_node_t wmem_tree_node_t;
 
 typedef struct _wmem_itree_node_t wmem_itree_node_t;
 
+typedef struct _wmem_bptree_leaf_t wmem_bptree_leaf_t;
+
+/* B+tree holding the entries with 32-bit keys (see wmem_bptree.c). */
+typedef struct _wmem_bptree_t {
+    void               *root;       /* A leaf if height is 0 */
+    unsigned            height;     /* Number of inner node levels */
+    unsigned            count;      /* Number of entries */
+    wmem_bptree_leaf_t *head;       /* Leftmost leaf */
+    wmem_bptree_leaf_t *tail;       /* Rightmost leaf */
+    wmem_bptree_leaf_t *finger;     /* Leaf of the last lookup */
+} wmem_bptree_t;
+
 struct _wmem_tree_t {
     wmem_allocator_t *metadata_allocator;
     wmem_allocator_t *data_allocator;
     wmem_tree_node_t *root;
+    wmem_bptree_t     bptree;
     unsigned          metadata_scope_cb_id;
     unsigned          data_scope_cb_id;
 
@@ -60,6 +73,41 @@ typedef int (*compare_func)(const void *a, const void *b);
 wmem_tree_node_t *
 wmem_tree_insert_node(wmem_tree_t *tree, const void *key, void *data, compare_func cmp);
 
+void
+wmem_print_indent(uint32_t level);
+
+void
+wmem_print_subtree(wmem_tree_t *tree, uint32_t level, wmem_printer_func key_printer,
+        wmem_printer_func data_printer);
+
+/* wmem_bptree.c */
+
+void *
+wmem_bptree_insert(wmem_tree_t *tree, uint32_t key, void*(*func)(void*),
+        void *data, bool is_subtree, bool replace);
+
+bool
+wmem_bptree_lookup(wmem_tree_t *tree, uint32_t key, void **data);
+
+bool
+wmem_bptree_lookup_le(wmem_tree_t *tree, uint32_t key, uint32_t *orig_key, void **data);
+
+bool
+wmem_bptree_lookup_ge(wmem_tree_t *tree, uint32_t key, uint32_t *orig_key, void **data);
+
+void *
+wmem_bptree_remove(wmem_tree_t *tree, uint32_t key);
+
+bool
+wmem_bptree_foreach(wmem_tree_t *tree, wmem_foreach_func callback, void *user_data);
+
+void
+wmem_bptree_destroy(wmem_tree_t *tree, bool free_keys, bool free_values);
+
+void
+wmem_bptree_print(wmem_tree_t *tree, uint32_t level, wmem_printer_func key_printer,
+        wmem_printer_func data_printer);
+
 typedef struct _wmem_range_t wmem_range_t;
 
 bool
@@ -375,6 +375,7 @@ wmem_tree_reset_cb(wmem_allocator_t *allocator _U_, wmem_cb_event_t event,
     wmem_tree_t *tree = (wmem_tree_t *)user_data;
 
     tree->root = NULL;
+    memset(&tree->bptree, 0, sizeof(tree->bptree));
 
     if (event == WMEM_CB_DESTROY_EVENT) {
         wmem_unregister_callback(tree->metadata_allocator, tree->metadata_scope_cb_id);
@@ -446,6 +447,7 @@ void
 wmem_tree_destroy(wmem_tree_t *tree, bool free_keys, bool free_values)
 {
     free_tree_node(tree->data_allocator, tree->root, free_keys, free_values);
+    wmem_bptree_destroy(tree, free_keys, free_values);
     if (tree->metadata_allocator) {
         wmem_unregister_callback(tree->metadata_allocator, tree->metadata_scope_cb_id);
     }
@@ -458,7 +460,7 @@ wmem_tree_destroy(wmem_tree_t *tree, bool free_keys, bool free_values)
 bool
 wmem_tree_is_empty(wmem_tree_t *tree)
 {
-    return tree->root == NULL;
+    return tree->root == NULL && tree->bptree.count == 0;
 }
 
 static bool
@@ -504,77 +506,11 @@ create_node(wmem_allocator_t *allocator, wmem_tree_node_t *parent, const void *k
     return node;
 }
 
-#define CREATE_DATA(TRANSFORM, DATA) ((TRANSFORM) ? (TRANSFORM)(DATA) : (DATA))
-
-
-/**
- * return inserted node
- */
-static wmem_tree_node_t *
-lookup_or_insert32_node(wmem_tree_t *tree, uint32_t key,
-        void*(*func)(void*), void* data, bool is_subtree, bool replace)
-{
-    wmem_tree_node_t *node     = tree->root;
-    wmem_tree_node_t *new_node = NULL;
-
-    /* is this the first node ?*/
-    if (!node) {
-        new_node = create_node(tree->data_allocator, NULL, GUINT_TO_POINTER(key),
-                CREATE_DATA(func, data), WMEM_NODE_COLOR_BLACK, is_subtree);
-        tree->root = new_node;
-        return new_node;
-    }
-
-    /* it was not the new root so walk the tree until we find where to
-     * insert this new leaf.
-     */
-    while (!new_node) {
-        /* this node already exists, so just return the data pointer*/
-        if (key == GPOINTER_TO_UINT(node->key)) {
-            if (replace) {
-                node->data = CREATE_DATA(func, data);
-            }
-            return node;
-        }
-        else if (key < GPOINTER_TO_UINT(node->key)) {
-            if (node->left) {
-                node = node->left;
-            }
-            else {
-                /* new node to the left */
-                new_node = create_node(tree->data_allocator, node, GUINT_TO_POINTER(key),
-                        CREATE_DATA(func, data), WMEM_NODE_COLOR_RED,
-                        is_subtree);
-                node->left = new_node;
-            }
-        }
-        else if (key > GPOINTER_TO_UINT(node->key)) {
-            if (node->right) {
-                node = node->right;
-            }
-            else {
-                /* new node to the right */
-                new_node = create_node(tree->data_allocator, node, GUINT_TO_POINTER(key),
-                        CREATE_DATA(func, data), WMEM_NODE_COLOR_RED,
-                        is_subtree);
-                node->right = new_node;
-            }
-        }
-    }
-
-    /* node will now point to the newly created node */
-    rb_insert_case1(tree, new_node);
-
-    return new_node;
-}
-
-
 static void *
 lookup_or_insert32(wmem_tree_t *tree, uint32_t key,
         void*(*func)(void*), void* data, bool is_subtree, bool replace)
 {
-    wmem_tree_node_t *node = lookup_or_insert32_node(tree, key, func, data, is_subtree, replace);
-    return node->data;
+    return wmem_bptree_insert(tree, key, func, data, is_subtree, replace);
 }
 
 static void *
@@ -668,251 +604,62 @@ bool wmem_tree_contains32(wmem_tree_t *tree, uint32_t key)
         return false;
     }
 
-    wmem_tree_node_t *node = tree->root;
-
-    while (node) {
-        if (key == GPOINTER_TO_UINT(node->key)) {
-            return true;
-        }
-        else if (key < GPOINTER_TO_UINT(node->key)) {
-            node = node->left;
-        }
-        else if (key > GPOINTER_TO_UINT(node->key)) {
-            node = node->right;
-        }
-    }
-
-    return false;
-}
-
-static wmem_tree_node_t*
-wmem_tree_lookup32_node(wmem_tree_t *tree, uint32_t key)
-{
-    if (!tree) {
-        return NULL;
-    }
-
-    wmem_tree_node_t *node = tree->root;
-
-    while (node) {
-        if (key == GPOINTER_TO_UINT(node->key)) {
-            return node;
-        }
-        else if (key < GPOINTER_TO_UINT(node->key)) {
-            node = node->left;
-        }
-        else if (key > GPOINTER_TO_UINT(node->key)) {
-            node = node->right;
-        }
-    }
-
-    return NULL;
+    return wmem_bptree_lookup(tree, key, NULL);
 }
 
 void *
 wmem_tree_lookup32(wmem_tree_t *tree, uint32_t key)
 {
-    wmem_tree_node_t *node = wmem_tree_lookup32_node(tree, key);
-    if (node == NULL) {
-        return NULL;
-    }
-    return node->data;
-}
-
-static wmem_tree_node_t*
-wmem_tree_lookup32_le_node(wmem_tree_t *tree, uint32_t key)
-{
-    if (!tree) {
-        return NULL;
-    }
-
-    wmem_tree_node_t *node = tree->root;
-
-    while (node) {
-        if (key == GPOINTER_TO_UINT(node->key)) {
-            return node;
-        }
-        else if (key < GPOINTER_TO_UINT(node->key)) {
-            if (node->left == NULL) {
-                break;
-            }
-            node = node->left;
-        }
-        else if (key > GPOINTER_TO_UINT(node->key)) {
-            if (node->right == NULL) {
-                break;
-            }
-            node = node->right;
-        }
-    }
-
-    if (!node) {
-        return NULL;
-    }
+    void *data;
 
-    /* If we are still at the root of the tree this means that this node
-     * is either smaller than the search key and then we return this
-     * node or else there is no smaller key available and then
-     * we return NULL.
-     */
-    if (node->parent == NULL) {
-        if (key > GPOINTER_TO_UINT(node->key)) {
-            return node;
-        } else {
-            return NULL;
-        }
-    }
-
-    if (GPOINTER_TO_UINT(node->key) <= key) {
-        /* if our key is <= the search key, we have the right node */
-        return node;
-    }
-    else if (node == node->parent->left) {
-        /* our key is bigger than the search key and we're a left child,
-         * we have to check if any of our ancestors are smaller. */
-        while (node) {
-            if (key > GPOINTER_TO_UINT(node->key)) {
-                return node;
-            }
-            node=node->parent;
-        }
+    if (!tree || !wmem_bptree_lookup(tree, key, &data)) {
         return NULL;
     }
-    else {
-        /* our key is bigger than the search key and we're a right child,
-         * our parent is the one we want */
-        return node->parent;
-    }
+    return data;
 }
 
 void *
 wmem_tree_lookup32_le(wmem_tree_t *tree, uint32_t key)
 {
-    wmem_tree_node_t *node = wmem_tree_lookup32_le_node(tree, key);
-    if (node == NULL) {
-        return NULL;
-    }
+    uint32_t orig_key;
 
-    return node->data;
+    return wmem_tree_lookup32_le_full(tree, key, &orig_key);
 }
 
 void *
 wmem_tree_lookup32_le_full(wmem_tree_t *tree, uint32_t key, uint32_t *orig_key)
 {
-    wmem_tree_node_t *node = wmem_tree_lookup32_le_node(tree, key);
-    if (node == NULL) {
-        return NULL;
-    }
+    void *data;
 
-    *orig_key = GPOINTER_TO_UINT(node->key);
-    return node->data;
-}
-
-static wmem_tree_node_t*
-wmem_tree_lookup32_ge_node(wmem_tree_t *tree, uint32_t key)
-{
-    if (!tree) {
+    if (!tree || !wmem_bptree_lookup_le(tree, key, orig_key, &data)) {
         return NULL;
     }
-
-    wmem_tree_node_t *node = tree->root;
-
-    while (node) {
-        if (key == GPOINTER_TO_UINT(node->key)) {
-            return node;
-        }
-        else if (key < GPOINTER_TO_UINT(node->key)) {
-            if (node->left == NULL) {
-                break;
-            }
-            node = node->left;
-        }
-        else if (key > GPOINTER_TO_UINT(node->key)) {
-            if (node->right == NULL) {
-                break;
-            }
-            node = node->right;
-        }
-    }
-
-    if (!node) {
-        return NULL;
-    }
-
-    /* If we are still at the root of the tree this means that this node
-     * is either greater than the search key and then we return this
-     * node or else there is no greater key available and then
-     * we return NULL.
-     */
-    if (node->parent == NULL) {
-        if (key < GPOINTER_TO_UINT(node->key)) {
-            return node;
-        } else {
-            return NULL;
-        }
-    }
-
-    if (GPOINTER_TO_UINT(node->key) >= key) {
-        /* if our key is >= the search key, we have the right node */
-        return node;
-    }
-    else if (node == node->parent->right) {
-        /* our key is smaller than the search key and we're a right child,
-         * we have to check if any of our ancestors are bigger. */
-        while (node) {
-            if (key < GPOINTER_TO_UINT(node->key)) {
-                return node;
-            }
-            node=node->parent;
-        }
-        return NULL;
-    }
-    else {
-        /* our key is smaller than the search key and we're a left child,
-         * our parent is the one we want */
-        return node->parent;
-    }
+    return data;
 }
 
 void *
 wmem_tree_lookup32_ge(wmem_tree_t *tree, uint32_t key)
 {
-    wmem_tree_node_t *node = wmem_tree_lookup32_ge_node(tree, key);
-    if (node == NULL) {
-        return NULL;
-    }
+    uint32_t orig_key;
 
-    return node->data;
+    return wmem_tree_lookup32_ge_full(tree, key, &orig_key);
 }
 
 void *
 wmem_tree_lookup32_ge_full(wmem_tree_t *tree, uint32_t key, uint32_t *orig_key)
 {
-    wmem_tree_node_t *node = wmem_tree_lookup32_ge_node(tree, key);
-    if (node == NULL) {
+    void *data;
+
+    if (!tree || !wmem_bptree_lookup_ge(tree, key, orig_key, &data)) {
         return NULL;
     }
-
-    *orig_key = GPOINTER_TO_UINT(node->key);
-    return node->data;
+    return data;
 }
 
 void *
 wmem_tree_remove32(wmem_tree_t *tree, uint32_t key)
 {
-    wmem_tree_node_t *node = wmem_tree_lookup32_node(tree, key);
-    if (node == NULL) {
-        return NULL;
-    }
-
-    void *ret = node->data;
-
-    /* Remove the node. Do not free the key, because it is a
-     * GPOINTER_TO_UINT. The value we return.
-     */
-    rb_remove_node(tree, node, false);
-
-    return ret;
+    return wmem_bptree_remove(tree, key);
 }
 
 void
@@ -1076,15 +823,13 @@ bool
 wmem_tree_foreach(wmem_tree_t* tree, wmem_foreach_func callback,
         void *user_data)
 {
-    if(!tree->root)
-        return false;
+    if (tree->root && wmem_tree_foreach_nodes(tree->root, callback, user_data))
+        return true;
 
-    return wmem_tree_foreach_nodes(tree->root, callback, user_data);
+    return wmem_bptree_foreach(tree, callback, user_data);
 }
 
-static void wmem_print_subtree(wmem_tree_t *tree, uint32_t level, wmem_printer_func key_printer, wmem_printer_func data_printer);
-
-static void
+void
 wmem_print_indent(uint32_t level) {
     uint32_t i;
     for (i=0; i<level; i++) {
@@ -1127,8 +872,7 @@ wmem_tree_print_nodes(const char *prefix, wmem_tree_node_t *node, uint32_t level
         wmem_print_subtree((wmem_tree_t *)node->data, level+1, key_printer, data_printer);
 }
 
-
-static void
+void
 wmem_print_subtree(wmem_tree_t *tree, uint32_t level, wmem_printer_func key_printer, wmem_printer_func data_printer)
 {
     if (!tree)
@@ -1140,6 +884,7 @@ wmem_print_subtree(wmem_tree_t *tree, uint32_t level, wmem_printer_func key_prin
     if (tree->root) {
         wmem_tree_print_nodes("Root-", tree->root, level, key_printer, data_printer);
     }
+    wmem_bptree_print(tree, level, key_printer, data_printer);
 }
 
 void
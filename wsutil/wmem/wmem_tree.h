@@ -30,6 +30,11 @@ extern "C" {
  *    time for lookups, compared to linked lists that are O(n). This means
  *    red/black trees scale very well when many objects are being stored.
  *
+ *    Entries with 32-bit keys are kept in a B+tree instead, which needs
+ *    far fewer cache misses per lookup and is fastest when the keys are
+ *    inserted in increasing order, as frame and sequence numbers usually
+ *    are.
+ *
  *    @{
  */
 
@@ -28,6 +28,10 @@
  *
  * The "CPUInfo" argument points to 4 32-bit values into which the
  * resulting values of EAX, EBX, ECX, and EDX are store, in order.
+ *
+ * ws_xgetbv0() returns the XCR0 register, which says which registers
+ * the OS saves and restores; it must only be called if cpuid says that
+ * the OS has enabled XSAVE.
  */
 
 #include "ws_attributes.h"
@@ -47,16 +51,24 @@
  * on Windows anyway, so the answer is probably "no".
  */
 #if defined(_M_IX86) || defined(_M_X64)
+#include <intrin.h>
+
 static bool
 ws_cpuid(uint32_t *CPUInfo, uint32_t selector)
 {
 	/* https://docs.microsoft.com/en-us/cpp/intrinsics/cpuid-cpuidex */
 
 	CPUInfo[0] = CPUInfo[1] = CPUInfo[2] = CPUInfo[3] = 0;
-	__cpuid((int *) CPUInfo, selector);
+	__cpuidex((int *) CPUInfo, selector, 0);
 	/* XXX, how to check if it's supported on MSVC? just in case clear all flags above */
 	return true;
 }
+
+static inline uint64_t
+ws_xgetbv0(void)
+{
+	return _xgetbv(0);
+}
 #else /* not x86 */
 static bool
 ws_cpuid(uint32_t *CPUInfo _U_, int selector _U_)
@@ -64,6 +76,12 @@ ws_cpuid(uint32_t *CPUInfo _U_, int selector _U_)
 	/* Not x86, so no cpuid instruction */
 	return false;
 }
+
+static inline uint64_t
+ws_xgetbv0(void)
+{
+	return 0;
+}
 #endif
 
 #elif defined(__GNUC__)  /* GCC/clang */
@@ -81,6 +99,15 @@ ws_cpuid(uint32_t *CPUInfo, int selector)
 							"c" (0));
 	return true;
 }
+
+static inline uint64_t
+ws_xgetbv0(void)
+{
+	uint32_t eax, edx;
+
+	__asm__ __volatile__("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+	return ((uint64_t)edx << 32) | eax;
+}
 #elif defined(__i386__)
 static bool
 ws_cpuid(uint32_t *CPUInfo _U_, int selector _U_)
@@ -110,6 +137,12 @@ ws_cpuid(uint32_t *CPUInfo _U_, int selector _U_)
 	 */
 	return false;
 }
+
+static inline uint64_t
+ws_xgetbv0(void)
+{
+	return 0;
+}
 #else /* not x86 */
 static bool
 ws_cpuid(uint32_t *CPUInfo _U_, int selector _U_)
@@ -117,6 +150,12 @@ ws_cpuid(uint32_t *CPUInfo _U_, int selector _U_)
 	/* Not x86, so no cpuid instruction */
 	return false;
 }
+
+static inline uint64_t
+ws_xgetbv0(void)
+{
+	return 0;
+}
 #endif
 
 #else /* Other compilers */
@@ -126,9 +165,15 @@ ws_cpuid(uint32_t *CPUInfo _U_, int selector _U_)
 {
 	return false;
 }
+
+static inline uint64_t
+ws_xgetbv0(void)
+{
+	return 0;
+}
 #endif
 
-static int
+static inline int
 ws_cpuid_sse42(void)
 {
 	uint32_t CPUInfo[4];
@@ -139,3 +184,29 @@ ws_cpuid_sse42(void)
 	/* in ECX bit 20 toggled on */
 	return (CPUInfo[2] & (1 << 20));
 }
+
+static inline int
+ws_cpuid_avx2(void)
+{
+	uint32_t CPUInfo[4];
+
+	if (!ws_cpuid(CPUInfo, 0) || CPUInfo[0] < 7)
+		return 0;
+
+	if (!ws_cpuid(CPUInfo, 1))
+		return 0;
+
+	/* OSXSAVE (ECX bit 27) and AVX (ECX bit 28) toggled on */
+	if ((CPUInfo[2] & (3 << 27)) != (3 << 27))
+		return 0;
+
+	/* The OS saves the XMM and YMM registers (XCR0 bits 1 and 2) */
+	if ((ws_xgetbv0() & 6) != 6)
+		return 0;
+
+	if (!ws_cpuid(CPUInfo, 7))
+		return 0;
+
+	/* in EBX bit 5 toggled on */
+	return (CPUInfo[1] & (1 << 5)) != 0;
+}
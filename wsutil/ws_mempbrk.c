@@ -27,20 +27,150 @@
 
 #include <string.h>
 
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define WS_MEMPBRK_NEON
+#include <arm_neon.h>
+#include "bits_ctz.h"
+#endif
+
+#ifdef HAVE_AVX2
+#include "ws_cpuid.h"
+#endif
+
+#if defined(HAVE_AVX2) || defined(WS_MEMPBRK_NEON)
+/*
+ * Fill in the nibble tables: each distinct high nibble among the needles
+ * gets a bit, which is set in nibble_hi for that high nibble and in
+ * nibble_lo for the low nibble of each needle with that high nibble. That
+ * only works for up to eight distinct high nibbles, which is plenty for
+ * ASCII needles; with more, return false.
+ */
+static bool
+ws_mempbrk_nibbles_compile(ws_mempbrk_pattern* pattern, const char *needles)
+{
+    unsigned buckets = 0;
+    const char *n;
+
+    memset(pattern->nibble_lo, 0, sizeof pattern->nibble_lo);
+    memset(pattern->nibble_hi, 0, sizeof pattern->nibble_hi);
+    for (n = needles; *n; n++) {
+        uint8_t c = (uint8_t)*n;
+
+        if (pattern->nibble_hi[c >> 4] == 0) {
+            if (buckets == 8)
+                return false;
+            pattern->nibble_hi[c >> 4] = (uint8_t)(1 << buckets++);
+        }
+        pattern->nibble_lo[c & 0xf] |= pattern->nibble_hi[c >> 4];
+    }
+    return true;
+}
+#endif
+
 void
 ws_mempbrk_compile(ws_mempbrk_pattern* pattern, const char *needles)
 {
     const char *n = needles;
     memset(pattern->patt, 0, 256);
     while (*n) {
-        pattern->patt[(int)*n] = 1;
+        pattern->patt[(uint8_t)*n] = 1;
         n++;
     }
 
 #ifdef HAVE_SSE4_2
     ws_mempbrk_sse42_compile(pattern, needles);
 #endif
+
+#if defined(HAVE_AVX2)
+    pattern->use_nibbles = ws_mempbrk_nibbles_compile(pattern, needles) && ws_cpuid_avx2();
+#elif defined(WS_MEMPBRK_NEON)
+    pattern->use_nibbles = ws_mempbrk_nibbles_compile(pattern, needles);
+#endif
+}
+
+#ifdef WS_MEMPBRK_NEON
+/*
+ * Return a mask with bits 4n to 4n+3 set if byte n of data is a needle.
+ * NEON has no movemask, but shifting the 16-bit lanes right by 4 and
+ * narrowing them packs each 0x00/0xff byte into a nibble.
+ */
+static inline uint64_t
+ws_mempbrk_neon_mask(uint8x16_t data, uint8x16_t nibble_lo, uint8x16_t nibble_hi)
+{
+    uint8x16_t lo = vandq_u8(data, vdupq_n_u8(0x0f));
+    uint8x16_t hi = vshrq_n_u8(data, 4);
+    uint8x16_t found = vtstq_u8(vqtbl1q_u8(nibble_lo, lo), vqtbl1q_u8(nibble_hi, hi));
+
+    return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(found), 4)), 0);
+}
+
+/* haystacklen must be at least 16. */
+static const uint8_t *
+ws_mempbrk_neon_exec(const uint8_t* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, unsigned char *found_needle)
+{
+    const uint8x16_t nibble_lo = vld1q_u8(pattern->nibble_lo);
+    const uint8x16_t nibble_hi = vld1q_u8(pattern->nibble_hi);
+    const uint8_t *p = haystack;
+    const uint8_t *end = haystack + haystacklen;
+    uint64_t mask;
+
+    for (; end - p >= 16; p += 16) {
+        mask = ws_mempbrk_neon_mask(vld1q_u8(p), nibble_lo, nibble_hi);
+        if (mask != 0) {
+            p += ws_ctz(mask) / 4;
+            goto found;
+        }
+    }
+
+    if (p == end)
+        return NULL;
+
+    /* The rest, with the last 16 bytes, ignoring the ones already done. */
+    mask = ws_mempbrk_neon_mask(vld1q_u8(end - 16), nibble_lo, nibble_hi);
+    mask &= ~(uint64_t)0 << (4 * (16 - (end - p)));
+    if (mask == 0)
+        return NULL;
+    p = end - 16 + ws_ctz(mask) / 4;
+
+found:
+    if (found_needle)
+        *found_needle = *p;
+    return p;
+}
+
+/* haystacklen must be at least 16. */
+static const uint8_t *
+ws_memrpbrk_neon_exec(const uint8_t* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, unsigned char *found_needle)
+{
+    const uint8x16_t nibble_lo = vld1q_u8(pattern->nibble_lo);
+    const uint8x16_t nibble_hi = vld1q_u8(pattern->nibble_hi);
+    const uint8_t *p = haystack + haystacklen;
+    uint64_t mask;
+
+    for (; p - haystack >= 16; p -= 16) {
+        mask = ws_mempbrk_neon_mask(vld1q_u8(p - 16), nibble_lo, nibble_hi);
+        if (mask != 0) {
+            p = p - 16 + ws_ilog2(mask) / 4;
+            goto found;
+        }
+    }
+
+    if (p == haystack)
+        return NULL;
+
+    /* Likewise with the first 16 bytes. */
+    mask = ws_mempbrk_neon_mask(vld1q_u8(haystack), nibble_lo, nibble_hi);
+    mask &= ((uint64_t)1 << (4 * (p - haystack))) - 1;
+    if (mask == 0)
+        return NULL;
+    p = haystack + ws_ilog2(mask) / 4;
+
+found:
+    if (found_needle)
+        *found_needle = *p;
+    return p;
 }
+#endif /* WS_MEMPBRK_NEON */
 
 
 const uint8_t *
@@ -64,6 +194,16 @@ ws_mempbrk_portable_exec(const uint8_t* haystack, size_t haystacklen, const ws_m
 WS_DLL_PUBLIC const uint8_t *
 ws_mempbrk_exec(const uint8_t* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, unsigned char *found_needle)
 {
+#ifdef HAVE_AVX2
+    if (haystacklen >= 32 && pattern->use_nibbles)
+        return ws_mempbrk_avx2_exec(haystack, haystacklen, pattern, found_needle);
+#endif
+
+#ifdef WS_MEMPBRK_NEON
+    if (haystacklen >= 16 && pattern->use_nibbles)
+        return ws_mempbrk_neon_exec(haystack, haystacklen, pattern, found_needle);
+#endif
+
 #ifdef HAVE_SSE4_2
     if (haystacklen >= 16 && pattern->use_sse42)
         return ws_mempbrk_sse42_exec(haystack, haystacklen, pattern, found_needle);
@@ -77,6 +217,16 @@ ws_memrpbrk_exec(const uint8_t* haystack, size_t haystacklen, const ws_mempbrk_p
 {
     const uint8_t *haystack_end = haystack + haystacklen;
 
+#ifdef HAVE_AVX2
+    if (haystacklen >= 32 && pattern->use_nibbles)
+        return ws_memrpbrk_avx2_exec(haystack, haystacklen, pattern, found_needle);
+#endif
+
+#ifdef WS_MEMPBRK_NEON
+    if (haystacklen >= 16 && pattern->use_nibbles)
+        return ws_memrpbrk_neon_exec(haystack, haystacklen, pattern, found_needle);
+#endif
+
     while (haystack_end > haystack) {
         if (pattern->patt[*(--haystack_end)]) {
             if (found_needle)
@@ -24,6 +24,14 @@ typedef struct {
     bool use_sse42;
     __m128i mask;
 #endif
+#if defined(HAVE_AVX2) || defined(__aarch64__) || defined(_M_ARM64)
+    /* For the AVX2 and NEON code, which looks bytes up by nibble:
+     * a byte is a needle if nibble_lo[byte & 0xf] & nibble_hi[byte >> 4]
+     * is non-zero. */
+    bool use_nibbles;
+    uint8_t nibble_lo[16];
+    uint8_t nibble_hi[16];
+#endif
 } ws_mempbrk_pattern;
 
 /** Compile the pattern for the needles to find using ws_mempbrk_exec().
@@ -0,0 +1,128 @@
+/* ws_mempbrk_avx2.c
+ * ws_mempbrk_exec() and ws_memrpbrk_exec() with AVX2
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#ifdef HAVE_AVX2
+
+#include <immintrin.h>
+
+#include "bits_ctz.h"
+#include "ws_mempbrk.h"
+#include "ws_mempbrk_int.h"
+
+/*
+ * Return a mask with bit n set if byte n of data is a needle. Each
+ * byte's nibbles are looked up in the pattern's nibble tables with
+ * vpshufb, which works within 128-bit lanes, so the tables are
+ * repeated in both lanes.
+ */
+static inline uint32_t
+match_mask(__m256i data, __m256i nibble_lo, __m256i nibble_hi)
+{
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+    __m256i lo = _mm256_and_si256(data, low_nibbles);
+    __m256i hi = _mm256_and_si256(_mm256_srli_epi16(data, 4), low_nibbles);
+    __m256i found = _mm256_and_si256(_mm256_shuffle_epi8(nibble_lo, lo),
+                                     _mm256_shuffle_epi8(nibble_hi, hi));
+
+    return ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(found, _mm256_setzero_si256()));
+}
+
+static inline __m256i
+load_table(const uint8_t *table)
+{
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(const void *)table));
+}
+
+static inline __m256i
+load_data(const uint8_t *p)
+{
+    return _mm256_loadu_si256((const __m256i *)(const void *)p);
+}
+
+static inline const uint8_t *
+found(const uint8_t *p, unsigned char *found_needle)
+{
+    if (found_needle)
+        *found_needle = *p;
+    return p;
+}
+
+const uint8_t *
+ws_mempbrk_avx2_exec(const uint8_t* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, unsigned char *found_needle)
+{
+    const __m256i nibble_lo = load_table(pattern->nibble_lo);
+    const __m256i nibble_hi = load_table(pattern->nibble_hi);
+    const uint8_t *p = haystack;
+    const uint8_t *end = haystack + haystacklen;
+    uint32_t mask;
+
+    for (; end - p >= 32; p += 32) {
+        mask = match_mask(load_data(p), nibble_lo, nibble_hi);
+        if (mask != 0)
+            return found(p + ws_ctz(mask), found_needle);
+    }
+
+    if (p == end)
+        return NULL;
+
+    /*
+     * Do the rest with the last 32 bytes of the haystack, ignoring the
+     * ones that have already been looked at.
+     */
+    mask = match_mask(load_data(end - 32), nibble_lo, nibble_hi);
+    mask &= ~(uint32_t)0 << (32 - (end - p));
+    if (mask != 0)
+        return found(end - 32 + ws_ctz(mask), found_needle);
+
+    return NULL;
+}
+
+const uint8_t *
+ws_memrpbrk_avx2_exec(const uint8_t* haystack, size_t haystacklen, const ws_mempbrk_pattern* pattern, unsigned char *found_needle)
+{
+    const __m256i nibble_lo = load_table(pattern->nibble_lo);
+    const __m256i nibble_hi = load_table(pattern->nibble_hi);
+    const uint8_t *p = haystack + haystacklen;
+    uint32_t mask;
+
+    for (; p - haystack >= 32; p -= 32) {
+        mask = match_mask(load_data(p - 32), nibble_lo, nibble_hi);
+        if (mask != 0)
+            return found(p - 32 + ws_ilog2(mask), found_needle);
+    }
+
+    if (p == haystack)
+        return NULL;
+
+    /* Likewise with the first 32 bytes. */
+    mask = match_mask(load_data(haystack), nibble_lo, nibble_hi);
+    mask &= ((uint32_t)1 << (p - haystack)) - 1;
+    if (mask != 0)
+        return found(haystack + ws_ilog2(mask), found_needle);
+
+    return NULL;
+}
+
+#endif /* HAVE_AVX2 */
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
@@ -0,0 +1,335 @@
+/* ws_multipattern.c
+ * Multi-pattern substring search (Aho-Corasick)
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "config.h"
+
+#include "ws_multipattern.h"
+
+#include <string.h>
+
+#include <wsutil/ws_assert.h>
+#include <wsutil/ws_mempbrk.h>
+
+/*
+ * The automaton is a trie of the needles with Aho-Corasick failure links.
+ * Transitions out of the root are kept in a dense table, since that is
+ * where a scan spends most of its time; all the other transitions are
+ * stored as per-state runs of an edge array sorted by byte value.
+ *
+ * While the scan is at the root, the set of bytes that can start a
+ * needle is used as a prefilter with ws_mempbrk_exec(), which skips
+ * over uninteresting data with SSE4.2 when the set is small enough.
+ */
+
+/* ws_mempbrk_exec() can use pcmpistri only for up to 16 needle bytes. */
+#define PREFILTER_MAX_FIRST_BYTES   16
+
+#define ROOT_STATE  0
+
+typedef struct {
+    uint32_t first_child;
+    uint32_t next_sibling;
+    int32_t  needle_idx;
+    uint8_t  byte;
+} mp_trie_node_t;
+
+typedef struct {
+    uint32_t edges_start;
+    uint32_t edges_count;
+    uint32_t fail;
+    int32_t  needle_idx;   /* Needle ending here or at a suffix, or -1. */
+} mp_state_t;
+
+struct _ws_multipattern {
+    GArray *trie;           /* mp_trie_node_t, only while building */
+    GArray *needle_lens;    /* size_t */
+    bool compiled;
+
+    uint32_t root_next[256];
+    mp_state_t *states;
+    uint8_t *edge_bytes;
+    uint32_t *edge_targets;
+
+    bool use_prefilter;
+    ws_mempbrk_pattern first_bytes;
+};
+
+ws_multipattern_t *
+ws_multipattern_new(void)
+{
+    ws_multipattern_t *mp = g_new0(ws_multipattern_t, 1);
+    mp_trie_node_t root = { 0, 0, -1, 0 };
+
+    mp->trie = g_array_new(FALSE, FALSE, sizeof(mp_trie_node_t));
+    g_array_append_val(mp->trie, root);
+    mp->needle_lens = g_array_new(FALSE, FALSE, sizeof(size_t));
+    return mp;
+}
+
+static uint32_t
+trie_child(GArray *trie, uint32_t node, uint8_t byte)
+{
+    uint32_t child = g_array_index(trie, mp_trie_node_t, node).first_child;
+
+    while (child != 0) {
+        mp_trie_node_t *n = &g_array_index(trie, mp_trie_node_t, child);
+        if (n->byte == byte)
+            return child;
+        child = n->next_sibling;
+    }
+    return 0;
+}
+
+int
+ws_multipattern_add(ws_multipattern_t *mp, const void *needle, size_t needle_len)
+{
+    const uint8_t *bytes = needle;
+    uint32_t node = ROOT_STATE;
+    int idx;
+
+    ws_return_val_if(mp->compiled, -1);
+
+    if (needle_len == 0)
+        return -1;
+
+    for (size_t i = 0; i < needle_len; i++) {
+        uint32_t child = trie_child(mp->trie, node, bytes[i]);
+
+        if (child == 0) {
+            mp_trie_node_t n = { 0, 0, -1, bytes[i] };
+
+            child = mp->trie->len;
+            n.next_sibling = g_array_index(mp->trie, mp_trie_node_t, node).first_child;
+            g_array_append_val(mp->trie, n);
+            g_array_index(mp->trie, mp_trie_node_t, node).first_child = child;
+        }
+        node = child;
+    }
+
+    idx = (int)mp->needle_lens->len;
+    g_array_append_val(mp->needle_lens, needle_len);
+
+    /* A duplicate needle keeps the index of the first one. */
+    if (g_array_index(mp->trie, mp_trie_node_t, node).needle_idx < 0)
+        g_array_index(mp->trie, mp_trie_node_t, node).needle_idx = idx;
+
+    return idx;
+}
+
+static inline uint32_t
+state_child(const ws_multipattern_t *mp, uint32_t state, uint8_t byte)
+{
+    const mp_state_t *s = &mp->states[state];
+    uint32_t lo = s->edges_start;
+    uint32_t hi = s->edges_start + s->edges_count;
+
+    while (lo < hi) {
+        uint32_t mid = lo + (hi - lo) / 2;
+        uint8_t b = mp->edge_bytes[mid];
+
+        if (b == byte)
+            return mp->edge_targets[mid];
+        if (b < byte)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return 0;
+}
+
+static inline uint32_t
+state_next(const ws_multipattern_t *mp, uint32_t state, uint8_t byte)
+{
+    uint32_t next;
+
+    while (state != ROOT_STATE) {
+        next = state_child(mp, state, byte);
+        if (next != 0)
+            return next;
+        state = mp->states[state].fail;
+    }
+    return mp->root_next[byte];
+}
+
+/* Insertion sort of sibling nodes by byte; most states have very few. */
+static void
+sort_siblings(GArray *trie, uint32_t *nodes, unsigned count)
+{
+    for (unsigned i = 1; i < count; i++) {
+        uint32_t node = nodes[i];
+        uint8_t byte = g_array_index(trie, mp_trie_node_t, node).byte;
+        unsigned j = i;
+
+        while (j > 0 && g_array_index(trie, mp_trie_node_t, nodes[j - 1]).byte > byte) {
+            nodes[j] = nodes[j - 1];
+            j--;
+        }
+        nodes[j] = node;
+    }
+}
+
+void
+ws_multipattern_compile(ws_multipattern_t *mp)
+{
+    GArray *trie = mp->trie;
+    uint32_t n_states;
+    uint32_t *queue;
+    unsigned head = 0, tail = 0;
+    uint32_t n_edges = 0;
+    char first_bytes[PREFILTER_MAX_FIRST_BYTES + 1];
+    unsigned n_first_bytes = 0;
+
+    if (mp->compiled)
+        return;
+
+    n_states = trie->len;
+    mp->states = g_new0(mp_state_t, n_states);
+    mp->edge_bytes = g_new(uint8_t, n_states);
+    mp->edge_targets = g_new(uint32_t, n_states);
+    queue = g_new(uint32_t, n_states);
+
+    memset(mp->root_next, 0, sizeof(mp->root_next));
+    mp->states[ROOT_STATE].needle_idx = -1;
+
+    /*
+     * Breadth-first walk: a state's failure link always points to a
+     * shallower state, so it is complete by the time we need it.
+     */
+    queue[tail++] = ROOT_STATE;
+    while (head < tail) {
+        uint32_t node = queue[head++];
+        mp_state_t *state = &mp->states[node];
+        uint32_t child;
+        unsigned first;
+
+        if (node != ROOT_STATE) {
+            state->needle_idx = g_array_index(trie, mp_trie_node_t, node).needle_idx;
+            if (state->needle_idx < 0)
+                state->needle_idx = mp->states[state->fail].needle_idx;
+        }
+
+        first = tail;
+        for (child = g_array_index(trie, mp_trie_node_t, node).first_child;
+                child != 0;
+                child = g_array_index(trie, mp_trie_node_t, child).next_sibling) {
+            uint8_t byte = g_array_index(trie, mp_trie_node_t, child).byte;
+
+            if (node == ROOT_STATE) {
+                mp->root_next[byte] = child;
+                mp->states[child].fail = ROOT_STATE;
+            }
+            else {
+                /* Edges of shallower states are already flattened. */
+                mp->states[child].fail = state_next(mp, state->fail, byte);
+            }
+            queue[tail++] = child;
+        }
+
+        /* Flatten this state's edges, sorted by byte. */
+        sort_siblings(trie, &queue[first], tail - first);
+        state->edges_start = n_edges;
+        state->edges_count = tail - first;
+        for (unsigned i = first; i < tail; i++) {
+            mp->edge_bytes[n_edges] = g_array_index(trie, mp_trie_node_t, queue[i]).byte;
+            mp->edge_targets[n_edges] = queue[i];
+            n_edges++;
+        }
+    }
+
+    g_free(queue);
+    g_array_free(mp->trie, TRUE);
+    mp->trie = NULL;
+
+    /*
+     * The prefilter needle list is NUL-terminated, so it can't be
+     * used if some needle starts with a NUL byte.
+     */
+    mp->use_prefilter = mp->root_next[0] == 0;
+    for (unsigned b = 1; b < 256 && mp->use_prefilter; b++) {
+        if (mp->root_next[b] == 0)
+            continue;
+        if (n_first_bytes == PREFILTER_MAX_FIRST_BYTES)
+            mp->use_prefilter = false;
+        else
+            first_bytes[n_first_bytes++] = (char)b;
+    }
+    if (mp->use_prefilter) {
+        first_bytes[n_first_bytes] = '\0';
+        ws_mempbrk_compile(&mp->first_bytes, first_bytes);
+    }
+
+    mp->compiled = true;
+}
+
+unsigned
+ws_multipattern_count(const ws_multipattern_t *mp)
+{
+    return mp->needle_lens->len;
+}
+
+const uint8_t *
+ws_multipattern_exec(const ws_multipattern_t *mp,
+                     const void *haystack, size_t haystack_len,
+                     unsigned *needle_idx)
+{
+    const uint8_t *p = haystack;
+    const uint8_t *end = p + haystack_len;
+    uint32_t state = ROOT_STATE;
+    int32_t idx;
+
+    ws_return_val_if(!mp->compiled, NULL);
+
+    if (mp->needle_lens->len == 0)
+        return NULL;
+
+    while (p < end) {
+        if (state == ROOT_STATE && mp->use_prefilter) {
+            p = ws_mempbrk_exec(p, end - p, &mp->first_bytes, NULL);
+            if (p == NULL)
+                return NULL;
+        }
+        state = state_next(mp, state, *p++);
+        idx = mp->states[state].needle_idx;
+        if (idx >= 0) {
+            if (needle_idx)
+                *needle_idx = (unsigned)idx;
+            return p - g_array_index(mp->needle_lens, size_t, idx);
+        }
+    }
+
+    return NULL;
+}
+
+void
+ws_multipattern_free(ws_multipattern_t *mp)
+{
+    if (mp == NULL)
+        return;
+    if (mp->trie)
+        g_array_free(mp->trie, TRUE);
+    g_array_free(mp->needle_lens, TRUE);
+    g_free(mp->states);
+    g_free(mp->edge_bytes);
+    g_free(mp->edge_targets);
+    g_free(mp);
+}
+
+/*
+ * Editor modelines  -  https://www.wireshark.org/tools/modelines.html
+ *
+ * Local variables:
+ * c-basic-offset: 4
+ * tab-width: 8
+ * indent-tabs-mode: nil
+ * End:
+ *
+ * vi: set shiftwidth=4 tabstop=8 expandtab:
+ * :indentSize=4:tabSize=8:noTabs=true:
+ */
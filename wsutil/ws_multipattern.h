@@ -0,0 +1,71 @@
+/** @file
+ *
+ * Multi-pattern substring search (Aho-Corasick)
+ *
+ * Wireshark - Network traffic analyzer
+ * By Gerald Combs <gerald@wireshark.org>
+ * Copyright 1998 Gerald Combs
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __WS_MULTIPATTERN_H__
+#define __WS_MULTIPATTERN_H__
+
+#include <wireshark.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/** An automaton that searches a buffer for any of a set of byte strings
+ * in a single pass, independently of the number of needles.
+ *
+ * Needles are added with ws_multipattern_add() and the automaton is
+ * built with ws_multipattern_compile(); after that the object is
+ * read-only and can be used concurrently by several threads.
+ */
+typedef struct _ws_multipattern ws_multipattern_t;
+
+/** Create an empty pattern set. */
+WS_DLL_PUBLIC ws_multipattern_t *
+ws_multipattern_new(void);
+
+/** Add a needle to the pattern set. Empty needles are ignored.
+ * Must not be called after ws_multipattern_compile().
+ *
+ * @return The index of the needle, or -1 if it was ignored.
+ */
+WS_DLL_PUBLIC int
+ws_multipattern_add(ws_multipattern_t *mp, const void *needle, size_t needle_len);
+
+/** Build the automaton. Must be called once before ws_multipattern_exec(). */
+WS_DLL_PUBLIC void
+ws_multipattern_compile(ws_multipattern_t *mp);
+
+/** Returns the number of needles in the pattern set. */
+WS_DLL_PUBLIC unsigned
+ws_multipattern_count(const ws_multipattern_t *mp);
+
+/** Scan the haystack for the first occurrence of any needle.
+ *
+ * @param mp The compiled pattern set.
+ * @param haystack The data to search.
+ * @param haystack_len The length of the data.
+ * @param[out] needle_idx If not NULL, set to the index of the needle found.
+ * @return A pointer to the start of the first match (by end position)
+ * or NULL if no needle occurs in the haystack.
+ */
+WS_DLL_PUBLIC const uint8_t *
+ws_multipattern_exec(const ws_multipattern_t *mp,
+                     const void *haystack, size_t haystack_len,
+                     unsigned *needle_idx);
+
+WS_DLL_PUBLIC void
+ws_multipattern_free(ws_multipattern_t *mp);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* __WS_MULTIPATTERN_H__ */